@@ -0,0 +1,412 @@
+#include "benchmark.h"
+
+/**
+* @file benchmark.h
+* @brief This file defines a small benchmark harness in the style of Google Benchmark, without
+* the dependency: a suite of named bodies run for a calibrated number of iterations, reported in
+* nanoseconds and heap allocations per operation, and written in a versioned JSON (or CSV) file
+* which a later run compares itself to, to fail on performance regressions.
+*
+* An operation is one item of an iteration: a body pricing a chain of 4096 options per
+* iteration registers 4096 items, and its ns/op is per option. The timings are the median
+* (and the minimum) of several repetitions. The allocations are counted by replacing the global
+* operator new in the benchmark binary.
+*
+* References :
+* - "Google Benchmark", https://github.com/google/benchmark.
+* - "Robust benchmarking in noisy environments", Chen, Revels, 2016.
+*/
+
+static std::atomic<std::size_t> allocations{0};
+
+/**
+ * @brief The global operator new of the benchmark binary, counts the allocations.
+ * @param size The size of the allocation.
+ * @return The allocated memory.
+ * @throw std::bad_alloc
+ */
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)){return p;}
+    throw std::bad_alloc();
+};
+
+/**
+ * @brief The global operator new[] of the benchmark binary, counts the allocations.
+ * @param size The size of the allocation.
+ * @return The allocated memory.
+ * @throw std::bad_alloc
+ */
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+};
+
+/**
+ * @brief The global operator delete matching operator new.
+ * @param p The memory.
+ */
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+};
+
+/**
+ * @brief The global operator delete[] matching operator new[].
+ * @param p The memory.
+ */
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+};
+
+/**
+ * @brief The sized global operator delete matching operator new.
+ * @param p The memory.
+ */
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+};
+
+/**
+ * @brief The sized global operator delete[] matching operator new[].
+ * @param p The memory.
+ */
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+};
+
+/**
+ * @return The number of allocations through operator new since the start of the program.
+ */
+std::size_t benchmark_get_allocations()
+{
+    return allocations.load(std::memory_order_relaxed);
+};
+
+/**
+ * @var int BENCHMARK_SUITE_VERSION
+ * @brief The version of the suite and of its output: the results of two versions are not
+ * compared.
+ */
+
+/**
+ * @var double BENCHMARK_MIN_TIME_MS
+ * @brief The default time spent measuring a benchmark, in milliseconds.
+ */
+
+/**
+ * @var std::size_t BENCHMARK_REPETITIONS
+ * @brief The default number of timed repetitions of a benchmark.
+ */
+
+/**
+ * @var int BENCHMARK_NAME_WIDTH
+ * @brief The width of the name column of the text reports.
+ */
+
+/**
+ * @class BenchmarkIOError
+ * @brief Definition of the error when a results file can not be read or written.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * BenchmarkIOError::what() const throw(){
+    return "The benchmark results file can not be read or written.";
+};
+
+/**
+ * @class BenchmarkWrongFormat
+ * @brief Definition of the error when a results file is not of the version of the suite.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * BenchmarkWrongFormat::what() const throw(){
+    return "The benchmark results file is not a results file of this version of the suite.";
+};
+
+/**
+ * @class BenchmarkCheckFailed
+ * @brief Definition of the error when a benchmarked function does not give the expected result
+ * on its benchmark inputs.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * BenchmarkCheckFailed::what() const throw(){
+    return "A benchmarked function does not give the expected result on its benchmark inputs.";
+};
+
+/**
+ * @enum BenchmarkFormat
+ * @brief The output formats: a table for the console, JSON and CSV for the tools.
+ */
+
+/**
+ * @struct BenchmarkResult
+ * @brief The result of a benchmark: the median and minimum ns per operation over the
+ * repetitions, the allocations per operation and the operations per second (from the median).
+ */
+
+/**
+ * @fn template <typename T> void benchmark_do_not_optimize(const T& value)
+ * @brief Forces the compiler to materialize a value, so that the computation of an unused
+ * result is not removed.
+ * @param value The value.
+ */
+
+/**
+ * @fn void benchmark_clobber_memory()
+ * @brief Forces the compiler to consider that the memory is read and written, so that the
+ * stores of a body are not removed or moved out of the loop.
+ */
+
+/**
+ * @class BenchmarkSuite
+ * @brief The registered benchmarks and their runner.
+ */
+
+/**
+ * @brief Constructor, BENCHMARK_MIN_TIME_MS and BENCHMARK_REPETITIONS.
+ */
+BenchmarkSuite::BenchmarkSuite(): BenchmarkSuite(BENCHMARK_MIN_TIME_MS, BENCHMARK_REPETITIONS){};
+
+/**
+ * @brief Constructor.
+ * @param min_time_ms The time spent measuring a benchmark, in milliseconds.
+ * @param repetitions The number of timed repetitions (at least 1).
+ */
+BenchmarkSuite::BenchmarkSuite(const double min_time_ms, const std::size_t repetitions):
+    min_time_ms_(min_time_ms), repetitions_(std::max<std::size_t>(repetitions, 1)){};
+
+/**
+ * @brief Registers a benchmark.
+ * @param name The name, stable across versions of the code so that the results compare.
+ * @param items_per_iteration The number of operations of an iteration.
+ * @param body The body, which runs the given number of iterations.
+ */
+void BenchmarkSuite::add(
+    const std::string& name,
+    const std::size_t items_per_iteration,
+    const std::function<void(std::size_t iterations)>& body)
+{
+    entries.push_back(Entry{name, std::max<std::size_t>(items_per_iteration, 1), body});
+};
+
+/**
+ * @return The number of benchmarks.
+ */
+std::size_t BenchmarkSuite::size() const
+{
+    return entries.size();
+};
+
+/**
+ * @brief Runs a benchmark: one warm-up iteration, a calibration of the number of iterations
+ * to min_time_ms/repetitions per repetition, then the timed repetitions.
+ * @param entry The benchmark.
+ * @return The result.
+ */
+BenchmarkResult BenchmarkSuite::run_entry(const Entry& entry)
+{
+    using clock = std::chrono::steady_clock;
+    auto elapsed_ns = [&](std::size_t iterations)
+    {
+        const auto start = clock::now();
+        entry.body(iterations);
+        return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    };
+    entry.body(1);
+    const double target_ns = 1e6*min_time_ms_/static_cast<double>(repetitions_);
+    std::size_t iterations = 1;
+    double ns = elapsed_ns(iterations);
+    while (ns < 0.1*target_ns && iterations < (std::size_t(1) << 40)){
+        iterations *= 10;
+        ns = elapsed_ns(iterations);
+    }
+    iterations = std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(iterations)*target_ns/std::max(ns, 1.)));
+
+    std::vector<double> ns_per_op(repetitions_);
+    const std::size_t allocations_before = benchmark_get_allocations();
+    for (std::size_t r = 0; r < repetitions_; r++){
+        ns_per_op[r] = elapsed_ns(iterations)/static_cast<double>(iterations*entry.items_per_iteration);
+    }
+    const std::size_t n_allocations = benchmark_get_allocations() - allocations_before;
+    std::sort(ns_per_op.begin(), ns_per_op.end());
+    const double median = repetitions_ % 2 ? ns_per_op[repetitions_/2]
+        : 0.5*(ns_per_op[repetitions_/2 - 1] + ns_per_op[repetitions_/2]);
+    return BenchmarkResult{
+        entry.name, entry.items_per_iteration, iterations, median, ns_per_op.front(),
+        static_cast<double>(n_allocations)/static_cast<double>(repetitions_*iterations*entry.items_per_iteration),
+        median > 0. ? 1e9/median : 0.
+    };
+};
+
+/**
+ * @brief Runs the benchmarks whose name contains the filter, in the order of registration.
+ * @param filter The filter, empty for all the benchmarks.
+ * @param progress The stream where the name of each benchmark is written before it runs, null
+ * for none.
+ * @return The results.
+ */
+std::vector<BenchmarkResult> BenchmarkSuite::run(const std::string& filter, std::ostream* progress)
+{
+    std::vector<BenchmarkResult> results;
+    for (const Entry& entry : entries){
+        if (!filter.empty() && entry.name.find(filter) == std::string::npos){continue;}
+        if (progress){*progress << entry.name << std::endl;}
+        results.push_back(run_entry(entry));
+    }
+    return results;
+};
+
+/**
+ * @brief Writes results.
+ * @param out The stream.
+ * @param results The results.
+ * @param format The format: BENCHMARK_JSON writes one benchmark per line, which
+ * read_benchmark_results reads back.
+ */
+void write_benchmark_results(std::ostream& out, const std::vector<BenchmarkResult>& results, const BenchmarkFormat format)
+{
+    if (format == BENCHMARK_JSON){
+        out << "{\n\"version\": " << BENCHMARK_SUITE_VERSION << ",\n\"benchmarks\": [\n";
+        out << std::setprecision(9);
+        for (std::size_t i = 0; i < results.size(); i++){
+            const BenchmarkResult& result = results[i];
+            out << "{\"name\": \"" << result.name << "\", \"items_per_iteration\": " << result.items_per_iteration
+                << ", \"iterations\": " << result.iterations << ", \"ns_per_op\": " << result.ns_per_op
+                << ", \"ns_per_op_min\": " << result.ns_per_op_min << ", \"allocations_per_op\": " << result.allocations_per_op
+                << ", \"ops_per_second\": " << result.ops_per_second << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]\n}\n";
+    }
+    else if (format == BENCHMARK_CSV){
+        out << "name,items_per_iteration,iterations,ns_per_op,ns_per_op_min,allocations_per_op,ops_per_second\n";
+        out << std::setprecision(9);
+        for (const BenchmarkResult& result : results){
+            out << result.name << "," << result.items_per_iteration << "," << result.iterations << ","
+                << result.ns_per_op << "," << result.ns_per_op_min << "," << result.allocations_per_op << ","
+                << result.ops_per_second << "\n";
+        }
+    }
+    else{
+        out << std::left << std::setw(BENCHMARK_NAME_WIDTH) << "benchmark" << std::right << std::setw(12) << "ns/op"
+            << std::setw(12) << "min ns/op" << std::setw(12) << "allocs/op" << std::setw(14) << "Mops/s" << "\n";
+        for (const BenchmarkResult& result : results){
+            out << std::left << std::setw(BENCHMARK_NAME_WIDTH) << result.name << std::right << std::fixed << std::setprecision(2)
+                << std::setw(12) << result.ns_per_op << std::setw(12) << result.ns_per_op_min
+                << std::setw(12) << std::setprecision(3) << result.allocations_per_op
+                << std::setw(14) << std::setprecision(2) << result.ops_per_second*1e-6 << "\n";
+        }
+        out.unsetf(std::ios::fixed);
+    }
+};
+
+/**
+ * @brief Reads a field of a line of the JSON output.
+ * @param line The line.
+ * @param field The name of the field.
+ * @return The text of the value (without the quotes of a string).
+ * @throw BenchmarkWrongFormat if the field is not in the line.
+ */
+static std::string read_json_field(const std::string& line, const std::string& field)
+{
+    const std::string key = "\"" + field + "\": ";
+    std::size_t begin = line.find(key);
+    if (begin == std::string::npos){throw BenchmarkWrongFormat();}
+    begin += key.size();
+    if (line[begin] == '"'){
+        const std::size_t end = line.find('"', begin + 1);
+        if (end == std::string::npos){throw BenchmarkWrongFormat();}
+        return line.substr(begin + 1, end - begin - 1);
+    }
+    const std::size_t end = line.find_first_of(",}", begin);
+    return line.substr(begin, end - begin);
+};
+
+/**
+ * @brief Reads the results written by write_benchmark_results in BENCHMARK_JSON.
+ * @param path The path of the file.
+ * @return The results.
+ * @throw BenchmarkIOError if the file can not be read.
+ * @throw BenchmarkWrongFormat if the file is not a results file of BENCHMARK_SUITE_VERSION.
+ */
+std::vector<BenchmarkResult> read_benchmark_results(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file){throw BenchmarkIOError();}
+    std::vector<BenchmarkResult> results;
+    std::string line;
+    bool has_version = false;
+    while (std::getline(file, line)){
+        if (line.rfind("\"version\": ", 0) == 0){
+            if (std::atoi(line.c_str() + 11) != BENCHMARK_SUITE_VERSION){throw BenchmarkWrongFormat();}
+            has_version = true;
+        }
+        else if (line.rfind("{\"name\": ", 0) == 0){
+            results.push_back(BenchmarkResult{
+                read_json_field(line, "name"),
+                static_cast<std::size_t>(std::strtoull(read_json_field(line, "items_per_iteration").c_str(), nullptr, 10)),
+                static_cast<std::size_t>(std::strtoull(read_json_field(line, "iterations").c_str(), nullptr, 10)),
+                std::strtod(read_json_field(line, "ns_per_op").c_str(), nullptr),
+                std::strtod(read_json_field(line, "ns_per_op_min").c_str(), nullptr),
+                std::strtod(read_json_field(line, "allocations_per_op").c_str(), nullptr),
+                std::strtod(read_json_field(line, "ops_per_second").c_str(), nullptr)
+            });
+        }
+    }
+    if (!has_version){throw BenchmarkWrongFormat();}
+    return results;
+};
+
+/**
+ * @brief Compares results to a baseline: a benchmark regresses when its median ns/op is above
+ * (1 + tolerance) times the baseline, or when it allocates more per operation. The benchmarks
+ * missing from either side are reported and not counted.
+ * @param baseline The results of the baseline.
+ * @param results The results of the run.
+ * @param tolerance The relative slowdown tolerated, 0.1 for 10%.
+ * @param out The stream of the report.
+ * @return The number of regressions.
+ */
+std::size_t compare_benchmark_results(
+    const std::vector<BenchmarkResult>& baseline,
+    const std::vector<BenchmarkResult>& results,
+    const double tolerance,
+    std::ostream& out)
+{
+    std::size_t n_regressions = 0;
+    for (const BenchmarkResult& result : results){
+        const auto found = std::find_if(baseline.begin(), baseline.end(),
+            [&](const BenchmarkResult& b){return b.name == result.name;});
+        if (found == baseline.end()){
+            out << "new        " << result.name << "\n";
+            continue;
+        }
+        const double ratio = found->ns_per_op > 0. ? result.ns_per_op/found->ns_per_op : 1.;
+        const bool slower = ratio > 1. + tolerance;
+        const bool allocates = result.allocations_per_op > found->allocations_per_op + 1e-9;
+        n_regressions += slower || allocates;
+        out << (slower || allocates ? "REGRESSION " : "ok         ") << std::left << std::setw(BENCHMARK_NAME_WIDTH) << result.name
+            << std::right << std::fixed << std::setprecision(2) << std::setw(10) << found->ns_per_op << " -> "
+            << std::setw(10) << result.ns_per_op << " ns/op (x" << std::setprecision(3) << ratio << ")";
+        if (allocates){out << ", allocs/op " << found->allocations_per_op << " -> " << result.allocations_per_op;}
+        out << "\n";
+        out.unsetf(std::ios::fixed);
+    }
+    for (const BenchmarkResult& b : baseline){
+        const auto found = std::find_if(results.begin(), results.end(),
+            [&](const BenchmarkResult& r){return r.name == b.name;});
+        if (found == results.end()){out << "missing    " << b.name << "\n";}
+    }
+    return n_regressions;
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+
+constexpr int BENCHMARK_SUITE_VERSION = 1;
+
+constexpr double BENCHMARK_MIN_TIME_MS = 200.;
+
+constexpr std::size_t BENCHMARK_REPETITIONS = 5;
+
+constexpr int BENCHMARK_NAME_WIDTH = 52;
+
+class BenchmarkIOError:  public std::exception
+{public: const char * what() const throw();};
+
+class BenchmarkWrongFormat:  public std::exception
+{public: const char * what() const throw();};
+
+class BenchmarkCheckFailed:  public std::exception
+{public: const char * what() const throw();};
+
+enum BenchmarkFormat
+{
+    BENCHMARK_CONSOLE = 0,
+    BENCHMARK_JSON = 1,
+    BENCHMARK_CSV = 2
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::size_t items_per_iteration;
+    std::size_t iterations;
+    double ns_per_op;
+    double ns_per_op_min;
+    double allocations_per_op;
+    double ops_per_second;
+};
+
+template <typename T>
+inline void benchmark_do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+};
+
+inline void benchmark_clobber_memory()
+{
+    asm volatile("" : : : "memory");
+};
+
+std::size_t benchmark_get_allocations();
+
+class BenchmarkSuite
+{
+    public:
+        BenchmarkSuite();
+        BenchmarkSuite(const double min_time_ms, const std::size_t repetitions);
+        ~BenchmarkSuite(){};
+        void add(
+            const std::string& name,
+            const std::size_t items_per_iteration,
+            const std::function<void(std::size_t iterations)>& body);
+        std::size_t size() const;
+        std::vector<BenchmarkResult> run(const std::string& filter, std::ostream* progress);
+    private:
+        struct Entry
+        {
+            std::string name;
+            std::size_t items_per_iteration;
+            std::function<void(std::size_t iterations)> body;
+        };
+        BenchmarkResult run_entry(const Entry& entry);
+        double min_time_ms_;
+        std::size_t repetitions_;
+        std::vector<Entry> entries;
+};
+
+void write_benchmark_results(std::ostream& out, const std::vector<BenchmarkResult>& results, const BenchmarkFormat format);
+
+std::vector<BenchmarkResult> read_benchmark_results(const std::string& path);
+
+std::size_t compare_benchmark_results(
+    const std::vector<BenchmarkResult>& baseline,
+    const std::vector<BenchmarkResult>& results,
+    const double tolerance,
+    std::ostream& out);
+
+void register_pricing_benchmarks(BenchmarkSuite& suite);
@@ -0,0 +1,111 @@
+#include "benchmark.h"
+
+/**
+* @file main.cpp
+* @brief The benchmark binary of the pricing hot paths.
+*
+* Build, from the root of the repository (the same flags as the library), in one command:
+*
+*     g++ -std=c++20 -O2 -march=native -pthread -Isrc
+*         -include memory -include string -include vector -include cmath -include algorithm
+*         -include map -include set -include cstring
+*         benchmarks/main.cpp benchmarks/benchmark.cpp benchmarks/pricing.cpp
+*         $(find src -name "*.cpp") -o arbitrage_benchmarks
+*
+* The forced includes provide the standard headers that some sources of src only get
+* transitively with other standard libraries.
+*
+* Run:
+*
+*     ./arbitrage_benchmarks [--filter=<substring>] [--min-time-ms=<ms>] [--repetitions=<n>]
+*         [--format=console|json|csv] [--out=<path>] [--baseline=<path>] [--tolerance=<ratio>]
+*
+* --out writes the results in the given format (json by default for a file), --baseline
+* compares the run to a json file of a previous run: the exit code is 1 if a benchmark is
+* slower than (1 + tolerance) times the baseline (tolerance 0.1 by default) or allocates more,
+* so that a change can be gated on it. The baseline must come from the same machine and flags.
+*/
+
+/**
+ * @brief Reads the value of an option --name=value.
+ * @param argument The argument.
+ * @param name The name of the option, with the leading dashes and the equal sign.
+ * @param value The value, set if the argument is the option.
+ * @return True if the argument is the option.
+ */
+static bool read_option(const std::string& argument, const std::string& name, std::string& value)
+{
+    if (argument.rfind(name, 0) != 0){return false;}
+    value = argument.substr(name.size());
+    return true;
+};
+
+/**
+ * @brief Reads the name of a format.
+ * @param name The name: console, json or csv.
+ * @return The format.
+ * @throw BenchmarkWrongFormat if the name is not a format.
+ */
+static BenchmarkFormat read_format(const std::string& name)
+{
+    if (name == "console"){return BENCHMARK_CONSOLE;}
+    if (name == "json"){return BENCHMARK_JSON;}
+    if (name == "csv"){return BENCHMARK_CSV;}
+    throw BenchmarkWrongFormat();
+};
+
+/**
+ * @brief Runs the benchmarks, writes and compares their results.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @return 0, 1 if there are regressions against the baseline, 2 for a wrong argument or file.
+ */
+int main(int argc, char** argv)
+{
+    std::string filter, out_path, baseline_path, value;
+    double min_time_ms = BENCHMARK_MIN_TIME_MS;
+    double tolerance = 0.1;
+    std::size_t repetitions = BENCHMARK_REPETITIONS;
+    bool has_format = false;
+    BenchmarkFormat format = BENCHMARK_CONSOLE;
+    try{
+        for (int i = 1; i < argc; i++){
+            const std::string argument(argv[i]);
+            if (read_option(argument, "--filter=", value)){filter = value;}
+            else if (read_option(argument, "--min-time-ms=", value)){min_time_ms = std::stod(value);}
+            else if (read_option(argument, "--repetitions=", value)){repetitions = std::stoul(value);}
+            else if (read_option(argument, "--format=", value)){format = read_format(value); has_format = true;}
+            else if (read_option(argument, "--out=", value)){out_path = value;}
+            else if (read_option(argument, "--baseline=", value)){baseline_path = value;}
+            else if (read_option(argument, "--tolerance=", value)){tolerance = std::stod(value);}
+            else{
+                std::cerr << "unknown argument " << argument << std::endl;
+                return 2;
+            }
+        }
+
+        BenchmarkSuite suite(min_time_ms, repetitions);
+        register_pricing_benchmarks(suite);
+        const std::vector<BenchmarkResult> results = suite.run(filter, out_path.empty() ? nullptr : &std::cerr);
+
+        if (out_path.empty()){write_benchmark_results(std::cout, results, format);}
+        else{
+            std::ofstream file(out_path);
+            if (!file){throw BenchmarkIOError();}
+            write_benchmark_results(file, results, has_format ? format : BENCHMARK_JSON);
+            write_benchmark_results(std::cout, results, BENCHMARK_CONSOLE);
+        }
+
+        if (!baseline_path.empty()){
+            const std::size_t n_regressions = compare_benchmark_results(
+                read_benchmark_results(baseline_path), results, tolerance, std::cout);
+            std::cout << n_regressions << " regression(s) against " << baseline_path << std::endl;
+            return n_regressions > 0 ? 1 : 0;
+        }
+    }
+    catch (std::exception& error){
+        std::cerr << error.what() << std::endl;
+        return 2;
+    }
+    return 0;
+};
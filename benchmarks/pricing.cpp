@@ -0,0 +1,579 @@
+#include "benchmark.h"
+#include <cmath>
+#include <memory>
+#include <random>
+#include "../src/math/probability/normal/normal.h"
+#include "../src/math/interpolation2D/linearinterpolation/linearinterplation.h"
+#include "../src/math/interpolation2D/cubicspline/cubicspline.h"
+#include "../src/frameworks/blackscholes/blackscholes.h"
+#include "../src/frameworks/blackscholes/batch/batch.h"
+#include "../src/frameworks/blackscholes/impliedvolatility/impliedvolatility.h"
+#include "../src/frameworks/svi/svi.h"
+#include "../src/frameworks/svi/calibration/calibration.h"
+#include "../src/frameworks/nelsonsiegel/nelsonsiegel.h"
+#include "../src/datastructure/datetime/datetime.h"
+
+/**
+* @file pricing.cpp
+* @brief This file registers the benchmarks of the pricing hot paths, on inputs of the size of
+* a crypto option chain: 4096 options (strikes from 50% to 150% of the spot, expiries from a day
+* to two years, volatilities from 40% to 100%), 200 log-moneyness points per SVI slice, 30
+* maturities per curve, 7 expiries of 40 quotes per SVI calibration. The inputs are drawn once
+* from a fixed seed, so that two runs measure the same work.
+*
+* The names are <module>/<function>[/<size>], an operation is one option, point, date or
+* calibrated quote.
+*/
+
+/**
+ * @var std::size_t BENCHMARK_CHAIN
+ * @brief The number of options of the benchmarked chain.
+ */
+static constexpr std::size_t BENCHMARK_CHAIN = 4096;
+
+/**
+ * @var std::size_t BENCHMARK_SVI_POINTS
+ * @brief The number of log-moneyness points of an SVI slice.
+ */
+static constexpr std::size_t BENCHMARK_SVI_POINTS = 200;
+
+/**
+ * @struct BenchmarkChain
+ * @brief The structure of arrays of the benchmarked chain, and its prices at the chain
+ * volatilities (the inputs of the implied volatility benchmarks).
+ */
+struct BenchmarkChain
+{
+    std::vector<double> S, K, r, q, sigma, T, price;
+    std::unique_ptr<bool[]> is_call;
+    std::unique_ptr<bool[]> is_future;
+    BenchmarkChain(const std::size_t n): S(n), K(n), r(n), q(n), sigma(n), T(n), price(n),
+        is_call(new bool[n]), is_future(new bool[n])
+    {
+        std::mt19937_64 generator(20240501);
+        std::uniform_real_distribution<double> uniform(0., 1.);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            S[i] = 60000.;
+            K[i] = S[i]*(0.5 + uniform(generator));
+            r[i] = 0.05;
+            q[i] = 0.;
+            sigma[i] = 0.4 + 0.6*uniform(generator);
+            T[i] = 1./365. + 2.*uniform(generator);
+            is_call[i] = i % 2 == 0;
+            is_future[i] = i % 4 == 0;
+            price[i] = BlackScholesClosedForm(S[i], K[i], r[i], q[i], sigma[i], T[i], is_call[i], is_future[i]).price();
+        }
+    };
+    BlackScholesBatchInput get_input() const
+    {
+        return BlackScholesBatchInput{S.size(), S.data(), K.data(), r.data(), q.data(), sigma.data(), T.data(),
+            is_call.get(), is_future.get(), nullptr};
+    };
+};
+
+/**
+ * @brief Draws sorted or shuffled points in an interval.
+ * @param n The number of points.
+ * @param a The lower bound.
+ * @param b The upper bound.
+ * @param sorted True for increasing points.
+ * @return The points.
+ */
+static std::vector<double> draw_points(const std::size_t n, const double a, const double b, const bool sorted)
+{
+    std::mt19937_64 generator(7);
+    std::uniform_real_distribution<double> uniform(a, b);
+    std::vector<double> points(n);
+    for (double& point : points){point = uniform(generator);}
+    if (sorted){std::sort(points.begin(), points.end());}
+    return points;
+};
+
+/**
+ * @brief Registers the Black-Scholes benchmarks: the constructor, the price and each Greek
+ * from a constructed option (its memoized values cleared), the bundle of all the Greeks, the
+ * batches and the implied volatility.
+ * @param suite The suite.
+ */
+static void register_black_scholes(BenchmarkSuite& suite)
+{
+    auto chain = std::make_shared<BenchmarkChain>(BENCHMARK_CHAIN);
+    const std::size_t n = BENCHMARK_CHAIN;
+    suite.add("blackscholes/construct", n, [chain, n](std::size_t iterations)
+    {
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                BlackScholesClosedForm option(chain->S[i], chain->K[i], chain->r[i], chain->q[i], chain->sigma[i],
+                    chain->T[i], chain->is_call[i], chain->is_future[i]);
+                benchmark_do_not_optimize(option.Nd2);
+            }
+        }
+    });
+
+    auto options = std::make_shared<std::vector<BlackScholesClosedForm>>();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        options->emplace_back(chain->S[i], chain->K[i], chain->r[i], chain->q[i], chain->sigma[i], chain->T[i],
+            chain->is_call[i], chain->is_future[i]);
+    }
+    const std::pair<const char*, double (BlackScholesClosedForm::*)()> greeks[] = {
+        {"price", &BlackScholesClosedForm::price}, {"delta", &BlackScholesClosedForm::delta},
+        {"gamma", &BlackScholesClosedForm::gamma}, {"theta", &BlackScholesClosedForm::theta},
+        {"vega", &BlackScholesClosedForm::vega}, {"rho", &BlackScholesClosedForm::rho},
+        {"epsilon", &BlackScholesClosedForm::epsilon}, {"vanna", &BlackScholesClosedForm::vanna},
+        {"volga", &BlackScholesClosedForm::volga}, {"charm", &BlackScholesClosedForm::charm},
+        {"veta", &BlackScholesClosedForm::veta}, {"zomma", &BlackScholesClosedForm::zomma},
+        {"speed", &BlackScholesClosedForm::speed}, {"color", &BlackScholesClosedForm::color},
+        {"ultima", &BlackScholesClosedForm::ultima}, {"dual_delta", &BlackScholesClosedForm::dual_delta},
+        {"dual_gamma", &BlackScholesClosedForm::dual_gamma}
+    };
+    for (const auto& greek : greeks)
+    {
+        const auto method = greek.second;
+        suite.add(std::string("blackscholes/") + greek.first, n, [options, method](std::size_t iterations)
+        {
+            for (std::size_t it = 0; it < iterations; ++it)
+            {
+                for (BlackScholesClosedForm& option : *options)
+                {
+                    option.cached_mask = 0;
+                    benchmark_do_not_optimize((option.*method)());
+                }
+            }
+        });
+    }
+    suite.add("blackscholes/all_greeks", n, [options](std::size_t iterations)
+    {
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (BlackScholesClosedForm& option : *options)
+            {
+                option.cached_mask = 0;
+                benchmark_do_not_optimize(option.all_greeks());
+            }
+        }
+    });
+
+    auto outputs = std::make_shared<std::vector<std::vector<double>>>(17, std::vector<double>(n));
+    auto bad_input = std::make_shared<std::vector<unsigned char>>(n);
+    auto get_output = [outputs, bad_input]()
+    {
+        std::vector<std::vector<double>>& o = *outputs;
+        return BlackScholesBatchOutput{o[0].data(), o[1].data(), o[2].data(), o[3].data(), o[4].data(), o[5].data(),
+            o[6].data(), o[7].data(), o[8].data(), o[9].data(), o[10].data(), o[11].data(), o[12].data(),
+            o[13].data(), o[14].data(), o[15].data(), o[16].data(), bad_input->data()};
+    };
+    const std::pair<const char*, int> masks[] = {
+        {"price", BS_PRICE},
+        {"first_order", BS_PRICE | BS_DELTA | BS_GAMMA | BS_THETA | BS_VEGA | BS_RHO},
+        {"all", BS_ALL}
+    };
+    for (const auto& mask : masks)
+    {
+        const int greeks_mask = mask.second;
+        suite.add(std::string("blackscholes/batch/") + mask.first, n, [chain, get_output, greeks_mask](std::size_t iterations)
+        {
+            const BlackScholesBatchInput input = chain->get_input();
+            const BlackScholesBatchOutput output = get_output();
+            for (std::size_t it = 0; it < iterations; ++it)
+            {
+                benchmark_do_not_optimize(black_scholes_batch(input, output, greeks_mask));
+                benchmark_clobber_memory();
+            }
+        });
+        suite.add(std::string("blackscholes/batch_vectorized/") + mask.first, n, [chain, get_output, greeks_mask](std::size_t iterations)
+        {
+            const BlackScholesBatchInput input = chain->get_input();
+            const BlackScholesBatchOutput output = get_output();
+            for (std::size_t it = 0; it < iterations; ++it)
+            {
+                benchmark_do_not_optimize(black_scholes_batch_vectorized(input, output, greeks_mask));
+                benchmark_clobber_memory();
+            }
+        });
+    }
+
+    suite.add("impliedvolatility/solve", n, [chain, n](std::size_t iterations)
+    {
+        BlackScholesImpliedVolatility solver;
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                benchmark_do_not_optimize(solver.solve(chain->price[i], chain->S[i], chain->K[i], chain->r[i],
+                    chain->q[i], chain->T[i], chain->is_call[i], chain->is_future[i]));
+            }
+        }
+    });
+    suite.add("impliedvolatility/solve_batch", n, [chain, outputs, bad_input, n](std::size_t iterations)
+    {
+        BlackScholesImpliedVolatility solver;
+        std::vector<int> counts(n);
+        const ImpliedVolatilityBatchInput input{n, chain->price.data(), chain->S.data(), chain->K.data(), chain->r.data(),
+            chain->q.data(), chain->T.data(), chain->is_call.get(), chain->is_future.get()};
+        const ImpliedVolatilityBatchOutput output{(*outputs)[0].data(), bad_input->data(), counts.data()};
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            benchmark_do_not_optimize(solver.solve_batch(input, output));
+            benchmark_clobber_memory();
+        }
+    });
+};
+
+/**
+ * @brief Registers the benchmarks of the normal distribution, scalar and batched.
+ * @param suite The suite.
+ */
+static void register_normal(BenchmarkSuite& suite)
+{
+    const std::size_t n = BENCHMARK_CHAIN;
+    auto x = std::make_shared<std::vector<double>>(draw_points(n, -6., 6., false));
+    auto out = std::make_shared<std::vector<double>>(n);
+    suite.add("normal/cdf", n, [x](std::size_t iterations)
+    {
+        NormalDistribution normal;
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (const double v : *x){benchmark_do_not_optimize(normal.cdf(v));}
+        }
+    });
+    suite.add("normal/pdf", n, [x](std::size_t iterations)
+    {
+        NormalDistribution normal;
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (const double v : *x){benchmark_do_not_optimize(normal.pdf(v));}
+        }
+    });
+    suite.add("normal/cdf_n", n, [x, out, n](std::size_t iterations)
+    {
+        NormalDistribution normal;
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            normal.cdf_n(x->data(), out->data(), n);
+            benchmark_clobber_memory();
+        }
+    });
+    suite.add("normal/pdf_n", n, [x, out, n](std::size_t iterations)
+    {
+        NormalDistribution normal;
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            normal.pdf_n(x->data(), out->data(), n);
+            benchmark_clobber_memory();
+        }
+    });
+};
+
+/**
+ * @brief Registers the benchmarks of the SVI slice and of the SSVI surface, pointwise and on
+ * grids.
+ * @param suite The suite.
+ */
+static void register_svi(BenchmarkSuite& suite)
+{
+    const std::size_t n = BENCHMARK_SVI_POINTS;
+    auto k = std::make_shared<std::vector<double>>(draw_points(n, -1.5, 1.5, true));
+    auto svi = std::make_shared<SVI>(0.0852311, -0.155626, 0.290648, 0.678179, 0.0766606, 0.5);
+    const std::pair<const char*, double (SVI::*)(double)> quantities[] = {
+        {"total_variance", &SVI::total_variance}, {"implied_volatility", &SVI::implied_volatility},
+        {"risk_neutral_density", &SVI::risk_neutral_density}, {"local_volatility", &SVI::local_volatility}
+    };
+    for (const auto& quantity : quantities)
+    {
+        const auto method = quantity.second;
+        suite.add(std::string("svi/") + quantity.first, n, [k, svi, method](std::size_t iterations)
+        {
+            for (std::size_t it = 0; it < iterations; ++it)
+            {
+                for (const double v : *k){benchmark_do_not_optimize(((*svi).*method)(v));}
+            }
+        });
+    }
+    auto grid = std::make_shared<std::vector<std::vector<double>>>(6, std::vector<double>(30*n));
+    auto get_output = [grid]()
+    {
+        std::vector<std::vector<double>>& g = *grid;
+        return SVIGridOutput{g[0].data(), g[1].data(), g[2].data(), g[3].data(), g[4].data(), g[5].data()};
+    };
+    suite.add("svi/evaluate_grid", n, [k, svi, get_output, n](std::size_t iterations)
+    {
+        const SVIGridOutput output = get_output();
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            svi->evaluate_grid(k->data(), n, SVI_ALL, output);
+            benchmark_clobber_memory();
+        }
+    });
+
+    auto thetas = std::make_shared<std::vector<double>>(30);
+    auto t = std::make_shared<std::vector<double>>(30);
+    for (std::size_t e = 0; e < 30; ++e)
+    {
+        (*t)[e] = (e + 1)/15.;
+        (*thetas)[e] = 0.36*(*t)[e];
+    }
+    suite.add("ssvi/implied_volatility", n*30, [k, thetas, t](std::size_t iterations)
+    {
+        SSVI ssvi(-0.5, 0.6, 0.4);
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (std::size_t e = 0; e < 30; ++e)
+            {
+                for (const double v : *k){benchmark_do_not_optimize(ssvi.implied_volatility(v, (*thetas)[e], (*t)[e]));}
+            }
+        }
+    });
+    suite.add("ssvi/evaluate_grid", n*30, [k, thetas, t, get_output, n](std::size_t iterations)
+    {
+        SSVI ssvi(-0.5, 0.6, 0.4);
+        const SVIGridOutput output = get_output();
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            ssvi.evaluate_grid(k->data(), n, thetas->data(), t->data(), 30, SVI_ALL, output);
+            benchmark_clobber_memory();
+        }
+    });
+};
+
+/**
+ * @brief Draws the quotes of a calibration: a power law SSVI close to its butterfly bound, its
+ * total variances scaled and noised by 0.1%.
+ * @param scale The scale of the total variances.
+ * @return The quotes of the 7 expiries.
+ */
+static std::vector<SVISliceQuotes> draw_calibration_quotes(const double scale)
+{
+    std::mt19937_64 generator(11);
+    std::normal_distribution<double> noise(0., 1.);
+    SSVI ssvi(-0.5, 1.6, 0.4);
+    std::vector<SVISliceQuotes> quotes;
+    for (const double t : {0.02, 0.05, 0.1, 0.25, 0.5, 1., 2.})
+    {
+        SVISliceQuotes slice;
+        slice.t = t;
+        for (std::size_t i = 0; i < 40; ++i)
+        {
+            const double k = 1.2*sqrt(t)*(-1. + 2.*static_cast<double>(i)/39.);
+            slice.k.push_back(k);
+            slice.w.push_back(scale*ssvi.total_variance(k, 0.36*t)*(1. + 1e-3*noise(generator)));
+        }
+        quotes.push_back(slice);
+    }
+    return quotes;
+};
+
+/**
+ * @brief Registers the benchmarks of the SVI calibration: a cold start, a warm start on barely
+ * moved quotes, and a warm start on quotes whose total variances tripled, on which the previous
+ * SSVI is not arbitrage free and the SSVI is cold started.
+ * @param suite The suite.
+ * @throw BenchmarkCheckFailed if the previous SSVI is a feasible warm start of the tripled quotes,
+ * or if their fit is not finite and arbitrage free.
+ */
+static void register_svi_calibration(BenchmarkSuite& suite)
+{
+    auto previous = std::make_shared<SVICalibrator>(nullptr);
+    previous->calibrate(draw_calibration_quotes(1.));
+    auto moved = std::make_shared<std::vector<SVISliceQuotes>>(draw_calibration_quotes(1.0002));
+    auto tripled = std::make_shared<std::vector<SVISliceQuotes>>(draw_calibration_quotes(3.));
+    const std::size_t n = 7*40;
+
+    SVICalibrator check = *previous;
+    const SVICalibrationReport report = check.calibrate(*tripled);
+    if (report.ssvi.warm_started || !std::isfinite(report.ssvi.rmse) || !report.ssvi.arbitrage_free)
+    {
+        throw BenchmarkCheckFailed();
+    }
+
+    suite.add("svi/calibrate/cold", n, [moved](std::size_t iterations)
+    {
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            SVICalibrator calibrator(nullptr);
+            benchmark_do_not_optimize(calibrator.calibrate(*moved).ssvi.rmse);
+        }
+    });
+    const std::pair<const char*, std::shared_ptr<std::vector<SVISliceQuotes>>> warm_starts[] = {
+        {"warm", moved}, {"warm_infeasible", tripled}
+    };
+    for (const auto& warm_start : warm_starts)
+    {
+        const std::shared_ptr<std::vector<SVISliceQuotes>> quotes = warm_start.second;
+        suite.add(std::string("svi/calibrate/") + warm_start.first, n, [previous, quotes](std::size_t iterations)
+        {
+            for (std::size_t it = 0; it < iterations; ++it)
+            {
+                SVICalibrator calibrator = *previous;
+                benchmark_do_not_optimize(calibrator.calibrate(*quotes).ssvi.rmse);
+            }
+        });
+    }
+};
+
+/**
+ * @brief Registers the benchmarks of the linear and cubic spline interpolations, at 8, 32, 128
+ * and 512 pillars: random points, sorted points with a cursor, and the batch of random points
+ * (a binary search per point) or of sorted points (the merge walk of the pillars).
+ * @param suite The suite.
+ */
+static void register_interpolation(BenchmarkSuite& suite)
+{
+    const std::size_t n = BENCHMARK_CHAIN;
+    auto random_x = std::make_shared<std::vector<double>>(draw_points(n, 0., 1., false));
+    auto sorted_x = std::make_shared<std::vector<double>>(draw_points(n, 0., 1., true));
+    auto out = std::make_shared<std::vector<double>>(n);
+    for (const std::size_t pillars : {8, 32, 128, 512})
+    {
+        std::vector<double> x = draw_points(pillars - 2, 0., 1., true);
+        x.insert(x.begin(), 0.);
+        x.push_back(1.);
+        std::vector<double> y(pillars);
+        for (std::size_t i = 0; i < pillars; ++i){y[i] = std::sin(6.*x[i]) + 0.1*static_cast<double>(i % 3);}
+        const std::pair<const char*, std::shared_ptr<Interpolation2D>> interpolations[] = {
+            {"linear", std::make_shared<LinearInterpolation2D>(x, y)},
+            {"cubicspline", std::make_shared<CubicSpline2D>(x, y)}
+        };
+        for (const auto& entry : interpolations)
+        {
+            const std::shared_ptr<Interpolation2D> interpolation = entry.second;
+            const std::string suffix = "/" + std::to_string(pillars);
+            suite.add(std::string("interpolation/") + entry.first + "/evaluate" + suffix, n, [interpolation, random_x](std::size_t iterations)
+            {
+                for (std::size_t it = 0; it < iterations; ++it)
+                {
+                    for (const double v : *random_x){benchmark_do_not_optimize(interpolation->evaluate(v));}
+                }
+            });
+            suite.add(std::string("interpolation/") + entry.first + "/evaluate_hint" + suffix, n, [interpolation, sorted_x](std::size_t iterations)
+            {
+                for (std::size_t it = 0; it < iterations; ++it)
+                {
+                    std::size_t hint = 0;
+                    for (const double v : *sorted_x){benchmark_do_not_optimize(interpolation->evaluate(v, hint));}
+                }
+            });
+            suite.add(std::string("interpolation/") + entry.first + "/evaluate_batch" + suffix, n, [interpolation, random_x, out, n](std::size_t iterations)
+            {
+                for (std::size_t it = 0; it < iterations; ++it)
+                {
+                    interpolation->evaluate(random_x->data(), out->data(), n);
+                    benchmark_clobber_memory();
+                }
+            });
+            suite.add(std::string("interpolation/") + entry.first + "/evaluate_batch_sorted" + suffix, n, [interpolation, sorted_x, out, n](std::size_t iterations)
+            {
+                for (std::size_t it = 0; it < iterations; ++it)
+                {
+                    interpolation->evaluate(sorted_x->data(), out->data(), n);
+                    benchmark_clobber_memory();
+                }
+            });
+        }
+    }
+};
+
+/**
+ * @brief Registers the benchmarks of the Nelson-Siegel-Svensson rates.
+ * @param suite The suite.
+ */
+static void register_nelson_siegel(BenchmarkSuite& suite)
+{
+    auto maturities = std::make_shared<std::vector<double>>(30);
+    for (std::size_t i = 0; i < 30; ++i){(*maturities)[i] = 0.25*static_cast<double>(i + 1);}
+    auto out = std::make_shared<std::vector<double>>(30);
+    suite.add("nelsonsiegel/svensson_get_rate", 30, [maturities](std::size_t iterations)
+    {
+        NelsonSiegelSvensson model(0.04, -0.01, 0.02, 0.01, 1.5, 4.0);
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (const double t : *maturities){benchmark_do_not_optimize(model.get_rate(t));}
+        }
+    });
+    suite.add("nelsonsiegel/svensson_get_rates", 30, [maturities, out](std::size_t iterations)
+    {
+        NelsonSiegelSvensson model(0.04, -0.01, 0.02, 0.01, 1.5, 4.0);
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            model.get_rates(maturities->data(), out->data(), 30);
+            benchmark_clobber_memory();
+        }
+    });
+};
+
+/**
+ * @brief Registers the benchmarks of the dates: the monthly schedule of 30 years (an
+ * operation is a date) and the year fractions.
+ * @param suite The suite.
+ */
+static void register_datetime(BenchmarkSuite& suite)
+{
+    const long long start_seconds = 1704067200;
+    auto start = std::make_shared<DateTime>(start_seconds, EpochTimestampType::SECONDS);
+    auto end = std::make_shared<DateTime>(start_seconds + 30LL*365*86400, EpochTimestampType::SECONDS);
+    const std::size_t n_dates = generate_datetime_sequence(start, _1M, ACT365, true, true, end).size();
+    suite.add("datetime/generate_datetime_sequence", n_dates, [start, end](std::size_t iterations)
+    {
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            benchmark_do_not_optimize(generate_datetime_sequence(start, _1M, ACT365, true, true, end).size());
+        }
+    });
+    suite.add("datetime/generate_datetime_sequence_timestamps", n_dates, [start, end](std::size_t iterations)
+    {
+        std::vector<Timestamp> dates;
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            generate_datetime_sequence(start->to_timestamp(), _1M, ACT365, true, true, end->to_timestamp(), dates);
+            benchmark_do_not_optimize(dates.size());
+        }
+    });
+
+    const std::size_t n = BENCHMARK_CHAIN;
+    auto expiries = std::make_shared<std::vector<std::shared_ptr<DateTime>>>();
+    auto timestamps = std::make_shared<std::vector<Timestamp>>();
+    for (const double u : draw_points(n, 0., 1., false))
+    {
+        expiries->push_back(std::make_shared<DateTime>(start_seconds + static_cast<long long>(u*2*365*86400), EpochTimestampType::SECONDS));
+        timestamps->push_back(expiries->back()->to_timestamp());
+    }
+    suite.add("datetime/get_year_fraction_from_datetimes", n, [start, expiries](std::size_t iterations)
+    {
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (const std::shared_ptr<DateTime>& expiry : *expiries)
+            {
+                benchmark_do_not_optimize(get_year_fraction_from_datetimes(start, expiry, ACT365));
+            }
+        }
+    });
+    suite.add("datetime/get_year_fraction_from_timestamps", n, [start, timestamps](std::size_t iterations)
+    {
+        const Timestamp reference = start->to_timestamp();
+        for (std::size_t it = 0; it < iterations; ++it)
+        {
+            for (const Timestamp expiry : *timestamps)
+            {
+                benchmark_do_not_optimize(get_year_fraction_from_datetimes(reference, expiry, ACT365));
+            }
+        }
+    });
+};
+
+/**
+ * @brief Registers every benchmark of the pricing hot paths.
+ * @param suite The suite.
+ */
+void register_pricing_benchmarks(BenchmarkSuite& suite)
+{
+    register_black_scholes(suite);
+    register_normal(suite);
+    register_svi(suite);
+    register_svi_calibration(suite);
+    register_interpolation(suite);
+    register_nelson_siegel(suite);
+    register_datetime(suite);
+};
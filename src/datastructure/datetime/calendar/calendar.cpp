@@ -0,0 +1,131 @@
+#include "calendar.h"
+
+/**
+* @file calendar.h
+* @brief This file defines the holiday calendar used to check business days in O(1).
+*/
+
+/**
+ * @class HolidayCalendar
+ * @brief A set of holidays stored as a bitset of epoch days (days since 1970-01-01, UTC).
+ *
+ * The bitset covers the days from the first to the last holiday, its first day is aligned on
+ * 64 days so that it grows by whole words. A membership lookup is one subtraction, one shift
+ * and one mask, with no allocation: 100 years of holidays fit in 4.6 kB.
+ */
+
+/**
+ * @brief Constructs an empty calendar.
+ */
+HolidayCalendar::HolidayCalendar(): first_day_(0), count_(0){};
+
+/**
+ * @brief Constructs a calendar from timestamps, only their UTC day is kept.
+ * @param holidays The holidays.
+ */
+HolidayCalendar::HolidayCalendar(const std::vector<Timestamp>& holidays): HolidayCalendar()
+{
+    for (const Timestamp holiday : holidays){add_holiday(holiday);}
+};
+
+/**
+ * @brief Constructs a calendar from DateTimes, only their UTC day is kept.
+ * @param holidays The holidays.
+ */
+HolidayCalendar::HolidayCalendar(const std::vector<std::shared_ptr<DateTime>>& holidays): HolidayCalendar()
+{
+    for (const std::shared_ptr<DateTime>& holiday : holidays){add_holiday(holiday->get_epoch_day());}
+};
+
+/**
+ * @brief Adds the UTC day of a timestamp to the holidays.
+ * @param holiday The holiday.
+ */
+void HolidayCalendar::add_holiday(const Timestamp holiday)
+{
+    add_holiday(get_epoch_day(holiday));
+};
+
+/**
+ * @brief Adds a day to the holidays, the bitset is extended if the day is out of its range.
+ * @param epoch_day The number of days since 1970-01-01.
+ */
+void HolidayCalendar::add_holiday(const long long epoch_day)
+{
+    const long long aligned_day = epoch_day >= 0 ? epoch_day - epoch_day%64 : epoch_day - (64 + epoch_day%64)%64;
+    if (bits_.empty())
+    {
+        first_day_ = aligned_day;
+        bits_.assign(1, 0);
+    }
+    else if (aligned_day < first_day_)
+    {
+        bits_.insert(bits_.begin(), static_cast<std::size_t>((first_day_ - aligned_day)/64), 0);
+        first_day_ = aligned_day;
+    }
+    const std::size_t offset = static_cast<std::size_t>(epoch_day - first_day_);
+    if (offset/64 >= bits_.size()){bits_.resize(offset/64 + 1, 0);}
+    const std::uint64_t bit = std::uint64_t(1) << (offset%64);
+    if (!(bits_[offset/64] & bit)){count_++;}
+    bits_[offset/64] |= bit;
+};
+
+/**
+ * @param t A timestamp.
+ * @return True if its UTC day is a holiday.
+ */
+bool HolidayCalendar::is_holiday(const Timestamp t) const
+{
+    return is_holiday(get_epoch_day(t));
+};
+
+/**
+ * @param epoch_day The number of days since 1970-01-01.
+ * @return True if the day is a holiday, in O(1).
+ */
+bool HolidayCalendar::is_holiday(const long long epoch_day) const
+{
+    const std::uint64_t offset = static_cast<std::uint64_t>(epoch_day - first_day_);
+    if (offset >= 64*bits_.size()){return false;}
+    return (bits_[offset/64] >> (offset%64)) & 1;
+};
+
+/**
+ * @param t A timestamp.
+ * @return True if its UTC day is neither a week end day nor a holiday.
+ */
+bool HolidayCalendar::is_business_day(const Timestamp t) const
+{
+    return is_business_day(get_epoch_day(t));
+};
+
+/**
+ * @param epoch_day The number of days since 1970-01-01.
+ * @return True if the day is neither a week end day nor a holiday.
+ */
+bool HolidayCalendar::is_business_day(const long long epoch_day) const
+{
+    const int weekday = weekday_from_days(epoch_day);
+    return weekday!=0 && weekday!=6 && !is_holiday(epoch_day);
+};
+
+/**
+ * @return The number of holidays.
+ */
+std::size_t HolidayCalendar::size() const
+{
+    return count_;
+};
+
+/**
+ * @return The holidays as sorted epoch days.
+ */
+std::vector<long long> HolidayCalendar::get_holidays() const
+{
+    std::vector<long long> holidays;
+    holidays.reserve(count_);
+    for (std::size_t w = 0; w < bits_.size(); ++w)
+        for (std::size_t b = 0; b < 64; ++b)
+            if ((bits_[w] >> b) & 1){holidays.push_back(first_day_ + static_cast<long long>(64*w + b));}
+    return holidays;
+};
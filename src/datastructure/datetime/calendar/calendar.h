@@ -0,0 +1,26 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include "../../../datastructure/datetime/datetime.h"
+
+class HolidayCalendar
+{
+    public:
+        HolidayCalendar();
+        HolidayCalendar(const std::vector<Timestamp>& holidays);
+        HolidayCalendar(const std::vector<std::shared_ptr<DateTime>>& holidays);
+        ~HolidayCalendar(){};
+        void add_holiday(const Timestamp holiday);
+        void add_holiday(const long long epoch_day);
+        bool is_holiday(const Timestamp t) const;
+        bool is_holiday(const long long epoch_day) const;
+        bool is_business_day(const Timestamp t) const;
+        bool is_business_day(const long long epoch_day) const;
+        std::size_t size() const;
+        std::vector<long long> get_holidays() const;
+    private:
+        long long first_day_;
+        std::vector<std::uint64_t> bits_;
+        std::size_t count_;
+};
@@ -29,6 +29,48 @@
  * count rules: ACT/360, ACT/365, and ACT/364.
  */
 
+/**
+ * @struct Timestamp
+ * @brief A trivially copyable 8 bytes timestamp, always in nanoseconds since the epoch.
+ *
+ * Unlike DateTime, it has no unit to convert, it is passed by value and every arithmetic
+ * operation and comparison is constexpr integer arithmetic on nanoseconds. The overloads of
+ * get_timedelta and get_year_fraction_from_datetimes taking timestamps never allocate.
+ */
+
+/**
+ * @var long long Timestamp::ns
+ * @brief The number of nanoseconds since the epoch.
+ */
+
+/**
+ * @struct CivilDate
+ * @brief A proleptic Gregorian calendar date: the year, the month in [1, 12] and the day in [1, 31].
+ */
+
+/**
+ * @fn constexpr long long days_from_civil(const int year, const int month, const int day)
+ * @brief Converts a calendar date into the number of days since 1970-01-01, with the 
+ * closed form algorithm of "chrono-Compatible Low-Level Date Algorithms" (H. Hinnant): the
+ * year is shifted to start in March so that the leap day is the last day, then split into 
+ * 400 years eras of 146097 days. It is constexpr, branch free and never allocates.
+ */
+
+/**
+ * @fn constexpr CivilDate civil_from_days(const long long epoch_day)
+ * @brief The inverse of days_from_civil.
+ */
+
+/**
+ * @fn constexpr int weekday_from_days(const long long epoch_day)
+ * @brief The day of the week of an epoch day, 0 for Sunday to 6 for Saturday (as std::tm::tm_wday).
+ */
+
+/**
+ * @fn constexpr long long get_epoch_day(const Timestamp t)
+ * @brief The number of days since 1970-01-01 of a timestamp (floor division, in UTC).
+ */
+
 /**
  * @brief Exception thrown when a negative timestamp value is encountered.
  * @return A message indicating that the timestamp cannot be negative.
@@ -245,6 +287,15 @@ DateTime::DateTime(
     if (tmsp<0){throw NegativeEpochTimestampError();}
 };
 
+/**
+ * @brief Constructs a DateTime object from a nanoseconds timestamp.
+ * 
+ * @param timestamp The timestamp.
+ * @throws NegativeEpochTimestampError If the timestamp is negative.
+ */
+DateTime::DateTime(const Timestamp timestamp): 
+    DateTime(timestamp.ns, EpochTimestampType::NANOSECONDS){};
+
 /**
  * @brief Gets the timestamp of the DateTime.
  * 
@@ -265,6 +316,35 @@ EpochTimestampType DateTime::get_timestamp_type()
     return type_; 
 };
 
+/**
+ * @brief Gets the DateTime as a nanoseconds timestamp, without converting it in place.
+ * 
+ * @return The timestamp.
+ */
+Timestamp DateTime::to_timestamp()
+{
+    return make_timestamp(tmsp, type_); 
+};
+
+/**
+ * @return The number of days since 1970-01-01 (UTC) of the DateTime.
+ */
+long long DateTime::get_epoch_day()
+{
+    return ::get_epoch_day(to_timestamp()); 
+};
+
+/**
+ * @brief Gets the UTC calendar date, thread safe and without allocation (unlike get_time_info 
+ * which goes through std::localtime).
+ * 
+ * @return The year, month and day of the DateTime.
+ */
+CivilDate DateTime::get_civil_date()
+{
+    return civil_from_days(get_epoch_day()); 
+};
+
 /**
  * @brief Sets the timestamp value of the DateTime.
  * 
@@ -286,31 +366,27 @@ void DateTime::set_timestamp_type(const EpochTimestampType type)
 };
 
 /**
- * @brief Converts the timestamp to a different type and returns time information as a tm structure.
+ * @brief Returns the time information of the timestamp (truncated to the second) as a tm structure.
  * 
  * @return A unique pointer to a tm structure containing the time information.
  */
 std::unique_ptr<std::tm> DateTime::get_time_info()
 {
-    EpochTimestampType old_tmsp_type = type_;
-    convert_timestamp(EpochTimestampType::SECONDS);
-    std::time_t timestamp = tmsp;
-    convert_timestamp(old_tmsp_type);
+    std::time_t timestamp = get_epoch_timestamp(to_timestamp(), EpochTimestampType::SECONDS);
     std::tm* time_info_ptr = std::localtime(&timestamp);
     return std::make_unique<std::tm>(*time_info_ptr);
 };
 
 /**
- * @brief Checks if the date falls on a weekend (Saturday or Sunday).
+ * @brief Checks if the date falls on a weekend (Saturday or Sunday), in UTC, without 
+ * allocation and without going through std::tm.
  * 
  * @return True if the date is a weekend, false otherwise.
  */
 bool DateTime::is_week_end()
 {
-    std::unique_ptr<std::tm> time_info = get_time_info();
-    if (time_info->tm_wday==0){return true;}
-    if (time_info->tm_wday==6){return true;}
-    return false;
+    const int weekday = weekday_from_days(get_epoch_day());
+    return weekday==0 || weekday==6;
 };
 
 /**
@@ -360,19 +436,17 @@ void DateTime::convert_timestamp(const EpochTimestampType type)
 };
 
 /**
- * @brief Checks if the DateTime is a holiday from a list of holiday DateTimes.
+ * @brief Checks if the DateTime is a holiday from a list of holiday DateTimes, comparing 
+ * UTC days. The list is scanned, HolidayCalendar::is_holiday answers in O(1).
  * 
  * @param holiday_datetimes A vector of shared pointers to DateTime objects representing holidays.
  * @return True if the DateTime is a holiday, false otherwise.
  */
 bool DateTime::is_date_in_holiday(const std::vector<std::shared_ptr<DateTime>>& holiday_datetimes)
 {
-    std::unique_ptr<std::tm> time_info = get_time_info();
+    const long long day = get_epoch_day();
     for (const std::shared_ptr<DateTime>& h : holiday_datetimes) {
-        std::unique_ptr<std::tm> h_time_info = h->get_time_info();
-        if (time_info->tm_mday == h_time_info->tm_mday &&
-            time_info->tm_mon == h_time_info->tm_mon &&
-            time_info->tm_year == h_time_info->tm_year){return true;}
+        if (h->get_epoch_day() == day){return true;}
     }
     return false;
 };
@@ -421,6 +495,29 @@ std::shared_ptr<TimeDelta> get_timedelta(
     }
 };
 
+/**
+ * @brief Calculates the TimeDelta between two timestamps, truncated to the desired unit, 
+ * without any allocation.
+ * 
+ * @param start_timestamp The start timestamp.
+ * @param end_timestamp The end timestamp.
+ * @param delta_type The desired timestamp type for the delta (e.g., seconds, milliseconds, etc.).
+ * @return The TimeDelta object representing the time difference.
+ */
+TimeDelta get_timedelta(
+    const Timestamp start_timestamp, 
+    const Timestamp end_timestamp, 
+    const EpochTimestampType delta_type)
+{
+    long long delta = (end_timestamp - start_timestamp)/(EpochTimestampType::NANOSECONDS/delta_type);
+    switch(delta_type){
+        case EpochTimestampType::SECONDS: {return TimeDelta(0,0,0,delta,0,0,0);}
+        case EpochTimestampType::MILLISECONDS: {return TimeDelta(0,0,0,0,delta,0,0);}
+        case EpochTimestampType::MICROSECONDS: {return TimeDelta(0,0,0,0,0,delta,0);}
+        default: {return TimeDelta(0,0,0,0,0,0,delta);}
+    }
+};
+
 /**
  * @brief Gets the name of a day count convention.
  * 
@@ -490,15 +587,29 @@ double get_year_fraction_from_datetimes(
     const std::shared_ptr<DateTime> end_datetime, 
     const DayCountConvention day_count_convention)
 {
-    int ns_value = static_cast<int>(EpochTimestampType::NANOSECONDS);
-    std::shared_ptr<TimeDelta> dt = get_timedelta(
-        start_datetime,
-        end_datetime, 
-        EpochTimestampType::NANOSECONDS); 
-    long long total_ns = dt->get_total_nanoseconds();
-    long long day_in_s = 24*60*60;
-    long long day_in_ns = day_in_s*ns_value;
-    double t = double(total_ns)/double(get_number_days_in_year(day_count_convention)*day_in_ns);
+    return get_year_fraction_from_datetimes(
+        start_datetime->to_timestamp(), 
+        end_datetime->to_timestamp(), 
+        day_count_convention);
+};
+
+/**
+ * @brief Calculates the year fraction between two timestamps using a given day count convention, 
+ * without any allocation.
+ * 
+ * @param start_timestamp The start timestamp.
+ * @param end_timestamp The end timestamp.
+ * @param day_count_convention The day count convention to use.
+ * @return The year fraction between the two timestamps.
+ * @throws NonPositiveYearFractionError If the resulting year fraction is negative.
+ */
+double get_year_fraction_from_datetimes(
+    const Timestamp start_timestamp, 
+    const Timestamp end_timestamp, 
+    const DayCountConvention day_count_convention)
+{
+    long long total_ns = end_timestamp - start_timestamp;
+    double t = double(total_ns)/double(get_number_days_in_year(day_count_convention)*NANOSECONDS_PER_DAY);
     if (t<0){throw NonPositiveYearFractionError();}
     return t;
 };
@@ -684,6 +795,7 @@ std::vector<std::shared_ptr<DateTime>> generate_datetime_sequence(
         frequency_tenor,
         day_count_convention
     );
+    output.reserve(std::max(n, 1) + 1);
     int i = 1;
     while (i<n){
         next_datetime->apply_time_delta(dt_ptr);
@@ -697,4 +809,170 @@ std::vector<std::shared_ptr<DateTime>> generate_datetime_sequence(
         output.push_back(end_datetime);
     };
     return output;
-};  
+};
+
+/**
+ * @brief Calculates the number of periods between two timestamps for a frequency tenor.
+ * 
+ * @param start_timestamp The start timestamp.
+ * @param end_timestamp The end timestamp.
+ * @param frequency_tenor The frequency tenor.
+ * @param day_count_convention The day count convention.
+ * @return The number of periods in the sequence.
+ */
+int sequence_length_from_frequency_tenor(
+    const Timestamp start_timestamp,
+    const Timestamp end_timestamp,
+    const Tenor frequency_tenor, 
+    const DayCountConvention day_count_convention
+)
+{
+    const long long step = get_tenor_in_days(frequency_tenor, day_count_convention)*NANOSECONDS_PER_DAY;
+    return round(double(end_timestamp - start_timestamp)/double(step));
+};
+
+/**
+ * @brief Generates the same sequence as the DateTime version into a caller provided vector of 
+ * timestamps: the vector is cleared and written in place, so that no allocation happens if its 
+ * capacity is large enough (sequence_length_from_frequency_tenor + 1 values). The dates are 
+ * produced in increasing order, there is nothing to sort.
+ * 
+ * @param start_timestamp The start timestamp.
+ * @param frequency_tenor The frequency Tenor.
+ * @param day_count_convention The day count convention.
+ * @param include_start Whether to include the start timestamp in the sequence.
+ * @param include_end Whether to include the end timestamp in the sequence.
+ * @param end_timestamp The end timestamp.
+ * @param output The sequence.
+ * @see TimestampSequence
+ */
+void generate_datetime_sequence(
+    const Timestamp start_timestamp,
+    const Tenor frequency_tenor, 
+    const DayCountConvention day_count_convention, 
+    const bool include_start, 
+    const bool include_end,
+    const Timestamp end_timestamp,
+    std::vector<Timestamp>& output
+)
+{
+    const TimestampSequence sequence(
+        start_timestamp, frequency_tenor, day_count_convention, include_start, include_end, end_timestamp);
+    output.clear();
+    output.reserve(sequence.size());
+    for (std::size_t i = 0; i < sequence.size(); ++i){output.push_back(sequence[i]);}
+};
+
+/**
+ * @class TimestampSequence
+ * @brief The lazy form of generate_datetime_sequence: the sequence is a range computed on the 
+ * fly (the i-th date is one multiplication away from the start), so that a schedule can be 
+ * streamed without being materialized.
+ */
+
+/**
+ * @class TimestampSequence::Iterator
+ * @brief The forward iterator over the dates of a TimestampSequence.
+ */
+
+/**
+ * @brief Constructs the iterator at a position of the sequence.
+ * @param sequence The sequence.
+ * @param index The position.
+ */
+TimestampSequence::Iterator::Iterator(const TimestampSequence* sequence, std::size_t index): 
+    sequence_(sequence), index_(index){};
+
+/**
+ * @return The date at the position of the iterator.
+ */
+Timestamp TimestampSequence::Iterator::operator*() const
+{
+    return (*sequence_)[index_];
+};
+
+/**
+ * @return The iterator moved to the next date.
+ */
+TimestampSequence::Iterator& TimestampSequence::Iterator::operator++()
+{
+    ++index_;
+    return *this;
+};
+
+/**
+ * @param other Another iterator of the same sequence.
+ * @return True if both iterators are at different positions.
+ */
+bool TimestampSequence::Iterator::operator!=(const Iterator& other) const
+{
+    return index_ != other.index_;
+};
+
+/**
+ * @param other Another iterator of the same sequence.
+ * @return True if both iterators are at the same position.
+ */
+bool TimestampSequence::Iterator::operator==(const Iterator& other) const
+{
+    return index_ == other.index_;
+};
+
+/**
+ * @brief Constructs the sequence, see generate_datetime_sequence.
+ * 
+ * @param start_timestamp The start timestamp.
+ * @param frequency_tenor The frequency Tenor.
+ * @param day_count_convention The day count convention.
+ * @param include_start Whether to include the start timestamp in the sequence.
+ * @param include_end Whether to include the end timestamp in the sequence.
+ * @param end_timestamp The end timestamp.
+ */
+TimestampSequence::TimestampSequence(
+    const Timestamp start_timestamp,
+    const Tenor frequency_tenor, 
+    const DayCountConvention day_count_convention, 
+    const bool include_start, 
+    const bool include_end,
+    const Timestamp end_timestamp): 
+    start_(start_timestamp), end_(end_timestamp), 
+    step_(get_tenor_in_days(frequency_tenor, day_count_convention)*NANOSECONDS_PER_DAY), 
+    n_interior_(std::max(sequence_length_from_frequency_tenor(
+        start_timestamp, end_timestamp, frequency_tenor, day_count_convention) - 1, 0)), 
+    include_start_(include_start), include_end_(include_end){};
+
+/**
+ * @return The number of dates of the sequence.
+ */
+std::size_t TimestampSequence::size() const
+{
+    return n_interior_ + include_start_ + include_end_;
+};
+
+/**
+ * @param i The position of a date, in [0, size()).
+ * @return The date.
+ */
+Timestamp TimestampSequence::operator[](const std::size_t i) const
+{
+    if (include_start_ && i == 0){return start_;}
+    const std::size_t k = i + !include_start_;
+    if (k > n_interior_){return end_;}
+    return start_ + static_cast<long long>(k)*step_;
+};
+
+/**
+ * @return The iterator to the first date.
+ */
+TimestampSequence::Iterator TimestampSequence::begin() const
+{
+    return Iterator(this, 0);
+};
+
+/**
+ * @return The iterator past the last date.
+ */
+TimestampSequence::Iterator TimestampSequence::end() const
+{
+    return Iterator(this, size());
+};
@@ -3,6 +3,7 @@
 #include <ctime>
 #include <vector>
 #include <set>
+#include <algorithm>
 
 enum EpochTimestampType 
 {
@@ -35,6 +36,65 @@ class UndefinedTenorError : public std::exception
 class NonPositiveYearFractionError : public std::exception 
 {public: const char * what() const throw();};
 
+constexpr long long NANOSECONDS_PER_DAY = 24LL*60*60*EpochTimestampType::NANOSECONDS;
+
+struct Timestamp
+{
+    long long ns;
+};
+
+constexpr Timestamp make_timestamp(const long long timestamp, const EpochTimestampType type)
+{return Timestamp{timestamp*(EpochTimestampType::NANOSECONDS/type)};};
+
+constexpr long long get_epoch_timestamp(const Timestamp t, const EpochTimestampType type)
+{return t.ns/(EpochTimestampType::NANOSECONDS/type);};
+
+constexpr Timestamp operator+(const Timestamp t, const long long ns){return Timestamp{t.ns + ns};};
+constexpr Timestamp operator-(const Timestamp t, const long long ns){return Timestamp{t.ns - ns};};
+constexpr long long operator-(const Timestamp a, const Timestamp b){return a.ns - b.ns;};
+constexpr bool operator==(const Timestamp a, const Timestamp b){return a.ns == b.ns;};
+constexpr bool operator!=(const Timestamp a, const Timestamp b){return a.ns != b.ns;};
+constexpr bool operator<(const Timestamp a, const Timestamp b){return a.ns < b.ns;};
+constexpr bool operator<=(const Timestamp a, const Timestamp b){return a.ns <= b.ns;};
+constexpr bool operator>(const Timestamp a, const Timestamp b){return a.ns > b.ns;};
+constexpr bool operator>=(const Timestamp a, const Timestamp b){return a.ns >= b.ns;};
+
+struct CivilDate
+{
+    int year;
+    int month;
+    int day;
+};
+
+constexpr long long get_epoch_day(const Timestamp t)
+{return t.ns >= 0 ? t.ns/NANOSECONDS_PER_DAY : -((-t.ns - 1)/NANOSECONDS_PER_DAY) - 1;};
+
+constexpr long long days_from_civil(const int year, const int month, const int day)
+{
+    const long long y = month <= 2 ? year - 1 : year;
+    const long long era = (y >= 0 ? y : y - 399)/400;
+    const long long yoe = y - era*400;
+    const long long doy = (153*(month > 2 ? month - 3 : month + 9) + 2)/5 + day - 1;
+    const long long doe = yoe*365 + yoe/4 - yoe/100 + doy;
+    return era*146097 + doe - 719468;
+};
+
+constexpr CivilDate civil_from_days(const long long epoch_day)
+{
+    const long long z = epoch_day + 719468;
+    const long long era = (z >= 0 ? z : z - 146096)/146097;
+    const long long doe = z - era*146097;
+    const long long yoe = (doe - doe/1460 + doe/36524 - doe/146096)/365;
+    const long long doy = doe - (365*yoe + yoe/4 - yoe/100);
+    const long long mp = (5*doy + 2)/153;
+    const int day = static_cast<int>(doy - (153*mp + 2)/5 + 1);
+    const int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    return CivilDate{static_cast<int>(yoe + era*400 + (month <= 2)), month, day};
+};
+
+constexpr int weekday_from_days(const long long epoch_day)
+{return static_cast<int>(epoch_day >= -4 ? (epoch_day + 4) % 7 : (epoch_day + 5) % 7 + 6);};
+
 class TimeDelta
 {
     public:
@@ -73,9 +133,13 @@ class DateTime
 {
     public:
         DateTime(long long timestamp, EpochTimestampType type);
+        DateTime(const Timestamp timestamp);
         ~DateTime(){};
         long long get_timestamp(); 
         EpochTimestampType get_timestamp_type();
+        Timestamp to_timestamp();
+        long long get_epoch_day();
+        CivilDate get_civil_date();
         void set_timestamp(const long long timestamp); 
         void set_timestamp_type(const EpochTimestampType type); 
         void convert_timestamp(const EpochTimestampType type);
@@ -93,6 +157,11 @@ std::shared_ptr<TimeDelta> get_timedelta(
     const std::shared_ptr<DateTime>& end_datetime, 
     const EpochTimestampType delta_type);
 
+TimeDelta get_timedelta(
+    const Timestamp start_timestamp, 
+    const Timestamp end_timestamp, 
+    const EpochTimestampType delta_type);
+
 std::string get_day_count_convention_name(const DayCountConvention dcc); 
 
 int get_number_days_in_year(const DayCountConvention dcc); 
@@ -105,6 +174,12 @@ double get_year_fraction_from_datetimes(
     const DayCountConvention convention
 ); 
 
+double get_year_fraction_from_datetimes(
+    const Timestamp start_timestamp, 
+    const Timestamp end_timestamp, 
+    const DayCountConvention convention
+); 
+
 std::string get_tenor_name(const Tenor tenor); 
 
 int get_tenor_in_days(const Tenor tenor, const DayCountConvention dcc);
@@ -142,5 +217,56 @@ std::vector<std::shared_ptr<DateTime>> generate_datetime_sequence(
     const std::shared_ptr<DateTime> end_datetime
 );
 
+int sequence_length_from_frequency_tenor(
+    const Timestamp start_timestamp,
+    const Timestamp end_timestamp,
+    const Tenor frequency_tenor, 
+    const DayCountConvention day_count_convention
+);
 
+void generate_datetime_sequence(
+    const Timestamp start_timestamp,
+    const Tenor frequency_tenor, 
+    const DayCountConvention day_count_convention, 
+    const bool include_start, 
+    const bool include_end,
+    const Timestamp end_timestamp,
+    std::vector<Timestamp>& output
+);
 
+class TimestampSequence
+{
+    public:
+        class Iterator
+        {
+            public:
+                Iterator(const TimestampSequence* sequence, std::size_t index);
+                Timestamp operator*() const;
+                Iterator& operator++();
+                bool operator!=(const Iterator& other) const;
+                bool operator==(const Iterator& other) const;
+            private:
+                const TimestampSequence* sequence_;
+                std::size_t index_;
+        };
+        TimestampSequence(
+            const Timestamp start_timestamp,
+            const Tenor frequency_tenor, 
+            const DayCountConvention day_count_convention, 
+            const bool include_start, 
+            const bool include_end,
+            const Timestamp end_timestamp
+        );
+        ~TimestampSequence(){};
+        std::size_t size() const;
+        Timestamp operator[](const std::size_t i) const;
+        Iterator begin() const;
+        Iterator end() const;
+    private:
+        Timestamp start_;
+        Timestamp end_;
+        long long step_;
+        std::size_t n_interior_;
+        bool include_start_;
+        bool include_end_;
+};
\ No newline at end of file
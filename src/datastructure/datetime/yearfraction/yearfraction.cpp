@@ -0,0 +1,120 @@
+#include "yearfraction.h"
+
+/**
+* @file yearfraction.h
+* @brief This file defines the year fraction table of a pricing snapshot.
+*/
+
+/**
+ * @var std::size_t UNREGISTERED_YEAR_FRACTION
+ * @brief The year fraction index kept for an instrument which is not registered in a table, such
+ * as a perpetual future.
+ */
+
+/**
+ * @class YearFractionTableUnknownIndex
+ * @brief Definition of the error when an index has not been returned by register_expiry.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * YearFractionTableUnknownIndex::what() const throw(){
+    return "The index is not registered in the year fraction table.";
+};
+
+/**
+ * @class YearFractionTable
+ * @brief The year fractions of every distinct (expiry, day count convention) pair of a book 
+ * from one reference time.
+ *
+ * Thousands of instruments share a few dozen expiries: each pair is registered once and gets a
+ * stable index, its year fraction is computed once per reference time and is then read in O(1)
+ * (see Option::register_year_fraction). The indices are kept by the owner of the table, not by
+ * the instruments, which can be registered in several tables. Moving the reference time
+ * recomputes the table, which is one subtraction and one division per pair.
+ */
+
+/**
+ * @brief Constructs an empty table.
+ * @param reference_timestamp The reference time of the snapshot.
+ */
+YearFractionTable::YearFractionTable(const Timestamp reference_timestamp): reference_(reference_timestamp){};
+
+/**
+ * @brief Registers an expiry, a pair registered twice gets the same index.
+ * @param expiry_timestamp The expiry.
+ * @param day_count_convention The day count convention.
+ * @return The stable index of the pair.
+ * @throws UndefinedDayCountConventionError If the day count convention is undefined.
+ */
+std::size_t YearFractionTable::register_expiry(const Timestamp expiry_timestamp, const DayCountConvention day_count_convention)
+{
+    get_number_days_in_year(day_count_convention);
+    const auto inserted = indices_.emplace(
+        std::make_pair(expiry_timestamp.ns, static_cast<int>(day_count_convention)), expiries_.size());
+    if (!inserted.second){return inserted.first->second;}
+    expiries_.push_back(expiry_timestamp);
+    day_count_conventions_.push_back(day_count_convention);
+    year_fractions_.push_back(compute_year_fraction(expiries_.size()-1));
+    return expiries_.size()-1;
+};
+
+/**
+ * @brief Moves the reference time, every year fraction is recomputed if it changed.
+ * @param reference_timestamp The reference time of the snapshot.
+ */
+void YearFractionTable::set_reference_timestamp(const Timestamp reference_timestamp)
+{
+    if (reference_timestamp == reference_){return;}
+    reference_ = reference_timestamp;
+    for (std::size_t i = 0; i < expiries_.size(); ++i){year_fractions_[i] = compute_year_fraction(i);}
+};
+
+/**
+ * @return The reference time of the snapshot.
+ */
+Timestamp YearFractionTable::get_reference_timestamp() const
+{
+    return reference_;
+};
+
+/**
+ * @param i The index of a registered pair.
+ * @return The year fraction, as get_year_fraction_from_datetimes, in O(1).
+ * @throws YearFractionTableUnknownIndex If the index is not registered.
+ * @throws NonPositiveYearFractionError If the expiry is before the reference time.
+ */
+double YearFractionTable::get_year_fraction(const std::size_t i) const
+{
+    if (i >= year_fractions_.size()){throw YearFractionTableUnknownIndex();}
+    const double t = year_fractions_[i];
+    if (t<0){throw NonPositiveYearFractionError();}
+    return t;
+};
+
+/**
+ * @return The year fractions of the registered pairs, by index. The expiries before the 
+ * reference time have a negative year fraction.
+ */
+const double* YearFractionTable::get_year_fractions() const
+{
+    return year_fractions_.data();
+};
+
+/**
+ * @return The number of registered pairs.
+ */
+std::size_t YearFractionTable::size() const
+{
+    return expiries_.size();
+};
+
+/**
+ * @param i The index of a registered pair.
+ * @return Its year fraction from the reference time, negative if it is expired.
+ */
+double YearFractionTable::compute_year_fraction(const std::size_t i) const
+{
+    return double(expiries_[i] - reference_)/double(get_number_days_in_year(day_count_conventions_[i])*NANOSECONDS_PER_DAY);
+};
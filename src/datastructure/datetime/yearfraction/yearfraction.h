@@ -0,0 +1,31 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <map>
+#include <limits>
+#include "../../../datastructure/datetime/datetime.h"
+
+constexpr std::size_t UNREGISTERED_YEAR_FRACTION = std::numeric_limits<std::size_t>::max();
+
+class YearFractionTableUnknownIndex:  public std::exception
+{public: const char * what() const throw();};
+
+class YearFractionTable
+{
+    public:
+        YearFractionTable(const Timestamp reference_timestamp);
+        ~YearFractionTable(){};
+        std::size_t register_expiry(const Timestamp expiry_timestamp, const DayCountConvention day_count_convention);
+        void set_reference_timestamp(const Timestamp reference_timestamp);
+        Timestamp get_reference_timestamp() const;
+        double get_year_fraction(const std::size_t i) const;
+        const double* get_year_fractions() const;
+        std::size_t size() const;
+    private:
+        double compute_year_fraction(const std::size_t i) const;
+        Timestamp reference_;
+        std::map<std::pair<long long, int>, std::size_t> indices_;
+        std::vector<Timestamp> expiries_;
+        std::vector<DayCountConvention> day_count_conventions_;
+        std::vector<double> year_fractions_;
+};
@@ -0,0 +1,54 @@
+#include "arena.h"
+
+/**
+* @file arena.h
+* @brief This file defines the monotonic arenas in which a universe of market objects is built
+* and torn down in bulk.
+*
+* An arena is a std::pmr::monotonic_buffer_resource shared by the objects built in it: the
+* allocator of each object, stored in its control block, holds a reference to the arena. The
+* objects are bump allocated next to each other and their deallocation is free; the arena gives
+* its memory back to the heap at once, when the last object built in it is destroyed. An object
+* can therefore be copied anywhere, and outlive whoever built it, without dangling. Building in
+* an arena is not thread safe, destroying the objects is.
+*/
+
+/**
+ * @typedef MarketArena
+ * @brief A shared monotonic arena, kept alive by the objects built in it.
+ */
+
+/**
+ * @brief Makes an arena with the default block size of the monotonic resource.
+ * @return The arena.
+ */
+MarketArena make_market_arena()
+{
+    return std::make_shared<std::pmr::monotonic_buffer_resource>();
+};
+
+/**
+ * @brief Makes an arena for a universe of known size.
+ * @param initial_bytes The size of the first block of the arena, a universe fitting in it is
+ * built with a single allocation from the heap.
+ * @return The arena.
+ */
+MarketArena make_market_arena(const std::size_t initial_bytes)
+{
+    return std::make_shared<std::pmr::monotonic_buffer_resource>(initial_bytes);
+};
+
+/**
+ * @class MarketArenaAllocator
+ * @brief The allocator of the objects built in an arena, it holds a reference to the arena so
+ * that the arena outlives the objects allocated from it.
+ */
+
+/**
+ * @fn template <typename T, typename... Args> std::shared_ptr<T> make_in_arena(const MarketArena& arena, Args&&... args)
+ * @brief Builds an object and its control block in an arena, with a single bump of the arena
+ * instead of a heap allocation.
+ * @param arena The arena, a null arena builds the object on the heap with std::make_shared.
+ * @param args The arguments of the constructor of T.
+ * @return The object, which keeps the arena alive.
+ */
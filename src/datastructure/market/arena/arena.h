@@ -0,0 +1,44 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+typedef std::shared_ptr<std::pmr::memory_resource> MarketArena;
+
+MarketArena make_market_arena();
+MarketArena make_market_arena(const std::size_t initial_bytes);
+
+template <typename T>
+class MarketArenaAllocator
+{
+    public:
+        typedef T value_type;
+        MarketArenaAllocator(const MarketArena& arena): arena_(arena){};
+        template <typename U>
+        MarketArenaAllocator(const MarketArenaAllocator<U>& other): arena_(other.get_arena()){};
+        T* allocate(const std::size_t n){return static_cast<T*>(arena_->allocate(n*sizeof(T), alignof(T)));};
+        void deallocate(T* p, const std::size_t n){arena_->deallocate(p, n*sizeof(T), alignof(T));};
+        const MarketArena& get_arena() const{return arena_;};
+    private:
+        MarketArena arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const MarketArenaAllocator<T>& a, const MarketArenaAllocator<U>& b)
+{
+    return a.get_arena() == b.get_arena();
+};
+
+template <typename T, typename U>
+bool operator!=(const MarketArenaAllocator<T>& a, const MarketArenaAllocator<U>& b)
+{
+    return a.get_arena() != b.get_arena();
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<T> make_in_arena(const MarketArena& arena, Args&&... args)
+{
+    if (!arena){return std::make_shared<T>(std::forward<Args>(args)...);}
+    return std::allocate_shared<T>(MarketArenaAllocator<T>(arena), std::forward<Args>(args)...);
+};
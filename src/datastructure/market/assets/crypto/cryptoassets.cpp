@@ -21,7 +21,22 @@ CryptoAsset::CryptoAsset(
     const std::shared_ptr<Crypto> crypto, 
     const std::shared_ptr<Currency> quote_currency
 ): 
-    Asset(id, quote_currency, crypto){}; 
+    Asset(id, quote_currency, crypto, ASSET_CRYPTO){}; 
+
+/**
+ * @brief Constructs a CryptoAsset object for the derived classes, which give their tag.
+ * @param id The asset's id.
+ * @param crypto A shared pointer to the Crypto object.
+ * @param quote_currency A shared pointer to the Currency object.
+ * @param tag The tag of the concrete class.
+ */
+CryptoAsset::CryptoAsset(
+    const std::string id,
+    const std::shared_ptr<Crypto> crypto, 
+    const std::shared_ptr<Currency> quote_currency, 
+    const AssetTag tag
+): 
+    Asset(id, quote_currency, crypto, tag){}; 
 
 /**
  * @class CryptoSpot
@@ -39,7 +54,7 @@ CryptoSpot::CryptoSpot(
     const std::shared_ptr<Crypto> crypto, 
     const std::shared_ptr<Currency> quote_currency
 ): 
-    CryptoAsset(id, crypto, quote_currency){}; 
+    CryptoAsset(id, crypto, quote_currency, ASSET_CRYPTO_SPOT){}; 
 
 /**
  * @class CryptoFuture
@@ -59,7 +74,7 @@ CryptoFuture::CryptoFuture(
     const std::shared_ptr<Currency> quote_currency, 
     const std::shared_ptr<Future> future
 ): 
-    CryptoAsset(id, crypto, quote_currency), future_ptr(future){}; 
+    CryptoAsset(id, crypto, quote_currency, ASSET_CRYPTO_FUTURE), future_ptr(future){}; 
 
 /**
  * @brief Retrieves the associated Future object.
@@ -88,6 +103,17 @@ std::shared_ptr<DateTime> CryptoFuture::get_expiry_datetime()
     return future_ptr->get_expiry();
 };
 
+/**
+ * @brief Retrieves the expiry date of the future by value.
+ * @return The expiry timestamp.
+ * @throws PerpetualFutureExpiryError if the future is perpetual.
+ * @see Future::get_expiry_timestamp
+ */
+Timestamp CryptoFuture::get_expiry_timestamp()
+{
+    return future_ptr->get_expiry_timestamp();
+};
+
 /**
  * @class CryptoStructuredFuture
  * @brief Represents a structured cryptocurrency future.
@@ -107,7 +133,7 @@ CryptoStructuredFuture::CryptoStructuredFuture(
     const std::shared_ptr<Currency> quote_currency, 
     const std::shared_ptr<StructuredFuture> structured_future
 ): 
-    CryptoAsset(id, crypto, quote_currency), structured_future_ptr(structured_future){};
+    CryptoAsset(id, crypto, quote_currency, ASSET_CRYPTO_STRUCTURED_FUTURE), structured_future_ptr(structured_future){};
 
 /**
  * @brief Retrieves the associated StructuredFuture object.
@@ -137,7 +163,27 @@ CryptoVolatilityFuture::CryptoVolatilityFuture(
     const std::shared_ptr<DateTime> expiry, 
     const DayCountConvention day_count
 ): 
-    CryptoAsset(id, crypto, quote_currency), future_ptr(set_future(id, expiry, day_count)){}; 
+    CryptoVolatilityFuture(id, crypto, quote_currency, expiry, day_count, MarketArena()){}; 
+
+/**
+ * @brief Constructs a CryptoVolatilityFuture object, its Future is allocated in an arena.
+ * @param id The asset's id.
+ * @param crypto A shared pointer to the Crypto object.
+ * @param quote_currency A shared pointer to the Currency object.
+ * @param expiry A shared pointer to the DateTime object representing the expiry date.
+ * @param day_count The day count convention of the future.
+ * @param arena The arena of the Future, which the Future keeps alive.
+ */
+CryptoVolatilityFuture::CryptoVolatilityFuture(
+    const std::string id,
+    const std::shared_ptr<Crypto> crypto, 
+    const std::shared_ptr<Currency> quote_currency, 
+    const std::shared_ptr<DateTime> expiry, 
+    const DayCountConvention day_count, 
+    const MarketArena& arena
+): 
+    CryptoAsset(id, crypto, quote_currency, ASSET_CRYPTO_VOLATILITY_FUTURE), 
+    future_ptr(set_future(id, expiry, day_count, arena)){}; 
 
 /**
  * @brief Retrieves the associated Future object.
@@ -157,17 +203,30 @@ std::shared_ptr<DateTime> CryptoVolatilityFuture::get_expiry_datetime()
     return future_ptr->get_expiry();
 };
 
+/**
+ * @brief Retrieves the expiry date of the future by value.
+ * @return The expiry timestamp.
+ * @throws PerpetualFutureExpiryError if the future is perpetual.
+ * @see Future::get_expiry_timestamp
+ */
+Timestamp CryptoVolatilityFuture::get_expiry_timestamp()
+{
+    return future_ptr->get_expiry_timestamp();
+};
+
 /**
  * @brief Sets the Future object based on the expiry date.
  * @param expiry A shared pointer to the DateTime object representing the expiry date.
+ * @param arena The arena of the Future and of its control block, null for the heap.
  * @return A shared pointer to the newly created Future object.
  */
 std::shared_ptr<Future> CryptoVolatilityFuture::set_future(
     const std::string id,
     const std::shared_ptr<DateTime> expiry, 
-    const DayCountConvention day_count)
+    const DayCountConvention day_count, 
+    const MarketArena& arena)
 {
-    return std::make_shared<Future>(id, expiry, day_count);
+    return make_in_arena<Future>(arena, id, expiry, day_count);
 }; 
 
 /**
@@ -188,9 +247,7 @@ CryptoOption::CryptoOption(
     const std::shared_ptr<Currency> quote_currency, 
     const std::shared_ptr<Option> option
 ): 
-    CryptoAsset(id, crypto, quote_currency), 
-    underlying_crypto_asset(std::make_shared<CryptoSpot>(id, crypto, quote_currency)), 
-    option_ptr(option){};
+    CryptoOption(id, crypto, quote_currency, option, MarketArena()){};
 
 /**
  * @brief Constructs a CryptoOption object with a future underlying asset.
@@ -207,8 +264,49 @@ CryptoOption::CryptoOption(
     const std::shared_ptr<Option> option, 
     const std::shared_ptr<Future> future
 ): 
-    CryptoAsset(id, crypto, quote_currency), 
-    underlying_crypto_asset(std::make_shared<CryptoFuture>(id, crypto, quote_currency, future)), 
+    CryptoOption(id, crypto, quote_currency, option, future, MarketArena()){};
+
+/**
+ * @brief Constructs a CryptoOption object with a spot underlying asset, allocated in an arena.
+ * @param id The asset's id.
+ * @param crypto A shared pointer to the Crypto object.
+ * @param quote_currency A shared pointer to the Currency object.
+ * @param option A shared pointer to the Option object.
+ * @param arena The arena of the underlying asset, which the asset keeps alive.
+ */
+CryptoOption::CryptoOption(
+    const std::string id,
+    const std::shared_ptr<Crypto> crypto, 
+    const std::shared_ptr<Currency> quote_currency, 
+    const std::shared_ptr<Option> option, 
+    const MarketArena& arena
+): 
+    CryptoAsset(id, crypto, quote_currency, ASSET_CRYPTO_OPTION), 
+    underlying_crypto_asset(make_in_arena<CryptoSpot>(
+        arena, id, crypto, quote_currency)), 
+    option_ptr(option){};
+
+/**
+ * @brief Constructs a CryptoOption object with a future underlying asset, allocated in an 
+ * arena.
+ * @param id The asset's id.
+ * @param crypto A shared pointer to the Crypto object.
+ * @param quote_currency A shared pointer to the Currency object.
+ * @param option A shared pointer to the Option object.
+ * @param future A shared pointer to the Future object.
+ * @param arena The arena of the underlying asset, which the asset keeps alive.
+ */
+CryptoOption::CryptoOption(
+    const std::string id,
+    const std::shared_ptr<Crypto> crypto, 
+    const std::shared_ptr<Currency> quote_currency, 
+    const std::shared_ptr<Option> option, 
+    const std::shared_ptr<Future> future, 
+    const MarketArena& arena
+): 
+    CryptoAsset(id, crypto, quote_currency, ASSET_CRYPTO_OPTION), 
+    underlying_crypto_asset(make_in_arena<CryptoFuture>(
+        arena, id, crypto, quote_currency, future)), 
     option_ptr(option){};
 
 /**
@@ -248,9 +346,7 @@ CryptoStructuredOption::CryptoStructuredOption(
     const std::shared_ptr<Currency> quote_currency, 
     const std::shared_ptr<StructuredOption> structured_option
 ): 
-    CryptoAsset(id, crypto, quote_currency), 
-    underlying_crypto_asset(std::make_shared<CryptoSpot>(id, crypto, quote_currency)),
-    structured_option_ptr(structured_option)
+    CryptoStructuredOption(id, crypto, quote_currency, structured_option, MarketArena())
     {};
 
 /**
@@ -269,8 +365,54 @@ CryptoStructuredOption::CryptoStructuredOption(
     const std::shared_ptr<StructuredOption> structured_option,
     const std::shared_ptr<Future> future
 ): 
-    CryptoAsset(id, crypto, quote_currency), 
-    underlying_crypto_asset(std::make_shared<CryptoFuture>(id, crypto, quote_currency, future)),
+    CryptoStructuredOption(id, crypto, quote_currency, structured_option, future, MarketArena())
+    {};
+
+/**
+ * @brief Constructs a CryptoStructuredOption object with a spot underlying asset, allocated in
+ * an arena.
+ * @param id The asset's id.
+ * @param crypto A shared pointer to the Crypto object.
+ * @param quote_currency A shared pointer to the Currency object.
+ * @param structured_option A shared pointer to the StructuredOption object.
+ * @param arena The arena of the underlying asset, which the asset keeps alive.
+ * @throw StructuredOptionMismatchError
+ */
+CryptoStructuredOption::CryptoStructuredOption(
+    const std::string id,
+    const std::shared_ptr<Crypto> crypto, 
+    const std::shared_ptr<Currency> quote_currency, 
+    const std::shared_ptr<StructuredOption> structured_option,
+    const MarketArena& arena
+): 
+    CryptoAsset(id, crypto, quote_currency, ASSET_CRYPTO_STRUCTURED_OPTION), 
+    underlying_crypto_asset(make_in_arena<CryptoSpot>(
+        arena, id, crypto, quote_currency)),
+    structured_option_ptr(structured_option)
+    {};
+
+/**
+ * @brief Constructs a CryptoStructuredOption object with a future underlying asset, allocated 
+ * in an arena.
+ * @param id The asset's id.
+ * @param crypto A shared pointer to the Crypto object.
+ * @param quote_currency A shared pointer to the Currency object.
+ * @param structured_option A shared pointer to the StructuredOption object.
+ * @param future A shared pointer to the Future object.
+ * @param arena The arena of the underlying asset, which the asset keeps alive.
+ * @throw StructuredOptionMismatchError
+ */
+CryptoStructuredOption::CryptoStructuredOption(
+    const std::string id,
+    const std::shared_ptr<Crypto> crypto, 
+    const std::shared_ptr<Currency> quote_currency, 
+    const std::shared_ptr<StructuredOption> structured_option,
+    const std::shared_ptr<Future> future,
+    const MarketArena& arena
+): 
+    CryptoAsset(id, crypto, quote_currency, ASSET_CRYPTO_STRUCTURED_OPTION), 
+    underlying_crypto_asset(make_in_arena<CryptoFuture>(
+        arena, id, crypto, quote_currency, future)),
     structured_option_ptr(structured_option)
     {};
 
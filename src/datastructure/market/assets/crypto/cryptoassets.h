@@ -1,25 +1,35 @@
 #pragma once
 #include <iostream>
 #include <vector>
+#include <memory>
 #include "../../../../../src/datastructure/market/assets/interface.h"
 #include "../../../../../src/datastructure/market/riskfactors/riskfactors.h"
 #include "../../../../../src/datastructure/datetime/datetime.h"
+#include "../../../../../src/datastructure/market/arena/arena.h"
 #include "../../../../../src/datastructure/market/instruments/options/options.h"
 #include "../../../../../src/datastructure/market/instruments/futures/futures.h"
 
 class CryptoAsset : public Asset 
 {
     public: 
+        static constexpr AssetTag TAG = ASSET_CRYPTO;
         CryptoAsset(
             const std::string id,
             const std::shared_ptr<Crypto> crypto, 
             const std::shared_ptr<Currency> quote_currency);
         virtual ~CryptoAsset() = default; 
+    protected:
+        CryptoAsset(
+            const std::string id,
+            const std::shared_ptr<Crypto> crypto, 
+            const std::shared_ptr<Currency> quote_currency, 
+            const AssetTag tag);
 };
 
 class CryptoSpot : public CryptoAsset 
 {
     public: 
+        static constexpr AssetTag TAG = ASSET_CRYPTO_SPOT;
         CryptoSpot(
             const std::string id,
             const std::shared_ptr<Crypto> crypto, 
@@ -30,9 +40,11 @@ class CryptoSpot : public CryptoAsset
 class CryptoFuture : public CryptoAsset 
 {
     public: 
+        static constexpr AssetTag TAG = ASSET_CRYPTO_FUTURE;
         std::shared_ptr<Future> get_future();
         bool is_perpetual(); 
         std::shared_ptr<DateTime> get_expiry_datetime();
+        Timestamp get_expiry_timestamp();
         CryptoFuture(
             const std::string id,
             const std::shared_ptr<Crypto> crypto, 
@@ -47,6 +59,7 @@ class CryptoFuture : public CryptoAsset
 class CryptoStructuredFuture : public CryptoAsset
 {
     public: 
+        static constexpr AssetTag TAG = ASSET_CRYPTO_STRUCTURED_FUTURE;
         std::shared_ptr<StructuredFuture> get_structured_future();
         CryptoStructuredFuture(
             const std::string id,
@@ -61,26 +74,37 @@ class CryptoStructuredFuture : public CryptoAsset
 class CryptoVolatilityFuture : public CryptoAsset 
 {
     public: 
+        static constexpr AssetTag TAG = ASSET_CRYPTO_VOLATILITY_FUTURE;
         std::shared_ptr<Future> get_future();
         std::shared_ptr<DateTime> get_expiry_datetime();
+        Timestamp get_expiry_timestamp();
         CryptoVolatilityFuture(
             const std::string id,
             const std::shared_ptr<Crypto> crypto, 
             const std::shared_ptr<Currency> quote_currency, 
             const std::shared_ptr<DateTime> expiry, 
             const DayCountConvention day_count);
+        CryptoVolatilityFuture(
+            const std::string id,
+            const std::shared_ptr<Crypto> crypto, 
+            const std::shared_ptr<Currency> quote_currency, 
+            const std::shared_ptr<DateTime> expiry, 
+            const DayCountConvention day_count, 
+            const MarketArena& arena);
         ~CryptoVolatilityFuture() = default;
     private: 
         std::shared_ptr<Future> set_future(
             const std::string id,
             const std::shared_ptr<DateTime> expiry, 
-            const DayCountConvention day_count);
+            const DayCountConvention day_count, 
+            const MarketArena& arena);
         const std::shared_ptr<Future> future_ptr;  
 };
 
 class CryptoOption : public CryptoAsset
 {
     public: 
+        static constexpr AssetTag TAG = ASSET_CRYPTO_OPTION;
         std::shared_ptr<Option> get_option();
         std::shared_ptr<CryptoAsset> get_underlying_crypto_asset();
         CryptoOption(
@@ -94,6 +118,19 @@ class CryptoOption : public CryptoAsset
             const std::shared_ptr<Currency> quote_currency, 
             const std::shared_ptr<Option> option, 
             const std::shared_ptr<Future> future);
+        CryptoOption(
+            const std::string id,
+            const std::shared_ptr<Crypto> crypto, 
+            const std::shared_ptr<Currency> quote_currency, 
+            const std::shared_ptr<Option> option, 
+            const MarketArena& arena);
+        CryptoOption(
+            const std::string id,
+            const std::shared_ptr<Crypto> crypto, 
+            const std::shared_ptr<Currency> quote_currency, 
+            const std::shared_ptr<Option> option, 
+            const std::shared_ptr<Future> future, 
+            const MarketArena& arena);
         ~CryptoOption() = default;
     private: 
         const std::shared_ptr<CryptoAsset> underlying_crypto_asset; 
@@ -103,6 +140,7 @@ class CryptoOption : public CryptoAsset
 class CryptoStructuredOption : public CryptoAsset
 {
     public: 
+        static constexpr AssetTag TAG = ASSET_CRYPTO_STRUCTURED_OPTION;
         std::shared_ptr<StructuredOption> get_structured_option();
         std::shared_ptr<CryptoAsset> get_underlying_crypto_asset();
         CryptoStructuredOption(
@@ -116,6 +154,19 @@ class CryptoStructuredOption : public CryptoAsset
             const std::shared_ptr<Currency> quote_currency, 
             const std::shared_ptr<StructuredOption> structured_option, 
             const std::shared_ptr<Future> future);
+        CryptoStructuredOption(
+            const std::string id,
+            const std::shared_ptr<Crypto> crypto, 
+            const std::shared_ptr<Currency> quote_currency, 
+            const std::shared_ptr<StructuredOption> structured_option, 
+            const MarketArena& arena);
+        CryptoStructuredOption(
+            const std::string id,
+            const std::shared_ptr<Crypto> crypto, 
+            const std::shared_ptr<Currency> quote_currency, 
+            const std::shared_ptr<StructuredOption> structured_option, 
+            const std::shared_ptr<Future> future, 
+            const MarketArena& arena);
         ~CryptoStructuredOption() = default; 
     private: 
         const std::shared_ptr<CryptoAsset> underlying_crypto_asset; 
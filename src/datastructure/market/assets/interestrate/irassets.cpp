@@ -11,7 +11,20 @@
 InterestRateAsset::InterestRateAsset(
     const std::string id,
     const std::shared_ptr<InterestRate> interest_rate): 
-    Asset(id, interest_rate->get_base_currency(), interest_rate), interest_rate_ptr(interest_rate){}; 
+    Asset(id, interest_rate->get_base_currency(), interest_rate, ASSET_INTEREST_RATE), 
+    interest_rate_ptr(interest_rate){}; 
+
+/**
+ * @brief Constructs an InterestRateAsset for the derived classes, which give their tag.
+ * @param id The asset's id. 
+ * @param interest_rate Shared pointer to an InterestRate object.
+ * @param tag The tag of the concrete class.
+ */
+InterestRateAsset::InterestRateAsset(
+    const std::string id,
+    const std::shared_ptr<InterestRate> interest_rate, 
+    const AssetTag tag): 
+    Asset(id, interest_rate->get_base_currency(), interest_rate, tag), interest_rate_ptr(interest_rate){}; 
 
 /**
  * @class ZeroCouponBond
@@ -28,7 +41,7 @@ ZeroCouponBond::ZeroCouponBond(
     const std::shared_ptr<InterestRate> interest_rate,  
     const DayCountConvention day_count_convention, 
     const std::shared_ptr<DateTime> expiry_datetime): 
-    InterestRateAsset(id, interest_rate), 
+    InterestRateAsset(id, interest_rate, ASSET_ZERO_COUPON_BOND), 
     day_count_convention_(day_count_convention),
     expiry_ptr(expiry_datetime){};
 
@@ -47,7 +60,7 @@ ZeroCouponBond::ZeroCouponBond(
     const DayCountConvention day_count_convention, 
     const Tenor expiry_tenor, 
     const std::shared_ptr<DateTime> start_datetime): 
-    InterestRateAsset(id, interest_rate), 
+    InterestRateAsset(id, interest_rate, ASSET_ZERO_COUPON_BOND), 
     day_count_convention_(day_count_convention),
     expiry_ptr(get_end_datetime_from_tenor(start_datetime, expiry_tenor, day_count_convention)){};
 
@@ -86,3 +99,42 @@ double ZeroCouponBond::get_year_fraction(std::shared_ptr<DateTime> reference_dat
         day_count_convention_
     );
 };
+
+/**
+ * @brief Retrieves the expiry date of the bond by value, without any heap traffic.
+ * @return The expiry timestamp.
+ */
+Timestamp ZeroCouponBond::get_expiry_timestamp()
+{
+    return expiry_ptr->to_timestamp();
+};
+
+/**
+ * @brief Calculates the year fraction between a reference date and the bond's expiry date.
+ *
+ * @param reference_timestamp The reference timestamp.
+ * @return The year fraction between the reference date and the expiry date.
+ * @throws UndefinedDayCountConventionError if the day count convention is invalid.
+ * @throws NonPositiveYearFractionError if the reference timestamp is after the expiry date. 
+ */
+double ZeroCouponBond::get_year_fraction(const Timestamp reference_timestamp)
+{
+    return get_year_fraction_from_datetimes(
+        reference_timestamp, 
+        get_expiry_timestamp(), 
+        day_count_convention_
+    );
+};
+
+/**
+ * @brief Registers the expiry of the bond in the year fraction table of a snapshot, the
+ * bonds sharing an expiry and a day count convention share an entry.
+ * @param table The year fraction table.
+ * @return The index of the expiry in the table, kept by the caller: an instrument shared by
+ * several snapshots has an index in each of their tables.
+ * @throws UndefinedDayCountConventionError if the day count convention is invalid.
+ */
+std::size_t ZeroCouponBond::register_year_fraction(YearFractionTable& table)
+{
+    return table.register_expiry(get_expiry_timestamp(), day_count_convention_);
+};
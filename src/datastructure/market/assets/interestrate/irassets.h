@@ -3,14 +3,21 @@
 #include "../../../../../src/datastructure/market/assets/interface.h"
 #include "../../../../../src/datastructure/market/riskfactors/riskfactors.h"
 #include "../../../../../src/datastructure/datetime/datetime.h"
+#include "../../../../../src/datastructure/datetime/yearfraction/yearfraction.h"
 
 class InterestRateAsset: public Asset
 {
     public: 
+        static constexpr AssetTag TAG = ASSET_INTEREST_RATE;
         InterestRateAsset(
             const std::string id, 
             const std::shared_ptr<InterestRate> interest_rate);
         virtual ~InterestRateAsset(){} 
+    protected:
+        InterestRateAsset(
+            const std::string id, 
+            const std::shared_ptr<InterestRate> interest_rate, 
+            const AssetTag tag);
     private: 
         const std::shared_ptr<InterestRate> interest_rate_ptr;
 }; 
@@ -18,9 +25,13 @@ class InterestRateAsset: public Asset
 class ZeroCouponBond: public InterestRateAsset
 {
     public:
+        static constexpr AssetTag TAG = ASSET_ZERO_COUPON_BOND;
         DayCountConvention get_day_count_convention(); 
         std::shared_ptr<DateTime> get_expiry_datetime();
         double get_year_fraction(std::shared_ptr<DateTime> reference_datetime);
+        Timestamp get_expiry_timestamp();
+        double get_year_fraction(const Timestamp reference_timestamp);
+        std::size_t register_year_fraction(YearFractionTable& table);
         ZeroCouponBond(
             const std::string id,
             const std::shared_ptr<InterestRate> interest_rate, 
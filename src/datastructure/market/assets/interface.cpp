@@ -22,7 +22,25 @@ Asset::Asset(
     std::shared_ptr<RiskFactor> risk_factor):
     id_(id),
     quote_ccy_ptr_(quote_currency), 
-    risk_factor_ptr_(risk_factor){}; 
+    risk_factor_ptr_(risk_factor), 
+    tag_(ASSET_BASE){}; 
+
+/**
+ * @brief Constructor for the derived classes, which give their tag.
+ * @param id The asset ID.
+ * @param quote_currency Shared pointer to the quote currency.
+ * @param risk_factor Shared pointer to the risk factor associated with the asset.
+ * @param tag The tag of the concrete class.
+ */
+Asset::Asset(
+    const std::string id,
+    std::shared_ptr<Currency> quote_currency,
+    std::shared_ptr<RiskFactor> risk_factor, 
+    const AssetTag tag):
+    id_(id),
+    quote_ccy_ptr_(quote_currency), 
+    risk_factor_ptr_(risk_factor), 
+    tag_(tag){}; 
 
 /**
  * @brief Gets the asset's id.
@@ -34,7 +52,17 @@ std::string Asset::get_id()
 };
 
 /**
- * @brief Gets the asset's type name.
+ * @brief Gets the asset's tag, the concrete class of the asset without RTTI (see visit_asset). 
+ * Each class has its tag as the compile-time constant TAG.
+ * @return The asset's tag.
+ */
+AssetTag Asset::get_asset_tag() const
+{
+    return tag_;
+};
+
+/**
+ * @brief Gets the asset's type name. It allocates a new string: use get_asset_tag to dispatch.
  * @return The asset's type.
  */
 std::string Asset::get_asset_type() const
@@ -5,6 +5,20 @@
 #include <typeinfo>
 #include "../../../../src/datastructure/market/riskfactors/riskfactors.h"
 
+enum AssetTag
+{
+    ASSET_BASE = 0,
+    ASSET_CRYPTO = 1,
+    ASSET_CRYPTO_SPOT = 2,
+    ASSET_CRYPTO_FUTURE = 3,
+    ASSET_CRYPTO_STRUCTURED_FUTURE = 4,
+    ASSET_CRYPTO_VOLATILITY_FUTURE = 5,
+    ASSET_CRYPTO_OPTION = 6,
+    ASSET_CRYPTO_STRUCTURED_OPTION = 7,
+    ASSET_INTEREST_RATE = 8,
+    ASSET_ZERO_COUPON_BOND = 9
+};
+
 class Asset
 {
     public: 
@@ -14,16 +28,26 @@ class Asset
         bool is_quanto(); 
         std::shared_ptr<FX> get_fx_quanto_risk_factor(); 
         std::string get_asset_type() const;
+        AssetTag get_asset_tag() const;
+        static constexpr AssetTag TAG = ASSET_BASE;
         Asset(
             const std::string id,
             const std::shared_ptr<Currency> quote_currency,
             const std::shared_ptr<RiskFactor> risk_factor
         );
         virtual ~Asset(){};
+    protected:
+        Asset(
+            const std::string id,
+            const std::shared_ptr<Currency> quote_currency,
+            const std::shared_ptr<RiskFactor> risk_factor,
+            const AssetTag tag
+        );
     private: 
         const std::string id_;
         const std::shared_ptr<Currency> quote_ccy_ptr_;
         const std::shared_ptr<RiskFactor> risk_factor_ptr_;
+        const AssetTag tag_;
 };
 
 class AssetQuote
@@ -0,0 +1,108 @@
+#pragma once
+#include <iostream>
+#include <variant>
+#include "../../../../src/datastructure/market/assets/interface.h"
+#include "../../../../src/datastructure/market/assets/crypto/cryptoassets.h"
+#include "../../../../src/datastructure/market/assets/interestrate/irassets.h"
+#include "../../../../src/datastructure/market/instruments/interface.h"
+#include "../../../../src/datastructure/market/instruments/options/options.h"
+#include "../../../../src/datastructure/market/instruments/futures/futures.h"
+
+/**
+* @file dispatch.h
+* @brief This file defines the dispatch over the concrete asset and instrument classes.
+*
+* The concrete class of an object is read from its tag (get_asset_tag, get_instrument_tag), 
+* which is set once by the constructors: a dispatch is a switch on a small integer followed by a 
+* static_cast, with no RTTI, no string and no virtual call. visit_asset / visit_instrument call a
+* visitor with the object as its concrete class (the visitor is typically an overload set or a 
+* generic lambda testing the type with if constexpr, every overload must return the same type),
+* get_asset_variant / get_instrument_variant give the same object as a std::variant of pointers 
+* for std::visit.
+*/
+
+typedef std::variant<
+    Asset*, 
+    CryptoAsset*, 
+    CryptoSpot*, 
+    CryptoFuture*, 
+    CryptoStructuredFuture*, 
+    CryptoVolatilityFuture*, 
+    CryptoOption*, 
+    CryptoStructuredOption*, 
+    InterestRateAsset*, 
+    ZeroCouponBond*
+> AssetVariant;
+
+typedef std::variant<
+    Instrument*, 
+    Option*, 
+    EuropeanVanillaOption*, 
+    AmericanVanillaOption*, 
+    StructuredOption*, 
+    Future*, 
+    StructuredFuture*
+> InstrumentVariant;
+
+/**
+ * @brief Calls a visitor with an asset as its concrete class.
+ * @param asset The asset.
+ * @param visitor The visitor, callable with every class of AssetVariant.
+ * @return The result of the visitor.
+ */
+template <typename Visitor>
+decltype(auto) visit_asset(Asset& asset, Visitor&& visitor)
+{
+    switch (asset.get_asset_tag())
+    {
+        case ASSET_CRYPTO: return visitor(static_cast<CryptoAsset&>(asset));
+        case ASSET_CRYPTO_SPOT: return visitor(static_cast<CryptoSpot&>(asset));
+        case ASSET_CRYPTO_FUTURE: return visitor(static_cast<CryptoFuture&>(asset));
+        case ASSET_CRYPTO_STRUCTURED_FUTURE: return visitor(static_cast<CryptoStructuredFuture&>(asset));
+        case ASSET_CRYPTO_VOLATILITY_FUTURE: return visitor(static_cast<CryptoVolatilityFuture&>(asset));
+        case ASSET_CRYPTO_OPTION: return visitor(static_cast<CryptoOption&>(asset));
+        case ASSET_CRYPTO_STRUCTURED_OPTION: return visitor(static_cast<CryptoStructuredOption&>(asset));
+        case ASSET_INTEREST_RATE: return visitor(static_cast<InterestRateAsset&>(asset));
+        case ASSET_ZERO_COUPON_BOND: return visitor(static_cast<ZeroCouponBond&>(asset));
+        default: return visitor(asset);
+    }
+};
+
+/**
+ * @brief Calls a visitor with an instrument as its concrete class.
+ * @param instrument The instrument.
+ * @param visitor The visitor, callable with every class of InstrumentVariant.
+ * @return The result of the visitor.
+ */
+template <typename Visitor>
+decltype(auto) visit_instrument(Instrument& instrument, Visitor&& visitor)
+{
+    switch (instrument.get_instrument_tag())
+    {
+        case INSTRUMENT_OPTION: return visitor(static_cast<Option&>(instrument));
+        case INSTRUMENT_EUROPEAN_VANILLA_OPTION: return visitor(static_cast<EuropeanVanillaOption&>(instrument));
+        case INSTRUMENT_AMERICAN_VANILLA_OPTION: return visitor(static_cast<AmericanVanillaOption&>(instrument));
+        case INSTRUMENT_STRUCTURED_OPTION: return visitor(static_cast<StructuredOption&>(instrument));
+        case INSTRUMENT_FUTURE: return visitor(static_cast<Future&>(instrument));
+        case INSTRUMENT_STRUCTURED_FUTURE: return visitor(static_cast<StructuredFuture&>(instrument));
+        default: return visitor(instrument);
+    }
+};
+
+/**
+ * @param asset The asset.
+ * @return A pointer to the asset as its concrete class.
+ */
+inline AssetVariant get_asset_variant(Asset& asset)
+{
+    return visit_asset(asset, [](auto& concrete){return AssetVariant(&concrete);});
+};
+
+/**
+ * @param instrument The instrument.
+ * @return A pointer to the instrument as its concrete class.
+ */
+inline InstrumentVariant get_instrument_variant(Instrument& instrument)
+{
+    return visit_instrument(instrument, [](auto& concrete){return InstrumentVariant(&concrete);});
+};
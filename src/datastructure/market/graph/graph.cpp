@@ -0,0 +1,255 @@
+#include "graph.h"
+
+/**
+* @file graph.h
+* @brief This file defines the dependency graph from the risk factors to the assets, which
+* drives the incremental revaluation of a book on each market tick.
+*/
+
+/**
+ * @class RiskFactorGraph
+ * @brief The bipartite graph of the risk factors and of the assets depending on them.
+ *
+ * The edges come from the object model: the risk factor of the asset, its FX quanto risk factor
+ * when the quote currency is not the base currency of the risk factor, and for the crypto
+ * options (vanilla and structured) the same two links of the underlying crypto asset. The chain
+ * through the underlying is flattened when the asset is added, so that a tick walks a single
+ * adjacency list. A tick marks the dependent assets dirty, once each however many of their risk
+ * factors moved, and the dirty set is repriced in one batch by revalue: a BTC tick never touches
+ * an ETH option. The risk factors and the assets are addressed by dense handles, as in the
+ * MarketRegistry. Building the graph (add_asset) is not thread safe.
+ */
+
+/**
+ * @brief Adds an asset and its edges, it is dirty until its first revaluation.
+ * @param asset The asset, null gives NULL_HANDLE.
+ * @return The handle of the asset, the existing one if it is already in the graph.
+ * @throws RegistryDuplicatedId If another asset is in the graph with the same id.
+ * @throws RegistryFull If 2^32-1 assets or risk factors are already in the graph.
+ */
+RegistryHandle RiskFactorGraph::add_asset(const std::shared_ptr<Asset> asset)
+{
+    if (!asset){return NULL_HANDLE;}
+    const std::string id = asset->get_id();
+    const RegistryHandle existing = asset_ids_.find(id);
+    if (existing!=NULL_HANDLE)
+    {
+        if (assets_[existing]!=asset){throw RegistryDuplicatedId();}
+        return existing;
+    }
+    const RegistryHandle handle = asset_ids_.intern(id);
+    assets_.push_back(asset);
+    asset_risk_factors_.emplace_back();
+    dirty_flags_.push_back(0);
+    add_dependencies(handle, asset);
+    const AssetTag tag = asset->get_asset_tag();
+    if (tag==ASSET_CRYPTO_OPTION)
+    {
+        add_dependencies(handle, static_cast<CryptoOption*>(asset.get())->get_underlying_crypto_asset());
+    }
+    else if (tag==ASSET_CRYPTO_STRUCTURED_OPTION)
+    {
+        add_dependencies(handle, static_cast<CryptoStructuredOption*>(asset.get())->get_underlying_crypto_asset());
+    }
+    dirty_flags_[handle] = 1;
+    dirty_assets_.push_back(handle);
+    return handle;
+};
+
+/**
+ * @brief Adds the edges from the risk factor and the FX quanto risk factor of an asset.
+ * @param asset The handle of the dependent asset.
+ * @param source The asset whose risk factors are read, the dependent asset or its underlying.
+ */
+void RiskFactorGraph::add_dependencies(const RegistryHandle asset, const std::shared_ptr<Asset>& source)
+{
+    if (!source){return;}
+    const std::shared_ptr<RiskFactor> risk_factor = source->get_risk_factor();
+    if (!risk_factor){return;}
+    add_dependency(asset, risk_factor->get_id());
+    if (source->get_quote_currency() && source->is_quanto())
+    {
+        add_dependency(asset, source->get_fx_quanto_risk_factor()->get_id());
+    }
+};
+
+/**
+ * @brief Adds the edge from a risk factor to an asset, if it does not exist yet.
+ * @param asset The handle of the dependent asset.
+ * @param risk_factor_id The id of the risk factor, interned if it is new.
+ */
+void RiskFactorGraph::add_dependency(const RegistryHandle asset, const std::string& risk_factor_id)
+{
+    const RegistryHandle risk_factor = risk_factor_ids_.intern(risk_factor_id);
+    if (risk_factor==dependent_assets_.size()){dependent_assets_.emplace_back();}
+    std::vector<RegistryHandle>& factors = asset_risk_factors_[asset];
+    if (std::find(factors.begin(), factors.end(), risk_factor)!=factors.end()){return;}
+    factors.push_back(risk_factor);
+    dependent_assets_[risk_factor].push_back(asset);
+};
+
+/**
+ * @param id The id of the risk factor.
+ * @return The handle of the risk factor, NULL_HANDLE if no asset of the graph depends on it.
+ */
+RegistryHandle RiskFactorGraph::find_risk_factor(const std::string& id) const
+{
+    return risk_factor_ids_.find(id);
+};
+
+/**
+ * @param id The id of the asset.
+ * @return The handle of the asset, NULL_HANDLE if it is not in the graph.
+ */
+RegistryHandle RiskFactorGraph::find_asset(const std::string& id) const
+{
+    return asset_ids_.find(id);
+};
+
+/**
+ * @param handle The handle of the asset.
+ * @return The asset, by reference.
+ * @throws RegistryUnknownHandle If the handle is not in the graph.
+ */
+const std::shared_ptr<Asset>& RiskFactorGraph::get_asset(const RegistryHandle handle) const
+{
+    if (handle >= assets_.size()){throw RegistryUnknownHandle();}
+    return assets_[handle];
+};
+
+/**
+ * @param handle The handle of the risk factor.
+ * @return The id of the risk factor, by reference.
+ * @throws RegistryUnknownHandle If the handle is not in the graph.
+ */
+const std::string& RiskFactorGraph::get_risk_factor_id(const RegistryHandle handle) const
+{
+    return risk_factor_ids_.get_id(handle);
+};
+
+/**
+ * @param risk_factor The handle of the risk factor.
+ * @return The handles of the assets depending on the risk factor, in the order they were added.
+ * @throws RegistryUnknownHandle If the handle is not in the graph.
+ */
+const std::vector<RegistryHandle>& RiskFactorGraph::get_dependent_assets(const RegistryHandle risk_factor) const
+{
+    if (risk_factor >= dependent_assets_.size()){throw RegistryUnknownHandle();}
+    return dependent_assets_[risk_factor];
+};
+
+/**
+ * @param asset The handle of the asset.
+ * @return The handles of the risk factors the asset depends on.
+ * @throws RegistryUnknownHandle If the handle is not in the graph.
+ */
+const std::vector<RegistryHandle>& RiskFactorGraph::get_asset_risk_factors(const RegistryHandle asset) const
+{
+    if (asset >= asset_risk_factors_.size()){throw RegistryUnknownHandle();}
+    return asset_risk_factors_[asset];
+};
+
+/**
+ * @brief Marks the assets depending on a risk factor dirty, on a tick of the risk factor.
+ * @param risk_factor The handle of the risk factor.
+ * @return The number of assets which were clean and are now dirty.
+ * @throws RegistryUnknownHandle If the handle is not in the graph.
+ */
+std::size_t RiskFactorGraph::mark_dirty(const RegistryHandle risk_factor)
+{
+    std::size_t n_marked = 0;
+    for (const RegistryHandle asset: get_dependent_assets(risk_factor))
+    {
+        if (dirty_flags_[asset]){continue;}
+        dirty_flags_[asset] = 1;
+        dirty_assets_.push_back(asset);
+        n_marked++;
+    }
+    return n_marked;
+};
+
+/**
+ * @brief Marks the assets depending on a risk factor dirty, from the id of the risk factor.
+ * @param risk_factor_id The id of the risk factor.
+ * @return The number of assets which were clean and are now dirty, 0 if no asset of the graph
+ * depends on the risk factor.
+ */
+std::size_t RiskFactorGraph::mark_dirty(const std::string& risk_factor_id)
+{
+    const RegistryHandle risk_factor = risk_factor_ids_.find(risk_factor_id);
+    if (risk_factor==NULL_HANDLE){return 0;}
+    return mark_dirty(risk_factor);
+};
+
+/**
+ * @brief Marks the assets depending on several risk factors dirty, on a batch of ticks.
+ * @param risk_factors The handles of the risk factors.
+ * @param n The number of risk factors.
+ * @return The number of assets which were clean and are now dirty.
+ * @throws RegistryUnknownHandle If a handle is not in the graph.
+ */
+std::size_t RiskFactorGraph::mark_dirty(const RegistryHandle* risk_factors, const std::size_t n)
+{
+    std::size_t n_marked = 0;
+    for (std::size_t i = 0; i < n; ++i){n_marked += mark_dirty(risk_factors[i]);}
+    return n_marked;
+};
+
+/**
+ * @param asset The handle of the asset.
+ * @return Whether the asset must be repriced.
+ * @throws RegistryUnknownHandle If the handle is not in the graph.
+ */
+bool RiskFactorGraph::is_dirty(const RegistryHandle asset) const
+{
+    if (asset >= dirty_flags_.size()){throw RegistryUnknownHandle();}
+    return dirty_flags_[asset];
+};
+
+/**
+ * @return The handles of the dirty assets, in the order they were marked.
+ */
+const std::vector<RegistryHandle>& RiskFactorGraph::get_dirty_assets() const
+{
+    return dirty_assets_;
+};
+
+/**
+ * @brief Marks every asset clean, once the dirty set has been repriced.
+ */
+void RiskFactorGraph::clear_dirty()
+{
+    for (const RegistryHandle asset: dirty_assets_){dirty_flags_[asset] = 0;}
+    dirty_assets_.clear();
+};
+
+/**
+ * @brief Reprices the dirty set in one batch and marks every asset clean.
+ * @param reprice The batch repricing, called once with the handles of the dirty assets, not
+ * called if no asset is dirty.
+ * @return The number of repriced assets.
+ */
+std::size_t RiskFactorGraph::revalue(const std::function<void(const RegistryHandle* assets, std::size_t n)>& reprice)
+{
+    const std::size_t n = dirty_assets_.size();
+    if (n==0){return 0;}
+    reprice(dirty_assets_.data(), n);
+    clear_dirty();
+    return n;
+};
+
+/**
+ * @return The number of risk factors at least one asset depends on.
+ */
+std::size_t RiskFactorGraph::get_number_risk_factors() const
+{
+    return risk_factor_ids_.size();
+};
+
+/**
+ * @return The number of assets.
+ */
+std::size_t RiskFactorGraph::get_number_assets() const
+{
+    return assets_.size();
+};
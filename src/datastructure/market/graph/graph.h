@@ -0,0 +1,43 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include "../../../../src/datastructure/market/riskfactors/riskfactors.h"
+#include "../../../../src/datastructure/market/assets/interface.h"
+#include "../../../../src/datastructure/market/assets/crypto/cryptoassets.h"
+#include "../../../../src/datastructure/market/registry/registry.h"
+
+class RiskFactorGraph
+{
+    public:
+        RiskFactorGraph(){};
+        ~RiskFactorGraph(){};
+        RegistryHandle add_asset(const std::shared_ptr<Asset> asset);
+        RegistryHandle find_risk_factor(const std::string& id) const;
+        RegistryHandle find_asset(const std::string& id) const;
+        const std::shared_ptr<Asset>& get_asset(const RegistryHandle handle) const;
+        const std::string& get_risk_factor_id(const RegistryHandle handle) const;
+        const std::vector<RegistryHandle>& get_dependent_assets(const RegistryHandle risk_factor) const;
+        const std::vector<RegistryHandle>& get_asset_risk_factors(const RegistryHandle asset) const;
+        std::size_t mark_dirty(const RegistryHandle risk_factor);
+        std::size_t mark_dirty(const std::string& risk_factor_id);
+        std::size_t mark_dirty(const RegistryHandle* risk_factors, const std::size_t n);
+        bool is_dirty(const RegistryHandle asset) const;
+        const std::vector<RegistryHandle>& get_dirty_assets() const;
+        void clear_dirty();
+        std::size_t revalue(const std::function<void(const RegistryHandle* assets, std::size_t n)>& reprice);
+        std::size_t get_number_risk_factors() const;
+        std::size_t get_number_assets() const;
+    private:
+        void add_dependency(const RegistryHandle asset, const std::string& risk_factor_id);
+        void add_dependencies(const RegistryHandle asset, const std::shared_ptr<Asset>& source);
+        InternTable risk_factor_ids_;
+        InternTable asset_ids_;
+        std::vector<std::shared_ptr<Asset>> assets_;
+        std::vector<std::vector<RegistryHandle>> dependent_assets_;
+        std::vector<std::vector<RegistryHandle>> asset_risk_factors_;
+        std::vector<unsigned char> dirty_flags_;
+        std::vector<RegistryHandle> dirty_assets_;
+};
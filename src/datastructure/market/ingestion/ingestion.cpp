@@ -0,0 +1,437 @@
+#include "ingestion.h"
+
+/**
+* @file ingestion.h
+* @brief This file defines the lock-free rings carrying the quotes from the feed threads to the
+* pricing threads, and the coalescing of the quotes into the QuoteBook.
+*
+* References :
+* - "Bounded MPMC queue", Vyukov, 2010.
+* - "A lock-free, cache-efficient multi-core synchronization mechanism for line-rate network
+* traffic monitoring", Lee, Bu, Chandranmenon, 2010.
+*/
+
+/**
+ * @var std::size_t QUOTE_RING_CACHE_LINE
+ * @brief The alignment of the indices of the rings, which are written by different threads.
+ */
+
+/**
+ * @var std::size_t QUOTE_COALESCER_BUFFER
+ * @brief The number of records a coalescer pops from a ring at once.
+ */
+
+/**
+ * @class QuoteRingWrongCapacity
+ * @brief Definition of the error when the capacity of a ring is zero or too large.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * QuoteRingWrongCapacity::what() const throw(){
+    return "The capacity of a ring must be positive and at most 2^62.";
+};
+
+/**
+ * @class QuoteCoalescerUnknownHandle
+ * @brief Definition of the error when a quote is received for a handle beyond the instruments
+ * of the coalescer.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * QuoteCoalescerUnknownHandle::what() const throw(){
+    return "The handle of the quote is beyond the instruments of the coalescer.";
+};
+
+/**
+ * @class QuoteCoalescerHandleOutsideBook
+ * @brief Definition of the error when a pending quote has a handle beyond the assets of the
+ * QuoteBook it is flushed into.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * QuoteCoalescerHandleOutsideBook::what() const throw(){
+    return "The handle of the quote is beyond the assets of the book.";
+};
+
+/**
+ * @struct QuoteRecord
+ * @brief The fixed size record of a quote carried by the rings, 32 bytes, trivially copyable.
+ *
+ * @var RegistryHandle QuoteRecord::handle
+ *  The handle of the instrument, its index in the QuoteBook.
+ * @var double QuoteRecord::bid
+ *  The bid price.
+ * @var double QuoteRecord::ask
+ *  The ask price.
+ * @var Timestamp QuoteRecord::exchange_timestamp
+ *  The time of the quote at the exchange, in nanoseconds.
+ */
+
+/**
+ * @brief Rounds a capacity up to the next power of two.
+ * @param capacity The requested capacity.
+ * @return The mask of the indices of the ring, the capacity minus one.
+ * @throw QuoteRingWrongCapacity if the capacity is 0 or above 2^62.
+ */
+static std::size_t get_ring_mask(const std::size_t capacity)
+{
+    if (capacity == 0 || capacity > (std::size_t(1) << 62)){throw QuoteRingWrongCapacity();}
+    std::size_t rounded = 1;
+    while (rounded < capacity){rounded <<= 1;}
+    return rounded - 1;
+};
+
+/**
+ * @class SPSCQuoteRing
+ * @brief The bounded ring of one producer and one consumer thread.
+ *
+ * Each side owns its index and keeps a cached copy of the index of the other side, which is
+ * reloaded (acquire) only when the ring looks full or empty: in steady state a push or a pop
+ * touches one slot and one cache line of its own. The indices are never wrapped, the slot is
+ * the index masked by the capacity. Nothing is allocated after the construction.
+ */
+
+/**
+ * @brief The constructor.
+ * @param capacity The minimum number of records, rounded up to a power of two.
+ * @throw QuoteRingWrongCapacity if the capacity is 0 or above 2^62.
+ */
+SPSCQuoteRing::SPSCQuoteRing(const std::size_t capacity):
+    mask_(get_ring_mask(capacity)), tail_(0), cached_head_(0), head_(0), cached_tail_(0)
+{
+    slots_.resize(mask_ + 1);
+};
+
+/**
+ * @brief Pushes a record, called by the producer thread only.
+ * @param record The record.
+ * @return False if the ring is full, the record is then dropped.
+ */
+bool SPSCQuoteRing::push(const QuoteRecord& record)
+{
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_)
+    {
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (tail - cached_head_ > mask_){return false;}
+    }
+    slots_[tail & mask_] = record;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+};
+
+/**
+ * @brief Pops the oldest record, called by the consumer thread only.
+ * @param record The popped record.
+ * @return False if the ring is empty.
+ */
+bool SPSCQuoteRing::pop(QuoteRecord& record)
+{
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_)
+    {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head == cached_tail_){return false;}
+    }
+    record = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+};
+
+/**
+ * @brief Pops up to n records at once, with one release of the consumer index.
+ * @param records The popped records, oldest first.
+ * @param n The maximum number of records.
+ * @return The number of popped records.
+ */
+std::size_t SPSCQuoteRing::pop(QuoteRecord* records, const std::size_t n)
+{
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (cached_tail_ - head < n){cached_tail_ = tail_.load(std::memory_order_acquire);}
+    const std::size_t m = std::min(n, cached_tail_ - head);
+    for (std::size_t i = 0; i < m; ++i){records[i] = slots_[(head + i) & mask_];}
+    if (m > 0){head_.store(head + m, std::memory_order_release);}
+    return m;
+};
+
+/**
+ * @return The number of slots.
+ */
+std::size_t SPSCQuoteRing::capacity() const
+{
+    return mask_ + 1;
+};
+
+/**
+ * @return The number of records in the ring, exact only when neither side is running.
+ */
+std::size_t SPSCQuoteRing::size() const
+{
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+};
+
+/**
+ * @class MPSCQuoteRing
+ * @brief The bounded ring of several producer threads and one consumer thread.
+ *
+ * Each slot carries a sequence number telling whose turn it is: the slot of index i is free
+ * for the producer of index i when its sequence is i, and ready for the consumer when it is
+ * i+1. The producers claim an index with a compare and swap of the shared tail, then publish
+ * the record with a release of the sequence; the consumer frees the slot for the next lap with
+ * the sequence i+capacity. A producer never waits for another one, except for the slot it
+ * claimed, and nothing is allocated after the construction.
+ */
+
+/**
+ * @brief The constructor.
+ * @param capacity The minimum number of records, rounded up to a power of two.
+ * @throw QuoteRingWrongCapacity if the capacity is 0 or above 2^62.
+ */
+MPSCQuoteRing::MPSCQuoteRing(const std::size_t capacity):
+    mask_(get_ring_mask(capacity)), tail_(0), head_(0)
+{
+    slots_.reset(new Slot[mask_ + 1]);
+    for (std::size_t i = 0; i <= mask_; ++i){slots_[i].sequence.store(i, std::memory_order_relaxed);}
+};
+
+/**
+ * @brief Pushes a record, may be called by any number of producer threads.
+ * @param record The record.
+ * @return False if the ring is full, the record is then dropped.
+ */
+bool MPSCQuoteRing::push(const QuoteRecord& record)
+{
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true)
+    {
+        slot = &slots_[tail & mask_];
+        const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence - tail);
+        if (lag == 0)
+        {
+            if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)){break;}
+        }
+        else if (lag < 0){return false;}
+        else {tail = tail_.load(std::memory_order_relaxed);}
+    }
+    slot->record = record;
+    slot->sequence.store(tail + 1, std::memory_order_release);
+    return true;
+};
+
+/**
+ * @brief Pops the oldest published record, called by the consumer thread only.
+ * @param record The popped record.
+ * @return False if the ring is empty, or if the oldest claimed slot is not published yet.
+ */
+bool MPSCQuoteRing::pop(QuoteRecord& record)
+{
+    Slot& slot = slots_[head_ & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != head_ + 1){return false;}
+    record = slot.record;
+    slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+    head_++;
+    return true;
+};
+
+/**
+ * @brief Pops up to n records at once.
+ * @param records The popped records, oldest first.
+ * @param n The maximum number of records.
+ * @return The number of popped records.
+ */
+std::size_t MPSCQuoteRing::pop(QuoteRecord* records, const std::size_t n)
+{
+    std::size_t m = 0;
+    while (m < n && pop(records[m])){m++;}
+    return m;
+};
+
+/**
+ * @return The number of slots.
+ */
+std::size_t MPSCQuoteRing::capacity() const
+{
+    return mask_ + 1;
+};
+
+/**
+ * @class QuoteCoalescer
+ * @brief The consumer side of the rings: keeps only the latest quote of each instrument since
+ * the last flush, so that a burst of ticks on one instrument is priced once.
+ *
+ * The latest quote is the one with the latest exchange time (the later arrival for equal
+ * times): a quote older than the last one kept for its instrument, pending or already flushed,
+ * is stale and dropped, so that the order of the venues in the rings does not matter. The instruments are
+ * addressed by their dense handles; the tables and the flush buffers are allocated once, by
+ * the constructor.
+ */
+
+/**
+ * @brief The constructor.
+ * @param n_instruments The number of instruments, the handles are in [0, n_instruments).
+ */
+QuoteCoalescer::QuoteCoalescer(const std::size_t n_instruments):
+    latest_(n_instruments), pending_flags_(n_instruments, 0), buffer_(QUOTE_COALESCER_BUFFER),
+    indices_(n_instruments), bids_(n_instruments), asks_(n_instruments), timestamps_(n_instruments),
+    n_received_(0), n_coalesced_(0), n_stale_(0)
+{
+    const Timestamp never{std::numeric_limits<long long>::min()};
+    for (QuoteRecord& record: latest_){record = QuoteRecord{NULL_HANDLE, 0., 0., never};}
+    pending_.reserve(n_instruments);
+};
+
+/**
+ * @brief Adds a quote.
+ * @param record The quote.
+ * @throw QuoteCoalescerUnknownHandle if the handle is beyond the instruments.
+ */
+void QuoteCoalescer::add(const QuoteRecord& record)
+{
+    if (record.handle >= latest_.size()){throw QuoteCoalescerUnknownHandle();}
+    n_received_++;
+    QuoteRecord& latest = latest_[record.handle];
+    if (record.exchange_timestamp.ns < latest.exchange_timestamp.ns)
+    {
+        n_stale_++;
+        return;
+    }
+    if (pending_flags_[record.handle])
+    {
+        n_coalesced_++;
+        latest = record;
+        return;
+    }
+    pending_flags_[record.handle] = 1;
+    pending_.push_back(record.handle);
+    latest = record;
+};
+
+/**
+ * @brief Pops the records of a ring and adds them, at most a capacity of the ring per call so
+ * that a busy producer does not hold the consumer.
+ * @param ring The ring.
+ * @return The number of popped records.
+ * @throw QuoteCoalescerUnknownHandle if a handle is beyond the instruments.
+ */
+std::size_t QuoteCoalescer::drain(SPSCQuoteRing& ring)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_INGESTION);
+    std::size_t n_popped = 0;
+    while (n_popped < ring.capacity())
+    {
+        const std::size_t m = ring.pop(buffer_.data(), buffer_.size());
+        for (std::size_t i = 0; i < m; ++i){add(buffer_[i]);}
+        n_popped += m;
+        if (m < buffer_.size()){break;}
+    }
+    return n_popped;
+};
+
+/**
+ * @brief Pops the records of a ring and adds them, at most a capacity of the ring per call so
+ * that the producers do not hold the consumer.
+ * @param ring The ring.
+ * @return The number of popped records.
+ * @throw QuoteCoalescerUnknownHandle if a handle is beyond the instruments.
+ */
+std::size_t QuoteCoalescer::drain(MPSCQuoteRing& ring)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_INGESTION);
+    std::size_t n_popped = 0;
+    while (n_popped < ring.capacity())
+    {
+        const std::size_t m = ring.pop(buffer_.data(), buffer_.size());
+        for (std::size_t i = 0; i < m; ++i){add(buffer_[i]);}
+        n_popped += m;
+        if (m < buffer_.size()){break;}
+    }
+    return n_popped;
+};
+
+/**
+ * @brief Writes the latest quote of each pending instrument into the book, in one batch
+ * update, and clears the pending set. The handles are checked against the book before anything
+ * is written, as QuoteBook::update does not check its indices; when the coalescer has no more
+ * instruments than the book every handle is in range and the check is skipped.
+ * @param book The book, whose indices are the handles of the quotes.
+ * @return The number of updated instruments.
+ * @throw QuoteCoalescerHandleOutsideBook if a pending handle is beyond the assets of the book,
+ * the book and the pending set are then left unchanged.
+ */
+std::size_t QuoteCoalescer::flush(QuoteBook& book)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_INGESTION);
+    const std::size_t n = pending_.size();
+    const std::size_t n_assets = book.size();
+    if (latest_.size() > n_assets)
+    {
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            if (pending_[j] >= n_assets){throw QuoteCoalescerHandleOutsideBook();}
+        }
+    }
+    for (std::size_t j = 0; j < n; ++j)
+    {
+        const QuoteRecord& record = latest_[pending_[j]];
+        indices_[j] = record.handle;
+        bids_[j] = record.bid;
+        asks_[j] = record.ask;
+        timestamps_[j] = record.exchange_timestamp;
+        pending_flags_[record.handle] = 0;
+    }
+    book.update(indices_.data(), bids_.data(), asks_.data(), timestamps_.data(), n);
+    pending_.clear();
+    return n;
+};
+
+/**
+ * @return The handles of the instruments quoted since the last flush, in order of first arrival.
+ */
+const std::vector<RegistryHandle>& QuoteCoalescer::get_pending() const
+{
+    return pending_;
+};
+
+/**
+ * @param handle The handle of the instrument.
+ * @return The latest quote of the instrument, the last flushed one if it is not pending.
+ * @throw QuoteCoalescerUnknownHandle if the handle is beyond the instruments.
+ */
+const QuoteRecord& QuoteCoalescer::get_latest(const RegistryHandle handle) const
+{
+    if (handle >= latest_.size()){throw QuoteCoalescerUnknownHandle();}
+    return latest_[handle];
+};
+
+/**
+ * @return The number of quotes added since the construction.
+ */
+std::size_t QuoteCoalescer::get_number_received() const
+{
+    return n_received_;
+};
+
+/**
+ * @return The number of quotes merged into an already pending quote since the construction.
+ */
+std::size_t QuoteCoalescer::get_number_coalesced() const
+{
+    return n_coalesced_;
+};
+
+/**
+ * @return The number of quotes dropped as older than the latest one of their instrument since 
+ * the construction.
+ */
+std::size_t QuoteCoalescer::get_number_stale() const
+{
+    return n_stale_;
+};
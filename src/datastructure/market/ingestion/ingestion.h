@@ -0,0 +1,102 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <cstddef>
+#include <algorithm>
+#include "../../../../src/datastructure/datetime/datetime.h"
+#include "../../../../src/datastructure/market/registry/registry.h"
+#include "../../../../src/datastructure/market/quotebook/quotebook.h"
+#include "../../../../src/instrumentation/instrumentation.h"
+
+constexpr std::size_t QUOTE_RING_CACHE_LINE = 64;
+
+constexpr std::size_t QUOTE_COALESCER_BUFFER = 256;
+
+class QuoteRingWrongCapacity:  public std::exception
+{public: const char * what() const throw();};
+
+class QuoteCoalescerUnknownHandle:  public std::exception
+{public: const char * what() const throw();};
+
+class QuoteCoalescerHandleOutsideBook:  public std::exception
+{public: const char * what() const throw();};
+
+struct QuoteRecord
+{
+    RegistryHandle handle;
+    double bid;
+    double ask;
+    Timestamp exchange_timestamp;
+};
+
+class SPSCQuoteRing
+{
+    public:
+        SPSCQuoteRing(const std::size_t capacity);
+        ~SPSCQuoteRing(){};
+        bool push(const QuoteRecord& record);
+        bool pop(QuoteRecord& record);
+        std::size_t pop(QuoteRecord* records, const std::size_t n);
+        std::size_t capacity() const;
+        std::size_t size() const;
+    private:
+        std::vector<QuoteRecord> slots_;
+        const std::size_t mask_;
+        alignas(QUOTE_RING_CACHE_LINE) std::atomic<std::size_t> tail_;
+        std::size_t cached_head_;
+        alignas(QUOTE_RING_CACHE_LINE) std::atomic<std::size_t> head_;
+        std::size_t cached_tail_;
+};
+
+class MPSCQuoteRing
+{
+    public:
+        MPSCQuoteRing(const std::size_t capacity);
+        ~MPSCQuoteRing(){};
+        bool push(const QuoteRecord& record);
+        bool pop(QuoteRecord& record);
+        std::size_t pop(QuoteRecord* records, const std::size_t n);
+        std::size_t capacity() const;
+    private:
+        struct Slot
+        {
+            std::atomic<std::size_t> sequence;
+            QuoteRecord record;
+        };
+        std::unique_ptr<Slot[]> slots_;
+        const std::size_t mask_;
+        alignas(QUOTE_RING_CACHE_LINE) std::atomic<std::size_t> tail_;
+        alignas(QUOTE_RING_CACHE_LINE) std::size_t head_;
+};
+
+class QuoteCoalescer
+{
+    public:
+        QuoteCoalescer(const std::size_t n_instruments);
+        ~QuoteCoalescer(){};
+        void add(const QuoteRecord& record);
+        std::size_t drain(SPSCQuoteRing& ring);
+        std::size_t drain(MPSCQuoteRing& ring);
+        std::size_t flush(QuoteBook& book);
+        const std::vector<RegistryHandle>& get_pending() const;
+        const QuoteRecord& get_latest(const RegistryHandle handle) const;
+        std::size_t get_number_received() const;
+        std::size_t get_number_coalesced() const;
+        std::size_t get_number_stale() const;
+    private:
+        std::vector<QuoteRecord> latest_;
+        std::vector<unsigned char> pending_flags_;
+        std::vector<RegistryHandle> pending_;
+        std::vector<QuoteRecord> buffer_;
+        std::vector<std::size_t> indices_;
+        std::vector<double> bids_;
+        std::vector<double> asks_;
+        std::vector<Timestamp> timestamps_;
+        std::size_t n_received_;
+        std::size_t n_coalesced_;
+        std::size_t n_stale_;
+};
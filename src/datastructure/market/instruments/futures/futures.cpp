@@ -5,6 +5,19 @@
  * @brief Contains the implementation of Future and StructuredFuture classes.
  */
 
+/**
+ * @class PerpetualFutureExpiryError
+ * @brief Exception class for the expiry of a perpetual future, which has none.
+ */
+
+/**
+ * @brief Returns the error message for the expiry of a perpetual future.
+ * @return A C-string containing the error message.
+ */
+const char * PerpetualFutureExpiryError::what() const throw(){
+    return "A perpetual future has no expiry date.";
+};
+
 /**
  * @class Future
  * @brief Represents a financial future contract with an expiry date.
@@ -15,7 +28,7 @@
  * @param id The instrument's id. 
  */
 Future::Future(const std::string id): 
-    Instrument(id), is_perpetual_(true), expiry_ptr(nullptr), day_count_(DayCountConvention::ACT360){};
+    Instrument(id, INSTRUMENT_FUTURE), is_perpetual_(true), expiry_ptr(nullptr), day_count_(DayCountConvention::ACT360){};
 
 /**
  * @brief Constructs a Future object with the given expiry date (as a term future).
@@ -29,7 +42,7 @@ Future::Future(
     const std::string id,
     const std::shared_ptr<DateTime> expiry, 
     const DayCountConvention day_count): 
-    Instrument(id), is_perpetual_(false), expiry_ptr(expiry), day_count_(day_count){};
+    Instrument(id, INSTRUMENT_FUTURE), is_perpetual_(false), expiry_ptr(expiry), day_count_(day_count){};
 
 /**
  * @brief Retrieves the expiry date pointer for the future.
@@ -40,6 +53,43 @@ std::shared_ptr<DateTime> Future::get_expiry()
     return expiry_ptr;
 };
 
+/**
+ * @brief Retrieves the expiry date of the future by value, without any heap traffic.
+ * @return The expiry timestamp.
+ * @throws PerpetualFutureExpiryError if the future is perpetual.
+ */
+Timestamp Future::get_expiry_timestamp()
+{
+    if (is_perpetual_){throw PerpetualFutureExpiryError();}
+    return expiry_ptr->to_timestamp();
+};
+
+/**
+ * @brief Calculates the year fraction between a reference date and the future's expiry date.
+ * @param reference_timestamp The reference timestamp.
+ * @return The year fraction with the future's day count convention.
+ * @throws PerpetualFutureExpiryError if the future is perpetual.
+ * @throws NonPositiveYearFractionError if the reference timestamp is after the expiry date. 
+ */
+double Future::get_year_fraction(const Timestamp reference_timestamp)
+{
+    return get_year_fraction_from_datetimes(reference_timestamp, get_expiry_timestamp(), day_count_);
+};
+
+/**
+ * @brief Registers the expiry of the future in the year fraction table of a snapshot, the
+ * futures sharing an expiry and a day count convention share an entry.
+ * @param table The year fraction table.
+ * @return The index of the expiry in the table, kept by the caller: an instrument shared by
+ * several snapshots has an index in each of their tables.
+ * @throws PerpetualFutureExpiryError if the future is perpetual.
+ * @throws UndefinedDayCountConventionError if the day count convention is invalid.
+ */
+std::size_t Future::register_year_fraction(YearFractionTable& table)
+{
+    return table.register_expiry(get_expiry_timestamp(), day_count_);
+};
+
 /**
  * @brief Retrieves the expiry date pointer for the future.
  * @return A shared pointer to the DateTime object representing the expiry date.
@@ -91,7 +141,7 @@ StructuredFuture::StructuredFuture(
     const std::string id,
     const std::vector<std::shared_ptr<Future>> futures, 
     const std::vector<double> weights): 
-    Instrument(id), weights_(weights), futures_(futures)
+    Instrument(id, INSTRUMENT_STRUCTURED_FUTURE), weights_(weights), futures_(futures)
 {
     check();
 }
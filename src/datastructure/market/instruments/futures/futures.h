@@ -2,14 +2,22 @@
 #include <iostream>
 #include <vector>
 #include "../../../../../src/datastructure/datetime/datetime.h"
+#include "../../../../../src/datastructure/datetime/yearfraction/yearfraction.h"
 #include "../../../../../src/datastructure/market/instruments/interface.h"
 
+class PerpetualFutureExpiryError: public std::exception 
+{public: const char * what() const throw();};
+
 class Future : public Instrument
 {
     public:
         bool is_perpetual();
         std::shared_ptr<DateTime> get_expiry();
+        Timestamp get_expiry_timestamp();
+        double get_year_fraction(const Timestamp reference_timestamp);
+        std::size_t register_year_fraction(YearFractionTable& table);
         DayCountConvention get_day_count();
+        static constexpr InstrumentTag TAG = INSTRUMENT_FUTURE;
         Future(const std::string id);
         Future(
             const std::string id,
@@ -30,6 +38,7 @@ class StructuredFuture : public Instrument
     public:
         std::vector<std::shared_ptr<Future>> get_futures();
         std::vector<double> get_weights();
+        static constexpr InstrumentTag TAG = INSTRUMENT_STRUCTURED_FUTURE;
         StructuredFuture(
             const std::string id,
             const std::vector<std::shared_ptr<Future>> futures, 
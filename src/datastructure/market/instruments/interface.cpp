@@ -14,7 +14,14 @@
  * @brief Constructor for the Instrument class.
  * @param id The instrument ID.
  */
-Instrument::Instrument(const std::string id):id_(id){}; 
+Instrument::Instrument(const std::string id):id_(id), tag_(INSTRUMENT_BASE){}; 
+
+/**
+ * @brief Constructor for the derived classes, which give their tag.
+ * @param id The instrument ID.
+ * @param tag The tag of the concrete class.
+ */
+Instrument::Instrument(const std::string id, const InstrumentTag tag):id_(id), tag_(tag){}; 
 
 /**
  * @brief Gets the instrument's id.
@@ -26,7 +33,18 @@ std::string Instrument::get_id()
 };
 
 /**
- * @brief Gets the instrument's type. It also handles possible mangled names. 
+ * @brief Gets the instrument's tag, the concrete class of the instrument without RTTI (see 
+ * visit_instrument). Each class has its tag as the compile-time constant TAG.
+ * @return The instrument's tag.
+ */
+InstrumentTag Instrument::get_instrument_tag() const
+{
+    return tag_;
+};
+
+/**
+ * @brief Gets the instrument's type. It also handles possible mangled names. It allocates a 
+ * new string: use get_instrument_tag to dispatch.
  * @return The instrument's type.
  */
 std::string Instrument::get_instrument_type() const
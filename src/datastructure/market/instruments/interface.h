@@ -2,14 +2,30 @@
 #include <iostream>
 #include <typeinfo>
 
+enum InstrumentTag
+{
+    INSTRUMENT_BASE = 0,
+    INSTRUMENT_OPTION = 1,
+    INSTRUMENT_EUROPEAN_VANILLA_OPTION = 2,
+    INSTRUMENT_AMERICAN_VANILLA_OPTION = 3,
+    INSTRUMENT_STRUCTURED_OPTION = 4,
+    INSTRUMENT_FUTURE = 5,
+    INSTRUMENT_STRUCTURED_FUTURE = 6
+};
+
 class Instrument
 {
     public: 
         std::string get_id();
         std::string get_instrument_type() const;
+        InstrumentTag get_instrument_tag() const;
+        static constexpr InstrumentTag TAG = INSTRUMENT_BASE;
         Instrument(const std::string id);
         virtual ~Instrument(){};
+    protected:
+        Instrument(const std::string id, const InstrumentTag tag);
     private: 
         const std::string id_;
+        const InstrumentTag tag_;
 };
 
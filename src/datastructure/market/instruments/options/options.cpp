@@ -39,7 +39,26 @@ Option::Option(
     const double strike, 
     const DayCountConvention day_count, 
     const std::shared_ptr<Currency> strike_currency): 
-    Instrument(id), K(strike), strike_ccy_ptr(strike_currency), type_(type), 
+    Option(id, expiry, type, strike, day_count, strike_currency, INSTRUMENT_OPTION){};
+
+/**
+ * @brief Constructor for the derived classes, which give their tag.
+ * @param expiry Pointer to the expiry date of the option.
+ * @param type Type of the option (call or put).
+ * @param strike Strike price of the option.
+ * @param daycount The day count onvention to be used. 
+ * @param strike_currency The strike price's currency. 
+ * @param tag The tag of the concrete class.
+ */
+Option::Option(
+    const std::string id,
+    const std::shared_ptr<DateTime> expiry, 
+    const OptionType type, 
+    const double strike, 
+    const DayCountConvention day_count, 
+    const std::shared_ptr<Currency> strike_currency, 
+    const InstrumentTag tag): 
+    Instrument(id, tag), K(strike), strike_ccy_ptr(strike_currency), type_(type), 
     expiry_ptr(expiry), day_count_(day_count){};
 
 /**
@@ -91,6 +110,39 @@ std::shared_ptr<DateTime> Option::get_expiry()
     return expiry_ptr;
 };
 
+/**
+ * @brief Gets the expiry date of the option by value, without any heap traffic.
+ * @return The expiry timestamp.
+ */
+Timestamp Option::get_expiry_timestamp()
+{
+    return expiry_ptr->to_timestamp();
+};
+
+/**
+ * @brief Calculates the year fraction between a reference date and the option's expiry date.
+ * @param reference_timestamp The reference timestamp.
+ * @return The year fraction with the option's day count convention.
+ * @throws NonPositiveYearFractionError if the reference timestamp is after the expiry date. 
+ */
+double Option::get_year_fraction(const Timestamp reference_timestamp)
+{
+    return get_year_fraction_from_datetimes(reference_timestamp, get_expiry_timestamp(), day_count_);
+};
+
+/**
+ * @brief Registers the expiry of the option in the year fraction table of a snapshot, the
+ * options sharing an expiry and a day count convention share an entry.
+ * @param table The year fraction table.
+ * @return The index of the expiry in the table, kept by the caller: an instrument shared by
+ * several snapshots has an index in each of their tables.
+ * @throws UndefinedDayCountConventionError if the day count convention is invalid.
+ */
+std::size_t Option::register_year_fraction(YearFractionTable& table)
+{
+    return table.register_expiry(get_expiry_timestamp(), day_count_);
+};
+
 /**
  * @class EuropeanVanillaOption
  * @brief Class representing a European vanilla option.
@@ -115,7 +167,7 @@ EuropeanVanillaOption::EuropeanVanillaOption(
     const double strike, 
     const DayCountConvention day_count, 
     const std::shared_ptr<Currency> strike_currency): 
-    Option(id, expiry, type, strike, day_count, strike_currency)
+    Option(id, expiry, type, strike, day_count, strike_currency, INSTRUMENT_EUROPEAN_VANILLA_OPTION)
     {};
 
 /**
@@ -142,7 +194,7 @@ AmericanVanillaOption::AmericanVanillaOption(
     const double strike, 
     const DayCountConvention day_count, 
     const std::shared_ptr<Currency> strike_currency): 
-    Option(id, expiry, type, strike, day_count, strike_currency)
+    Option(id, expiry, type, strike, day_count, strike_currency, INSTRUMENT_AMERICAN_VANILLA_OPTION)
     {};
 
 /**
@@ -178,7 +230,7 @@ StructuredOption::StructuredOption(
     const std::string id,
     const std::vector<std::shared_ptr<Option>> options, 
     const std::vector<double> weights): 
-    Instrument(id), weights_(weights), options_(options)
+    Instrument(id, INSTRUMENT_STRUCTURED_OPTION), weights_(weights), options_(options)
 {
     check();
 }
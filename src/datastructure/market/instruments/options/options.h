@@ -2,6 +2,7 @@
 #include <iostream>
 #include <vector>
 #include "../../../../../src/datastructure/datetime/datetime.h"
+#include "../../../../../src/datastructure/datetime/yearfraction/yearfraction.h"
 #include "../../../../../src/datastructure/market/riskfactors/riskfactors.h"
 #include "../../../../../src/datastructure/market/instruments/interface.h"
 
@@ -25,8 +26,12 @@ class Option : public Instrument
         double get_strike();
         OptionType get_option_type();
         std::shared_ptr<DateTime> get_expiry();
+        Timestamp get_expiry_timestamp();
+        double get_year_fraction(const Timestamp reference_timestamp);
+        std::size_t register_year_fraction(YearFractionTable& table);
         DayCountConvention get_day_count();
         std::shared_ptr<Currency> get_strike_currency();
+        static constexpr InstrumentTag TAG = INSTRUMENT_OPTION;
         Option(
             const std::string id,
             const std::shared_ptr<DateTime> expiry, 
@@ -35,6 +40,15 @@ class Option : public Instrument
             const DayCountConvention day_count, 
             const std::shared_ptr<Currency> strike_currency);
         virtual ~Option() = default;
+    protected:
+        Option(
+            const std::string id,
+            const std::shared_ptr<DateTime> expiry, 
+            const OptionType type, 
+            const double strike, 
+            const DayCountConvention day_count, 
+            const std::shared_ptr<Currency> strike_currency, 
+            const InstrumentTag tag);
     private: 
         const double K; 
         const std::shared_ptr<Currency> strike_ccy_ptr;
@@ -51,6 +65,7 @@ class StructuredOption : public Instrument
     public:
         std::vector<std::shared_ptr<Option>> get_options();
         std::vector<double> get_weights();
+        static constexpr InstrumentTag TAG = INSTRUMENT_STRUCTURED_OPTION;
         StructuredOption(
             const std::string id,
             const std::vector<std::shared_ptr<Option>> options, 
@@ -65,6 +80,7 @@ class StructuredOption : public Instrument
 class EuropeanVanillaOption : public Option
 {
     public: 
+        static constexpr InstrumentTag TAG = INSTRUMENT_EUROPEAN_VANILLA_OPTION;
         EuropeanVanillaOption(
             const std::string id,
             const std::shared_ptr<DateTime> expiry, 
@@ -78,6 +94,7 @@ class EuropeanVanillaOption : public Option
 class AmericanVanillaOption : public Option
 {
     public:
+        static constexpr InstrumentTag TAG = INSTRUMENT_AMERICAN_VANILLA_OPTION;
         AmericanVanillaOption(
             const std::string id,
             const std::shared_ptr<DateTime> expiry, 
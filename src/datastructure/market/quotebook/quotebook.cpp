@@ -0,0 +1,347 @@
+#include "quotebook.h"
+
+/**
+* @file quotebook.h
+* @brief This file defines the columnar quote book of a venue.
+*/
+
+/**
+ * @class QuoteBookUnknownAsset
+ * @brief Definition of the error when an asset id is not in the quote book.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * QuoteBookUnknownAsset::what() const throw(){
+    return "The asset is not in the quote book.";
+};
+
+/**
+ * @class QuoteBookDuplicatedAsset
+ * @brief Definition of the error when an asset id is added twice to the quote book.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * QuoteBookDuplicatedAsset::what() const throw(){
+    return "The asset is already in the quote book.";
+};
+
+/**
+ * @class QuoteBook
+ * @brief The last quotes of a set of assets, stored by column.
+ *
+ * Each asset gets a stable index when it is added, its bid, ask, sizes and timestamp are 
+ * stored in parallel arrays at that index and a tick overwrites them in place, so that no 
+ * object is allocated per quote. The spreads, mids and microprices of the whole book are 
+ * computed SIMD_WIDTH quotes at a time from the columns. The quotes which have not been 
+ * updated yet are NaN.
+ */
+
+/**
+ * @brief Constructs an empty quote book.
+ */
+QuoteBook::QuoteBook(){};
+
+/**
+ * @brief Constructs a quote book of assets, the index of an asset is its position in the vector.
+ * @param assets The assets.
+ * @throws QuoteBookDuplicatedAsset If two assets have the same id.
+ */
+QuoteBook::QuoteBook(const std::vector<std::shared_ptr<Asset>>& assets)
+{
+    assets_.reserve(assets.size());
+    bids_.reserve(assets.size());
+    asks_.reserve(assets.size());
+    bid_sizes_.reserve(assets.size());
+    ask_sizes_.reserve(assets.size());
+    timestamps_.reserve(assets.size());
+    for (const auto& asset: assets){add_asset(asset);}
+};
+
+/**
+ * @brief Adds an asset to the quote book, with NaN quotes.
+ * @param asset The asset.
+ * @return The index of the asset.
+ * @throws QuoteBookDuplicatedAsset If an asset with the same id is already in the quote book.
+ */
+std::size_t QuoteBook::add_asset(const std::shared_ptr<Asset> asset)
+{
+    if (!indices_.emplace(asset->get_id(), assets_.size()).second){throw QuoteBookDuplicatedAsset();}
+    assets_.push_back(asset);
+    bids_.push_back(NAN);
+    asks_.push_back(NAN);
+    bid_sizes_.push_back(NAN);
+    ask_sizes_.push_back(NAN);
+    timestamps_.push_back(Timestamp{0});
+    return assets_.size()-1;
+};
+
+/**
+ * @param id The id of an asset.
+ * @return The index of the asset.
+ * @throws QuoteBookUnknownAsset If the asset is not in the quote book.
+ */
+std::size_t QuoteBook::find_asset(const std::string& id) const
+{
+    const auto it = indices_.find(id);
+    if (it==indices_.end()){throw QuoteBookUnknownAsset();}
+    return it->second;
+};
+
+/**
+ * @return The number of assets.
+ */
+std::size_t QuoteBook::size() const
+{
+    return assets_.size();
+};
+
+/**
+ * @brief Overwrites the quote of an asset, its sizes are kept.
+ * @param i The index of the asset.
+ * @param bid The bid price.
+ * @param ask The ask price.
+ * @param timestamp The time of the quote.
+ */
+void QuoteBook::update(const std::size_t i, const double bid, const double ask, const Timestamp timestamp)
+{
+    bids_[i] = bid;
+    asks_[i] = ask;
+    timestamps_[i] = timestamp;
+};
+
+/**
+ * @brief Overwrites the quote of an asset.
+ * @param i The index of the asset.
+ * @param bid The bid price.
+ * @param ask The ask price.
+ * @param bid_size The size at the bid.
+ * @param ask_size The size at the ask.
+ * @param timestamp The time of the quote.
+ */
+void QuoteBook::update(
+    const std::size_t i, 
+    const double bid, 
+    const double ask, 
+    const double bid_size, 
+    const double ask_size, 
+    const Timestamp timestamp)
+{
+    bids_[i] = bid;
+    asks_[i] = ask;
+    bid_sizes_[i] = bid_size;
+    ask_sizes_[i] = ask_size;
+    timestamps_[i] = timestamp;
+};
+
+/**
+ * @brief Overwrites the quotes of a batch of assets, their sizes are kept.
+ * @param indices The indices of the assets.
+ * @param bids The bid prices.
+ * @param asks The ask prices.
+ * @param timestamps The times of the quotes.
+ * @param n The size of the batch.
+ */
+void QuoteBook::update(
+    const std::size_t* indices, 
+    const double* bids, 
+    const double* asks, 
+    const Timestamp* timestamps, 
+    const std::size_t n)
+{
+    for (std::size_t j = 0; j < n; ++j){update(indices[j], bids[j], asks[j], timestamps[j]);}
+};
+
+/**
+ * @param i The index of the asset.
+ * @return The asset.
+ */
+std::shared_ptr<Asset> QuoteBook::get_asset(const std::size_t i) const
+{
+    return assets_[i];
+};
+
+/**
+ * @param i The index of the asset.
+ * @return The bid price.
+ */
+double QuoteBook::get_bid(const std::size_t i) const
+{
+    return bids_[i];
+};
+
+/**
+ * @param i The index of the asset.
+ * @return The ask price.
+ */
+double QuoteBook::get_ask(const std::size_t i) const
+{
+    return asks_[i];
+};
+
+/**
+ * @param i The index of the asset.
+ * @return The size at the bid.
+ */
+double QuoteBook::get_bid_size(const std::size_t i) const
+{
+    return bid_sizes_[i];
+};
+
+/**
+ * @param i The index of the asset.
+ * @return The size at the ask.
+ */
+double QuoteBook::get_ask_size(const std::size_t i) const
+{
+    return ask_sizes_[i];
+};
+
+/**
+ * @param i The index of the asset.
+ * @return The time of the last quote.
+ */
+Timestamp QuoteBook::get_timestamp(const std::size_t i) const
+{
+    return timestamps_[i];
+};
+
+/**
+ * @param i The index of the asset.
+ * @return The last quote of the asset as an AssetQuote.
+ */
+AssetQuote QuoteBook::get_quote(const std::size_t i) const
+{
+    return AssetQuote(assets_[i], bids_[i], asks_[i]);
+};
+
+/**
+ * @return The bid prices, by index.
+ */
+const double* QuoteBook::get_bids() const
+{
+    return bids_.data();
+};
+
+/**
+ * @return The ask prices, by index.
+ */
+const double* QuoteBook::get_asks() const
+{
+    return asks_.data();
+};
+
+/**
+ * @return The sizes at the bid, by index.
+ */
+const double* QuoteBook::get_bid_sizes() const
+{
+    return bid_sizes_.data();
+};
+
+/**
+ * @return The sizes at the ask, by index.
+ */
+const double* QuoteBook::get_ask_sizes() const
+{
+    return ask_sizes_.data();
+};
+
+/**
+ * @return The times of the last quotes, by index.
+ */
+const Timestamp* QuoteBook::get_timestamps() const
+{
+    return timestamps_.data();
+};
+
+/**
+ * @brief Computes the absolute spreads of the book, as AssetQuote::get_absolute_spread.
+ * @param out The spreads, by index (size() values).
+ */
+void QuoteBook::get_absolute_spreads(double* out) const
+{
+    const std::size_t n = size();
+    const double* bid = bids_.data();
+    const double* ask = asks_.data();
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_store(out + i, simd_sub(simd_load(ask + i), simd_load(bid + i)));
+    }
+    for (; i < n; ++i){out[i] = ask[i] - bid[i];}
+};
+
+/**
+ * @brief Computes the relative spreads of the book, as AssetQuote::get_relative_spread.
+ * @param out The spreads, by index (size() values), NaN where the bid price is zero.
+ */
+void QuoteBook::get_relative_spreads(double* out) const
+{
+    const std::size_t n = size();
+    const double* bid = bids_.data();
+    const double* ask = asks_.data();
+    const simd_double zero = simd_set1(0.0);
+    const simd_double nan = simd_set1(NAN);
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        const simd_double b = simd_load(bid + i);
+        const simd_double s = simd_div(simd_sub(simd_load(ask + i), b), b);
+        simd_store(out + i, simd_select(simd_le(simd_abs(b), zero), nan, s));
+    }
+    for (; i < n; ++i){out[i] = bid[i]==0.0 ? NAN : (ask[i] - bid[i])/bid[i];}
+};
+
+/**
+ * @brief Computes the mid prices of the book.
+ * @param out The mid prices, by index (size() values).
+ */
+void QuoteBook::get_mids(double* out) const
+{
+    const std::size_t n = size();
+    const double* bid = bids_.data();
+    const double* ask = asks_.data();
+    const simd_double half = simd_set1(0.5);
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_store(out + i, simd_mul(half, simd_add(simd_load(bid + i), simd_load(ask + i))));
+    }
+    for (; i < n; ++i){out[i] = .5*(bid[i] + ask[i]);}
+};
+
+/**
+ * @brief Computes the microprices of the book, the mid weighted by the opposite sizes 
+ * (bid*ask_size + ask*bid_size)/(bid_size + ask_size). It is the mid where both sizes are zero.
+ * @param out The microprices, by index (size() values), NaN where the sizes are not quoted.
+ */
+void QuoteBook::get_microprices(double* out) const
+{
+    const std::size_t n = size();
+    const double* bid = bids_.data();
+    const double* ask = asks_.data();
+    const double* bid_size = bid_sizes_.data();
+    const double* ask_size = ask_sizes_.data();
+    const simd_double zero = simd_set1(0.0);
+    const simd_double half = simd_set1(0.5);
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        const simd_double b = simd_load(bid + i);
+        const simd_double a = simd_load(ask + i);
+        const simd_double qb = simd_load(bid_size + i);
+        const simd_double qa = simd_load(ask_size + i);
+        const simd_double total = simd_add(qb, qa);
+        const simd_double micro = simd_div(simd_add(simd_mul(b, qa), simd_mul(a, qb)), total);
+        simd_store(out + i, simd_select(simd_le(total, zero), simd_mul(half, simd_add(b, a)), micro));
+    }
+    for (; i < n; ++i)
+    {
+        const double total = bid_size[i] + ask_size[i];
+        out[i] = total <= 0.0 ? .5*(bid[i] + ask[i]) : (bid[i]*ask_size[i] + ask[i]*bid_size[i])/total;
+    }
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "../../../../src/datastructure/datetime/datetime.h"
+#include "../../../../src/datastructure/market/assets/interface.h"
+#include "../../../../src/math/simd/simd.h"
+
+class QuoteBookUnknownAsset:  public std::exception
+{public: const char * what() const throw();};
+
+class QuoteBookDuplicatedAsset:  public std::exception
+{public: const char * what() const throw();};
+
+class QuoteBook
+{
+    public:
+        QuoteBook();
+        QuoteBook(const std::vector<std::shared_ptr<Asset>>& assets);
+        ~QuoteBook(){};
+        std::size_t add_asset(const std::shared_ptr<Asset> asset);
+        std::size_t find_asset(const std::string& id) const;
+        std::size_t size() const;
+        void update(const std::size_t i, const double bid, const double ask, const Timestamp timestamp);
+        void update(
+            const std::size_t i, 
+            const double bid, 
+            const double ask, 
+            const double bid_size, 
+            const double ask_size, 
+            const Timestamp timestamp);
+        void update(
+            const std::size_t* indices, 
+            const double* bids, 
+            const double* asks, 
+            const Timestamp* timestamps, 
+            const std::size_t n);
+        std::shared_ptr<Asset> get_asset(const std::size_t i) const;
+        double get_bid(const std::size_t i) const;
+        double get_ask(const std::size_t i) const;
+        double get_bid_size(const std::size_t i) const;
+        double get_ask_size(const std::size_t i) const;
+        Timestamp get_timestamp(const std::size_t i) const;
+        AssetQuote get_quote(const std::size_t i) const;
+        const double* get_bids() const;
+        const double* get_asks() const;
+        const double* get_bid_sizes() const;
+        const double* get_ask_sizes() const;
+        const Timestamp* get_timestamps() const;
+        void get_absolute_spreads(double* out) const;
+        void get_relative_spreads(double* out) const;
+        void get_mids(double* out) const;
+        void get_microprices(double* out) const;
+    private:
+        std::vector<std::shared_ptr<Asset>> assets_;
+        std::unordered_map<std::string, std::size_t> indices_;
+        std::vector<double> bids_;
+        std::vector<double> asks_;
+        std::vector<double> bid_sizes_;
+        std::vector<double> ask_sizes_;
+        std::vector<Timestamp> timestamps_;
+};
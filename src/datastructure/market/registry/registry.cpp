@@ -0,0 +1,480 @@
+#include "registry.h"
+
+/**
+* @file registry.h
+* @brief This file defines the registry of the market objects, addressed by dense 32-bit handles.
+*/
+
+/**
+ * @var RegistryHandle NULL_HANDLE
+ * @brief The handle of an object which is not set (a null shared pointer).
+ */
+
+/**
+ * @class RegistryUnknownId
+ * @brief Definition of the error when an id is not in the registry.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * RegistryUnknownId::what() const throw(){
+    return "The id is not in the registry.";
+};
+
+/**
+ * @class RegistryUnknownHandle
+ * @brief Definition of the error when a handle has not been returned by the registry.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * RegistryUnknownHandle::what() const throw(){
+    return "The handle is not in the registry.";
+};
+
+/**
+ * @class RegistryDuplicatedId
+ * @brief Definition of the error when two different objects are registered with the same id.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * RegistryDuplicatedId::what() const throw(){
+    return "Another object is already registered with this id.";
+};
+
+/**
+ * @class RegistryFull
+ * @brief Definition of the error when a table of the registry has no handle left.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * RegistryFull::what() const throw(){
+    return "The registry cannot hold more than 2^32-1 objects of a kind.";
+};
+
+/**
+ * @class InternTable
+ * @brief The interned ids of one kind of object: each distinct id gets the next handle, 
+ * starting at 0.
+ */
+
+/**
+ * @brief Interns an id.
+ * @param id The id.
+ * @return The handle of the id, the existing one if it was already interned.
+ * @throws RegistryFull If 2^32-1 ids are already interned.
+ */
+RegistryHandle InternTable::intern(const std::string& id)
+{
+    const auto it = handles_.find(id);
+    if (it!=handles_.end()){return it->second;}
+    if (ids_.size() >= NULL_HANDLE){throw RegistryFull();}
+    const RegistryHandle handle = static_cast<RegistryHandle>(ids_.size());
+    ids_.push_back(id);
+    handles_.emplace(id, handle);
+    return handle;
+};
+
+/**
+ * @param id The id.
+ * @return The handle of the id, NULL_HANDLE if it is not interned.
+ */
+RegistryHandle InternTable::find(const std::string& id) const
+{
+    const auto it = handles_.find(id);
+    if (it==handles_.end()){return NULL_HANDLE;}
+    return it->second;
+};
+
+/**
+ * @param handle A handle returned by intern.
+ * @return The id, by reference.
+ * @throws RegistryUnknownHandle If the handle is not in the table.
+ */
+const std::string& InternTable::get_id(const RegistryHandle handle) const
+{
+    if (handle >= ids_.size()){throw RegistryUnknownHandle();}
+    return ids_[handle];
+};
+
+/**
+ * @return The number of interned ids.
+ */
+std::size_t InternTable::size() const
+{
+    return ids_.size();
+};
+
+/**
+ * @brief Removes every id, the next interned id gets the handle 0.
+ */
+void InternTable::clear()
+{
+    ids_.clear();
+    handles_.clear();
+};
+
+/**
+ * @class MarketRegistry
+ * @brief The currencies, risk factors, assets and instruments of a market, in one contiguous 
+ * table per kind.
+ *
+ * The ids are interned once, when an object is added, and the object is then addressed by its
+ * handle: the handle is its position in the table, so that a lookup is an index and two objects
+ * are compared by comparing two integers. The links between objects (the quote currency and the 
+ * risk factor of an asset, the base currency of a risk factor) are stored as handles too, next to
+ * the tables, to walk the graph without touching the shared pointers. The ids are resolved 
+ * (find_*) only at the edges, when data comes in or goes out. Adding an object is not thread 
+ * safe; once the registry is built it is read only and can be shared between threads.
+ *
+ * The registry owns a monotonic arena (see arena.h): the objects made by make (and the 
+ * underlying assets built from get_arena) are bump allocated next to each other and their 
+ * deallocation is free. Each of them holds a reference to the arena, so that it stays valid 
+ * wherever it is copied to; the whole universe is given back to the heap at once when the 
+ * registry is cleared or destroyed and no copy of its objects is left.
+ */
+
+/**
+ * @brief The constructor, the arena starts with the default block size of the monotonic 
+ * resource.
+ */
+MarketRegistry::MarketRegistry(): arena_bytes_(0), arena_(make_market_arena()){};
+
+/**
+ * @brief The constructor for a universe of known size.
+ * @param arena_bytes The size of the first block of the arena, a universe fitting in it is
+ * built with a single allocation from the heap.
+ */
+MarketRegistry::MarketRegistry(const std::size_t arena_bytes): 
+    arena_bytes_(arena_bytes), arena_(make_market_arena(arena_bytes)){};
+
+/**
+ * @return The arena of the registry, for the objects built outside make, such as the 
+ * underlying asset of a CryptoOption.
+ */
+const MarketArena& MarketRegistry::get_arena() const
+{
+    return arena_;
+};
+
+/**
+ * @fn template <typename T, typename... Args> std::shared_ptr<T> MarketRegistry::make(Args&&... args)
+ * @brief Builds an object and its control block in the arena of the registry, with a single 
+ * bump of the arena instead of a heap allocation.
+ * @param args The arguments of the constructor of T.
+ * @return The object, which keeps the arena alive.
+ */
+
+/**
+ * @brief Removes every object, the next objects are made in a new arena. The memory of the
+ * previous arena is given back to the heap at once, when the last copy of its objects held 
+ * outside the registry is dropped. The handles must no longer be used after the call.
+ */
+void MarketRegistry::clear()
+{
+    currency_codes_.clear();
+    risk_factor_ids_.clear();
+    asset_ids_.clear();
+    instrument_ids_.clear();
+    currencies_.clear();
+    risk_factors_.clear();
+    risk_factor_base_currencies_.clear();
+    assets_.clear();
+    asset_quote_currencies_.clear();
+    asset_risk_factors_.clear();
+    instruments_.clear();
+    arena_ = arena_bytes_ > 0 ? make_market_arena(arena_bytes_) : make_market_arena();
+};
+
+/**
+ * @brief Adds a currency, keyed by its code.
+ * @param currency The currency, null gives NULL_HANDLE.
+ * @return The handle of the currency, the existing one if it is already registered.
+ * @throws RegistryDuplicatedId If another currency is registered with the same code.
+ */
+RegistryHandle MarketRegistry::add_currency(const std::shared_ptr<Currency> currency)
+{
+    if (!currency){return NULL_HANDLE;}
+    const std::string id = currency->get_code();
+    const RegistryHandle existing = currency_codes_.find(id);
+    if (existing!=NULL_HANDLE)
+    {
+        if (currencies_[existing]!=currency){throw RegistryDuplicatedId();}
+        return existing;
+    }
+    const RegistryHandle handle = currency_codes_.intern(id);
+    currencies_.push_back(currency);
+    return handle;
+};
+
+/**
+ * @brief Adds a risk factor and its base currency.
+ * @param risk_factor The risk factor, null gives NULL_HANDLE.
+ * @return The handle of the risk factor, the existing one if it is already registered.
+ * @throws RegistryDuplicatedId If another object is registered with the same id.
+ */
+RegistryHandle MarketRegistry::add_risk_factor(const std::shared_ptr<RiskFactor> risk_factor)
+{
+    if (!risk_factor){return NULL_HANDLE;}
+    const std::string id = risk_factor->get_id();
+    const RegistryHandle existing = risk_factor_ids_.find(id);
+    if (existing!=NULL_HANDLE)
+    {
+        if (risk_factors_[existing]!=risk_factor){throw RegistryDuplicatedId();}
+        return existing;
+    }
+    const RegistryHandle base_currency = add_currency(risk_factor->get_base_currency());
+    const RegistryHandle handle = risk_factor_ids_.intern(id);
+    risk_factors_.push_back(risk_factor);
+    risk_factor_base_currencies_.push_back(base_currency);
+    return handle;
+};
+
+/**
+ * @brief Adds an asset, its quote currency and its risk factor.
+ * @param asset The asset, null gives NULL_HANDLE.
+ * @return The handle of the asset, the existing one if it is already registered.
+ * @throws RegistryDuplicatedId If another object is registered with the same id.
+ */
+RegistryHandle MarketRegistry::add_asset(const std::shared_ptr<Asset> asset)
+{
+    if (!asset){return NULL_HANDLE;}
+    const std::string id = asset->get_id();
+    const RegistryHandle existing = asset_ids_.find(id);
+    if (existing!=NULL_HANDLE)
+    {
+        if (assets_[existing]!=asset){throw RegistryDuplicatedId();}
+        return existing;
+    }
+    const RegistryHandle quote_currency = add_currency(asset->get_quote_currency());
+    const RegistryHandle risk_factor = add_risk_factor(asset->get_risk_factor());
+    const RegistryHandle handle = asset_ids_.intern(id);
+    assets_.push_back(asset);
+    asset_quote_currencies_.push_back(quote_currency);
+    asset_risk_factors_.push_back(risk_factor);
+    return handle;
+};
+
+/**
+ * @brief Adds an instrument.
+ * @param instrument The instrument, null gives NULL_HANDLE.
+ * @return The handle of the instrument, the existing one if it is already registered.
+ * @throws RegistryDuplicatedId If another instrument is registered with the same id.
+ */
+RegistryHandle MarketRegistry::add_instrument(const std::shared_ptr<Instrument> instrument)
+{
+    if (!instrument){return NULL_HANDLE;}
+    const std::string id = instrument->get_id();
+    const RegistryHandle existing = instrument_ids_.find(id);
+    if (existing!=NULL_HANDLE)
+    {
+        if (instruments_[existing]!=instrument){throw RegistryDuplicatedId();}
+        return existing;
+    }
+    const RegistryHandle handle = instrument_ids_.intern(id);
+    instruments_.push_back(instrument);
+    return handle;
+};
+
+/**
+ * @param code The code of a currency.
+ * @return The handle of the currency.
+ * @throws RegistryUnknownId If the currency is not registered.
+ */
+RegistryHandle MarketRegistry::find_currency(const std::string& code) const
+{
+    const RegistryHandle handle = currency_codes_.find(code);
+    if (handle==NULL_HANDLE){throw RegistryUnknownId();}
+    return handle;
+};
+
+/**
+ * @param id The id of a risk factor.
+ * @return The handle of the risk factor.
+ * @throws RegistryUnknownId If the risk factor is not registered.
+ */
+RegistryHandle MarketRegistry::find_risk_factor(const std::string& id) const
+{
+    const RegistryHandle handle = risk_factor_ids_.find(id);
+    if (handle==NULL_HANDLE){throw RegistryUnknownId();}
+    return handle;
+};
+
+/**
+ * @param id The id of an asset.
+ * @return The handle of the asset.
+ * @throws RegistryUnknownId If the asset is not registered.
+ */
+RegistryHandle MarketRegistry::find_asset(const std::string& id) const
+{
+    const RegistryHandle handle = asset_ids_.find(id);
+    if (handle==NULL_HANDLE){throw RegistryUnknownId();}
+    return handle;
+};
+
+/**
+ * @param id The id of an instrument.
+ * @return The handle of the instrument.
+ * @throws RegistryUnknownId If the instrument is not registered.
+ */
+RegistryHandle MarketRegistry::find_instrument(const std::string& id) const
+{
+    const RegistryHandle handle = instrument_ids_.find(id);
+    if (handle==NULL_HANDLE){throw RegistryUnknownId();}
+    return handle;
+};
+
+/**
+ * @param handle The handle of a currency.
+ * @return The currency, by reference (no reference count update).
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+const std::shared_ptr<Currency>& MarketRegistry::get_currency(const RegistryHandle handle) const
+{
+    if (handle >= currencies_.size()){throw RegistryUnknownHandle();}
+    return currencies_[handle];
+};
+
+/**
+ * @param handle The handle of a risk factor.
+ * @return The risk factor, by reference (no reference count update).
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+const std::shared_ptr<RiskFactor>& MarketRegistry::get_risk_factor(const RegistryHandle handle) const
+{
+    if (handle >= risk_factors_.size()){throw RegistryUnknownHandle();}
+    return risk_factors_[handle];
+};
+
+/**
+ * @param handle The handle of an asset.
+ * @return The asset, by reference (no reference count update).
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+const std::shared_ptr<Asset>& MarketRegistry::get_asset(const RegistryHandle handle) const
+{
+    if (handle >= assets_.size()){throw RegistryUnknownHandle();}
+    return assets_[handle];
+};
+
+/**
+ * @param handle The handle of an instrument.
+ * @return The instrument, by reference (no reference count update).
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+const std::shared_ptr<Instrument>& MarketRegistry::get_instrument(const RegistryHandle handle) const
+{
+    if (handle >= instruments_.size()){throw RegistryUnknownHandle();}
+    return instruments_[handle];
+};
+
+/**
+ * @param handle The handle of a currency.
+ * @return The code of the currency, by reference.
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+const std::string& MarketRegistry::get_currency_code(const RegistryHandle handle) const
+{
+    return currency_codes_.get_id(handle);
+};
+
+/**
+ * @param handle The handle of a risk factor.
+ * @return The id of the risk factor, by reference.
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+const std::string& MarketRegistry::get_risk_factor_id(const RegistryHandle handle) const
+{
+    return risk_factor_ids_.get_id(handle);
+};
+
+/**
+ * @param handle The handle of an asset.
+ * @return The id of the asset, by reference.
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+const std::string& MarketRegistry::get_asset_id(const RegistryHandle handle) const
+{
+    return asset_ids_.get_id(handle);
+};
+
+/**
+ * @param handle The handle of an instrument.
+ * @return The id of the instrument, by reference.
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+const std::string& MarketRegistry::get_instrument_id(const RegistryHandle handle) const
+{
+    return instrument_ids_.get_id(handle);
+};
+
+/**
+ * @param handle The handle of a risk factor.
+ * @return The handle of its base currency, NULL_HANDLE if it has none.
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+RegistryHandle MarketRegistry::get_risk_factor_base_currency(const RegistryHandle handle) const
+{
+    if (handle >= risk_factor_base_currencies_.size()){throw RegistryUnknownHandle();}
+    return risk_factor_base_currencies_[handle];
+};
+
+/**
+ * @param handle The handle of an asset.
+ * @return The handle of its quote currency, NULL_HANDLE if it has none.
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+RegistryHandle MarketRegistry::get_asset_quote_currency(const RegistryHandle handle) const
+{
+    if (handle >= asset_quote_currencies_.size()){throw RegistryUnknownHandle();}
+    return asset_quote_currencies_[handle];
+};
+
+/**
+ * @param handle The handle of an asset.
+ * @return The handle of its risk factor, NULL_HANDLE if it has none.
+ * @throws RegistryUnknownHandle If the handle is not in the registry.
+ */
+RegistryHandle MarketRegistry::get_asset_risk_factor(const RegistryHandle handle) const
+{
+    if (handle >= asset_risk_factors_.size()){throw RegistryUnknownHandle();}
+    return asset_risk_factors_[handle];
+};
+
+/**
+ * @return The number of registered currencies.
+ */
+std::size_t MarketRegistry::get_number_currencies() const
+{
+    return currencies_.size();
+};
+
+/**
+ * @return The number of registered risk factors.
+ */
+std::size_t MarketRegistry::get_number_risk_factors() const
+{
+    return risk_factors_.size();
+};
+
+/**
+ * @return The number of registered assets.
+ */
+std::size_t MarketRegistry::get_number_assets() const
+{
+    return assets_.size();
+};
+
+/**
+ * @return The number of registered instruments.
+ */
+std::size_t MarketRegistry::get_number_instruments() const
+{
+    return instruments_.size();
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <memory>
+#include <utility>
+#include "../../../../src/datastructure/market/riskfactors/riskfactors.h"
+#include "../../../../src/datastructure/market/assets/interface.h"
+#include "../../../../src/datastructure/market/instruments/interface.h"
+#include "../../../../src/datastructure/market/arena/arena.h"
+
+typedef std::uint32_t RegistryHandle;
+
+constexpr RegistryHandle NULL_HANDLE = std::numeric_limits<RegistryHandle>::max();
+
+class RegistryUnknownId:  public std::exception
+{public: const char * what() const throw();};
+
+class RegistryUnknownHandle:  public std::exception
+{public: const char * what() const throw();};
+
+class RegistryDuplicatedId:  public std::exception
+{public: const char * what() const throw();};
+
+class RegistryFull:  public std::exception
+{public: const char * what() const throw();};
+
+class InternTable
+{
+    public:
+        InternTable(){};
+        ~InternTable(){};
+        RegistryHandle intern(const std::string& id);
+        RegistryHandle find(const std::string& id) const;
+        const std::string& get_id(const RegistryHandle handle) const;
+        std::size_t size() const;
+        void clear();
+    private:
+        std::vector<std::string> ids_;
+        std::unordered_map<std::string, RegistryHandle> handles_;
+};
+
+class MarketRegistry
+{
+    public:
+        MarketRegistry();
+        MarketRegistry(const std::size_t arena_bytes);
+        ~MarketRegistry(){};
+        const MarketArena& get_arena() const;
+        template <typename T, typename... Args>
+        std::shared_ptr<T> make(Args&&... args);
+        void clear();
+        RegistryHandle add_currency(const std::shared_ptr<Currency> currency);
+        RegistryHandle add_risk_factor(const std::shared_ptr<RiskFactor> risk_factor);
+        RegistryHandle add_asset(const std::shared_ptr<Asset> asset);
+        RegistryHandle add_instrument(const std::shared_ptr<Instrument> instrument);
+        RegistryHandle find_currency(const std::string& code) const;
+        RegistryHandle find_risk_factor(const std::string& id) const;
+        RegistryHandle find_asset(const std::string& id) const;
+        RegistryHandle find_instrument(const std::string& id) const;
+        const std::shared_ptr<Currency>& get_currency(const RegistryHandle handle) const;
+        const std::shared_ptr<RiskFactor>& get_risk_factor(const RegistryHandle handle) const;
+        const std::shared_ptr<Asset>& get_asset(const RegistryHandle handle) const;
+        const std::shared_ptr<Instrument>& get_instrument(const RegistryHandle handle) const;
+        const std::string& get_currency_code(const RegistryHandle handle) const;
+        const std::string& get_risk_factor_id(const RegistryHandle handle) const;
+        const std::string& get_asset_id(const RegistryHandle handle) const;
+        const std::string& get_instrument_id(const RegistryHandle handle) const;
+        RegistryHandle get_risk_factor_base_currency(const RegistryHandle handle) const;
+        RegistryHandle get_asset_quote_currency(const RegistryHandle handle) const;
+        RegistryHandle get_asset_risk_factor(const RegistryHandle handle) const;
+        std::size_t get_number_currencies() const;
+        std::size_t get_number_risk_factors() const;
+        std::size_t get_number_assets() const;
+        std::size_t get_number_instruments() const;
+    private:
+        std::size_t arena_bytes_;
+        MarketArena arena_;
+        InternTable currency_codes_;
+        InternTable risk_factor_ids_;
+        InternTable asset_ids_;
+        InternTable instrument_ids_;
+        std::vector<std::shared_ptr<Currency>> currencies_;
+        std::vector<std::shared_ptr<RiskFactor>> risk_factors_;
+        std::vector<RegistryHandle> risk_factor_base_currencies_;
+        std::vector<std::shared_ptr<Asset>> assets_;
+        std::vector<RegistryHandle> asset_quote_currencies_;
+        std::vector<RegistryHandle> asset_risk_factors_;
+        std::vector<std::shared_ptr<Instrument>> instruments_;
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<T> MarketRegistry::make(Args&&... args)
+{
+    return make_in_arena<T>(arena_, std::forward<Args>(args)...);
+};
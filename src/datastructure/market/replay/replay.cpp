@@ -0,0 +1,771 @@
+#include "replay.h"
+
+/**
+* @file replay.h
+* @brief This file defines the recorded tick files and their replay through a QuoteBook, in
+* exchange time order and with a memory bounded by one chunk, to backtest on histories which
+* do not fit in memory.
+*
+* A tick file is a header (the ids of the instruments), a sequence of chunks of at most
+* chunk_size ticks sorted by timestamp, an index of the chunks (offsets, time ranges) and a
+* trailer. A chunk is stored by columns: the instrument indices and the timestamp increments as
+* varints, and the bid, ask and sizes as the XOR of their bits with the previous value of the same
+* instrument, which is zero or has few significant bits for quotes moving by a few ticks. The
+* chunks are self contained, so that they can be read in any order, by several readers.
+*
+* References :
+* - "Gorilla: a fast, scalable, in-memory time series database", Pelkonen et al., 2015.
+* - "Decoding billions of integers per second through vectorization", Lemire, Boytsov, 2015.
+*/
+
+/**
+ * @var char TICK_FILE_MAGIC[8]
+ * @brief The first bytes of a tick file, and the last bytes of its trailer.
+ */
+
+/**
+ * @var std::uint32_t TICK_FILE_VERSION
+ * @brief The version of the layout written by TickFileWriter.
+ */
+
+/**
+ * @var std::size_t TICK_FILE_CHUNK
+ * @brief The default number of ticks of a chunk.
+ */
+
+/**
+ * @var std::size_t TICK_N_COLUMNS
+ * @brief The number of columns of a chunk: instrument, timestamp, bid, ask, bid size, ask size.
+ */
+
+/**
+ * @class TickFileIOError
+ * @brief Definition of the error when a tick file can not be written or read.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * TickFileIOError::what() const throw(){
+    return "The tick file can not be written or read.";
+};
+
+/**
+ * @class TickFileWrongFormat
+ * @brief Definition of the error when a file is not a tick file, or is truncated or corrupted.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * TickFileWrongFormat::what() const throw(){
+    return "The file is not a tick file, or it is corrupted.";
+};
+
+/**
+ * @class TickOutOfOrder
+ * @brief Definition of the error when a tick is older than the previous tick of the file.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * TickOutOfOrder::what() const throw(){
+    return "The ticks of a tick file must be appended in timestamp order.";
+};
+
+/**
+ * @class TickUnknownInstrument
+ * @brief Definition of the error when a tick refers to an instrument which is not in the file.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * TickUnknownInstrument::what() const throw(){
+    return "The instrument of the tick is not in the tick file.";
+};
+
+/**
+ * @struct TickChunkEntry
+ * @brief The entry of a chunk in the index: its position in the file, the timestamps of its
+ * first and last ticks (in nanoseconds) and its number of ticks.
+ */
+
+/**
+ * @struct TickFileTrailer
+ * @brief The end of a tick file: the position of the index and its number of chunks.
+ */
+
+/**
+ * @struct TickChunk
+ * @brief The ticks of a chunk, decoded by columns.
+ */
+
+/**
+ * @return The number of ticks.
+ */
+std::size_t TickChunk::size() const
+{
+    return timestamps.size();
+};
+
+/**
+ * @brief Removes the ticks, keeps the capacity of the columns.
+ */
+void TickChunk::clear()
+{
+    instruments.clear();
+    timestamps.clear();
+    bids.clear();
+    asks.clear();
+    bid_sizes.clear();
+    ask_sizes.clear();
+};
+
+/**
+ * @brief Appends an unsigned integer, 7 bits per byte, the high bit set on all bytes but the
+ * last one.
+ * @param out The bytes.
+ * @param value The integer.
+ */
+static void write_varint(std::vector<unsigned char>& out, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+};
+
+/**
+ * @brief Reads an unsigned integer written by write_varint.
+ * @param p The position, moved after the integer.
+ * @param end The end of the bytes.
+ * @return The integer.
+ * @throw TickFileWrongFormat if the integer goes past the end of the bytes.
+ */
+static std::uint64_t read_varint(const unsigned char*& p, const unsigned char* end)
+{
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (p == end){throw TickFileWrongFormat();}
+        const unsigned char byte = *p++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)){return value;}
+    }
+    throw TickFileWrongFormat();
+};
+
+/**
+ * @brief Reads an unsigned integer written by write_varint from a stream.
+ * @param file The stream, moved after the integer.
+ * @return The integer.
+ * @throw TickFileWrongFormat if the integer goes past the end of the stream.
+ */
+static std::uint64_t read_varint(std::ifstream& file)
+{
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        const int byte = file.get();
+        if (byte == std::char_traits<char>::eof()){throw TickFileWrongFormat();}
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)){return value;}
+    }
+    throw TickFileWrongFormat();
+};
+
+/**
+ * @brief Appends a double as the XOR of its bits with the previous value: one byte for an
+ * unchanged value, else the number of trailing zero bits of the XOR and its significant bits
+ * as a varint.
+ * @param out The bytes.
+ * @param value The double.
+ * @param previous The bits of the previous value, replaced by those of the double.
+ */
+static void write_xor(std::vector<unsigned char>& out, const double value, std::uint64_t& previous)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const std::uint64_t x = bits ^ previous;
+    previous = bits;
+    if (x == 0)
+    {
+        out.push_back(64);
+        return;
+    }
+    const int zeros = __builtin_ctzll(x);
+    out.push_back(static_cast<unsigned char>(zeros));
+    write_varint(out, x >> zeros);
+};
+
+/**
+ * @brief Reads a double written by write_xor.
+ * @param p The position, moved after the double.
+ * @param end The end of the bytes.
+ * @param previous The bits of the previous value, replaced by those of the double.
+ * @return The double.
+ * @throw TickFileWrongFormat if the double goes past the end of the bytes.
+ */
+static double read_xor(const unsigned char*& p, const unsigned char* end, std::uint64_t& previous)
+{
+    if (p == end){throw TickFileWrongFormat();}
+    const unsigned zeros = *p++;
+    if (zeros > 64){throw TickFileWrongFormat();}
+    if (zeros < 64){previous ^= read_varint(p, end) << zeros;}
+    double value;
+    std::memcpy(&value, &previous, sizeof(value));
+    return value;
+};
+
+/**
+ * @class TickFileWriter
+ * @brief Writes a tick file, one chunk at a time: the memory used is one chunk, whatever the
+ * number of ticks.
+ */
+
+/**
+ * @brief Constructor, chunks of TICK_FILE_CHUNK ticks.
+ * @param path The path of the file.
+ * @param instrument_ids The ids of the instruments, a tick refers to its instrument by index.
+ * @throw TickFileIOError if the file can not be written.
+ */
+TickFileWriter::TickFileWriter(const std::string& path, const std::vector<std::string>& instrument_ids):
+    TickFileWriter(path, instrument_ids, TICK_FILE_CHUNK){};
+
+/**
+ * @brief Constructor.
+ * @param path The path of the file.
+ * @param instrument_ids The ids of the instruments, a tick refers to its instrument by index.
+ * @param chunk_size The number of ticks of a chunk (at least 1).
+ * @throw TickFileIOError if the file can not be written.
+ */
+TickFileWriter::TickFileWriter(
+    const std::string& path,
+    const std::vector<std::string>& instrument_ids,
+    const std::size_t chunk_size):
+    file_(path, std::ios::binary | std::ios::trunc), n_instruments_(instrument_ids.size()),
+    chunk_size_(std::max<std::size_t>(chunk_size, 1)), previous_(4*instrument_ids.size(), 0),
+    last_ns_(std::numeric_limits<std::int64_t>::min()), n_ticks_(0), offset_(0), closed_(false)
+{
+    if (!file_){throw TickFileIOError();}
+    std::vector<unsigned char> header(TICK_FILE_MAGIC, TICK_FILE_MAGIC + sizeof(TICK_FILE_MAGIC));
+    const std::uint32_t fields[2] = {TICK_FILE_VERSION, static_cast<std::uint32_t>(n_instruments_)};
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(fields);
+    header.insert(header.end(), bytes, bytes + sizeof(fields));
+    for (const std::string& id : instrument_ids)
+    {
+        write_varint(header, id.size());
+        header.insert(header.end(), id.begin(), id.end());
+    }
+    file_.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    if (!file_){throw TickFileIOError();}
+    offset_ = header.size();
+};
+
+/**
+ * @brief The destructor, closes the file if close was not called (the errors are lost then).
+ */
+TickFileWriter::~TickFileWriter()
+{
+    if (!closed_)
+    {
+        try{close();}
+        catch (...){}
+    }
+};
+
+/**
+ * @brief Appends a tick.
+ * @param instrument The index of the instrument.
+ * @param bid The bid.
+ * @param ask The ask.
+ * @param bid_size The size at the bid.
+ * @param ask_size The size at the ask.
+ * @param timestamp The exchange timestamp.
+ * @throw TickUnknownInstrument if the index is not one of the instruments.
+ * @throw TickOutOfOrder if the timestamp is older than the one of the previous tick.
+ * @throw TickFileIOError if the file is closed or a chunk can not be written.
+ */
+void TickFileWriter::append(
+    const std::uint32_t instrument,
+    const double bid,
+    const double ask,
+    const double bid_size,
+    const double ask_size,
+    const Timestamp timestamp)
+{
+    if (closed_){throw TickFileIOError();}
+    if (instrument >= n_instruments_){throw TickUnknownInstrument();}
+    if (timestamp.ns < last_ns_){throw TickOutOfOrder();}
+    last_ns_ = timestamp.ns;
+    chunk_.instruments.push_back(instrument);
+    chunk_.timestamps.push_back(timestamp);
+    chunk_.bids.push_back(bid);
+    chunk_.asks.push_back(ask);
+    chunk_.bid_sizes.push_back(bid_size);
+    chunk_.ask_sizes.push_back(ask_size);
+    n_ticks_++;
+    if (chunk_.size() == chunk_size_){flush();}
+};
+
+/**
+ * @brief Encodes and writes the current chunk, and adds it to the index.
+ * @throw TickFileIOError if the chunk can not be written.
+ */
+void TickFileWriter::flush()
+{
+    const std::size_t n = chunk_.size();
+    if (n == 0){return;}
+    for (std::vector<unsigned char>& column : columns_){column.clear();}
+    std::fill(previous_.begin(), previous_.end(), 0);
+    std::int64_t previous_ns = chunk_.timestamps[0].ns;
+    for (std::size_t j = 0; j < n; ++j)
+    {
+        const std::size_t i = chunk_.instruments[j];
+        write_varint(columns_[0], i);
+        write_varint(columns_[1], static_cast<std::uint64_t>(chunk_.timestamps[j].ns - previous_ns));
+        previous_ns = chunk_.timestamps[j].ns;
+        write_xor(columns_[2], chunk_.bids[j], previous_[4*i]);
+        write_xor(columns_[3], chunk_.asks[j], previous_[4*i + 1]);
+        write_xor(columns_[4], chunk_.bid_sizes[j], previous_[4*i + 2]);
+        write_xor(columns_[5], chunk_.ask_sizes[j], previous_[4*i + 3]);
+    }
+    std::uint64_t sizes[TICK_N_COLUMNS];
+    std::uint64_t bytes = sizeof(sizes);
+    for (std::size_t c = 0; c < TICK_N_COLUMNS; ++c)
+    {
+        sizes[c] = columns_[c].size();
+        bytes += sizes[c];
+    }
+    file_.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    for (const std::vector<unsigned char>& column : columns_)
+    {
+        file_.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size()));
+    }
+    if (!file_){throw TickFileIOError();}
+    index_.push_back(TickChunkEntry{offset_, bytes, chunk_.timestamps[0].ns, chunk_.timestamps[n - 1].ns, n});
+    offset_ += bytes;
+    chunk_.clear();
+};
+
+/**
+ * @brief Writes the last chunk, the index and the trailer, and closes the file.
+ * @throw TickFileIOError if the file can not be written.
+ */
+void TickFileWriter::close()
+{
+    if (closed_){return;}
+    closed_ = true;
+    flush();
+    TickFileTrailer trailer{offset_, index_.size(), {}};
+    std::memcpy(trailer.magic, TICK_FILE_MAGIC, sizeof(TICK_FILE_MAGIC));
+    file_.write(reinterpret_cast<const char*>(index_.data()), static_cast<std::streamsize>(index_.size()*sizeof(TickChunkEntry)));
+    file_.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+    offset_ += index_.size()*sizeof(TickChunkEntry) + sizeof(trailer);
+    file_.close();
+    if (!file_){throw TickFileIOError();}
+};
+
+/**
+ * @return The number of ticks appended.
+ */
+std::size_t TickFileWriter::get_number_ticks() const
+{
+    return n_ticks_;
+};
+
+/**
+ * @return The number of bytes written.
+ */
+std::size_t TickFileWriter::get_number_bytes() const
+{
+    return offset_;
+};
+
+/**
+ * @class TickFileReader
+ * @brief Reads a tick file one chunk at a time. A reader is used by one thread, the threads
+ * replaying the same file open one reader each.
+ */
+
+/**
+ * @brief Constructor, reads the header and the index.
+ * @param path The path of the file.
+ * @throw TickFileIOError if the file can not be opened.
+ * @throw TickFileWrongFormat if the file is not a tick file of the version TICK_FILE_VERSION.
+ */
+TickFileReader::TickFileReader(const std::string& path): file_(path, std::ios::binary)
+{
+    if (!file_){throw TickFileIOError();}
+    file_.seekg(0, std::ios::end);
+    const std::uint64_t size = static_cast<std::uint64_t>(file_.tellg());
+    if (size < sizeof(TICK_FILE_MAGIC) + 8 + sizeof(TickFileTrailer)){throw TickFileWrongFormat();}
+    TickFileTrailer trailer;
+    file_.seekg(static_cast<std::streamoff>(size - sizeof(trailer)));
+    file_.read(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+    if (!file_ || std::memcmp(trailer.magic, TICK_FILE_MAGIC, sizeof(TICK_FILE_MAGIC)) != 0){throw TickFileWrongFormat();}
+    if (trailer.index_offset > size - sizeof(trailer)
+        || trailer.n_chunks != (size - sizeof(trailer) - trailer.index_offset)/sizeof(TickChunkEntry))
+    {
+        throw TickFileWrongFormat();
+    }
+
+    file_.seekg(0);
+    char magic[sizeof(TICK_FILE_MAGIC)];
+    std::uint32_t fields[2];
+    file_.read(magic, sizeof(magic));
+    file_.read(reinterpret_cast<char*>(fields), sizeof(fields));
+    if (!file_ || std::memcmp(magic, TICK_FILE_MAGIC, sizeof(TICK_FILE_MAGIC)) != 0 || fields[0] != TICK_FILE_VERSION)
+    {
+        throw TickFileWrongFormat();
+    }
+    instrument_ids_.reserve(fields[1]);
+    for (std::uint32_t i = 0; i < fields[1]; ++i)
+    {
+        const std::uint64_t n = read_varint(file_);
+        if (n > trailer.index_offset){throw TickFileWrongFormat();}
+        std::string id(n, '\0');
+        file_.read(id.data(), static_cast<std::streamsize>(n));
+        if (!file_){throw TickFileWrongFormat();}
+        instrument_ids_.push_back(std::move(id));
+    }
+    const std::uint64_t header_size = static_cast<std::uint64_t>(file_.tellg());
+
+    index_.resize(trailer.n_chunks);
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(trailer.index_offset));
+    file_.read(reinterpret_cast<char*>(index_.data()), static_cast<std::streamsize>(index_.size()*sizeof(TickChunkEntry)));
+    if (!file_){throw TickFileWrongFormat();}
+    std::uint64_t expected = header_size;
+    for (const TickChunkEntry& entry : index_)
+    {
+        if (entry.offset != expected || entry.bytes > trailer.index_offset - entry.offset){throw TickFileWrongFormat();}
+        expected += entry.bytes;
+    }
+    if (expected != trailer.index_offset){throw TickFileWrongFormat();}
+    previous_.resize(4*instrument_ids_.size());
+};
+
+/**
+ * @return The number of instruments.
+ */
+std::size_t TickFileReader::get_number_instruments() const
+{
+    return instrument_ids_.size();
+};
+
+/**
+ * @param i The index of the instrument.
+ * @return The id of the instrument.
+ */
+const std::string& TickFileReader::get_instrument_id(const std::size_t i) const
+{
+    return instrument_ids_[i];
+};
+
+/**
+ * @return The number of chunks.
+ */
+std::size_t TickFileReader::get_number_chunks() const
+{
+    return index_.size();
+};
+
+/**
+ * @param i The index of the chunk.
+ * @return The entry of the chunk in the index.
+ */
+const TickChunkEntry& TickFileReader::get_chunk_entry(const std::size_t i) const
+{
+    return index_[i];
+};
+
+/**
+ * @return The number of ticks of the file.
+ */
+std::size_t TickFileReader::get_number_ticks() const
+{
+    std::size_t n = 0;
+    for (const TickChunkEntry& entry : index_){n += entry.n_ticks;}
+    return n;
+};
+
+/**
+ * @return The timestamp of the first tick, or zero for an empty file.
+ */
+Timestamp TickFileReader::get_first_timestamp() const
+{
+    return Timestamp{index_.empty() ? 0 : index_.front().first_ns};
+};
+
+/**
+ * @return The timestamp of the last tick, or zero for an empty file.
+ */
+Timestamp TickFileReader::get_last_timestamp() const
+{
+    return Timestamp{index_.empty() ? 0 : index_.back().last_ns};
+};
+
+/**
+ * @brief Reads and decodes a chunk.
+ * @param i The index of the chunk.
+ * @param chunk The decoded ticks, replaced.
+ * @throw TickFileIOError if the chunk can not be read.
+ * @throw TickFileWrongFormat if the chunk is corrupted.
+ */
+void TickFileReader::read_chunk(const std::size_t i, TickChunk& chunk)
+{
+    const TickChunkEntry& entry = index_[i];
+    buffer_.resize(entry.bytes);
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(entry.offset));
+    file_.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(entry.bytes));
+    if (!file_){throw TickFileIOError();}
+
+    std::uint64_t sizes[TICK_N_COLUMNS];
+    if (entry.bytes < sizeof(sizes)){throw TickFileWrongFormat();}
+    std::memcpy(sizes, buffer_.data(), sizeof(sizes));
+    const unsigned char* begins[TICK_N_COLUMNS];
+    const unsigned char* ends[TICK_N_COLUMNS];
+    std::uint64_t position = sizeof(sizes);
+    for (std::size_t c = 0; c < TICK_N_COLUMNS; ++c)
+    {
+        if (sizes[c] > entry.bytes - position){throw TickFileWrongFormat();}
+        begins[c] = buffer_.data() + position;
+        position += sizes[c];
+        ends[c] = buffer_.data() + position;
+    }
+
+    const std::size_t n = entry.n_ticks;
+    const std::size_t n_instruments = instrument_ids_.size();
+    chunk.instruments.resize(n);
+    chunk.timestamps.resize(n);
+    chunk.bids.resize(n);
+    chunk.asks.resize(n);
+    chunk.bid_sizes.resize(n);
+    chunk.ask_sizes.resize(n);
+    std::fill(previous_.begin(), previous_.end(), 0);
+    std::int64_t ns = entry.first_ns;
+    for (std::size_t j = 0; j < n; ++j)
+    {
+        const std::uint64_t instrument = read_varint(begins[0], ends[0]);
+        if (instrument >= n_instruments){throw TickFileWrongFormat();}
+        ns += static_cast<std::int64_t>(read_varint(begins[1], ends[1]));
+        chunk.instruments[j] = static_cast<std::uint32_t>(instrument);
+        chunk.timestamps[j] = Timestamp{ns};
+        chunk.bids[j] = read_xor(begins[2], ends[2], previous_[4*instrument]);
+        chunk.asks[j] = read_xor(begins[3], ends[3], previous_[4*instrument + 1]);
+        chunk.bid_sizes[j] = read_xor(begins[4], ends[4], previous_[4*instrument + 2]);
+        chunk.ask_sizes[j] = read_xor(begins[5], ends[5], previous_[4*instrument + 3]);
+    }
+    if (n > 0 && ns != entry.last_ns){throw TickFileWrongFormat();}
+};
+
+/**
+ * @struct TickReplayShard
+ * @brief The part of a tick file replayed by one TickReplay::run: the ticks of [begin, end)
+ * are replayed, those of [warmup_begin, begin) only fill the book, and only the instruments of
+ * index i with i % n_instrument_shards == instrument_shard are taken.
+ */
+
+/**
+ * @struct TickReplayStep
+ * @brief A step of a replay: the indices in the book of the instruments updated since the
+ * previous step, and the timestamp of the last tick of the step.
+ */
+
+/**
+ * @struct TickReplayStatistics
+ * @brief The statistics of a replay: the chunks read, the ticks in the time range of the shard,
+ * the ticks applied to the book, the ticks of the instruments of the shard which are not in the
+ * book, and the steps.
+ */
+
+/**
+ * @brief The shard of every tick of a file.
+ * @param reader The reader of the file.
+ * @return The shard.
+ */
+TickReplayShard tick_replay_full_shard(const TickFileReader& reader)
+{
+    const Timestamp first = reader.get_first_timestamp();
+    return TickReplayShard{first, first, Timestamp{reader.get_last_timestamp().ns + 1}, 0, 1};
+};
+
+/**
+ * @brief Splits a file into consecutive time ranges of about the same number of ticks, cut at
+ * the start of a chunk. The book of a shard starts empty: the quotes of the warm-up before the
+ * range fill it before the first step.
+ * @param reader The reader of the file.
+ * @param n_shards The number of shards (less if the file has less chunks).
+ * @param warmup_ns The duration of the warm-up, in nanoseconds.
+ * @return The shards, in time order.
+ */
+std::vector<TickReplayShard> tick_replay_shards_by_date(
+    const TickFileReader& reader,
+    const std::size_t n_shards,
+    const long long warmup_ns)
+{
+    std::vector<TickReplayShard> shards;
+    const std::size_t n_chunks = reader.get_number_chunks();
+    if (n_chunks == 0 || n_shards == 0){return shards;}
+    const long long first = reader.get_first_timestamp().ns;
+    const long long end = reader.get_last_timestamp().ns + 1;
+    for (std::size_t s = 0; s < n_shards; ++s)
+    {
+        const std::size_t chunk = n_chunks*s/n_shards;
+        const long long begin = s == 0 ? first : reader.get_chunk_entry(chunk).first_ns;
+        if (!shards.empty())
+        {
+            if (begin <= shards.back().begin.ns){continue;}
+            shards.back().end = Timestamp{begin};
+        }
+        shards.push_back(TickReplayShard{Timestamp{std::max(first, begin - warmup_ns)}, Timestamp{begin}, Timestamp{end}, 0, 1});
+    }
+    return shards;
+};
+
+/**
+ * @brief Splits a file by instruments: every shard replays the whole history of one instrument
+ * in n_shards.
+ * @param reader The reader of the file.
+ * @param n_shards The number of shards.
+ * @return The shards.
+ */
+std::vector<TickReplayShard> tick_replay_shards_by_instrument(const TickFileReader& reader, const std::size_t n_shards)
+{
+    std::vector<TickReplayShard> shards;
+    for (std::size_t s = 0; s < n_shards; ++s)
+    {
+        TickReplayShard shard = tick_replay_full_shard(reader);
+        shard.instrument_shard = s;
+        shard.n_instrument_shards = n_shards;
+        shards.push_back(shard);
+    }
+    return shards;
+};
+
+/**
+ * @class TickReplay
+ * @brief Replays a tick file into a QuoteBook in timestamp order, and calls back the pricing
+ * or calibration at each step, with the instruments updated during the step. One chunk is in
+ * memory at a time.
+ */
+
+/**
+ * @brief Constructor, maps the instruments of the file to the assets of the book by id.
+ * @param reader The reader of the file.
+ * @param book The book, the instruments of the file which are not in it are skipped.
+ */
+TickReplay::TickReplay(TickFileReader& reader, QuoteBook& book):
+    reader_(reader), book_(book), book_indices_(reader.get_number_instruments()), is_updated_(book.size(), 0)
+{
+    for (std::size_t i = 0; i < book_indices_.size(); ++i)
+    {
+        try{book_indices_[i] = book.find_asset(reader.get_instrument_id(i));}
+        catch (QuoteBookUnknownAsset&){book_indices_[i] = std::numeric_limits<std::size_t>::max();}
+    }
+};
+
+/**
+ * @param instrument The index of an instrument of the file.
+ * @return Its index in the book, std::numeric_limits<std::size_t>::max() if it is not in the book.
+ */
+std::size_t TickReplay::get_book_index(const std::size_t instrument) const
+{
+    return book_indices_[instrument];
+};
+
+/**
+ * @brief Replays a shard. A step ends at each multiple of step_ns after the begin of the shard
+ * (with step_ns = 0, at each new timestamp), the steps without updates are skipped, and the last
+ * step ends with the last tick.
+ * @param shard The shard.
+ * @param step_ns The duration of the steps, in nanoseconds, 0 for a step per timestamp.
+ * @param on_step The callback, called with the book and the step once the ticks of the step
+ * are applied.
+ * @return The statistics of the replay.
+ * @throw TickFileIOError
+ * @throw TickFileWrongFormat
+ */
+TickReplayStatistics TickReplay::run(
+    const TickReplayShard& shard,
+    const long long step_ns,
+    const std::function<void(const QuoteBook&, const TickReplayStep&)>& on_step)
+{
+    const auto start = std::chrono::steady_clock::now();
+    TickReplayStatistics statistics{0, 0, 0, 0, 0, 0.};
+    const std::size_t unmapped = std::numeric_limits<std::size_t>::max();
+    const std::size_t n_instrument_shards = std::max<std::size_t>(shard.n_instrument_shards, 1);
+    long long step_end = shard.begin.ns + step_ns;
+    long long last_ns = shard.begin.ns;
+    updated_.clear();
+    auto emit = [&]()
+    {
+        if (updated_.empty()){return;}
+        on_step(book_, TickReplayStep{Timestamp{last_ns}, updated_.data(), updated_.size()});
+        for (const std::size_t i : updated_){is_updated_[i] = 0;}
+        updated_.clear();
+        statistics.n_steps++;
+    };
+    for (std::size_t c = 0; c < reader_.get_number_chunks(); ++c)
+    {
+        const TickChunkEntry& entry = reader_.get_chunk_entry(c);
+        if (entry.first_ns >= shard.end.ns){break;}
+        if (entry.last_ns < shard.warmup_begin.ns){continue;}
+        reader_.read_chunk(c, chunk_);
+        statistics.n_chunks++;
+        for (std::size_t j = 0; j < chunk_.size(); ++j)
+        {
+            const long long ns = chunk_.timestamps[j].ns;
+            if (ns < shard.warmup_begin.ns){continue;}
+            if (ns >= shard.end.ns){break;}
+            statistics.n_ticks++;
+            if (chunk_.instruments[j] % n_instrument_shards != shard.instrument_shard){continue;}
+            const std::size_t i = book_indices_[chunk_.instruments[j]];
+            if (i == unmapped)
+            {
+                statistics.n_unmapped++;
+                continue;
+            }
+            if (ns >= shard.begin.ns)
+            {
+                if (step_ns > 0 && ns >= step_end)
+                {
+                    emit();
+                    step_end = shard.begin.ns + ((ns - shard.begin.ns)/step_ns + 1)*step_ns;
+                }
+                else if (step_ns <= 0 && ns != last_ns){emit();}
+                if (!is_updated_[i])
+                {
+                    is_updated_[i] = 1;
+                    updated_.push_back(i);
+                }
+                last_ns = ns;
+            }
+            book_.update(i, chunk_.bids[j], chunk_.asks[j], chunk_.bid_sizes[j], chunk_.ask_sizes[j], chunk_.timestamps[j]);
+            statistics.n_applied++;
+        }
+    }
+    emit();
+    statistics.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return statistics;
+};
+
+/**
+ * @fn template <typename T, typename Run, typename Merge> T tick_replay_parallel(const std::string& path, const std::vector<TickReplayShard>& shards, ThreadPool* pool, const T identity, Run run, Merge merge)
+ * @brief Replays shards of a tick file in parallel and merges their results in the order of
+ * the shards, so that the result does not depend on the scheduling.
+ * @param path The path of the file, each shard opens its own reader.
+ * @param shards The shards.
+ * @param pool The pool, null to replay the shards one after the other.
+ * @param identity The identity of merge.
+ * @param run The replay of a shard, T run(TickFileReader& reader, const TickReplayShard& shard),
+ * which builds its own book (and TickReplay) on the reader.
+ * @param merge The merge of two results, T merge(const T&, const T&).
+ * @return The merged result.
+ */
@@ -0,0 +1,193 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <chrono>
+#include <functional>
+#include "../../../../src/datastructure/datetime/datetime.h"
+#include "../../../../src/datastructure/market/quotebook/quotebook.h"
+#include "../../../../src/parallel/threadpool/threadpool.h"
+
+constexpr char TICK_FILE_MAGIC[8] = {'A', 'R', 'B', 'T', 'I', 'C', 'K', '\0'};
+
+constexpr std::uint32_t TICK_FILE_VERSION = 1;
+
+constexpr std::size_t TICK_FILE_CHUNK = 65536;
+
+constexpr std::size_t TICK_N_COLUMNS = 6;
+
+class TickFileIOError:  public std::exception
+{public: const char * what() const throw();};
+
+class TickFileWrongFormat:  public std::exception
+{public: const char * what() const throw();};
+
+class TickOutOfOrder:  public std::exception
+{public: const char * what() const throw();};
+
+class TickUnknownInstrument:  public std::exception
+{public: const char * what() const throw();};
+
+struct TickChunkEntry
+{
+    std::uint64_t offset;
+    std::uint64_t bytes;
+    std::int64_t first_ns;
+    std::int64_t last_ns;
+    std::uint64_t n_ticks;
+};
+
+struct TickFileTrailer
+{
+    std::uint64_t index_offset;
+    std::uint64_t n_chunks;
+    char magic[8];
+};
+
+struct TickChunk
+{
+    std::vector<std::uint32_t> instruments;
+    std::vector<Timestamp> timestamps;
+    std::vector<double> bids;
+    std::vector<double> asks;
+    std::vector<double> bid_sizes;
+    std::vector<double> ask_sizes;
+    std::size_t size() const;
+    void clear();
+};
+
+class TickFileWriter
+{
+    public:
+        TickFileWriter(const std::string& path, const std::vector<std::string>& instrument_ids);
+        TickFileWriter(const std::string& path, const std::vector<std::string>& instrument_ids, const std::size_t chunk_size);
+        ~TickFileWriter();
+        void append(
+            const std::uint32_t instrument,
+            const double bid,
+            const double ask,
+            const double bid_size,
+            const double ask_size,
+            const Timestamp timestamp);
+        void close();
+        std::size_t get_number_ticks() const;
+        std::size_t get_number_bytes() const;
+    private:
+        void flush();
+        std::ofstream file_;
+        std::size_t n_instruments_;
+        std::size_t chunk_size_;
+        TickChunk chunk_;
+        std::vector<TickChunkEntry> index_;
+        std::vector<unsigned char> columns_[TICK_N_COLUMNS];
+        std::vector<std::uint64_t> previous_;
+        std::int64_t last_ns_;
+        std::size_t n_ticks_;
+        std::uint64_t offset_;
+        bool closed_;
+};
+
+class TickFileReader
+{
+    public:
+        TickFileReader(const std::string& path);
+        ~TickFileReader(){};
+        std::size_t get_number_instruments() const;
+        const std::string& get_instrument_id(const std::size_t i) const;
+        std::size_t get_number_chunks() const;
+        const TickChunkEntry& get_chunk_entry(const std::size_t i) const;
+        std::size_t get_number_ticks() const;
+        Timestamp get_first_timestamp() const;
+        Timestamp get_last_timestamp() const;
+        void read_chunk(const std::size_t i, TickChunk& chunk);
+    private:
+        std::ifstream file_;
+        std::vector<std::string> instrument_ids_;
+        std::vector<TickChunkEntry> index_;
+        std::vector<unsigned char> buffer_;
+        std::vector<std::uint64_t> previous_;
+};
+
+struct TickReplayShard
+{
+    Timestamp warmup_begin;
+    Timestamp begin;
+    Timestamp end;
+    std::size_t instrument_shard;
+    std::size_t n_instrument_shards;
+};
+
+struct TickReplayStep
+{
+    Timestamp timestamp;
+    const std::size_t* updated;
+    std::size_t n_updated;
+};
+
+struct TickReplayStatistics
+{
+    std::size_t n_chunks;
+    std::size_t n_ticks;
+    std::size_t n_applied;
+    std::size_t n_unmapped;
+    std::size_t n_steps;
+    double elapsed_us;
+};
+
+TickReplayShard tick_replay_full_shard(const TickFileReader& reader);
+
+std::vector<TickReplayShard> tick_replay_shards_by_date(
+    const TickFileReader& reader,
+    const std::size_t n_shards,
+    const long long warmup_ns);
+
+std::vector<TickReplayShard> tick_replay_shards_by_instrument(const TickFileReader& reader, const std::size_t n_shards);
+
+class TickReplay
+{
+    public:
+        TickReplay(TickFileReader& reader, QuoteBook& book);
+        ~TickReplay(){};
+        std::size_t get_book_index(const std::size_t instrument) const;
+        TickReplayStatistics run(
+            const TickReplayShard& shard,
+            const long long step_ns,
+            const std::function<void(const QuoteBook&, const TickReplayStep&)>& on_step);
+    private:
+        TickFileReader& reader_;
+        QuoteBook& book_;
+        std::vector<std::size_t> book_indices_;
+        TickChunk chunk_;
+        std::vector<std::size_t> updated_;
+        std::vector<unsigned char> is_updated_;
+};
+
+template <typename T, typename Run, typename Merge>
+T tick_replay_parallel(
+    const std::string& path,
+    const std::vector<TickReplayShard>& shards,
+    ThreadPool* pool,
+    const T identity,
+    Run run,
+    Merge merge)
+{
+    std::vector<T> results(shards.size(), identity);
+    auto run_shards = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t s = begin; s < end; ++s)
+        {
+            TickFileReader reader(path);
+            results[s] = run(reader, shards[s]);
+        }
+    };
+    if (pool){pool->parallel_for(shards.size(), 1, run_shards);}
+    else {run_shards(0, shards.size());}
+    T result = identity;
+    for (const T& partial : results){result = merge(result, partial);}
+    return result;
+};
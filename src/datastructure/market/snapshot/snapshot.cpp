@@ -0,0 +1,936 @@
+#include "snapshot.h"
+
+/**
+* @file snapshot.h
+* @brief This file defines the flat binary snapshot of a market: the interned tables of the
+* registry (currencies, risk factors, options, futures, assets) and the calibrated models
+* (Nelson-Siegel curves, SVI slices, interpolations), read in place from a memory mapping.
+*
+* The file is a header followed by one section per table, each one an array of fixed size
+* records of fixed width integers and doubles, aligned on 8 bytes, in the byte order of the host.
+* The strings (ids, codes, names) are (offset, size) references into a single blob, the arrays
+* of the interpolations are ranges of a single array of doubles, and the links between records
+* are indices of the other tables (SNAPSHOT_NULL_INDEX for none). Nothing has to be decoded: a
+* worker maps the file read only, which is shared between the processes of the host by the page
+* cache, and prices from the records directly, or rebuilds the objects with load.
+*/
+
+/**
+ * @var char SNAPSHOT_MAGIC[8]
+ * @brief The first bytes of a snapshot file.
+ */
+
+/**
+ * @var std::uint32_t SNAPSHOT_VERSION
+ * @brief The version of the layout written by SnapshotWriter, a SnapshotView reads only this
+ * version.
+ */
+
+/**
+ * @var std::uint32_t SNAPSHOT_NULL_INDEX
+ * @brief The index of a link which is not set.
+ */
+
+/**
+ * @class SnapshotIOError
+ * @brief Definition of the error when a snapshot file can not be written, opened or mapped.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SnapshotIOError::what() const throw(){
+    return "The snapshot file can not be written, opened or mapped.";
+};
+
+/**
+ * @class SnapshotWrongFormat
+ * @brief Definition of the error when a file is not a snapshot, or is truncated.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SnapshotWrongFormat::what() const throw(){
+    return "The file is not a snapshot, or it is truncated.";
+};
+
+/**
+ * @class SnapshotWrongVersion
+ * @brief Definition of the error when the version of a snapshot is not SNAPSHOT_VERSION.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SnapshotWrongVersion::what() const throw(){
+    return "The version of the snapshot is not supported.";
+};
+
+/**
+ * @class SnapshotUnsupportedObject
+ * @brief Definition of the error when an object has no record in the snapshot format (the
+ * structured instruments and assets, the volatility futures).
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SnapshotUnsupportedObject::what() const throw(){
+    return "The object can not be stored in a snapshot.";
+};
+
+/**
+ * @class SnapshotUnknownRecord
+ * @brief Definition of the error when a record is read at an index beyond its section.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SnapshotUnknownRecord::what() const throw(){
+    return "The index is beyond the records of the section.";
+};
+
+/**
+ * @enum SnapshotSection
+ * @brief The sections of a snapshot, in the order of the section table of the header.
+ */
+
+/**
+ * @enum SnapshotRiskFactorKind
+ * @brief The concrete class of a risk factor record.
+ */
+
+/**
+ * @enum SnapshotInterpolationKind
+ * @brief The concrete class of an interpolation record.
+ */
+
+/**
+ * @struct SnapshotString
+ * @brief A string of the blob of the snapshot.
+ */
+
+/**
+ * @struct SnapshotSectionEntry
+ * @brief The position of a section: its offset in bytes from the start of the file, and its
+ * number of records (of bytes for the strings, of doubles for the doubles).
+ */
+
+/**
+ * @struct SnapshotHeader
+ * @brief The header of a snapshot, at the start of the file.
+ */
+
+/**
+ * @struct SnapshotCurrency
+ * @brief The record of a Currency.
+ */
+
+/**
+ * @struct SnapshotRiskFactor
+ * @brief The record of a RiskFactor: its kind, its base (domestic) currency and, for the FX
+ * and crypto pairs, its counter (foreign) currency.
+ */
+
+/**
+ * @struct SnapshotOption
+ * @brief The record of an Option, vanilla european, american or of the base class (tag).
+ */
+
+/**
+ * @struct SnapshotFuture
+ * @brief The record of a Future, perpetual or dated.
+ */
+
+/**
+ * @struct SnapshotAsset
+ * @brief The record of an asset: a crypto spot, future or option, or a zero coupon bond. The
+ * option and future indices are the instrument of the asset, for an option the future is its
+ * underlying (none for a spot underlying); the day count and expiry are those of the bond.
+ */
+
+/**
+ * @struct SnapshotNelsonSiegel
+ * @brief The record of a calibrated curve, parameters b0, b1, b2, b3, tau1, tau2 (b3 = 0 and
+ * tau2 = tau1 for a Nelson-Siegel curve).
+ */
+
+/**
+ * @struct SnapshotSVI
+ * @brief The record of an SVI slice, its jump-wings parameters vt, ut, ct, pt, vmt and its
+ * year fraction.
+ */
+
+/**
+ * @struct SnapshotInterpolation
+ * @brief The record of an interpolation, its pillars are the ranges [x, x+n) and [y, y+n) of
+ * the doubles.
+ */
+
+/**
+ * @struct SnapshotRegistryEntry
+ * @brief An object registered in the registry written by add_registry, the section of its
+ * table and its index: load registers them in this order, so that the handles of the loaded
+ * registry are those of the written one.
+ */
+
+static_assert(std::is_trivially_copyable<SnapshotHeader>::value, "The records must be trivially copyable.");
+static_assert(sizeof(SnapshotOption) == 40, "The layout of SnapshotOption changed, bump SNAPSHOT_VERSION.");
+static_assert(sizeof(SnapshotAsset) == 40, "The layout of SnapshotAsset changed, bump SNAPSHOT_VERSION.");
+static_assert(sizeof(SnapshotHeader) == 24 + 16*SNAPSHOT_N_SECTIONS, "The layout of the header changed.");
+
+/**
+ * @class SnapshotWriter
+ * @brief Collects the records of a market and writes the snapshot file. The objects are
+ * deduplicated by address: an object added twice, directly or as a link of another one, has a
+ * single record.
+ */
+
+/**
+ * @brief Adds a string to the blob.
+ * @param text The string.
+ * @return The reference of the string.
+ */
+SnapshotString SnapshotWriter::add_string(const std::string& text)
+{
+    SnapshotString reference{static_cast<std::uint32_t>(strings_.size()), static_cast<std::uint32_t>(text.size())};
+    strings_.insert(strings_.end(), text.begin(), text.end());
+    return reference;
+};
+
+/**
+ * @param tag The tag of an instrument.
+ * @return Whether the instrument has a record in the snapshot format.
+ */
+static bool has_instrument_record(const InstrumentTag tag)
+{
+    return tag == INSTRUMENT_OPTION || tag == INSTRUMENT_EUROPEAN_VANILLA_OPTION
+        || tag == INSTRUMENT_AMERICAN_VANILLA_OPTION || tag == INSTRUMENT_FUTURE;
+};
+
+/**
+ * @param tag The tag of an asset.
+ * @return Whether the asset has a record in the snapshot format.
+ */
+static bool has_asset_record(const AssetTag tag)
+{
+    return tag == ASSET_CRYPTO_SPOT || tag == ASSET_CRYPTO_FUTURE || tag == ASSET_CRYPTO_OPTION
+        || tag == ASSET_ZERO_COUPON_BOND;
+};
+
+/**
+ * @brief Adds the currencies, risk factors, options, futures and assets of a registry, in
+ * the order of their handles, so that the loaded registry gives every object the same handle.
+ * Every instrument and asset is checked before anything is added.
+ * @param registry The registry.
+ * @throw SnapshotUnsupportedObject if an instrument or an asset has no record (the structured
+ * instruments and assets, the volatility futures), the writer is then left unchanged.
+ */
+void SnapshotWriter::add_registry(const MarketRegistry& registry)
+{
+    for (std::size_t h = 0; h < registry.get_number_instruments(); ++h)
+    {
+        const std::shared_ptr<Instrument>& instrument = registry.get_instrument(static_cast<RegistryHandle>(h));
+        if (!has_instrument_record(instrument->get_instrument_tag())){throw SnapshotUnsupportedObject();}
+    }
+    for (std::size_t h = 0; h < registry.get_number_assets(); ++h)
+    {
+        const std::shared_ptr<Asset>& asset = registry.get_asset(static_cast<RegistryHandle>(h));
+        if (!has_asset_record(asset->get_asset_tag())){throw SnapshotUnsupportedObject();}
+    }
+    for (std::size_t h = 0; h < registry.get_number_currencies(); ++h)
+    {
+        registry_entries_.push_back(SnapshotRegistryEntry{SNAPSHOT_CURRENCIES,
+            add_currency(registry.get_currency(static_cast<RegistryHandle>(h)))});
+    }
+    for (std::size_t h = 0; h < registry.get_number_risk_factors(); ++h)
+    {
+        registry_entries_.push_back(SnapshotRegistryEntry{SNAPSHOT_RISK_FACTORS,
+            add_risk_factor(registry.get_risk_factor(static_cast<RegistryHandle>(h)))});
+    }
+    for (std::size_t h = 0; h < registry.get_number_instruments(); ++h)
+    {
+        const std::shared_ptr<Instrument>& instrument = registry.get_instrument(static_cast<RegistryHandle>(h));
+        switch (instrument->get_instrument_tag())
+        {
+            case INSTRUMENT_OPTION:
+            case INSTRUMENT_EUROPEAN_VANILLA_OPTION:
+            case INSTRUMENT_AMERICAN_VANILLA_OPTION:
+                registry_entries_.push_back(SnapshotRegistryEntry{SNAPSHOT_OPTIONS,
+                    add_option(std::static_pointer_cast<Option>(instrument))});
+                break;
+            case INSTRUMENT_FUTURE:
+                registry_entries_.push_back(SnapshotRegistryEntry{SNAPSHOT_FUTURES,
+                    add_future(std::static_pointer_cast<Future>(instrument))});
+                break;
+            default:
+                throw SnapshotUnsupportedObject();
+        }
+    }
+    for (std::size_t h = 0; h < registry.get_number_assets(); ++h)
+    {
+        add_asset(registry.get_asset(static_cast<RegistryHandle>(h)));
+    }
+};
+
+/**
+ * @brief Adds a currency.
+ * @param currency The currency, null gives SNAPSHOT_NULL_INDEX.
+ * @return The index of its record.
+ */
+std::uint32_t SnapshotWriter::add_currency(const std::shared_ptr<Currency> currency)
+{
+    if (!currency){return SNAPSHOT_NULL_INDEX;}
+    const auto found = indices_.find(currency.get());
+    if (found != indices_.end()){return found->second;}
+    const std::uint32_t index = static_cast<std::uint32_t>(currencies_.size());
+    currencies_.push_back(SnapshotCurrency{add_string(currency->get_code()), add_string(currency->get_name())});
+    indices_.emplace(currency.get(), index);
+    return index;
+};
+
+/**
+ * @brief Adds a risk factor and its currencies.
+ * @param risk_factor The risk factor, null gives SNAPSHOT_NULL_INDEX.
+ * @return The index of its record.
+ */
+std::uint32_t SnapshotWriter::add_risk_factor(const std::shared_ptr<RiskFactor> risk_factor)
+{
+    if (!risk_factor){return SNAPSHOT_NULL_INDEX;}
+    const auto found = indices_.find(risk_factor.get());
+    if (found != indices_.end()){return found->second;}
+    SnapshotRiskFactor record{add_string(risk_factor->get_id()), SNAPSHOT_RISK_FACTOR_BASE,
+        add_currency(risk_factor->get_base_currency()), SNAPSHOT_NULL_INDEX, 0};
+    if (std::shared_ptr<Crypto> crypto = std::dynamic_pointer_cast<Crypto>(risk_factor))
+    {
+        record.kind = SNAPSHOT_RISK_FACTOR_CRYPTO;
+        record.counter_currency = add_currency(crypto->get_foreign_currency());
+    }
+    else if (std::shared_ptr<FX> fx = std::dynamic_pointer_cast<FX>(risk_factor))
+    {
+        record.kind = SNAPSHOT_RISK_FACTOR_FX;
+        record.counter_currency = add_currency(fx->get_foreign_currency());
+    }
+    else if (std::dynamic_pointer_cast<InterestRate>(risk_factor))
+    {
+        record.kind = SNAPSHOT_RISK_FACTOR_INTEREST_RATE;
+    }
+    const std::uint32_t index = static_cast<std::uint32_t>(risk_factors_.size());
+    risk_factors_.push_back(record);
+    indices_.emplace(risk_factor.get(), index);
+    return index;
+};
+
+/**
+ * @brief Adds an option and its strike currency.
+ * @param option The option, null gives SNAPSHOT_NULL_INDEX.
+ * @return The index of its record.
+ */
+std::uint32_t SnapshotWriter::add_option(const std::shared_ptr<Option> option)
+{
+    if (!option){return SNAPSHOT_NULL_INDEX;}
+    const auto found = indices_.find(option.get());
+    if (found != indices_.end()){return found->second;}
+    const SnapshotOption record{
+        add_string(option->get_id()), option->get_expiry_timestamp().ns, option->get_strike(),
+        static_cast<std::int32_t>(option->get_option_type()), static_cast<std::int32_t>(option->get_day_count()),
+        add_currency(option->get_strike_currency()), static_cast<std::uint32_t>(option->get_instrument_tag())
+    };
+    const std::uint32_t index = static_cast<std::uint32_t>(options_.size());
+    options_.push_back(record);
+    indices_.emplace(option.get(), index);
+    return index;
+};
+
+/**
+ * @brief Adds a future.
+ * @param future The future, null gives SNAPSHOT_NULL_INDEX.
+ * @return The index of its record.
+ */
+std::uint32_t SnapshotWriter::add_future(const std::shared_ptr<Future> future)
+{
+    if (!future){return SNAPSHOT_NULL_INDEX;}
+    const auto found = indices_.find(future.get());
+    if (found != indices_.end()){return found->second;}
+    const bool perpetual = future->is_perpetual();
+    const SnapshotFuture record{
+        add_string(future->get_id()), perpetual ? 0 : future->get_expiry_timestamp().ns,
+        perpetual ? 0 : static_cast<std::int32_t>(future->get_day_count()), perpetual ? 1u : 0u
+    };
+    const std::uint32_t index = static_cast<std::uint32_t>(futures_.size());
+    futures_.push_back(record);
+    indices_.emplace(future.get(), index);
+    return index;
+};
+
+/**
+ * @brief Adds an asset, its risk factor, its quote currency and its instruments.
+ * @param asset The asset, null gives SNAPSHOT_NULL_INDEX.
+ * @return The index of its record.
+ * @throw SnapshotUnsupportedObject if the asset is not a crypto spot, future or option, or a
+ * zero coupon bond.
+ */
+std::uint32_t SnapshotWriter::add_asset(const std::shared_ptr<Asset> asset)
+{
+    if (!asset){return SNAPSHOT_NULL_INDEX;}
+    const auto found = indices_.find(asset.get());
+    if (found != indices_.end()){return found->second;}
+    const AssetTag tag = asset->get_asset_tag();
+    SnapshotAsset record{add_string(asset->get_id()), static_cast<std::uint32_t>(tag), 0, 0,
+        SNAPSHOT_NULL_INDEX, SNAPSHOT_NULL_INDEX, 0, 0};
+    switch (tag)
+    {
+        case ASSET_CRYPTO_SPOT:
+            break;
+        case ASSET_CRYPTO_FUTURE:
+            record.future = add_future(static_cast<CryptoFuture*>(asset.get())->get_future());
+            break;
+        case ASSET_CRYPTO_OPTION:
+        {
+            CryptoOption* option = static_cast<CryptoOption*>(asset.get());
+            record.option = add_option(option->get_option());
+            const std::shared_ptr<CryptoAsset> underlying = option->get_underlying_crypto_asset();
+            if (underlying && underlying->get_asset_tag() == ASSET_CRYPTO_FUTURE)
+            {
+                record.future = add_future(static_cast<CryptoFuture*>(underlying.get())->get_future());
+            }
+            break;
+        }
+        case ASSET_ZERO_COUPON_BOND:
+        {
+            ZeroCouponBond* bond = static_cast<ZeroCouponBond*>(asset.get());
+            record.day_count = static_cast<std::int32_t>(bond->get_day_count_convention());
+            record.expiry_ns = bond->get_expiry_timestamp().ns;
+            break;
+        }
+        default:
+            throw SnapshotUnsupportedObject();
+    }
+    record.risk_factor = add_risk_factor(asset->get_risk_factor());
+    record.quote_currency = add_currency(asset->get_quote_currency());
+    const std::uint32_t index = static_cast<std::uint32_t>(assets_.size());
+    assets_.push_back(record);
+    indices_.emplace(asset.get(), index);
+    return index;
+};
+
+/**
+ * @brief Adds a calibrated Nelson-Siegel curve.
+ * @param id The id of the curve.
+ * @param model The model.
+ * @return The index of its record.
+ */
+std::uint32_t SnapshotWriter::add_nelson_siegel(const std::string& id, const NelsonSiegel& model)
+{
+    const std::uint32_t index = static_cast<std::uint32_t>(nelson_siegels_.size());
+    nelson_siegels_.push_back(SnapshotNelsonSiegel{add_string(id), 0, 0,
+        {model.b0_, model.b1_, model.b2_, 0., model.tau_, model.tau_}});
+    return index;
+};
+
+/**
+ * @brief Adds a calibrated Nelson-Siegel-Svensson curve.
+ * @param id The id of the curve.
+ * @param model The model.
+ * @return The index of its record.
+ */
+std::uint32_t SnapshotWriter::add_nelson_siegel(const std::string& id, const NelsonSiegelSvensson& model)
+{
+    const std::uint32_t index = static_cast<std::uint32_t>(nelson_siegels_.size());
+    nelson_siegels_.push_back(SnapshotNelsonSiegel{add_string(id), 1, 0,
+        {model.b0_, model.b1_, model.b2_, model.b3_, model.tau1_, model.tau2_}});
+    return index;
+};
+
+/**
+ * @brief Adds a calibrated SVI slice.
+ * @param id The id of the slice.
+ * @param model The slice.
+ * @return The index of its record.
+ */
+std::uint32_t SnapshotWriter::add_svi(const std::string& id, const SVI& model)
+{
+    const std::uint32_t index = static_cast<std::uint32_t>(svis_.size());
+    svis_.push_back(SnapshotSVI{add_string(id), {model.vt_, model.ut_, model.ct_, model.pt_, model.vmt_, model.T_}});
+    return index;
+};
+
+/**
+ * @brief Adds an interpolation, its pillars are appended to the doubles.
+ * @param id The id of the interpolation.
+ * @param interpolation The interpolation, a LinearInterpolation2D or a CubicSpline2D.
+ * @return The index of its record.
+ * @throw SnapshotUnsupportedObject if the interpolation is of another class.
+ */
+std::uint32_t SnapshotWriter::add_interpolation(const std::string& id, Interpolation2D& interpolation)
+{
+    std::uint32_t kind;
+    if (dynamic_cast<CubicSpline2D*>(&interpolation)){kind = SNAPSHOT_CUBIC_SPLINE;}
+    else if (dynamic_cast<LinearInterpolation2D*>(&interpolation)){kind = SNAPSHOT_LINEAR_INTERPOLATION;}
+    else {throw SnapshotUnsupportedObject();}
+    const std::vector<double>& x = interpolation.get_x_values();
+    const std::vector<double>& y = interpolation.get_y_values();
+    const std::uint64_t x_begin = doubles_.size();
+    doubles_.insert(doubles_.end(), x.begin(), x.end());
+    const std::uint64_t y_begin = doubles_.size();
+    doubles_.insert(doubles_.end(), y.begin(), y.end());
+    const std::uint32_t index = static_cast<std::uint32_t>(interpolations_.size());
+    interpolations_.push_back(SnapshotInterpolation{add_string(id), kind, 0, x.size(), x_begin, y_begin});
+    return index;
+};
+
+/**
+ * @brief Appends a section to the image of the file, aligned on 8 bytes.
+ * @param image The image of the file.
+ * @param entry The entry of the section in the header.
+ * @param data The records.
+ * @param count The number of records.
+ * @param size The size of a record.
+ */
+static void append_section(
+    std::vector<char>& image, SnapshotSectionEntry& entry, const void* data, std::size_t count, std::size_t size)
+{
+    image.resize((image.size() + 7) & ~std::size_t(7), 0);
+    entry.offset = image.size();
+    entry.count = count;
+    const char* bytes = static_cast<const char*>(data);
+    image.insert(image.end(), bytes, bytes + count*size);
+};
+
+/**
+ * @brief Writes the snapshot file, through a temporary file renamed at the end so that a
+ * worker never maps a half written snapshot.
+ * @param path The path of the file.
+ * @throw SnapshotIOError if the file can not be written.
+ */
+void SnapshotWriter::write(const std::string& path) const
+{
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.n_sections = SNAPSHOT_N_SECTIONS;
+    std::vector<char> image(sizeof(SnapshotHeader), 0);
+    append_section(image, header.sections[SNAPSHOT_STRINGS], strings_.data(), strings_.size(), 1);
+    append_section(image, header.sections[SNAPSHOT_DOUBLES], doubles_.data(), doubles_.size(), sizeof(double));
+    append_section(image, header.sections[SNAPSHOT_CURRENCIES], currencies_.data(), currencies_.size(), sizeof(SnapshotCurrency));
+    append_section(image, header.sections[SNAPSHOT_RISK_FACTORS], risk_factors_.data(), risk_factors_.size(), sizeof(SnapshotRiskFactor));
+    append_section(image, header.sections[SNAPSHOT_OPTIONS], options_.data(), options_.size(), sizeof(SnapshotOption));
+    append_section(image, header.sections[SNAPSHOT_FUTURES], futures_.data(), futures_.size(), sizeof(SnapshotFuture));
+    append_section(image, header.sections[SNAPSHOT_ASSETS], assets_.data(), assets_.size(), sizeof(SnapshotAsset));
+    append_section(image, header.sections[SNAPSHOT_NELSON_SIEGEL], nelson_siegels_.data(), nelson_siegels_.size(), sizeof(SnapshotNelsonSiegel));
+    append_section(image, header.sections[SNAPSHOT_SVI], svis_.data(), svis_.size(), sizeof(SnapshotSVI));
+    append_section(image, header.sections[SNAPSHOT_INTERPOLATIONS], interpolations_.data(), interpolations_.size(), sizeof(SnapshotInterpolation));
+    append_section(image, header.sections[SNAPSHOT_REGISTRY], registry_entries_.data(), registry_entries_.size(), sizeof(SnapshotRegistryEntry));
+    image.resize((image.size() + 7) & ~std::size_t(7), 0);
+    header.file_size = image.size();
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file){throw SnapshotIOError();}
+        file.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!file){throw SnapshotIOError();}
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0){throw SnapshotIOError();}
+};
+
+/**
+ * @brief The size of the records of each section, in bytes.
+ */
+static const std::size_t SECTION_RECORD_SIZES[SNAPSHOT_N_SECTIONS] = {
+    1, sizeof(double), sizeof(SnapshotCurrency), sizeof(SnapshotRiskFactor), sizeof(SnapshotOption),
+    sizeof(SnapshotFuture), sizeof(SnapshotAsset), sizeof(SnapshotNelsonSiegel), sizeof(SnapshotSVI),
+    sizeof(SnapshotInterpolation), sizeof(SnapshotRegistryEntry)
+};
+
+/**
+ * @class SnapshotView
+ * @brief A snapshot file mapped read only: the records are read in place. The pages are
+ * shared with every other process mapping the same file, and only the pages which are touched
+ * are read from the disk (or the page cache). The view can be read from several threads.
+ */
+
+/**
+ * @brief Maps a snapshot file and checks its header and the bounds of its sections.
+ * @param path The path of the file.
+ * @throw SnapshotIOError if the file can not be opened or mapped.
+ * @throw SnapshotWrongFormat if the file is not a snapshot or is truncated.
+ * @throw SnapshotWrongVersion if the version of the snapshot is not SNAPSHOT_VERSION.
+ */
+SnapshotView::SnapshotView(const std::string& path): data_(nullptr), size_(0), header_(nullptr)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0){throw SnapshotIOError();}
+    struct stat status;
+    if (fstat(fd, &status) != 0){close(fd); throw SnapshotIOError();}
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (size_ < sizeof(SnapshotHeader)){close(fd); throw SnapshotWrongFormat();}
+    void* address = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED){throw SnapshotIOError();}
+    data_ = static_cast<const char*>(address);
+    header_ = reinterpret_cast<const SnapshotHeader*>(data_);
+    try
+    {
+        if (std::memcmp(header_->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0){throw SnapshotWrongFormat();}
+        if (header_->version != SNAPSHOT_VERSION){throw SnapshotWrongVersion();}
+        if (header_->n_sections != SNAPSHOT_N_SECTIONS || header_->file_size != size_){throw SnapshotWrongFormat();}
+        for (std::size_t s = 0; s < SNAPSHOT_N_SECTIONS; ++s)
+        {
+            const SnapshotSectionEntry& entry = header_->sections[s];
+            if (entry.offset % 8 != 0 || entry.offset > size_){throw SnapshotWrongFormat();}
+            if (entry.count > (size_ - entry.offset)/SECTION_RECORD_SIZES[s]){throw SnapshotWrongFormat();}
+        }
+    }
+    catch (...)
+    {
+        munmap(address, size_);
+        throw;
+    }
+};
+
+/**
+ * @brief The destructor, unmaps the file.
+ */
+SnapshotView::~SnapshotView()
+{
+    if (data_){munmap(const_cast<char*>(data_), size_);}
+};
+
+/**
+ * @return The version of the snapshot.
+ */
+std::uint32_t SnapshotView::get_version() const
+{
+    return header_->version;
+};
+
+/**
+ * @param section The section.
+ * @return The number of records of the section.
+ */
+std::size_t SnapshotView::get_size(const SnapshotSection section) const
+{
+    return header_->sections[section].count;
+};
+
+/**
+ * @param section The section.
+ * @return The address of the first record of the section.
+ */
+const void* SnapshotView::get_section(const SnapshotSection section) const
+{
+    return data_ + header_->sections[section].offset;
+};
+
+/**
+ * @param text The reference of a string.
+ * @return The string, a view of the mapping.
+ * @throw SnapshotWrongFormat if the reference is out of the blob.
+ */
+std::string_view SnapshotView::get_string(const SnapshotString& text) const
+{
+    const std::size_t n = get_size(SNAPSHOT_STRINGS);
+    if (text.offset > n || text.size > n - text.offset){throw SnapshotWrongFormat();}
+    return std::string_view(static_cast<const char*>(get_section(SNAPSHOT_STRINGS)) + text.offset, text.size);
+};
+
+/**
+ * @return The doubles of the interpolations.
+ */
+const double* SnapshotView::get_doubles() const
+{
+    return static_cast<const double*>(get_section(SNAPSHOT_DOUBLES));
+};
+
+/**
+ * @return The currency records.
+ */
+const SnapshotCurrency* SnapshotView::get_currencies() const
+{
+    return static_cast<const SnapshotCurrency*>(get_section(SNAPSHOT_CURRENCIES));
+};
+
+/**
+ * @return The risk factor records.
+ */
+const SnapshotRiskFactor* SnapshotView::get_risk_factors() const
+{
+    return static_cast<const SnapshotRiskFactor*>(get_section(SNAPSHOT_RISK_FACTORS));
+};
+
+/**
+ * @return The option records.
+ */
+const SnapshotOption* SnapshotView::get_options() const
+{
+    return static_cast<const SnapshotOption*>(get_section(SNAPSHOT_OPTIONS));
+};
+
+/**
+ * @return The future records.
+ */
+const SnapshotFuture* SnapshotView::get_futures() const
+{
+    return static_cast<const SnapshotFuture*>(get_section(SNAPSHOT_FUTURES));
+};
+
+/**
+ * @return The asset records.
+ */
+const SnapshotAsset* SnapshotView::get_assets() const
+{
+    return static_cast<const SnapshotAsset*>(get_section(SNAPSHOT_ASSETS));
+};
+
+/**
+ * @return The curve records.
+ */
+const SnapshotNelsonSiegel* SnapshotView::get_nelson_siegels() const
+{
+    return static_cast<const SnapshotNelsonSiegel*>(get_section(SNAPSHOT_NELSON_SIEGEL));
+};
+
+/**
+ * @return The SVI slice records.
+ */
+const SnapshotSVI* SnapshotView::get_svis() const
+{
+    return static_cast<const SnapshotSVI*>(get_section(SNAPSHOT_SVI));
+};
+
+/**
+ * @return The interpolation records.
+ */
+const SnapshotInterpolation* SnapshotView::get_interpolations() const
+{
+    return static_cast<const SnapshotInterpolation*>(get_section(SNAPSHOT_INTERPOLATIONS));
+};
+
+/**
+ * @return The registry entries.
+ */
+const SnapshotRegistryEntry* SnapshotView::get_registry_entries() const
+{
+    return static_cast<const SnapshotRegistryEntry*>(get_section(SNAPSHOT_REGISTRY));
+};
+
+/**
+ * @param i The index of the curve.
+ * @return The curve, a Nelson-Siegel curve is a Svensson curve with b3 = 0.
+ * @throw SnapshotUnknownRecord if the index is beyond the curves.
+ */
+NelsonSiegelSvensson SnapshotView::get_nelson_siegel(const std::size_t i) const
+{
+    if (i >= get_size(SNAPSHOT_NELSON_SIEGEL)){throw SnapshotUnknownRecord();}
+    const double* p = get_nelson_siegels()[i].parameters;
+    return NelsonSiegelSvensson(p[0], p[1], p[2], p[3], p[4], p[5]);
+};
+
+/**
+ * @param i The index of the slice.
+ * @return The slice.
+ * @throw SnapshotUnknownRecord if the index is beyond the slices.
+ * @throw SVIWrongParameterValue
+ */
+SVI SnapshotView::get_svi(const std::size_t i) const
+{
+    if (i >= get_size(SNAPSHOT_SVI)){throw SnapshotUnknownRecord();}
+    const double* p = get_svis()[i].parameters;
+    return SVI(p[0], p[1], p[2], p[3], p[4], p[5]);
+};
+
+/**
+ * @param i The index of the interpolation.
+ * @return The interpolation, built from its pillars.
+ * @throw SnapshotUnknownRecord if the index is beyond the interpolations.
+ * @throw SnapshotWrongFormat if the kind is unknown or the pillars are out of the doubles.
+ */
+std::unique_ptr<Interpolation2D> SnapshotView::get_interpolation(const std::size_t i) const
+{
+    if (i >= get_size(SNAPSHOT_INTERPOLATIONS)){throw SnapshotUnknownRecord();}
+    const SnapshotInterpolation& record = get_interpolations()[i];
+    const std::size_t n_doubles = get_size(SNAPSHOT_DOUBLES);
+    if (record.kind != SNAPSHOT_LINEAR_INTERPOLATION && record.kind != SNAPSHOT_CUBIC_SPLINE){throw SnapshotWrongFormat();}
+    if (record.n > n_doubles || record.x > n_doubles - record.n || record.y > n_doubles - record.n)
+    {
+        throw SnapshotWrongFormat();
+    }
+    const double* x = get_doubles() + record.x;
+    const double* y = get_doubles() + record.y;
+    if (record.kind == SNAPSHOT_CUBIC_SPLINE){return std::unique_ptr<Interpolation2D>(new CubicSpline2D(x, y, record.n));}
+    return std::unique_ptr<Interpolation2D>(new LinearInterpolation2D(x, y, record.n));
+};
+
+/**
+ * @brief Reads an index of a table.
+ * @param table The objects of the table.
+ * @param index The index.
+ * @return The object, null for SNAPSHOT_NULL_INDEX.
+ * @throw SnapshotWrongFormat if the index is out of the table.
+ */
+template <typename T>
+static std::shared_ptr<T> get_linked(const std::vector<std::shared_ptr<T>>& table, const std::uint32_t index)
+{
+    if (index == SNAPSHOT_NULL_INDEX){return nullptr;}
+    if (index >= table.size()){throw SnapshotWrongFormat();}
+    return table[index];
+};
+
+/**
+ * @brief Rebuilds the objects of the snapshot in the arena of a registry, registers the
+ * objects of the registry entries in their order, then every asset (with its quote currency and
+ * risk factor). The options and futures of the same expiry share one DateTime.
+ * @param registry The registry.
+ * @throw SnapshotWrongFormat if a link or a string is out of its table, or if the risk factor of
+ * an asset is not of the kind of the asset.
+ * @throw RegistryDuplicatedId if the registry holds other objects with the same ids.
+ */
+void SnapshotView::load(MarketRegistry& registry) const
+{
+    std::vector<std::shared_ptr<Currency>> currencies;
+    currencies.reserve(get_size(SNAPSHOT_CURRENCIES));
+    for (std::size_t i = 0; i < get_size(SNAPSHOT_CURRENCIES); ++i)
+    {
+        const SnapshotCurrency& record = get_currencies()[i];
+        currencies.push_back(registry.make<Currency>(std::string(get_string(record.code)), std::string(get_string(record.name))));
+    }
+    std::vector<std::shared_ptr<RiskFactor>> risk_factors;
+    risk_factors.reserve(get_size(SNAPSHOT_RISK_FACTORS));
+    for (std::size_t i = 0; i < get_size(SNAPSHOT_RISK_FACTORS); ++i)
+    {
+        const SnapshotRiskFactor& record = get_risk_factors()[i];
+        const std::shared_ptr<Currency> base = get_linked(currencies, record.base_currency);
+        std::shared_ptr<RiskFactor> risk_factor;
+        switch (record.kind)
+        {
+            case SNAPSHOT_RISK_FACTOR_CRYPTO:
+                risk_factor = registry.make<Crypto>(get_linked(currencies, record.counter_currency), base);
+                break;
+            case SNAPSHOT_RISK_FACTOR_FX:
+                risk_factor = registry.make<FX>(get_linked(currencies, record.counter_currency), base);
+                break;
+            case SNAPSHOT_RISK_FACTOR_INTEREST_RATE:
+                risk_factor = registry.make<InterestRate>(std::string(get_string(record.id)), base);
+                break;
+            default:
+                risk_factor = registry.make<RiskFactor>(std::string(get_string(record.id)), base);
+        }
+        risk_factors.push_back(risk_factor);
+    }
+    std::unordered_map<std::int64_t, std::shared_ptr<DateTime>> expiries;
+    auto get_expiry = [&](const std::int64_t ns)
+    {
+        std::shared_ptr<DateTime>& expiry = expiries[ns];
+        if (!expiry){expiry = registry.make<DateTime>(Timestamp{ns});}
+        return expiry;
+    };
+    std::vector<std::shared_ptr<Option>> options;
+    options.reserve(get_size(SNAPSHOT_OPTIONS));
+    for (std::size_t i = 0; i < get_size(SNAPSHOT_OPTIONS); ++i)
+    {
+        const SnapshotOption& record = get_options()[i];
+        const std::string id(get_string(record.id));
+        const std::shared_ptr<DateTime> expiry = get_expiry(record.expiry_ns);
+        const OptionType type = static_cast<OptionType>(record.type);
+        const DayCountConvention day_count = static_cast<DayCountConvention>(record.day_count);
+        const std::shared_ptr<Currency> currency = get_linked(currencies, record.strike_currency);
+        std::shared_ptr<Option> option;
+        if (record.tag == INSTRUMENT_EUROPEAN_VANILLA_OPTION)
+        {
+            option = registry.make<EuropeanVanillaOption>(id, expiry, type, record.strike, day_count, currency);
+        }
+        else if (record.tag == INSTRUMENT_AMERICAN_VANILLA_OPTION)
+        {
+            option = registry.make<AmericanVanillaOption>(id, expiry, type, record.strike, day_count, currency);
+        }
+        else {option = registry.make<Option>(id, expiry, type, record.strike, day_count, currency);}
+        options.push_back(option);
+    }
+    std::vector<std::shared_ptr<Future>> futures;
+    futures.reserve(get_size(SNAPSHOT_FUTURES));
+    for (std::size_t i = 0; i < get_size(SNAPSHOT_FUTURES); ++i)
+    {
+        const SnapshotFuture& record = get_futures()[i];
+        const std::string id(get_string(record.id));
+        if (record.perpetual){futures.push_back(registry.make<Future>(id));}
+        else
+        {
+            futures.push_back(registry.make<Future>(id, get_expiry(record.expiry_ns),
+                static_cast<DayCountConvention>(record.day_count)));
+        }
+    }
+    for (std::size_t i = 0; i < get_size(SNAPSHOT_REGISTRY); ++i)
+    {
+        const SnapshotRegistryEntry& entry = get_registry_entries()[i];
+        switch (entry.section)
+        {
+            case SNAPSHOT_CURRENCIES: registry.add_currency(get_linked(currencies, entry.index)); break;
+            case SNAPSHOT_RISK_FACTORS: registry.add_risk_factor(get_linked(risk_factors, entry.index)); break;
+            case SNAPSHOT_OPTIONS: registry.add_instrument(get_linked(options, entry.index)); break;
+            case SNAPSHOT_FUTURES: registry.add_instrument(get_linked(futures, entry.index)); break;
+            default: throw SnapshotWrongFormat();
+        }
+    }
+    auto get_risk_factor = [&](const std::uint32_t index, const SnapshotRiskFactorKind kind)
+    {
+        const std::shared_ptr<RiskFactor> risk_factor = get_linked(risk_factors, index);
+        if (risk_factor && get_risk_factors()[index].kind != kind){throw SnapshotWrongFormat();}
+        return risk_factor;
+    };
+    for (std::size_t i = 0; i < get_size(SNAPSHOT_ASSETS); ++i)
+    {
+        const SnapshotAsset& record = get_assets()[i];
+        const std::string id(get_string(record.id));
+        const std::shared_ptr<Currency> quote_currency = get_linked(currencies, record.quote_currency);
+        std::shared_ptr<Asset> asset;
+        switch (record.tag)
+        {
+            case ASSET_CRYPTO_SPOT:
+            {
+                const std::shared_ptr<Crypto> crypto = std::static_pointer_cast<Crypto>(
+                    get_risk_factor(record.risk_factor, SNAPSHOT_RISK_FACTOR_CRYPTO));
+                asset = registry.make<CryptoSpot>(id, crypto, quote_currency);
+                break;
+            }
+            case ASSET_CRYPTO_FUTURE:
+            {
+                const std::shared_ptr<Crypto> crypto = std::static_pointer_cast<Crypto>(
+                    get_risk_factor(record.risk_factor, SNAPSHOT_RISK_FACTOR_CRYPTO));
+                asset = registry.make<CryptoFuture>(id, crypto, quote_currency, get_linked(futures, record.future));
+                break;
+            }
+            case ASSET_CRYPTO_OPTION:
+            {
+                const std::shared_ptr<Crypto> crypto = std::static_pointer_cast<Crypto>(
+                    get_risk_factor(record.risk_factor, SNAPSHOT_RISK_FACTOR_CRYPTO));
+                if (record.future == SNAPSHOT_NULL_INDEX)
+                {
+                    asset = registry.make<CryptoOption>(id, crypto, quote_currency,
+                        get_linked(options, record.option), registry.get_arena());
+                }
+                else
+                {
+                    asset = registry.make<CryptoOption>(id, crypto, quote_currency,
+                        get_linked(options, record.option), get_linked(futures, record.future), registry.get_arena());
+                }
+                break;
+            }
+            case ASSET_ZERO_COUPON_BOND:
+            {
+                const std::shared_ptr<InterestRate> rate = std::static_pointer_cast<InterestRate>(
+                    get_risk_factor(record.risk_factor, SNAPSHOT_RISK_FACTOR_INTEREST_RATE));
+                asset = registry.make<ZeroCouponBond>(id, rate,
+                    static_cast<DayCountConvention>(record.day_count), get_expiry(record.expiry_ns));
+                break;
+            }
+            default:
+                throw SnapshotWrongFormat();
+        }
+        registry.add_asset(asset);
+    }
+};
@@ -0,0 +1,237 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <unordered_map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../../../../src/datastructure/datetime/datetime.h"
+#include "../../../../src/datastructure/market/riskfactors/riskfactors.h"
+#include "../../../../src/datastructure/market/instruments/options/options.h"
+#include "../../../../src/datastructure/market/instruments/futures/futures.h"
+#include "../../../../src/datastructure/market/assets/crypto/cryptoassets.h"
+#include "../../../../src/datastructure/market/assets/interestrate/irassets.h"
+#include "../../../../src/datastructure/market/registry/registry.h"
+#include "../../../../src/frameworks/nelsonsiegel/nelsonsiegel.h"
+#include "../../../../src/frameworks/svi/svi.h"
+#include "../../../../src/math/interpolation2D/linearinterpolation/linearinterplation.h"
+#include "../../../../src/math/interpolation2D/cubicspline/cubicspline.h"
+
+constexpr char SNAPSHOT_MAGIC[8] = {'A', 'R', 'B', 'S', 'N', 'A', 'P', '\0'};
+
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+constexpr std::uint32_t SNAPSHOT_NULL_INDEX = 0xFFFFFFFFu;
+
+class SnapshotIOError:  public std::exception
+{public: const char * what() const throw();};
+
+class SnapshotWrongFormat:  public std::exception
+{public: const char * what() const throw();};
+
+class SnapshotWrongVersion:  public std::exception
+{public: const char * what() const throw();};
+
+class SnapshotUnsupportedObject:  public std::exception
+{public: const char * what() const throw();};
+
+class SnapshotUnknownRecord:  public std::exception
+{public: const char * what() const throw();};
+
+enum SnapshotSection
+{
+    SNAPSHOT_STRINGS = 0,
+    SNAPSHOT_DOUBLES = 1,
+    SNAPSHOT_CURRENCIES = 2,
+    SNAPSHOT_RISK_FACTORS = 3,
+    SNAPSHOT_OPTIONS = 4,
+    SNAPSHOT_FUTURES = 5,
+    SNAPSHOT_ASSETS = 6,
+    SNAPSHOT_NELSON_SIEGEL = 7,
+    SNAPSHOT_SVI = 8,
+    SNAPSHOT_INTERPOLATIONS = 9,
+    SNAPSHOT_REGISTRY = 10,
+    SNAPSHOT_N_SECTIONS = 11
+};
+
+enum SnapshotRiskFactorKind
+{
+    SNAPSHOT_RISK_FACTOR_BASE = 0,
+    SNAPSHOT_RISK_FACTOR_INTEREST_RATE = 1,
+    SNAPSHOT_RISK_FACTOR_FX = 2,
+    SNAPSHOT_RISK_FACTOR_CRYPTO = 3
+};
+
+enum SnapshotInterpolationKind
+{
+    SNAPSHOT_LINEAR_INTERPOLATION = 0,
+    SNAPSHOT_CUBIC_SPLINE = 1
+};
+
+struct SnapshotString
+{
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+struct SnapshotSectionEntry
+{
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+
+struct SnapshotHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t n_sections;
+    std::uint64_t file_size;
+    SnapshotSectionEntry sections[SNAPSHOT_N_SECTIONS];
+};
+
+struct SnapshotCurrency
+{
+    SnapshotString code;
+    SnapshotString name;
+};
+
+struct SnapshotRiskFactor
+{
+    SnapshotString id;
+    std::uint32_t kind;
+    std::uint32_t base_currency;
+    std::uint32_t counter_currency;
+    std::uint32_t padding;
+};
+
+struct SnapshotOption
+{
+    SnapshotString id;
+    std::int64_t expiry_ns;
+    double strike;
+    std::int32_t type;
+    std::int32_t day_count;
+    std::uint32_t strike_currency;
+    std::uint32_t tag;
+};
+
+struct SnapshotFuture
+{
+    SnapshotString id;
+    std::int64_t expiry_ns;
+    std::int32_t day_count;
+    std::uint32_t perpetual;
+};
+
+struct SnapshotAsset
+{
+    SnapshotString id;
+    std::uint32_t tag;
+    std::uint32_t risk_factor;
+    std::uint32_t quote_currency;
+    std::uint32_t option;
+    std::uint32_t future;
+    std::int32_t day_count;
+    std::int64_t expiry_ns;
+};
+
+struct SnapshotNelsonSiegel
+{
+    SnapshotString id;
+    std::uint32_t svensson;
+    std::uint32_t padding;
+    double parameters[6];
+};
+
+struct SnapshotSVI
+{
+    SnapshotString id;
+    double parameters[6];
+};
+
+struct SnapshotInterpolation
+{
+    SnapshotString id;
+    std::uint32_t kind;
+    std::uint32_t padding;
+    std::uint64_t n;
+    std::uint64_t x;
+    std::uint64_t y;
+};
+
+struct SnapshotRegistryEntry
+{
+    std::uint32_t section;
+    std::uint32_t index;
+};
+
+class SnapshotWriter
+{
+    public:
+        SnapshotWriter(){};
+        ~SnapshotWriter(){};
+        void add_registry(const MarketRegistry& registry);
+        std::uint32_t add_currency(const std::shared_ptr<Currency> currency);
+        std::uint32_t add_risk_factor(const std::shared_ptr<RiskFactor> risk_factor);
+        std::uint32_t add_option(const std::shared_ptr<Option> option);
+        std::uint32_t add_future(const std::shared_ptr<Future> future);
+        std::uint32_t add_asset(const std::shared_ptr<Asset> asset);
+        std::uint32_t add_nelson_siegel(const std::string& id, const NelsonSiegel& model);
+        std::uint32_t add_nelson_siegel(const std::string& id, const NelsonSiegelSvensson& model);
+        std::uint32_t add_svi(const std::string& id, const SVI& model);
+        std::uint32_t add_interpolation(const std::string& id, Interpolation2D& interpolation);
+        void write(const std::string& path) const;
+    private:
+        SnapshotString add_string(const std::string& text);
+        std::vector<char> strings_;
+        std::vector<double> doubles_;
+        std::vector<SnapshotCurrency> currencies_;
+        std::vector<SnapshotRiskFactor> risk_factors_;
+        std::vector<SnapshotOption> options_;
+        std::vector<SnapshotFuture> futures_;
+        std::vector<SnapshotAsset> assets_;
+        std::vector<SnapshotNelsonSiegel> nelson_siegels_;
+        std::vector<SnapshotSVI> svis_;
+        std::vector<SnapshotInterpolation> interpolations_;
+        std::vector<SnapshotRegistryEntry> registry_entries_;
+        std::unordered_map<const void*, std::uint32_t> indices_;
+};
+
+class SnapshotView
+{
+    public:
+        SnapshotView(const std::string& path);
+        SnapshotView(const SnapshotView&) = delete;
+        SnapshotView& operator=(const SnapshotView&) = delete;
+        ~SnapshotView();
+        std::uint32_t get_version() const;
+        std::size_t get_size(const SnapshotSection section) const;
+        std::string_view get_string(const SnapshotString& text) const;
+        const double* get_doubles() const;
+        const SnapshotCurrency* get_currencies() const;
+        const SnapshotRiskFactor* get_risk_factors() const;
+        const SnapshotOption* get_options() const;
+        const SnapshotFuture* get_futures() const;
+        const SnapshotAsset* get_assets() const;
+        const SnapshotNelsonSiegel* get_nelson_siegels() const;
+        const SnapshotSVI* get_svis() const;
+        const SnapshotInterpolation* get_interpolations() const;
+        const SnapshotRegistryEntry* get_registry_entries() const;
+        NelsonSiegelSvensson get_nelson_siegel(const std::size_t i) const;
+        SVI get_svi(const std::size_t i) const;
+        std::unique_ptr<Interpolation2D> get_interpolation(const std::size_t i) const;
+        void load(MarketRegistry& registry) const;
+    private:
+        const void* get_section(const SnapshotSection section) const;
+        const char* data_;
+        std::size_t size_;
+        const SnapshotHeader* header_;
+};
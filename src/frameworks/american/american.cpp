@@ -0,0 +1,364 @@
+#include "american.h"
+
+/**
+* @file american.h
+* @brief This file defines the Crank-Nicolson finite difference pricer of American vanilla options.
+*
+* References :
+* - "The valuation of American put options", Brennan, Schwartz, 1977.
+* - "Pricing American options by the projected SOR method", Cryer, 1971.
+* - "Time-stepping and the convergence of Crank-Nicolson schemes", Rannacher, 1984.
+*/
+
+/**
+ * @class AmericanFiniteDifferenceWrongGrid
+ * @brief Definition of the error when the grid has less than 5 space points or 2 time steps.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * AmericanFiniteDifferenceWrongGrid::what() const throw(){
+    return "The grid must have at least 5 space points and 2 time steps.";
+};
+
+/**
+ * @class AmericanFiniteDifferenceNonPositiveParameter
+ * @brief Definition of the error when the spot, a strike, the volatility or the year fraction 
+ * is not positive.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * AmericanFiniteDifferenceNonPositiveParameter::what() const throw(){
+    return "The spot, the strikes, the volatility and the year fraction must be positive.";
+};
+
+/**
+ * @enum AmericanSolver
+ * @brief The solver of the linear complementarity problem of a time step: the Brennan-Schwartz
+ * projected tridiagonal elimination, exact in one pass for the vanilla payoffs (which have a 
+ * single exercise boundary), or the projected SOR, iterative and valid for any payoff.
+ */
+
+/**
+ * @struct AmericanGreeks
+ * @brief The price, delta, gamma and theta of an American option, read off the grid, and the 
+ * number of solver iterations of the backward induction (one per step for Brennan-Schwartz).
+ */
+
+/**
+ * @struct AmericanFiniteDifference
+ * @brief The American vanilla pricer under the Black-Scholes dynamics.
+ *
+ * By homogeneity V(S, K, tau) = K*v(log(S/K), tau), where v is the option of unit strike: 
+ * one backward induction of v on a uniform grid of log-moneyness prices every strike of a 
+ * chain with the same expiry and type, each one is read off the grid at log(S/K) with a 
+ * quadratic interpolation which also gives delta and gamma, theta comes from the last two time
+ * layers. The scheme is Crank-Nicolson (with two fully implicit first steps to damp the payoff 
+ * kink), the early exercise constraint v >= payoff is solved at each step by the Brennan-Schwartz
+ * elimination (default) or by projected SOR started from the previous layer (see AmericanSolver).
+ * The grid and the workspace are kept between the solves.
+ */
+
+ /**
+ * @var std::size_t AmericanFiniteDifference::n_space_
+ * @brief The number of space points of the grid.
+ */
+
+ /**
+ * @var std::size_t AmericanFiniteDifference::n_time_
+ * @brief The number of time steps.
+ */
+
+ /**
+ * @var AmericanSolver AmericanFiniteDifference::solver_
+ * @brief The solver of the time steps (AMERICAN_BRENNAN_SCHWARTZ by default).
+ */
+
+ /**
+ * @var double AmericanFiniteDifference::n_std_
+ * @brief The number of standard deviations sigma*sqrt(T) of the grid beyond the moneyness of 
+ * the extreme strikes (5 by default).
+ */
+
+ /**
+ * @var double AmericanFiniteDifference::omega_
+ * @brief The relaxation factor of the PSOR (1.5 by default).
+ */
+
+ /**
+ * @var double AmericanFiniteDifference::tolerance_
+ * @brief The maximal change of a PSOR sweep at convergence, for a unit strike (1e-10 by default).
+ */
+
+ /**
+ * @var int AmericanFiniteDifference::max_iterations_
+ * @brief The maximal number of PSOR sweeps per time step (500 by default).
+ */
+
+/**
+ * @brief The main constructor.
+ * @param n_space The number of space points of the grid.
+ * @param n_time The number of time steps.
+ * @throw AmericanFiniteDifferenceWrongGrid
+ */
+AmericanFiniteDifference::AmericanFiniteDifference(std::size_t n_space, std::size_t n_time):
+    n_space_(n_space), n_time_(n_time), solver_(AMERICAN_BRENNAN_SCHWARTZ), n_std_(5.0), omega_(1.5), tolerance_(1e-10), max_iterations_(500),
+    x_min_(0.0), dx_(0.0), dt_(0.0), iterations_(0), 
+    payoff_(n_space), v_(n_space), v_previous_(n_space), rhs_(n_space), pivot_(n_space), multiplier_(n_space)
+{
+    if (n_space_<5 || n_time_<2){throw AmericanFiniteDifferenceWrongGrid();}
+};
+
+/**
+ * @brief Values of the unit strike option far from the money, the exercise value or the 
+ * European asymptote whichever is larger.
+ * @param x The log-moneyness.
+ * @param tau The time to expiry.
+ * @param r The risk free rate.
+ * @param q The dividend rate.
+ * @param call_put_flag 1 for a call, -1 for a put.
+ * @return The boundary value.
+ */
+static double boundary_value(double x, double tau, double r, double q, int call_put_flag)
+{
+    const double exercise = std::max(call_put_flag*(exp(x) - 1), 0.0);
+    const double european = call_put_flag*(exp(x - q*tau) - exp(-r*tau));
+    return std::max(exercise, european);
+};
+
+/**
+ * @brief Solves the unit strike option on a grid of log-moneyness covering [x_low, x_high] 
+ * plus n_std_ standard deviations on each side, by backward induction from expiry.
+ * @param r The risk free rate.
+ * @param q The dividend rate.
+ * @param sigma The volatility.
+ * @param T The year fraction to expiry.
+ * @param call_put_flag 1 for a call, -1 for a put.
+ * @param x_low The lowest log-moneyness log(S/K) to price.
+ * @param x_high The highest log-moneyness log(S/K) to price.
+ * @throw AmericanFiniteDifferenceNonPositiveParameter
+ */
+void AmericanFiniteDifference::solve(double r, double q, double sigma, double T, int call_put_flag, double x_low, double x_high)
+{
+    if (!(sigma>0 && T>0)){throw AmericanFiniteDifferenceNonPositiveParameter();}
+    const std::size_t n = n_space_;
+    const double width = n_std_*sigma*sqrt(T);
+    x_min_ = x_low - width;
+    dx_ = (x_high - x_low + 2*width)/(n - 1);
+    dt_ = T/n_time_;
+    iterations_ = 0;
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        payoff_[i] = std::max(call_put_flag*(exp(x_min_ + i*dx_) - 1), 0.0);
+        v_[i] = payoff_[i];
+    }
+
+    const double a = .5*sigma*sigma/(dx_*dx_);
+    const double b = (r - q - .5*sigma*sigma)/(2*dx_);
+    const double lower = a - b;
+    const double middle = -2*a - r;
+    const double upper = a + b;
+
+    for (std::size_t step = 0; step < n_time_; ++step)
+    {
+        const double theta = step < 2 ? 1.0 : .5;
+        const double tau = (step + 1)*dt_;
+        const double explicit_factor = (1 - theta)*dt_;
+        const double implicit_factor = theta*dt_;
+        std::swap(v_, v_previous_);
+
+        for (std::size_t i = 1; i + 1 < n; ++i)
+        {
+            rhs_[i] = v_previous_[i] + explicit_factor*(
+                lower*v_previous_[i-1] + middle*v_previous_[i] + upper*v_previous_[i+1]);
+            v_[i] = v_previous_[i];
+        }
+        v_[0] = boundary_value(x_min_, tau, r, q, call_put_flag);
+        v_[n-1] = boundary_value(x_min_ + (n - 1)*dx_, tau, r, q, call_put_flag);
+
+        const double diagonal = 1 - implicit_factor*middle;
+        const double off_lower = -implicit_factor*lower;
+        const double off_upper = -implicit_factor*upper;
+        if (solver_==AMERICAN_BRENNAN_SCHWARTZ)
+        {
+            if (step==0 || step==2)
+            {
+                if (call_put_flag==CALL)
+                {
+                    pivot_[1] = 1/diagonal;
+                    for (std::size_t i = 2; i + 1 < n; ++i)
+                    {
+                        multiplier_[i] = off_lower*pivot_[i-1];
+                        pivot_[i] = 1/(diagonal - multiplier_[i]*off_upper);
+                    }
+                }
+                else
+                {
+                    pivot_[n-2] = 1/diagonal;
+                    for (std::size_t i = n-3; i >= 1; --i)
+                    {
+                        multiplier_[i] = off_upper*pivot_[i+1];
+                        pivot_[i] = 1/(diagonal - multiplier_[i]*off_lower);
+                    }
+                }
+            }
+            rhs_[1] -= off_lower*v_[0];
+            rhs_[n-2] -= off_upper*v_[n-1];
+            if (call_put_flag==CALL)
+            {
+                for (std::size_t i = 2; i + 1 < n; ++i){rhs_[i] -= multiplier_[i]*rhs_[i-1];}
+                v_[n-2] = std::max(payoff_[n-2], rhs_[n-2]*pivot_[n-2]);
+                for (std::size_t i = n-3; i >= 1; --i){v_[i] = std::max(payoff_[i], (rhs_[i] - off_upper*v_[i+1])*pivot_[i]);}
+            }
+            else
+            {
+                for (std::size_t i = n-3; i >= 1; --i){rhs_[i] -= multiplier_[i]*rhs_[i+1];}
+                v_[1] = std::max(payoff_[1], rhs_[1]*pivot_[1]);
+                for (std::size_t i = 2; i + 1 < n; ++i){v_[i] = std::max(payoff_[i], (rhs_[i] - off_lower*v_[i-1])*pivot_[i]);}
+            }
+            iterations_++;
+            continue;
+        }
+        const double inverse_diagonal = 1/diagonal;
+        for (int k = 0; k < max_iterations_; ++k)
+        {
+            double change = 0.0;
+            for (std::size_t i = 1; i + 1 < n; ++i)
+            {
+                const double y = (rhs_[i] - off_lower*v_[i-1] - off_upper*v_[i+1])*inverse_diagonal;
+                const double updated = std::max(payoff_[i], v_[i] + omega_*(y - v_[i]));
+                change = std::max(change, fabs(updated - v_[i]));
+                v_[i] = updated;
+            }
+            iterations_++;
+            if (change <= tolerance_){break;}
+        }
+    }
+};
+
+/**
+ * @brief Reads an option off the last solved grid.
+ * @param S The spot.
+ * @param K The strike.
+ * @return The price, delta, gamma and theta.
+ * @throw AmericanFiniteDifferenceNonPositiveParameter
+ */
+AmericanGreeks AmericanFiniteDifference::get_greeks(double S, double K)
+{
+    if (!(S>0 && K>0)){throw AmericanFiniteDifferenceNonPositiveParameter();}
+    const double x = log(S/K);
+    const double position = (x - x_min_)/dx_;
+    const std::size_t j = std::min(std::max(static_cast<long long>(std::lround(position)), 1LL), 
+        static_cast<long long>(n_space_) - 2);
+    const double u = position - j;
+
+    const double first = .5*(v_[j+1] - v_[j-1]);
+    const double second = v_[j+1] - 2*v_[j] + v_[j-1];
+    const double value = v_[j] + u*first + .5*u*u*second;
+    const double v_x = (first + u*second)/dx_;
+    const double v_xx = second/(dx_*dx_);
+    const double previous = v_previous_[j] + u*.5*(v_previous_[j+1] - v_previous_[j-1]) + 
+        .5*u*u*(v_previous_[j+1] - 2*v_previous_[j] + v_previous_[j-1]);
+
+    return AmericanGreeks{K*value, K*v_x/S, K*(v_xx - v_x)/(S*S), K*(previous - value)/dt_, iterations_};
+};
+
+/**
+ * @brief Prices one American option.
+ * @param S The spot.
+ * @param K The strike.
+ * @param r The risk free rate.
+ * @param q The dividend rate.
+ * @param sigma The volatility.
+ * @param T The year fraction to expiry.
+ * @param call_put_flag 1 for a call, -1 for a put.
+ * @return The price, delta, gamma and theta.
+ * @throw AmericanFiniteDifferenceNonPositiveParameter
+ */
+AmericanGreeks AmericanFiniteDifference::price(double S, double K, double r, double q, double sigma, double T, int call_put_flag)
+{
+    price_chain(S, &K, 1, r, q, sigma, T, call_put_flag, nullptr);
+    return get_greeks(S, K);
+};
+
+/**
+ * @brief Prices the strikes of a chain with the same expiry and type from one backward induction.
+ * @param S The spot.
+ * @param K The strikes.
+ * @param n The number of strikes.
+ * @param r The risk free rate.
+ * @param q The dividend rate.
+ * @param sigma The volatility.
+ * @param T The year fraction to expiry.
+ * @param call_put_flag 1 for a call, -1 for a put.
+ * @param out The n prices and greeks, or nullptr to only solve the grid.
+ * @throw AmericanFiniteDifferenceNonPositiveParameter
+ */
+void AmericanFiniteDifference::price_chain(
+    double S, 
+    const double* K, 
+    std::size_t n, 
+    double r, 
+    double q, 
+    double sigma, 
+    double T, 
+    int call_put_flag, 
+    AmericanGreeks* out)
+{
+    if (!(S>0) || n==0){throw AmericanFiniteDifferenceNonPositiveParameter();}
+    double x_low = std::numeric_limits<double>::infinity();
+    double x_high = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (!(K[i]>0)){throw AmericanFiniteDifferenceNonPositiveParameter();}
+        x_low = std::min(x_low, log(S/K[i]));
+        x_high = std::max(x_high, log(S/K[i]));
+    }
+    solve(r, q, sigma, T, call_put_flag, x_low, x_high);
+    if (out){for (std::size_t i = 0; i < n; ++i){out[i] = get_greeks(S, K[i]);}}
+};
+
+/**
+ * @brief Prices American options, one backward induction per expiry and type.
+ * @param options The options.
+ * @param reference_timestamp The pricing time.
+ * @param S The spot.
+ * @param r The risk free rate.
+ * @param q The dividend rate.
+ * @param sigma The volatility.
+ * @return The prices and greeks, in the order of the options.
+ * @throw NonPositiveYearFractionError
+ * @throw AmericanFiniteDifferenceNonPositiveParameter
+ */
+std::vector<AmericanGreeks> AmericanFiniteDifference::price_options(
+    const std::vector<std::shared_ptr<AmericanVanillaOption>>& options, 
+    const Timestamp reference_timestamp, 
+    double S, 
+    double r, 
+    double q, 
+    double sigma)
+{
+    std::map<std::pair<long long, int>, std::vector<std::size_t>> groups;
+    for (std::size_t i = 0; i < options.size(); ++i)
+    {
+        groups[std::make_pair(options[i]->get_expiry_timestamp().ns, static_cast<int>(options[i]->get_option_type()))].push_back(i);
+    }
+    std::vector<AmericanGreeks> result(options.size());
+    std::vector<double> strikes;
+    std::vector<AmericanGreeks> greeks;
+    for (const auto& group : groups)
+    {
+        const std::vector<std::size_t>& indices = group.second;
+        strikes.resize(indices.size());
+        greeks.resize(indices.size());
+        for (std::size_t k = 0; k < indices.size(); ++k){strikes[k] = options[indices[k]]->get_strike();}
+        const double T = options[indices[0]]->get_year_fraction(reference_timestamp);
+        price_chain(S, strikes.data(), strikes.size(), r, q, sigma, T, group.first.second, greeks.data());
+        for (std::size_t k = 0; k < indices.size(); ++k){result[indices[k]] = greeks[k];}
+    }
+    return result;
+};
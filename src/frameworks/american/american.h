@@ -0,0 +1,75 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <map>
+#include <algorithm>
+#include <limits>
+#include "../../datastructure/market/instruments/options/options.h"
+
+class AmericanFiniteDifferenceWrongGrid:  public std::exception
+{public: const char * what() const throw();};
+
+class AmericanFiniteDifferenceNonPositiveParameter:  public std::exception
+{public: const char * what() const throw();};
+
+enum AmericanSolver
+{
+    AMERICAN_BRENNAN_SCHWARTZ = 0,
+    AMERICAN_PSOR = 1
+};
+
+struct AmericanGreeks
+{
+    double price;
+    double delta;
+    double gamma;
+    double theta;
+    int iterations;
+};
+
+struct AmericanFiniteDifference
+{
+    std::size_t n_space_;
+    std::size_t n_time_;
+    AmericanSolver solver_;
+    double n_std_;
+    double omega_;
+    double tolerance_;
+    int max_iterations_;
+    double x_min_;
+    double dx_;
+    double dt_;
+    int iterations_;
+    std::vector<double> payoff_;
+    std::vector<double> v_;
+    std::vector<double> v_previous_;
+    std::vector<double> rhs_;
+    std::vector<double> pivot_;
+    std::vector<double> multiplier_;
+    AmericanFiniteDifference(std::size_t n_space, std::size_t n_time);
+    ~AmericanFiniteDifference(){};
+    void solve(double r, double q, double sigma, double T, int call_put_flag, double x_low, double x_high);
+    AmericanGreeks get_greeks(double S, double K);
+    AmericanGreeks price(double S, double K, double r, double q, double sigma, double T, int call_put_flag);
+    void price_chain(
+        double S, 
+        const double* K, 
+        std::size_t n, 
+        double r, 
+        double q, 
+        double sigma, 
+        double T, 
+        int call_put_flag, 
+        AmericanGreeks* out
+    );
+    std::vector<AmericanGreeks> price_options(
+        const std::vector<std::shared_ptr<AmericanVanillaOption>>& options, 
+        const Timestamp reference_timestamp, 
+        double S, 
+        double r, 
+        double q, 
+        double sigma
+    );
+};
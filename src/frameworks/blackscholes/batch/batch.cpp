@@ -0,0 +1,536 @@
+#include "batch.h"
+
+/**
+* @file batch.h
+* @brief This file defines the batched (structure of arrays) version of the
+* Black Scholes closed form framework.
+*
+* Every quantity is computed with the same expressions, in the same order, as
+* BlackScholesClosedForm so that the batched results are identical to the scalar ones
+* (as long as both are compiled with the same floating point contraction flags).
+* black_scholes_batch_vectorized trades this exactness for the SIMD exponential, logarithm and
+* normal pdf/cdf kernels.
+*
+* @see BlackScholesClosedForm
+*/
+
+/**
+ * @struct BlackScholesBatchInput
+ * @brief The structure of arrays holding the inputs of a batch of options.
+ *
+ * Every array is owned by the caller and must hold at least n values.
+ */
+
+/**
+ * @var std::size_t BlackScholesBatchInput::n
+ * @brief The number of options in the batch.
+ */
+
+/**
+ * @var const double* BlackScholesBatchInput::S
+ * @brief The spot/future prices of the underlyings.
+ */
+
+/**
+ * @var const double* BlackScholesBatchInput::K
+ * @brief The strike prices of the options.
+ */
+
+/**
+ * @var const double* BlackScholesBatchInput::r
+ * @brief The interest rates.
+ */
+
+/**
+ * @var const double* BlackScholesBatchInput::q
+ * @brief The carry cost rates.
+ */
+
+/**
+ * @var const double* BlackScholesBatchInput::sigma
+ * @brief The implied volatilities.
+ */
+
+/**
+ * @var const double* BlackScholesBatchInput::T
+ * @brief The year fractions.
+ */
+
+/**
+ * @var const bool* BlackScholesBatchInput::is_call
+ * @brief The call (True) / put (False) indicators.
+ */
+
+/**
+ * @var const bool* BlackScholesBatchInput::is_future
+ * @brief The future (True) / spot (False) underlying indicators.
+ */
+
+/**
+ * @var const double* BlackScholesBatchInput::df
+ * @brief The discount factors exp(-r*T), optional: if null they are computed from r and T. 
+ * A yield curve cache (see NelsonSiegelCurve) can hand them out directly, r is then only 
+ * used by the theta and the rho.
+ */
+
+/**
+ * @struct BlackScholesBatchOutput
+ * @brief The structure of arrays receiving the price and the Greeks of a batch of options.
+ *
+ * Every array is owned by the caller and must hold at least n values. Only the arrays
+ * selected with the BlackScholesGreek bitmask are written, the other ones can be null.
+ * The bad input mask is always written and can not be null.
+ *
+ * @see BlackScholesGreek
+ */
+
+/**
+ * @var unsigned char* BlackScholesBatchOutput::bad_input
+ * @brief The bad input mask: 1 if the option inputs are invalid, 0 if not.
+ */
+
+/**
+ * @brief Checks the inputs the scalar BlackScholesClosedForm constructor would reject.
+ * Not-a-number values are rejected as well.
+ * @param sigma The implied volatility.
+ * @param T The year fraction.
+ * @return True if the inputs are invalid, false else.
+ * @see BlackScholesNonPositiveImpliedVolatility
+ * @see BlackScholesNonPositiveYearFraction
+ */
+bool is_black_scholes_bad_input(const double sigma, const double T)
+{
+    return !(sigma>0) || !(T>0);
+};
+
+/**
+ * @struct BlackScholesBatchTerms
+ * @brief The intermediate terms of one option shared by the price and every Greek.
+ */
+struct BlackScholesBatchTerms
+{
+    double S; 
+    double K; 
+    double r; 
+    double sigma; 
+    double T; 
+    int future_flag; 
+    int call_put_flag; 
+    double mu; 
+    double df; 
+    double drift; 
+    double F; 
+    double sqrt_T; 
+    double d1; 
+    double d2; 
+};
+
+/**
+ * @brief Computes the intermediate terms of the option i, except the normal pdf/cdf values.
+ * @param input The structure of arrays holding the inputs.
+ * @param i The option index.
+ * @return The intermediate terms.
+ */
+static BlackScholesBatchTerms compute_terms(const BlackScholesBatchInput& input, const std::size_t i)
+{
+    BlackScholesBatchTerms t;
+    t.S = input.S[i];
+    t.K = input.K[i];
+    t.r = input.r[i];
+    t.sigma = input.sigma[i];
+    t.T = input.T[i];
+    t.future_flag = input.is_future[i] ? 0 : 1;
+    t.call_put_flag = input.is_call[i] ? 1 : -1;
+    t.mu = t.future_flag*(t.r-input.q[i]);
+    t.df = input.df ? input.df[i] : exp(-t.r*t.T);
+    t.drift = exp(t.mu*t.T);
+    t.F = t.S*t.drift;
+    t.sqrt_T = sqrt(t.T);
+    t.d1 = (log(t.F/t.K) + t.T*.5*t.sigma*t.sigma)/(t.sigma*t.sqrt_T);
+    t.d2 = t.d1 - t.sigma*t.sqrt_T;
+    return t;
+};
+
+/**
+ * @brief Flags the option i as a bad input and sets its selected outputs to NaN.
+ * @param output The structure of arrays receiving the outputs.
+ * @param i The option index.
+ * @param greeks The BlackScholesGreek bitmask of the quantities to compute.
+ */
+static void write_bad_input(const BlackScholesBatchOutput& output, const std::size_t i, const int greeks)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    output.bad_input[i] = 1;
+    if (greeks & BS_PRICE){output.price[i] = nan;}
+    if (greeks & BS_DELTA){output.delta[i] = nan;}
+    if (greeks & BS_GAMMA){output.gamma[i] = nan;}
+    if (greeks & BS_THETA){output.theta[i] = nan;}
+    if (greeks & BS_VEGA){output.vega[i] = nan;}
+    if (greeks & BS_RHO){output.rho[i] = nan;}
+    if (greeks & BS_EPSILON){output.epsilon[i] = nan;}
+    if (greeks & BS_VANNA){output.vanna[i] = nan;}
+    if (greeks & BS_VOLGA){output.volga[i] = nan;}
+    if (greeks & BS_CHARM){output.charm[i] = nan;}
+    if (greeks & BS_VETA){output.veta[i] = nan;}
+    if (greeks & BS_ZOMMA){output.zomma[i] = nan;}
+    if (greeks & BS_SPEED){output.speed[i] = nan;}
+    if (greeks & BS_COLOR){output.color[i] = nan;}
+    if (greeks & BS_ULTIMA){output.ultima[i] = nan;}
+    if (greeks & BS_DUAL_DELTA){output.dual_delta[i] = nan;}
+    if (greeks & BS_DUAL_GAMMA){output.dual_gamma[i] = nan;}
+};
+
+/**
+ * @brief Writes the price and the selected Greeks of the option i, with the same expressions 
+ * as the BlackScholesClosedForm methods.
+ * @param output The structure of arrays receiving the outputs.
+ * @param i The option index.
+ * @param greeks The BlackScholesGreek bitmask of the quantities to compute.
+ * @param t The intermediate terms of the option.
+ * @param nd1 The standard normal pdf of d1.
+ * @param nd2 The standard normal pdf of d2.
+ * @param Nd1 The standard normal cdf of call_put_flag*d1.
+ * @param Nd2 The standard normal cdf of call_put_flag*d2.
+ */
+static void write_greeks(
+    const BlackScholesBatchOutput& output, const std::size_t i, const int greeks, 
+    const BlackScholesBatchTerms& t, const double nd1, const double nd2, 
+    const double Nd1, const double Nd2)
+{
+    const double K = t.K;
+    const double r = t.r;
+    const double sigma = t.sigma;
+    const double T = t.T;
+    const int future_flag = t.future_flag;
+    const int call_put_flag = t.call_put_flag;
+    const double mu = t.mu;
+    const double df = t.df;
+    const double drift = t.drift;
+    const double F = t.F;
+    const double sqrt_T = t.sqrt_T;
+    const double d1 = t.d1;
+    const double d2 = t.d2;
+
+    output.bad_input[i] = 0;
+    const double price = df*call_put_flag*(F*Nd1 - K*Nd2);
+    const double gamma = df*drift*drift*nd1/(F*sigma*sqrt_T);
+    const double vega = F*df*nd1*sqrt_T;
+
+    if (greeks & BS_PRICE){output.price[i] = price;}
+    if (greeks & BS_DELTA){output.delta[i] = df*call_put_flag*drift*Nd1;}
+    if (greeks & BS_GAMMA){output.gamma[i] = gamma;}
+    if (greeks & BS_THETA)
+    {
+        double term1 = -F*df*nd1*sigma/(2*sqrt_T);
+        double term2 = -call_put_flag*r*K*df*Nd2;
+        double term3 = call_put_flag*(r-mu)*F*df*Nd1;
+        output.theta[i] = term1+term2+term3;
+    }
+    if (greeks & BS_VEGA){output.vega[i] = vega;}
+    if (greeks & BS_RHO)
+    {
+        if (future_flag == 0){output.rho[i] = -T*df*price;}
+        else{output.rho[i] = call_put_flag*K*T*Nd2*df;}
+    }
+    if (greeks & BS_EPSILON)
+    {
+        if (future_flag == 0){output.epsilon[i] = 0.0;}
+        else{output.epsilon[i] = -call_put_flag*F*T*Nd1*df;}
+    }
+    if (greeks & BS_VANNA){output.vanna[i] = -df*drift*nd1*d2/sigma;}
+    if (greeks & BS_VOLGA){output.volga[i] = vega*d1*d2/sigma;}
+    if (greeks & BS_CHARM)
+    {
+        double term1 = (mu-r)*df*drift*Nd1;
+        double term2 = (2*mu*T - sigma*d2*sqrt_T)/(2*T*sigma*sqrt_T);
+        double term3 = df*drift*nd1;
+        output.charm[i] = call_put_flag*term1 - term2*term3;
+    }
+    if (greeks & BS_VETA)
+    {
+        double term1 = -F*df*nd1*sqrt_T;
+        double term2 = (r-mu)+mu*d1/(sigma*sqrt_T);
+        double term3 = (1+d1*d2)/(2*T);
+        output.veta[i] = term1*(term2-term3);
+    }
+    if (greeks & BS_ZOMMA){output.zomma[i] = gamma*(d1*d2-1)/sigma;}
+    if (greeks & BS_SPEED)
+    {
+        double term1 = -drift*gamma*(1+d1/(sigma*sqrt_T));
+        output.speed[i] = term1/F;
+    }
+    if (greeks & BS_COLOR)
+    {
+        double term1 = d1*(2*mu*T - d2*sigma*sqrt_T)/(sigma*sqrt_T);
+        output.color[i] = gamma*(2*(r-mu) + 1 + term1)/(2*T);
+    }
+    if (greeks & BS_ULTIMA)
+    {
+        output.ultima[i] = -vega*(d1*d2*(1-d1*d2) + d1*d1 + d2*d2)/(sigma*sigma);
+    }
+    if (greeks & BS_DUAL_DELTA){output.dual_delta[i] = -call_put_flag*df*Nd2;}
+    if (greeks & BS_DUAL_GAMMA){output.dual_gamma[i] = df*nd2/(K*sigma*sqrt_T);}
+};
+
+/**
+ * @brief Computes the price and the selected Greeks of a batch of european vanilla options
+ * in a single pass.
+ *
+ * The function does not allocate and does not throw: the options with invalid inputs
+ * are flagged in the bad input mask and their selected outputs are set to NaN.
+ * The results are identical to the BlackScholesClosedForm ones.
+ *
+ * @param input The structure of arrays holding the inputs.
+ * @param output The structure of arrays receiving the outputs.
+ * @param greeks The BlackScholesGreek bitmask of the quantities to compute.
+ * @return The number of options with invalid inputs.
+ * @see BlackScholesClosedForm
+ */
+std::size_t black_scholes_batch(
+    const BlackScholesBatchInput& input,
+    const BlackScholesBatchOutput& output,
+    const int greeks)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_PRICING);
+    NormalDistribution stdnorm = NormalDistribution();
+    std::size_t n_bad = 0;
+
+    for (std::size_t i = 0; i < input.n; ++i)
+    {
+        if (is_black_scholes_bad_input(input.sigma[i], input.T[i]))
+        {
+            write_bad_input(output, i, greeks);
+            n_bad++;
+            continue;
+        }
+        const BlackScholesBatchTerms t = compute_terms(input, i);
+        write_greeks(
+            output, i, greeks, t, 
+            stdnorm.pdf(t.d1), 
+            stdnorm.pdf(t.d2), 
+            stdnorm.cdf(t.call_put_flag*t.d1), 
+            stdnorm.cdf(t.call_put_flag*t.d2));
+    }
+    ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_INSTRUMENTS_PRICED, input.n - n_bad);
+    return n_bad;
+};
+
+static_assert(BLACK_SCHOLES_BATCH_BLOCK % SIMD_WIDTH == 0, "The blocks must hold whole SIMD vectors.");
+
+/**
+ * @struct BlackScholesBatchBlock
+ * @brief The intermediate terms of a block of BLACK_SCHOLES_BATCH_BLOCK options as a structure 
+ * of arrays, so that they are computed with the simd_* functions. The lanes of the invalid 
+ * options and those past the end of the block hold a valid dummy option, S = K = sigma = T = 1.
+ *
+ * x holds the arguments of the normal pdf/cdf values: d1, d2, call_put_flag*d1 and 
+ * call_put_flag*d2, one block after the other.
+ */
+struct BlackScholesBatchBlock
+{
+    double S[BLACK_SCHOLES_BATCH_BLOCK];
+    double K[BLACK_SCHOLES_BATCH_BLOCK];
+    double r[BLACK_SCHOLES_BATCH_BLOCK];
+    double q[BLACK_SCHOLES_BATCH_BLOCK];
+    double sigma[BLACK_SCHOLES_BATCH_BLOCK];
+    double T[BLACK_SCHOLES_BATCH_BLOCK];
+    double future_flag[BLACK_SCHOLES_BATCH_BLOCK];
+    double call_put_flag[BLACK_SCHOLES_BATCH_BLOCK];
+    double mu[BLACK_SCHOLES_BATCH_BLOCK];
+    double df[BLACK_SCHOLES_BATCH_BLOCK];
+    double drift[BLACK_SCHOLES_BATCH_BLOCK];
+    double F[BLACK_SCHOLES_BATCH_BLOCK];
+    double sqrt_T[BLACK_SCHOLES_BATCH_BLOCK];
+    double x[4*BLACK_SCHOLES_BATCH_BLOCK];
+    double pdfs[2*BLACK_SCHOLES_BATCH_BLOCK];
+    double cdfs[2*BLACK_SCHOLES_BATCH_BLOCK];
+    bool bad[BLACK_SCHOLES_BATCH_BLOCK];
+};
+
+/**
+ * @brief Loads the inputs of a block of options, the invalid ones replaced by the dummy option.
+ * @param input The structure of arrays holding the inputs.
+ * @param start The index of the first option of the block.
+ * @param m The number of options of the block.
+ * @param block The block, whose inputs and bad input flags are written.
+ */
+static void load_block(const BlackScholesBatchInput& input, const std::size_t start, const std::size_t m, BlackScholesBatchBlock& block)
+{
+    for (std::size_t j = 0; j < BLACK_SCHOLES_BATCH_BLOCK; ++j)
+    {
+        const std::size_t i = start + j;
+        block.bad[j] = j >= m || is_black_scholes_bad_input(input.sigma[i], input.T[i]);
+        if (block.bad[j])
+        {
+            block.S[j] = block.K[j] = block.sigma[j] = block.T[j] = 1.0;
+            block.r[j] = block.q[j] = 0.0;
+            block.future_flag[j] = block.call_put_flag[j] = block.df[j] = 1.0;
+            continue;
+        }
+        block.S[j] = input.S[i];
+        block.K[j] = input.K[i];
+        block.r[j] = input.r[i];
+        block.q[j] = input.q[i];
+        block.sigma[j] = input.sigma[i];
+        block.T[j] = input.T[i];
+        block.future_flag[j] = input.is_future[i] ? 0 : 1;
+        block.call_put_flag[j] = input.is_call[i] ? 1 : -1;
+        block.df[j] = input.df ? input.df[i] : 1.0;
+    }
+};
+
+/**
+ * @brief Computes the intermediate terms of the first n lanes of a block, SIMD_WIDTH options 
+ * at a time, with the expressions of compute_terms and simd_exp, simd_log, simd_sqrt.
+ * @param block The block, whose inputs are loaded.
+ * @param n The number of lanes, a multiple of SIMD_WIDTH.
+ * @param has_df True if the discount factors are inputs, else they are computed from r and T.
+ */
+static void compute_block_terms(BlackScholesBatchBlock& block, const std::size_t n, const bool has_df)
+{
+    const std::size_t B = BLACK_SCHOLES_BATCH_BLOCK;
+    const simd_double half = simd_set1(.5);
+    const simd_double minus_one = simd_set1(-1.0);
+    for (std::size_t j = 0; j < n; j += SIMD_WIDTH)
+    {
+        const simd_double S = simd_load(block.S + j);
+        const simd_double K = simd_load(block.K + j);
+        const simd_double r = simd_load(block.r + j);
+        const simd_double sigma = simd_load(block.sigma + j);
+        const simd_double T = simd_load(block.T + j);
+        const simd_double call_put_flag = simd_load(block.call_put_flag + j);
+        const simd_double mu = simd_mul(simd_load(block.future_flag + j), simd_sub(r, simd_load(block.q + j)));
+        const simd_double df = has_df ? simd_load(block.df + j) : simd_exp(simd_mul(simd_mul(minus_one, r), T));
+        const simd_double drift = simd_exp(simd_mul(mu, T));
+        const simd_double F = simd_mul(S, drift);
+        const simd_double sqrt_T = simd_sqrt(T);
+        const simd_double sigma_sqrt_T = simd_mul(sigma, sqrt_T);
+        const simd_double d1 = simd_div(
+            simd_add(simd_log(simd_div(F, K)), simd_mul(simd_mul(simd_mul(T, half), sigma), sigma)), sigma_sqrt_T);
+        const simd_double d2 = simd_sub(d1, sigma_sqrt_T);
+        simd_store(block.mu + j, mu);
+        simd_store(block.df + j, df);
+        simd_store(block.drift + j, drift);
+        simd_store(block.F + j, F);
+        simd_store(block.sqrt_T + j, sqrt_T);
+        simd_store(block.x + j, d1);
+        simd_store(block.x + B + j, d2);
+        simd_store(block.x + 2*B + j, simd_mul(call_put_flag, d1));
+        simd_store(block.x + 3*B + j, simd_mul(call_put_flag, d2));
+    }
+};
+
+/**
+ * @brief Computes the price and the selected Greeks of a batch of european vanilla options
+ * with the vectorized kernels.
+ *
+ * The options are processed in blocks of BLACK_SCHOLES_BATCH_BLOCK: the inputs of a block are 
+ * loaded in a BlackScholesBatchBlock, its terms are computed SIMD_WIDTH options at a time 
+ * (simd_exp, simd_log), the normal pdf/cdf values of the whole block are evaluated with 
+ * NormalDistribution::pdf_n and NormalDistribution::cdf_n, and the outputs are written last. 
+ * Like black_scholes_batch, the function does not allocate and does not throw, but as the 
+ * vectorized functions are only within a few ULP of the scalar ones, the results match the 
+ * BlackScholesClosedForm ones up to a relative error of a few 1e-13 (the largest for the far 
+ * out of the money prices, where F*Nd1 - K*Nd2 cancels). The spot/future and strike prices 
+ * must be positive and finite (simd_log does not handle the other values).
+ *
+ * @param input The structure of arrays holding the inputs.
+ * @param output The structure of arrays receiving the outputs.
+ * @param greeks The BlackScholesGreek bitmask of the quantities to compute.
+ * @return The number of options with invalid inputs.
+ * @see black_scholes_batch
+ * @see NormalDistribution::cdf_n
+ */
+std::size_t black_scholes_batch_vectorized(
+    const BlackScholesBatchInput& input,
+    const BlackScholesBatchOutput& output,
+    const int greeks)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_PRICING);
+    const std::size_t B = BLACK_SCHOLES_BATCH_BLOCK;
+    NormalDistribution stdnorm = NormalDistribution();
+    std::size_t n_bad = 0;
+    BlackScholesBatchBlock block;
+
+    for (std::size_t start = 0; start < input.n; start += B)
+    {
+        const std::size_t m = std::min(B, input.n - start);
+        load_block(input, start, m, block);
+        compute_block_terms(block, (m + SIMD_WIDTH - 1)/SIMD_WIDTH*SIMD_WIDTH, input.df != nullptr);
+        stdnorm.pdf_n(block.x, block.pdfs, m);
+        stdnorm.pdf_n(block.x + B, block.pdfs + B, m);
+        stdnorm.cdf_n(block.x + 2*B, block.cdfs, m);
+        stdnorm.cdf_n(block.x + 3*B, block.cdfs + B, m);
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            const std::size_t i = start + j;
+            if (block.bad[j]){write_bad_input(output, i, greeks); n_bad++; continue;}
+            const BlackScholesBatchTerms t{
+                block.S[j], block.K[j], block.r[j], block.sigma[j], block.T[j],
+                static_cast<int>(block.future_flag[j]), static_cast<int>(block.call_put_flag[j]),
+                block.mu[j], block.df[j], block.drift[j], block.F[j], block.sqrt_T[j], block.x[j], block.x[B + j]};
+            write_greeks(output, i, greeks, t, block.pdfs[j], block.pdfs[B + j], block.cdfs[j], block.cdfs[B + j]);
+        }
+    }
+    ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_INSTRUMENTS_PRICED, input.n - n_bad);
+    return n_bad;
+};
+
+/**
+ * @brief Offsets a pointer of a structure of arrays, the null pointers stay null.
+ * @param p The pointer.
+ * @param begin The offset.
+ * @return The offset pointer.
+ */
+template <typename T>
+static T* offset(T* p, const std::size_t begin)
+{
+    return p ? p + begin : nullptr;
+};
+
+/**
+ * @brief Computes the price and the selected Greeks of a batch of european vanilla options
+ * with black_scholes_batch_vectorized, on the chunks of the batch in parallel.
+ *
+ * The chunks are rounded up to a multiple of BLACK_SCHOLES_BATCH_BLOCK and each one is a view of
+ * the arrays of the batch, the results are the ones of black_scholes_batch_vectorized whatever 
+ * the number of threads.
+ *
+ * @param input The structure of arrays holding the inputs.
+ * @param output The structure of arrays receiving the outputs.
+ * @param greeks The BlackScholesGreek bitmask of the quantities to compute.
+ * @param pool The thread pool, or nullptr to run serially.
+ * @param chunk The number of options of a chunk, 0 for the automatic chunking of the pool.
+ * @return The number of options with invalid inputs.
+ * @see black_scholes_batch_vectorized
+ */
+std::size_t black_scholes_batch_parallel(
+    const BlackScholesBatchInput& input,
+    const BlackScholesBatchOutput& output,
+    const int greeks,
+    ThreadPool* pool,
+    const std::size_t chunk)
+{
+    if (!pool){return black_scholes_batch_vectorized(input, output, greeks);}
+    std::size_t blocks = (pool->get_chunk(input.n, chunk) + BLACK_SCHOLES_BATCH_BLOCK - 1)/BLACK_SCHOLES_BATCH_BLOCK;
+    auto map = [&](std::size_t begin, std::size_t end)
+    {
+        const BlackScholesBatchInput part{
+            end - begin, offset(input.S, begin), offset(input.K, begin), offset(input.r, begin),
+            offset(input.q, begin), offset(input.sigma, begin), offset(input.T, begin), 
+            offset(input.is_call, begin), offset(input.is_future, begin), offset(input.df, begin)
+        };
+        const BlackScholesBatchOutput view{
+            offset(output.price, begin), offset(output.delta, begin), offset(output.gamma, begin),
+            offset(output.theta, begin), offset(output.vega, begin), offset(output.rho, begin),
+            offset(output.epsilon, begin), offset(output.vanna, begin), offset(output.volga, begin),
+            offset(output.charm, begin), offset(output.veta, begin), offset(output.zomma, begin),
+            offset(output.speed, begin), offset(output.color, begin), offset(output.ultima, begin),
+            offset(output.dual_delta, begin), offset(output.dual_gamma, begin), 
+            offset(output.bad_input, begin)
+        };
+        return black_scholes_batch_vectorized(part, view, greeks);
+    };
+    auto sum = [](std::size_t a, std::size_t b){return a + b;};
+    return pool->parallel_reduce(input.n, blocks*BLACK_SCHOLES_BATCH_BLOCK, std::size_t(0), map, sum);
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <iostream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "../../../math/probability/normal/normal.h"
+#include "../../../frameworks/blackscholes/blackscholes.h"
+#include "../../../parallel/threadpool/threadpool.h"
+#include "../../../instrumentation/instrumentation.h"
+
+constexpr std::size_t BLACK_SCHOLES_BATCH_BLOCK = 64;
+
+struct BlackScholesBatchInput
+{
+    std::size_t n;
+    const double* S;
+    const double* K;
+    const double* r;
+    const double* q;
+    const double* sigma;
+    const double* T;
+    const bool* is_call;
+    const bool* is_future;
+    const double* df;
+};
+
+struct BlackScholesBatchOutput
+{
+    double* price;
+    double* delta;
+    double* gamma;
+    double* theta;
+    double* vega;
+    double* rho;
+    double* epsilon;
+    double* vanna;
+    double* volga;
+    double* charm;
+    double* veta;
+    double* zomma;
+    double* speed;
+    double* color;
+    double* ultima;
+    double* dual_delta;
+    double* dual_gamma;
+    unsigned char* bad_input;
+};
+
+bool is_black_scholes_bad_input(const double sigma, const double T);
+
+std::size_t black_scholes_batch(
+    const BlackScholesBatchInput& input,
+    const BlackScholesBatchOutput& output,
+    const int greeks
+);
+
+std::size_t black_scholes_batch_vectorized(
+    const BlackScholesBatchInput& input,
+    const BlackScholesBatchOutput& output,
+    const int greeks
+);
+
+std::size_t black_scholes_batch_parallel(
+    const BlackScholesBatchInput& input,
+    const BlackScholesBatchOutput& output,
+    const int greeks,
+    ThreadPool* pool,
+    const std::size_t chunk
+);
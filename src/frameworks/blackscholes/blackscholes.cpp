@@ -36,6 +36,14 @@ const char * BlackScholesNonPositiveImpliedVolatility::what() const throw(){
     return "The implied volatility cannot be negative or equal to zero.";
 };
 
+/**
+ * @enum BlackScholesGreek
+ * @brief Bitmask used to select the price and the Greeks to compute.
+ * 
+ * Values can be combined with the bitwise or operator, BS_ALL selects 
+ * the price and every Greek.
+ */
+
 /** 
  * @struct BlackScholesClosedForm
  * @brief Used to calculate the Black Scholes analytical formula for euopean vanilla options.
@@ -87,6 +95,16 @@ const char * BlackScholesNonPositiveImpliedVolatility::what() const throw(){
  * @brief The underlying drift. 
  */
 
+/**
+ * @var double BlackScholesClosedForm::drift
+ * @brief The drift factor exp(mu*T), shared by the Greeks. 
+ */
+
+/**
+ * @var double BlackScholesClosedForm::sqrt_T
+ * @brief The square root of the year fraction, shared by the Greeks. 
+ */
+
 /**
  * @var double BlackScholesClosedForm::df
  * @brief The discount factor value.
@@ -121,6 +139,16 @@ const char * BlackScholesNonPositiveImpliedVolatility::what() const throw(){
  * @brief The standard normal cdf value of d1.
  */
 
+/**
+ * @var int BlackScholesClosedForm::cached_mask
+ * @brief The BlackScholesGreek bitmask of the values already stored in the cache.
+ */
+
+/**
+ * @var BlackScholesGreeks BlackScholesClosedForm::cache
+ * @brief The memoized price and Greeks, only the values flagged in cached_mask are valid.
+ */
+
  /** 
  * @brief The main constructor
  * @param S The spot/future price of the underlying.
@@ -140,9 +168,11 @@ const char * BlackScholesNonPositiveImpliedVolatility::what() const throw(){
     S_(S), K_(K), r_(r), q_(q), sigma_(sigma), T_(T),
     future_flag(set_future_flag(is_future)),
     call_put_flag(set_call_put_flag(is_call)), 
-    mu(compute_mu()), df(compute_df()),F(compute_F()), 
+    mu(compute_mu()), drift(compute_drift()), sqrt_T(compute_sqrt_T()), 
+    df(compute_df()),F(compute_F()), 
     d1(compute_d1()), d2(compute_d2()), nd1(compute_nd1()),
-    nd2(compute_nd2()), Nd1(compute_Nd1()), Nd2(compute_Nd2())
+    nd2(compute_nd2()), Nd1(compute_Nd1()), Nd2(compute_Nd2()), 
+    cached_mask(0)
 {
     if (sigma_<=0){throw BlackScholesNonPositiveImpliedVolatility();}
     if (T_<=0){throw BlackScholesNonPositiveYearFraction();}
@@ -184,12 +214,28 @@ double BlackScholesClosedForm::compute_mu()
     return future_flag*(r_-q_);
 };
 
+/**
+ * @return return the drift factor.
+ */
+double BlackScholesClosedForm::compute_drift()
+{
+    return exp(mu*T_);
+};
+
+/**
+ * @return return the square root of the year fraction.
+ */
+double BlackScholesClosedForm::compute_sqrt_T()
+{
+    return sqrt(T_);
+};
+
 /**
  * @return return the corresponding future price.
  */
 double BlackScholesClosedForm::compute_F()
 {
-    return S_*exp(mu*T_);
+    return S_*drift;
 };
 
 /**
@@ -197,7 +243,7 @@ double BlackScholesClosedForm::compute_F()
  */
 double BlackScholesClosedForm::compute_d1()
 {
-    return (log(F/K_) + T_*.5*sigma_*sigma_)/(sigma_*sqrt(T_));
+    return (log(F/K_) + T_*.5*sigma_*sigma_)/(sigma_*sqrt_T);
 };
 
 /**
@@ -205,7 +251,7 @@ double BlackScholesClosedForm::compute_d1()
  */
 double BlackScholesClosedForm::compute_d2()
 {
-    return d1 - sigma_*sqrt(T_);
+    return d1 - sigma_*sqrt_T;
 };
 
 /**
@@ -245,163 +291,268 @@ double BlackScholesClosedForm::compute_Nd2()
 };
 
 /**
- * @return compute the european vanilla option's price.
+ * @return compute the european vanilla option's price, memoized after the first call.
  */
 double BlackScholesClosedForm::price()
 {
-    return df*call_put_flag*(F*Nd1 - K_*Nd2);
+    if (!(cached_mask & BS_PRICE)){
+        cache.price = df*call_put_flag*(F*Nd1 - K_*Nd2);
+        cached_mask |= BS_PRICE;
+    }
+    return cache.price;
 };
 
 /**
- * @return compute the european vanilla option's delta.
+ * @return compute the european vanilla option's delta, memoized after the first call.
  */
 double BlackScholesClosedForm::delta()
 {
-    return df*call_put_flag*exp(mu*T_)*Nd1;
+    if (!(cached_mask & BS_DELTA)){
+        cache.delta = df*call_put_flag*drift*Nd1;
+        cached_mask |= BS_DELTA;
+    }
+    return cache.delta;
 };
 
 /**
- * @return compute the european vanilla option's gamma.
+ * @return compute the european vanilla option's gamma, memoized after the first call.
  */
 double BlackScholesClosedForm::gamma()
 {
-    double drift = exp(mu*T_);
-    return df*drift*drift*nd1/(F*sigma_*sqrt(T_));
+    if (!(cached_mask & BS_GAMMA)){
+        cache.gamma = df*drift*drift*nd1/(F*sigma_*sqrt_T);
+        cached_mask |= BS_GAMMA;
+    }
+    return cache.gamma;
 };
 
 /**
- * @return compute the european vanilla option's theta.
+ * @return compute the european vanilla option's theta, memoized after the first call.
  */
 double BlackScholesClosedForm::theta()
 {
-    double term1 = -F*df*nd1*sigma_/(2*sqrt(T_));
-    double term2 = -call_put_flag*r_*K_*df*Nd2; 
-    double term3 = call_put_flag*(r_-mu)*F*df*Nd1;
-    return term1+term2+term3;
+    if (!(cached_mask & BS_THETA)){
+        double term1 = -F*df*nd1*sigma_/(2*sqrt_T);
+        double term2 = -call_put_flag*r_*K_*df*Nd2; 
+        double term3 = call_put_flag*(r_-mu)*F*df*Nd1;
+        cache.theta = term1+term2+term3;
+        cached_mask |= BS_THETA;
+    }
+    return cache.theta;
 };
 
 /**
- * @return compute the european vanilla option's vega.
+ * @return compute the european vanilla option's vega, memoized after the first call.
  */
 double BlackScholesClosedForm::vega()
 {
-    return F*df*nd1*sqrt(T_);
+    if (!(cached_mask & BS_VEGA)){
+        cache.vega = F*df*nd1*sqrt_T;
+        cached_mask |= BS_VEGA;
+    }
+    return cache.vega;
 };
 
 /**
- * @return compute the european vanilla option's rho.
+ * @return compute the european vanilla option's rho, memoized after the first call.
  */
 double BlackScholesClosedForm::rho()
 {
-    if (future_flag == 0){
-        return -T_*df*price();
+    if (!(cached_mask & BS_RHO)){
+        if (future_flag == 0){
+            cache.rho = -T_*df*price();
+        }
+        else{
+            cache.rho = call_put_flag*K_*T_*Nd2*df;
+        };
+        cached_mask |= BS_RHO;
     }
-    else{
-        return call_put_flag*K_*T_*Nd2*df;
-    };
+    return cache.rho;
 };
 
 /**
- * @return compute the european vanilla option's epsilon.
+ * @return compute the european vanilla option's epsilon, memoized after the first call.
  */
 double BlackScholesClosedForm::epsilon()
 {
-    if (future_flag == 0){
-        return 0.0;
+    if (!(cached_mask & BS_EPSILON)){
+        if (future_flag == 0){
+            cache.epsilon = 0.0;
+        }
+        else{
+            cache.epsilon = -call_put_flag*F*T_*Nd1*df;
+        };
+        cached_mask |= BS_EPSILON;
     }
-    else{
-        return -call_put_flag*F*T_*Nd1*df;
-    };
+    return cache.epsilon;
 };
 
 /**
- * @return compute the european vanilla option's vanna.
+ * @return compute the european vanilla option's vanna, memoized after the first call.
  */
 double BlackScholesClosedForm::vanna()
 {
-    return -df*exp(mu*T_)*nd1*d2/sigma_;
+    if (!(cached_mask & BS_VANNA)){
+        cache.vanna = -df*drift*nd1*d2/sigma_;
+        cached_mask |= BS_VANNA;
+    }
+    return cache.vanna;
 };
 
 /**
- * @return compute the european vanilla option's volga.
+ * @return compute the european vanilla option's volga, memoized after the first call.
  */
 double BlackScholesClosedForm::volga()
 {
-    return vega()*d1*d2/sigma_;
+    if (!(cached_mask & BS_VOLGA)){
+        cache.volga = vega()*d1*d2/sigma_;
+        cached_mask |= BS_VOLGA;
+    }
+    return cache.volga;
 };
 
 /**
- * @return compute the european vanilla option's charm.
+ * @return compute the european vanilla option's charm, memoized after the first call.
  */
 double BlackScholesClosedForm::charm()
 {
-    double drift = exp(mu*T_);
-    double term1 = (mu-r_)*df*drift*Nd1; 
-    double term2 = (2*mu*T_ - sigma_*d2*sqrt(T_))/(2*T_*sigma_*sqrt(T_));
-    double term3 = df*drift*nd1; 
-    return call_put_flag*term1 - term2*term3;
+    if (!(cached_mask & BS_CHARM)){
+        double term1 = (mu-r_)*df*drift*Nd1; 
+        double term2 = (2*mu*T_ - sigma_*d2*sqrt_T)/(2*T_*sigma_*sqrt_T);
+        double term3 = df*drift*nd1; 
+        cache.charm = call_put_flag*term1 - term2*term3;
+        cached_mask |= BS_CHARM;
+    }
+    return cache.charm;
 };
 
 /**
- * @return compute the european vanilla option's veta.
+ * @return compute the european vanilla option's veta, memoized after the first call.
  */
 double BlackScholesClosedForm::veta()
 {
-    double term1 = -F*df*nd1*sqrt(T_);
-    double term2 = (r_-mu)+mu*d1/(sigma_*sqrt(T_));
-    double term3 = (1+d1*d2)/(2*T_); 
-    return term1*(term2-term3);
+    if (!(cached_mask & BS_VETA)){
+        double term1 = -F*df*nd1*sqrt_T;
+        double term2 = (r_-mu)+mu*d1/(sigma_*sqrt_T);
+        double term3 = (1+d1*d2)/(2*T_); 
+        cache.veta = term1*(term2-term3);
+        cached_mask |= BS_VETA;
+    }
+    return cache.veta;
 };
 
 /**
- * @return compute the european vanilla option's speed.
+ * @return compute the european vanilla option's speed, memoized after the first call.
  */
 double BlackScholesClosedForm::speed()
 {
-    double term1 = -exp(mu*T_)*gamma()*(1+d1/(sigma_*sqrt(T_)));
-    return term1/F;
+    if (!(cached_mask & BS_SPEED)){
+        double term1 = -drift*gamma()*(1+d1/(sigma_*sqrt_T));
+        cache.speed = term1/F;
+        cached_mask |= BS_SPEED;
+    }
+    return cache.speed;
 };
 
 /**
- * @return compute the european vanilla option's zomma.
+ * @return compute the european vanilla option's zomma, memoized after the first call.
  */
 double BlackScholesClosedForm::zomma()
 {
-    return gamma()*(d1*d2-1)/sigma_;
+    if (!(cached_mask & BS_ZOMMA)){
+        cache.zomma = gamma()*(d1*d2-1)/sigma_;
+        cached_mask |= BS_ZOMMA;
+    }
+    return cache.zomma;
 };
 
 /**
- * @return compute the european vanilla option's ultima.
+ * @return compute the european vanilla option's ultima, memoized after the first call.
  */
 double BlackScholesClosedForm::ultima()
 {
-    return -vega()*(d1*d2*(1-d1*d2) + d1*d1 + d2*d2)/(sigma_*sigma_);
+    if (!(cached_mask & BS_ULTIMA)){
+        cache.ultima = -vega()*(d1*d2*(1-d1*d2) + d1*d1 + d2*d2)/(sigma_*sigma_);
+        cached_mask |= BS_ULTIMA;
+    }
+    return cache.ultima;
 };
 
 /**
- * @return compute the european vanilla option's color.
+ * @return compute the european vanilla option's color, memoized after the first call.
  */
 double BlackScholesClosedForm::color()
 {
-    double term1 = d1*(2*mu*T_ - d2*sigma_*sqrt(T_))/(sigma_*sqrt(T_));
-    return gamma()*(2*(r_-mu) + 1 + term1)/(2*T_);
+    if (!(cached_mask & BS_COLOR)){
+        double term1 = d1*(2*mu*T_ - d2*sigma_*sqrt_T)/(sigma_*sqrt_T);
+        cache.color = gamma()*(2*(r_-mu) + 1 + term1)/(2*T_);
+        cached_mask |= BS_COLOR;
+    }
+    return cache.color;
 };
 
 /**
- * @return compute the european vanilla option's dual delta.
+ * @return compute the european vanilla option's dual delta, memoized after the first call.
  */
 double BlackScholesClosedForm::dual_delta()
 {
-    return -call_put_flag*df*Nd2;
+    if (!(cached_mask & BS_DUAL_DELTA)){
+        cache.dual_delta = -call_put_flag*df*Nd2;
+        cached_mask |= BS_DUAL_DELTA;
+    }
+    return cache.dual_delta;
 };
 
 /**
- * @return compute the european vanilla option's dual gamma.
+ * @return compute the european vanilla option's dual gamma, memoized after the first call.
  */
 double BlackScholesClosedForm::dual_gamma()
 {
-    return df*nd2/(K_*sigma_*sqrt(T_));
+    if (!(cached_mask & BS_DUAL_GAMMA)){
+        cache.dual_gamma = df*nd2/(K_*sigma_*sqrt_T);
+        cached_mask |= BS_DUAL_GAMMA;
+    }
+    return cache.dual_gamma;
 };
 
+/**
+ * @brief Computes a subset of the price and the Greeks in one call. The shared terms
+ * (drift, square root of the year fraction, gamma, vega, normal values) are computed once 
+ * and every value is memoized, so the individual accessors do not recompute them afterwards.
+ * @param mask The BlackScholesGreek bitmask of the values to compute.
+ * @return The selected values, the non selected ones are set to NaN.
+ */
+BlackScholesGreeks BlackScholesClosedForm::greeks(int mask)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    BlackScholesGreeks result = {
+        nan, nan, nan, nan, nan, nan, nan, nan, nan, 
+        nan, nan, nan, nan, nan, nan, nan, nan};
+    if (mask & BS_PRICE){result.price = price();}
+    if (mask & BS_DELTA){result.delta = delta();}
+    if (mask & BS_GAMMA){result.gamma = gamma();}
+    if (mask & BS_THETA){result.theta = theta();}
+    if (mask & BS_VEGA){result.vega = vega();}
+    if (mask & BS_RHO){result.rho = rho();}
+    if (mask & BS_EPSILON){result.epsilon = epsilon();}
+    if (mask & BS_VANNA){result.vanna = vanna();}
+    if (mask & BS_VOLGA){result.volga = volga();}
+    if (mask & BS_CHARM){result.charm = charm();}
+    if (mask & BS_VETA){result.veta = veta();}
+    if (mask & BS_SPEED){result.speed = speed();}
+    if (mask & BS_ZOMMA){result.zomma = zomma();}
+    if (mask & BS_ULTIMA){result.ultima = ultima();}
+    if (mask & BS_COLOR){result.color = color();}
+    if (mask & BS_DUAL_DELTA){result.dual_delta = dual_delta();}
+    if (mask & BS_DUAL_GAMMA){result.dual_gamma = dual_gamma();}
+    return result;
+};
 
-
+/**
+ * @return compute the european vanilla option's price and its 16 Greeks in one call.
+ * @see BlackScholesClosedForm::greeks
+ */
+BlackScholesGreeks BlackScholesClosedForm::all_greeks()
+{
+    return greeks(BS_ALL);
+};
\ No newline at end of file
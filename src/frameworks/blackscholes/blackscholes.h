@@ -1,5 +1,6 @@
 #pragma once 
 #include <iostream>
+#include <limits>
 #include "../../math/probability/normal/normal.h"
 
 class BlackScholesNonPositiveImpliedVolatility:  public std::exception 
@@ -8,6 +9,49 @@ class BlackScholesNonPositiveImpliedVolatility:  public std::exception
 class BlackScholesNonPositiveYearFraction:  public std::exception 
 {public: const char * what() const throw();};
 
+enum BlackScholesGreek
+{
+    BS_PRICE = 1 << 0, 
+    BS_DELTA = 1 << 1, 
+    BS_GAMMA = 1 << 2, 
+    BS_THETA = 1 << 3, 
+    BS_VEGA = 1 << 4, 
+    BS_RHO = 1 << 5, 
+    BS_EPSILON = 1 << 6, 
+    BS_VANNA = 1 << 7, 
+    BS_VOLGA = 1 << 8, 
+    BS_CHARM = 1 << 9, 
+    BS_VETA = 1 << 10, 
+    BS_ZOMMA = 1 << 11, 
+    BS_SPEED = 1 << 12, 
+    BS_COLOR = 1 << 13, 
+    BS_ULTIMA = 1 << 14, 
+    BS_DUAL_DELTA = 1 << 15, 
+    BS_DUAL_GAMMA = 1 << 16, 
+    BS_ALL = (1 << 17) - 1
+};
+
+struct BlackScholesGreeks
+{
+    double price; 
+    double delta; 
+    double gamma; 
+    double theta; 
+    double vega; 
+    double rho; 
+    double epsilon; 
+    double vanna; 
+    double volga; 
+    double charm; 
+    double veta; 
+    double zomma; 
+    double speed; 
+    double color; 
+    double ultima; 
+    double dual_delta; 
+    double dual_gamma; 
+};
+
 struct BlackScholesClosedForm
 {
     double S_; 
@@ -19,6 +63,8 @@ struct BlackScholesClosedForm
     int call_put_flag; 
     int future_flag; 
     double mu; 
+    double drift; 
+    double sqrt_T; 
     double F; 
     double df; 
     double d1; 
@@ -27,6 +73,8 @@ struct BlackScholesClosedForm
     double Nd2; 
     double nd1; 
     double nd2; 
+    int cached_mask; 
+    BlackScholesGreeks cache; 
     BlackScholesClosedForm(
         double S, 
         double K, 
@@ -42,6 +90,8 @@ struct BlackScholesClosedForm
     int set_call_put_flag(bool is_call); 
     double compute_df(); 
     double compute_mu();
+    double compute_drift();
+    double compute_sqrt_T();
     double compute_F(); 
     double compute_d1(); 
     double compute_d2(); 
@@ -66,4 +116,6 @@ struct BlackScholesClosedForm
     double ultima();
     double dual_delta();
     double dual_gamma();
+    BlackScholesGreeks greeks(int mask);
+    BlackScholesGreeks all_greeks();
 }; 
\ No newline at end of file
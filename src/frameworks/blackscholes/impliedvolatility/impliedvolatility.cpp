@@ -0,0 +1,514 @@
+#include "impliedvolatility.h"
+
+/**
+* @file impliedvolatility.h
+* @brief This file defines the implied volatility solver inverting the Black Scholes formula.
+*
+* The price is first normalized as in Jäckel's "Let's be rational" (2015): with x = ln(F/K) and
+* s = sigma*sqrt(T), any european price is turned into the normalized price b(x, s) of an out of
+* the money call (x <= 0), using the put/call parity and the symmetry b(x, s, call) = b(-x, s, put).
+* b(s) is convex below the inflection point s_c = sqrt(2|x|) and concave above it, so the
+* problem is split in two regions:
+* - above b(s_c), b(s) - beta is solved from a guess built on the normal quantile function.
+* - below b(s_c), ln(b(s)) - ln(beta) is solved from a guess built on the asymptotic expansion
+* b(s) ~ phi(x/s + s/2) e^{x/2} s^3/x^2 of the lower wing.
+* Both are refined with third order Householder steps, safeguarded by a bracket. The iterations stop
+* when the relative step is below the tolerance or when the residual reaches the rounding error of
+* the normalized price. From these guesses 2 to 4 steps are enough on most quotes.
+*
+* References :
+* - "Let's be rational", Jäckel, 2015.
+*/
+
+/**
+ * @enum ImpliedVolatilityStatus
+ * @brief The outcome of an implied volatility inversion.
+ */
+
+/**
+ * @class ImpliedVolatilityBadInput
+ * @brief Definition of the error when the inputs (price, spot, strike, year fraction) are invalid.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ImpliedVolatilityBadInput::what() const throw(){
+    return "The price, spot, strike and year fraction have to be positive to compute an implied volatility.";
+};
+
+/**
+ * @class ImpliedVolatilityPriceBelowIntrinsic
+ * @brief Definition of the error when the price is lower or equal to the intrinsic value.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ImpliedVolatilityPriceBelowIntrinsic::what() const throw(){
+    return "The option price has to be strictly higher than its intrinsic value.";
+};
+
+/**
+ * @class ImpliedVolatilityPriceAboveMaximum
+ * @brief Definition of the error when the price is higher than the maximal option price.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ImpliedVolatilityPriceAboveMaximum::what() const throw(){
+    return "The option price has to be strictly lower than the discounted forward (call) or strike (put).";
+};
+
+/**
+ * @class ImpliedVolatilityNotConverged
+ * @brief Definition of the error when the solver did not converge within the maximal number of iterations.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ImpliedVolatilityNotConverged::what() const throw(){
+    return "The implied volatility solver did not converge.";
+};
+
+/**
+ * @struct ImpliedVolatilityQuote
+ * @brief The bid and ask implied volatilities of a quote, with their status.
+ */
+
+/**
+ * @struct ImpliedVolatilityBatchInput
+ * @brief The structure of arrays holding the inputs of a batch of implied volatility inversions.
+ * Every array is owned by the caller and must hold at least n values.
+ */
+
+/**
+ * @struct ImpliedVolatilityBatchOutput
+ * @brief The structure of arrays receiving the implied volatilities, their ImpliedVolatilityStatus
+ * and the number of iterations used. The iterations array can be null.
+ */
+
+/**
+ * @struct ImpliedVolatilityForward
+ * @brief The terms of an inversion which only depend on the forward, the strike and the year fraction.
+ * They are shared by the bid and the ask of a quote.
+ */
+struct ImpliedVolatilityForward
+{
+    double x;
+    double theta_x;
+    double scale;
+    double sqrt_T;
+    double ehx;
+    double emhx;
+    double s_c;
+    double b_c;
+};
+
+/**
+ * @struct ImpliedVolatilityLane
+ * @brief The state of one inversion: the normalized out of the money call price and the
+ * current normalized volatility with its bracket.
+ */
+struct ImpliedVolatilityLane
+{
+    double x;
+    double beta;
+    double ln_beta;
+    double ehx;
+    double f_tolerance;
+    bool lower;
+    double s;
+    double lo;
+    double hi;
+    int iterations;
+    bool done;
+};
+
+/**
+ * @brief Computes the normalized price of an out of the money call.
+ * @param x The log moneyness ln(F/K), non positive.
+ * @param s The normalized volatility sigma*sqrt(T).
+ * @param ehx The value exp(x/2).
+ * @param emhx The value exp(-x/2).
+ * @return The normalized call price.
+ */
+static double normalized_otm_call(double x, double s, double ehx, double emhx)
+{
+    NormalDistribution stdnorm = NormalDistribution();
+    return ehx*stdnorm.cdf(x/s + .5*s) - emhx*stdnorm.cdf(x/s - .5*s);
+};
+
+/**
+ * @brief Computes the terms of an inversion which do not depend on the price.
+ * @param S The spot/future price of the underlying.
+ * @param K The strike price of the option.
+ * @param r The interest rate.
+ * @param q The carry cost rate.
+ * @param T The year fraction.
+ * @param is_call indicator if the option is a call (True) or a put (False).
+ * @param is_future indicator if the underyling is a future (True) or not (False).
+ * @param forward The terms to fill.
+ * @return IV_BAD_INPUT if the inputs are invalid, IV_CONVERGED else.
+ */
+static ImpliedVolatilityStatus prepare_forward(
+    double S, double K, double r, double q, double T,
+    bool is_call, bool is_future, ImpliedVolatilityForward& forward)
+{
+    if (!(S>0) || !(K>0) || !(T>0) || !std::isfinite(r) || !std::isfinite(q)){return IV_BAD_INPUT;}
+    const int future_flag = is_future ? 0 : 1;
+    const int call_put_flag = is_call ? 1 : -1;
+    const double F = S*exp(future_flag*(r-q)*T);
+    const double x = log(F/K);
+    forward.theta_x = call_put_flag*x;
+    forward.x = -fabs(x);
+    forward.scale = exp(-r*T)*sqrt(F*K);
+    forward.sqrt_T = sqrt(T);
+    forward.ehx = exp(.5*forward.x);
+    forward.emhx = exp(-.5*forward.x);
+    forward.s_c = sqrt(2*fabs(x));
+    forward.b_c = forward.s_c > 0 ?
+        normalized_otm_call(forward.x, forward.s_c, forward.ehx, forward.emhx) : 0.0;
+    return IV_CONVERGED;
+};
+
+/**
+ * @brief Normalizes a price and sets the initial guess of its inversion.
+ * @param price The option price.
+ * @param forward The terms shared by the prices of the same option.
+ * @param lane The inversion state to initialize.
+ * @return IV_BAD_INPUT, IV_BELOW_INTRINSIC or IV_ABOVE_MAXIMUM if the price can not be inverted,
+ * IV_CONVERGED else.
+ */
+static ImpliedVolatilityStatus prepare_lane(
+    double price, const ImpliedVolatilityForward& forward, ImpliedVolatilityLane& lane)
+{
+    if (!(price>=0) || !std::isfinite(price)){return IV_BAD_INPUT;}
+    double beta = price/forward.scale;
+    if (forward.theta_x>0){beta -= forward.emhx - forward.ehx;}
+    if (!(beta>0)){return IV_BELOW_INTRINSIC;}
+    if (beta>=forward.ehx){return IV_ABOVE_MAXIMUM;}
+
+    const double x = forward.x;
+    const double s_c = forward.s_c;
+    lane.x = x;
+    lane.beta = beta;
+    lane.ln_beta = log(beta);
+    lane.ehx = forward.ehx;
+    lane.lower = beta < forward.b_c;
+    lane.f_tolerance = 8*std::numeric_limits<double>::epsilon()*(lane.lower ? 1.0 : forward.ehx + forward.emhx);
+    lane.iterations = 0;
+    lane.done = false;
+
+    if (lane.lower)
+    {
+        const double ax = fabs(x);
+        const double c = -lane.ln_beta - 2*log(ax) - .5*log(2*numbers::PI);
+        double s = s_c;
+        for (int i = 0; i < 3; ++i)
+        {
+            const double arg = c + 3*log(s) - .125*s*s;
+            if (!(arg>0)){break;}
+            s = std::min(ax/sqrt(2*arg), s_c);
+        }
+        lane.s = s;
+        lane.lo = 0.0;
+        lane.hi = s_c;
+    }
+    else
+    {
+        NormalDistribution stdnorm = NormalDistribution();
+        const double p = std::min((beta + forward.emhx)/(forward.ehx + forward.emhx), 1 - 1e-16);
+        lane.s = std::max(2*stdnorm.inverse_cdf(p), s_c);
+        lane.lo = s_c;
+        lane.hi = std::numeric_limits<double>::infinity();
+    }
+    if (!(lane.s>0)){lane.s = s_c>0 ? .5*s_c : 1.0;}
+    return IV_CONVERGED;
+};
+
+/**
+ * @brief Applies one safeguarded third order Householder step to an inversion.
+ * @param lane The inversion state.
+ * @param b The normalized call price at lane.s.
+ * @param b1 The first derivative of the normalized call price with respect to s at lane.s.
+ * @param tolerance The relative tolerance on the normalized volatility.
+ */
+static void householder_step(ImpliedVolatilityLane& lane, double b, double b1, double tolerance)
+{
+    const double s = lane.s;
+    const double x2 = lane.x*lane.x;
+    const double t = x2/(s*s*s) - .25*s;
+    const double b2 = b1*t;
+    const double b3 = b1*(t*t - 3*x2/(s*s*s*s) - .25);
+    lane.iterations++;
+
+    double f, f1, f2, f3;
+    if (lane.lower)
+    {
+        if (!(b>0))
+        {
+            lane.lo = s;
+            lane.s = .5*(lane.lo + lane.hi);
+            return;
+        }
+        f = log(b) - lane.ln_beta;
+        f1 = b1/b;
+        f2 = b2/b - f1*f1;
+        f3 = b3/b - 3*f1*b2/b + 2*f1*f1*f1;
+    }
+    else
+    {
+        f = b - lane.beta;
+        f1 = b1;
+        f2 = b2;
+        f3 = b3;
+    }
+    if (fabs(f)<=lane.f_tolerance){lane.done = true; return;}
+    if (!(f1>0)){lane.s = .5*(lane.lo + std::min(lane.hi, 2*s)); return;}
+    if (f>0){lane.hi = s;}
+    else{lane.lo = s;}
+
+    const double nu = -f/f1;
+    const double h2 = f2/f1;
+    const double h3 = f3/f1;
+    const double step = nu*(1 + .5*h2*nu)/(1 + h2*nu + h3*nu*nu/6);
+    double s_new = s + step;
+    if (!(s_new>lane.lo && s_new<lane.hi))
+    {
+        s_new = std::isfinite(lane.hi) ? .5*(lane.lo + lane.hi) : 2*s;
+    }
+    lane.done = fabs(s_new - s) <= tolerance*s_new;
+    lane.s = s_new;
+};
+
+/**
+ * @struct BlackScholesImpliedVolatility
+ * @brief The implied volatility solver of the Black Scholes framework.
+ * @see BlackScholesClosedForm
+ */
+
+ /**
+ * @var double BlackScholesImpliedVolatility::tolerance_
+ * @brief The relative tolerance on the implied volatility.
+ */
+
+ /**
+ * @var int BlackScholesImpliedVolatility::max_iterations_
+ * @brief The maximal number of Householder steps.
+ */
+
+/**
+ * @brief The standard constructor, the tolerance is set to 1e-14 and the maximal number
+ * of iterations to 32.
+ */
+BlackScholesImpliedVolatility::BlackScholesImpliedVolatility():
+    tolerance_(1e-14), max_iterations_(32){};
+
+/**
+ * @brief The main constructor
+ * @param tolerance The relative tolerance on the implied volatility.
+ * @param max_iterations The maximal number of Householder steps.
+ */
+BlackScholesImpliedVolatility::BlackScholesImpliedVolatility(double tolerance, int max_iterations):
+    tolerance_(tolerance), max_iterations_(max_iterations){};
+
+/**
+ * @brief Computes the implied volatility of a price without throwing.
+ * @param price The option price.
+ * @param S The spot/future price of the underlying.
+ * @param K The strike price of the option.
+ * @param r The interest rate.
+ * @param q The carry cost rate.
+ * @param T The year fraction.
+ * @param is_call indicator if the option is a call (True) or a put (False).
+ * @param is_future indicator if the underyling is a future (True) or not (False).
+ * @param sigma The implied volatility, set to NaN if the price can not be inverted.
+ * @param iterations The number of Householder steps used.
+ * @return The status of the inversion.
+ */
+ImpliedVolatilityStatus BlackScholesImpliedVolatility::solve_status(
+    double price, double S, double K, double r, double q, double T,
+    bool is_call, bool is_future, double& sigma, int& iterations)
+{
+    NormalDistribution stdnorm = NormalDistribution();
+    ImpliedVolatilityForward forward;
+    ImpliedVolatilityLane lane;
+    sigma = std::numeric_limits<double>::quiet_NaN();
+    iterations = 0;
+
+    ImpliedVolatilityStatus status = prepare_forward(S, K, r, q, T, is_call, is_future, forward);
+    if (status != IV_CONVERGED){return status;}
+    status = prepare_lane(price, forward, lane);
+    if (status != IV_CONVERGED){return status;}
+
+    while (!lane.done && lane.iterations < max_iterations_)
+    {
+        const double d1 = lane.x/lane.s + .5*lane.s;
+        const double b = normalized_otm_call(lane.x, lane.s, forward.ehx, forward.emhx);
+        householder_step(lane, b, forward.ehx*stdnorm.pdf(d1), tolerance_);
+    }
+    iterations = lane.iterations;
+    sigma = lane.s/forward.sqrt_T;
+    return lane.done ? IV_CONVERGED : IV_NOT_CONVERGED;
+};
+
+/**
+ * @brief Computes the implied volatility of a price.
+ * @param price The option price.
+ * @param S The spot/future price of the underlying.
+ * @param K The strike price of the option.
+ * @param r The interest rate.
+ * @param q The carry cost rate.
+ * @param T The year fraction.
+ * @param is_call indicator if the option is a call (True) or a put (False).
+ * @param is_future indicator if the underyling is a future (True) or not (False).
+ * @return The implied volatility.
+ * @throw ImpliedVolatilityBadInput
+ * @throw ImpliedVolatilityPriceBelowIntrinsic
+ * @throw ImpliedVolatilityPriceAboveMaximum
+ * @throw ImpliedVolatilityNotConverged
+ */
+double BlackScholesImpliedVolatility::solve(
+    double price, double S, double K, double r, double q, double T,
+    bool is_call, bool is_future)
+{
+    double sigma;
+    int iterations;
+    switch (solve_status(price, S, K, r, q, T, is_call, is_future, sigma, iterations))
+    {
+    case IV_BAD_INPUT: {throw ImpliedVolatilityBadInput();}
+    case IV_BELOW_INTRINSIC: {throw ImpliedVolatilityPriceBelowIntrinsic();}
+    case IV_ABOVE_MAXIMUM: {throw ImpliedVolatilityPriceAboveMaximum();}
+    case IV_NOT_CONVERGED: {throw ImpliedVolatilityNotConverged();}
+    default: {return sigma;}
+    }
+};
+
+/**
+ * @brief Computes the bid and ask implied volatilities of a quote in one call. The terms
+ * which only depend on the forward and the strike are computed once for both sides.
+ * @param quote The option quote.
+ * @param S The spot/future price of the underlying.
+ * @param K The strike price of the option.
+ * @param r The interest rate.
+ * @param q The carry cost rate.
+ * @param T The year fraction.
+ * @param is_call indicator if the option is a call (True) or a put (False).
+ * @param is_future indicator if the underyling is a future (True) or not (False).
+ * @return The bid and ask implied volatilities (NaN if a side can not be inverted) and their status.
+ */
+ImpliedVolatilityQuote BlackScholesImpliedVolatility::solve_quote(
+    AssetQuote& quote, double S, double K, double r, double q, double T,
+    bool is_call, bool is_future)
+{
+    NormalDistribution stdnorm = NormalDistribution();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    ImpliedVolatilityQuote result = {nan, nan, IV_BAD_INPUT, IV_BAD_INPUT};
+    ImpliedVolatilityForward forward;
+    if (prepare_forward(S, K, r, q, T, is_call, is_future, forward) != IV_CONVERGED){return result;}
+
+    ImpliedVolatilityLane lanes[2];
+    ImpliedVolatilityStatus status[2] = {
+        prepare_lane(quote.get_bid(), forward, lanes[0]),
+        prepare_lane(quote.get_ask(), forward, lanes[1])};
+    double sigma[2] = {nan, nan};
+    for (int j = 0; j < 2; ++j)
+    {
+        if (status[j] != IV_CONVERGED){continue;}
+        ImpliedVolatilityLane& lane = lanes[j];
+        while (!lane.done && lane.iterations < max_iterations_)
+        {
+            const double d1 = lane.x/lane.s + .5*lane.s;
+            const double b = normalized_otm_call(lane.x, lane.s, forward.ehx, forward.emhx);
+            householder_step(lane, b, forward.ehx*stdnorm.pdf(d1), tolerance_);
+        }
+        sigma[j] = lane.s/forward.sqrt_T;
+        if (!lane.done){status[j] = IV_NOT_CONVERGED;}
+    }
+    result.bid = sigma[0];
+    result.ask = sigma[1];
+    result.bid_status = status[0];
+    result.ask_status = status[1];
+    return result;
+};
+
+/**
+ * @brief Computes the implied volatilities of a batch of prices.
+ *
+ * The prices are processed in blocks of IMPLIED_VOLATILITY_BATCH_BLOCK: at each iteration the
+ * normalized prices and vegas of the unconverged prices of the block are packed and evaluated at
+ * once with the vectorized NormalDistribution::cdf_n and NormalDistribution::pdf_n kernels, then
+ * every price takes its own Householder step. The function does not allocate and does not throw.
+ *
+ * @param input The structure of arrays holding the inputs.
+ * @param output The structure of arrays receiving the outputs.
+ * @return The number of prices which could not be inverted.
+ */
+std::size_t BlackScholesImpliedVolatility::solve_batch(
+    const ImpliedVolatilityBatchInput& input,
+    const ImpliedVolatilityBatchOutput& output)
+{
+    NormalDistribution stdnorm = NormalDistribution();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    ImpliedVolatilityForward forwards[IMPLIED_VOLATILITY_BATCH_BLOCK];
+    ImpliedVolatilityLane lanes[IMPLIED_VOLATILITY_BATCH_BLOCK];
+    std::size_t active[IMPLIED_VOLATILITY_BATCH_BLOCK];
+    double d[2*IMPLIED_VOLATILITY_BATCH_BLOCK];
+    double cdfs[2*IMPLIED_VOLATILITY_BATCH_BLOCK];
+    double pdfs[IMPLIED_VOLATILITY_BATCH_BLOCK];
+    std::size_t n_failed = 0;
+
+    for (std::size_t start = 0; start < input.n; start += IMPLIED_VOLATILITY_BATCH_BLOCK)
+    {
+        const std::size_t m = std::min(IMPLIED_VOLATILITY_BATCH_BLOCK, input.n - start);
+        std::size_t n_active = 0;
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            const std::size_t i = start + j;
+            ImpliedVolatilityStatus status = prepare_forward(
+                input.S[i], input.K[i], input.r[i], input.q[i], input.T[i],
+                input.is_call[i], input.is_future[i], forwards[j]);
+            if (status == IV_CONVERGED){status = prepare_lane(input.price[i], forwards[j], lanes[j]);}
+            output.status[i] = status;
+            output.sigma[i] = nan;
+            if (output.iterations){output.iterations[i] = 0;}
+            if (status == IV_CONVERGED){active[n_active++] = j;}
+        }
+
+        int iteration = 0;
+        while (n_active > 0 && iteration < max_iterations_)
+        {
+            for (std::size_t k = 0; k < n_active; ++k)
+            {
+                const ImpliedVolatilityLane& lane = lanes[active[k]];
+                d[k] = lane.x/lane.s + .5*lane.s;
+                d[n_active+k] = lane.x/lane.s - .5*lane.s;
+            }
+            stdnorm.cdf_n(d, cdfs, 2*n_active);
+            stdnorm.pdf_n(d, pdfs, n_active);
+            std::size_t n_still_active = 0;
+            for (std::size_t k = 0; k < n_active; ++k)
+            {
+                const std::size_t j = active[k];
+                const double b = forwards[j].ehx*cdfs[k] - forwards[j].emhx*cdfs[n_active+k];
+                householder_step(lanes[j], b, forwards[j].ehx*pdfs[k], tolerance_);
+                if (!lanes[j].done){active[n_still_active++] = j;}
+            }
+            n_active = n_still_active;
+            iteration++;
+        }
+
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            const std::size_t i = start + j;
+            if (output.status[i] != IV_CONVERGED){n_failed++; continue;}
+            output.sigma[i] = lanes[j].s/forwards[j].sqrt_T;
+            if (output.iterations){output.iterations[i] = lanes[j].iterations;}
+            if (!lanes[j].done){output.status[i] = IV_NOT_CONVERGED; n_failed++;}
+        }
+    }
+    return n_failed;
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include <iostream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "../../../math/probability/normal/normal.h"
+#include "../../../frameworks/blackscholes/blackscholes.h"
+#include "../../../datastructure/market/assets/interface.h"
+
+enum ImpliedVolatilityStatus
+{
+    IV_CONVERGED = 0,
+    IV_BAD_INPUT = 1,
+    IV_BELOW_INTRINSIC = 2,
+    IV_ABOVE_MAXIMUM = 3,
+    IV_NOT_CONVERGED = 4
+};
+
+class ImpliedVolatilityBadInput:  public std::exception
+{public: const char * what() const throw();};
+
+class ImpliedVolatilityPriceBelowIntrinsic:  public std::exception
+{public: const char * what() const throw();};
+
+class ImpliedVolatilityPriceAboveMaximum:  public std::exception
+{public: const char * what() const throw();};
+
+class ImpliedVolatilityNotConverged:  public std::exception
+{public: const char * what() const throw();};
+
+struct ImpliedVolatilityQuote
+{
+    double bid;
+    double ask;
+    ImpliedVolatilityStatus bid_status;
+    ImpliedVolatilityStatus ask_status;
+};
+
+struct ImpliedVolatilityBatchInput
+{
+    std::size_t n;
+    const double* price;
+    const double* S;
+    const double* K;
+    const double* r;
+    const double* q;
+    const double* T;
+    const bool* is_call;
+    const bool* is_future;
+};
+
+struct ImpliedVolatilityBatchOutput
+{
+    double* sigma;
+    unsigned char* status;
+    int* iterations;
+};
+
+constexpr std::size_t IMPLIED_VOLATILITY_BATCH_BLOCK = 64;
+
+struct BlackScholesImpliedVolatility
+{
+    double tolerance_;
+    int max_iterations_;
+    BlackScholesImpliedVolatility();
+    BlackScholesImpliedVolatility(double tolerance, int max_iterations);
+    ~BlackScholesImpliedVolatility(){};
+    double solve(
+        double price,
+        double S,
+        double K,
+        double r,
+        double q,
+        double T,
+        bool is_call,
+        bool is_future
+    );
+    ImpliedVolatilityStatus solve_status(
+        double price,
+        double S,
+        double K,
+        double r,
+        double q,
+        double T,
+        bool is_call,
+        bool is_future,
+        double& sigma,
+        int& iterations
+    );
+    ImpliedVolatilityQuote solve_quote(
+        AssetQuote& quote,
+        double S,
+        double K,
+        double r,
+        double q,
+        double T,
+        bool is_call,
+        bool is_future
+    );
+    std::size_t solve_batch(
+        const ImpliedVolatilityBatchInput& input,
+        const ImpliedVolatilityBatchOutput& output
+    );
+};
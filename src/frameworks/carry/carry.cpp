@@ -0,0 +1,465 @@
+#include "carry.h"
+
+/**
+* @file carry.h
+* @brief This file defines the term structure of the futures basis and of the implied carry of
+* the crypto underlyings, built from the mids of the QuoteBook and interpolated at the option
+* expiries.
+*
+* For a dated future of mid F and year fraction T on a spot of mid S, the basis is F - S, the
+* annualized basis is b = ln(F/S)/T and the implied carry (the q of the Black-Scholes inputs) is
+* q = r - b. The total log basis ln(F/S) is interpolated linearly in T between the pillars of the
+* futures, from (0, 0) at the spot, and extrapolated at a flat annualized basis after the last
+* pillar. An option expiry is then priced on F(T) = S exp(ln(F/S)(T)) and q(T) = r - ln(F/S)(T)/T.
+*
+* The workspace is allocated by prepare: compute and update do not allocate, an update
+* recomputes only the underlyings whose spot or futures were quoted.
+*
+* References :
+* - "Options, futures, and other derivatives", Hull, 2018, chapter 5.
+* - "Crypto carry", Schmeling, Schrimpf, Todorov, BIS working paper 1087, 2023.
+*/
+
+/**
+ * @var std::size_t CARRY_NONE
+ * @brief The underlying of a quote which is neither a spot nor a future of the term structure.
+ */
+
+/**
+ * @class CarryPerpetualFuture
+ * @brief Definition of the error when a perpetual future is added: it has no expiry.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * CarryPerpetualFuture::what() const throw(){
+    return "A perpetual future has no expiry, it can not be a pillar of the carry term structure.";
+};
+
+/**
+ * @class CarryUnknownUnderlying
+ * @brief Definition of the error when an underlying index is not in the term structure.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * CarryUnknownUnderlying::what() const throw(){
+    return "The underlying is not in the carry term structure.";
+};
+
+/**
+ * @class CarryDuplicatedQuote
+ * @brief Definition of the error when a quote of the book is used twice (as a spot, or as a
+ * future).
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * CarryDuplicatedQuote::what() const throw(){
+    return "The quote is already a spot or a future of the carry term structure.";
+};
+
+/**
+ * @struct CarryTermStructure
+ * @brief The futures basis and the implied carry of every underlying, per dated future and at
+ * the registered option expiries. The futures with a missing or crossed quote (or expired) have
+ * NaN outputs and are not pillars; without any pillar the expiries of the underlying are NaN.
+ * @var CarryTermStructure::book_
+ * The quote book of the spots and futures.
+ * @var CarryTermStructure::spots_
+ * The quote of the spot of each underlying.
+ * @var CarryTermStructure::rates_
+ * The rate of the quote currency of each underlying.
+ * @var CarryTermStructure::future_underlyings_
+ * The underlying of each future.
+ * @var CarryTermStructure::future_quotes_
+ * The quote of each future.
+ * @var CarryTermStructure::expiry_underlyings_
+ * The underlying of each option expiry.
+ * @var CarryTermStructure::future_offsets_
+ * The futures of underlying u are future_order_[future_offsets_[u], future_offsets_[u+1]), sorted by
+ * year fraction.
+ * @var CarryTermStructure::expiry_offsets_
+ * The expiries of underlying u are expiry_order_[expiry_offsets_[u], expiry_offsets_[u+1]).
+ * @var CarryTermStructure::quote_underlyings_
+ * The underlying of each quote of the book, CARRY_NONE for the others.
+ * @var CarryTermStructure::pillar_T_
+ * The pillars of underlying u start at future_offsets_[u] + u: (0, 0) and the valid futures.
+ */
+
+/**
+ * @brief Constructor.
+ * @param book The quote book of the spots and futures, it must outlive the term structure.
+ * @param reference_timestamp The valuation time.
+ */
+CarryTermStructure::CarryTermStructure(const QuoteBook& book, const Timestamp reference_timestamp):
+    book_(book), year_fractions_(reference_timestamp), prepared_(false){};
+
+/**
+ * @brief Adds an underlying.
+ * @param spot_quote The index of its spot in the book.
+ * @param rate The rate of its quote currency.
+ * @return The index of the underlying.
+ */
+std::size_t CarryTermStructure::add_underlying(const std::size_t spot_quote, const double rate)
+{
+    spots_.push_back(spot_quote);
+    rates_.push_back(rate);
+    prepared_ = false;
+    return spots_.size() - 1;
+};
+
+/**
+ * @brief Adds a dated future of an underlying.
+ * @param underlying The index of the underlying.
+ * @param future_quote The index of the future in the book.
+ * @param future The future.
+ * @return The index of the future.
+ * @throw CarryUnknownUnderlying
+ * @throw CarryPerpetualFuture
+ */
+std::size_t CarryTermStructure::add_future(
+    const std::size_t underlying,
+    const std::size_t future_quote,
+    const std::shared_ptr<CryptoFuture>& future)
+{
+    if (underlying >= spots_.size()){throw CarryUnknownUnderlying();}
+    if (future->is_perpetual()){throw CarryPerpetualFuture();}
+    future_year_fraction_indices_.push_back(
+        year_fractions_.register_expiry(future->get_expiry_timestamp(), future->get_future()->get_day_count()));
+    future_underlyings_.push_back(underlying);
+    future_quotes_.push_back(future_quote);
+    prepared_ = false;
+    return future_quotes_.size() - 1;
+};
+
+/**
+ * @brief Adds an option expiry of an underlying, at which the forward and the carry are
+ * interpolated.
+ * @param underlying The index of the underlying.
+ * @param expiry_timestamp The expiry.
+ * @param day_count The day count convention of the options.
+ * @return The index of the expiry.
+ * @throw CarryUnknownUnderlying
+ */
+std::size_t CarryTermStructure::add_expiry(
+    const std::size_t underlying,
+    const Timestamp expiry_timestamp,
+    const DayCountConvention day_count)
+{
+    if (underlying >= spots_.size()){throw CarryUnknownUnderlying();}
+    expiry_year_fraction_indices_.push_back(year_fractions_.register_expiry(expiry_timestamp, day_count));
+    expiry_underlyings_.push_back(underlying);
+    prepared_ = false;
+    return expiry_underlyings_.size() - 1;
+};
+
+/**
+ * @return The number of underlyings.
+ */
+std::size_t CarryTermStructure::get_number_underlyings()
+{
+    return spots_.size();
+};
+
+/**
+ * @return The number of futures.
+ */
+std::size_t CarryTermStructure::get_number_futures()
+{
+    return future_quotes_.size();
+};
+
+/**
+ * @return The number of option expiries.
+ */
+std::size_t CarryTermStructure::get_number_expiries()
+{
+    return expiry_underlyings_.size();
+};
+
+/**
+ * @brief Sets the rate of an underlying, the outputs are refreshed by the next compute.
+ * @param underlying The index of the underlying.
+ * @param rate The rate of its quote currency.
+ * @throw CarryUnknownUnderlying
+ */
+void CarryTermStructure::set_rate(const std::size_t underlying, const double rate)
+{
+    if (underlying >= spots_.size()){throw CarryUnknownUnderlying();}
+    rates_[underlying] = rate;
+};
+
+/**
+ * @brief Moves the valuation time, the outputs are refreshed by the next compute.
+ * @param reference_timestamp The valuation time.
+ */
+void CarryTermStructure::set_reference_timestamp(const Timestamp reference_timestamp)
+{
+    year_fractions_.set_reference_timestamp(reference_timestamp);
+};
+
+/**
+ * @brief Groups the futures and the expiries by underlying, sorts the futures by year
+ * fraction and allocates the workspace. Called by compute and update after an add.
+ * @throw CarryDuplicatedQuote
+ */
+void CarryTermStructure::prepare()
+{
+    const std::size_t n_underlyings = spots_.size();
+    const std::size_t n_futures = future_quotes_.size();
+    const std::size_t n_expiries = expiry_underlyings_.size();
+
+    auto group = [n_underlyings](const std::vector<std::size_t>& owners, std::vector<std::size_t>& offsets, std::vector<std::size_t>& order)
+    {
+        offsets.assign(n_underlyings + 1, 0);
+        for (const std::size_t u : owners){offsets[u + 1]++;}
+        for (std::size_t u = 0; u < n_underlyings; ++u){offsets[u + 1] += offsets[u];}
+        order.resize(owners.size());
+        std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < owners.size(); ++i){order[next[owners[i]]++] = i;}
+    };
+    group(future_underlyings_, future_offsets_, future_order_);
+    group(expiry_underlyings_, expiry_offsets_, expiry_order_);
+    const double* T = year_fractions_.get_year_fractions();
+    for (std::size_t u = 0; u < n_underlyings; ++u)
+    {
+        std::stable_sort(future_order_.begin() + future_offsets_[u], future_order_.begin() + future_offsets_[u + 1],
+            [&](std::size_t a, std::size_t b){
+                return T[future_year_fraction_indices_[a]] < T[future_year_fraction_indices_[b]];});
+    }
+
+    std::size_t n_quotes = book_.size();
+    for (const std::size_t q : spots_){n_quotes = std::max(n_quotes, q + 1);}
+    for (const std::size_t q : future_quotes_){n_quotes = std::max(n_quotes, q + 1);}
+    quote_underlyings_.assign(n_quotes, CARRY_NONE);
+    for (std::size_t u = 0; u < n_underlyings; ++u)
+    {
+        if (quote_underlyings_[spots_[u]] != CARRY_NONE){throw CarryDuplicatedQuote();}
+        quote_underlyings_[spots_[u]] = u;
+    }
+    for (std::size_t f = 0; f < n_futures; ++f)
+    {
+        if (quote_underlyings_[future_quotes_[f]] != CARRY_NONE){throw CarryDuplicatedQuote();}
+        quote_underlyings_[future_quotes_[f]] = future_underlyings_[f];
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    spot_.assign(n_underlyings, nan);
+    forward_.assign(n_futures, nan);
+    basis_.assign(n_futures, nan);
+    annualized_basis_.assign(n_futures, nan);
+    carry_.assign(n_futures, nan);
+    is_valid_.assign(n_futures, 0);
+    pillar_T_.assign(n_futures + n_underlyings, 0.);
+    pillar_log_basis_.assign(n_futures + n_underlyings, 0.);
+    expiry_forward_.assign(n_expiries, nan);
+    expiry_carry_.assign(n_expiries, nan);
+    is_dirty_.assign(n_underlyings, 0);
+    dirty_.clear();
+    dirty_.reserve(n_underlyings);
+    prepared_ = true;
+};
+
+/**
+ * @brief Checks a quote and returns its mid.
+ * @param bid The bid.
+ * @param ask The ask.
+ * @param mid The mid if the quote is two-sided, positive and not crossed.
+ * @return True if the quote is valid.
+ */
+static bool get_mid(const double bid, const double ask, double& mid)
+{
+    if (!(bid > 0.) || !(ask >= bid) || !std::isfinite(ask)){return false;}
+    mid = 0.5*(bid + ask);
+    return true;
+};
+
+/**
+ * @brief Recomputes the futures and the expiries of an underlying from the book.
+ * @param underlying The index of the underlying.
+ */
+void CarryTermStructure::build(const std::size_t underlying)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double* bids = book_.get_bids();
+    const double* asks = book_.get_asks();
+    const double* T = year_fractions_.get_year_fractions();
+    const double r = rates_[underlying];
+    double S = nan;
+    const bool is_spot_valid = get_mid(bids[spots_[underlying]], asks[spots_[underlying]], S);
+    spot_[underlying] = S;
+
+    const std::size_t base = future_offsets_[underlying] + underlying;
+    std::size_t m = 1;
+    for (std::size_t k = future_offsets_[underlying]; k < future_offsets_[underlying + 1]; ++k)
+    {
+        const std::size_t f = future_order_[k];
+        const double t = T[future_year_fraction_indices_[f]];
+        double F;
+        const bool valid = is_spot_valid && t > 0. && get_mid(bids[future_quotes_[f]], asks[future_quotes_[f]], F);
+        is_valid_[f] = valid;
+        if (!valid)
+        {
+            forward_[f] = basis_[f] = annualized_basis_[f] = carry_[f] = nan;
+            continue;
+        }
+        const double log_basis = std::log(F/S);
+        forward_[f] = F;
+        basis_[f] = F - S;
+        annualized_basis_[f] = log_basis/t;
+        carry_[f] = r - annualized_basis_[f];
+        if (t > pillar_T_[base + m - 1])
+        {
+            pillar_T_[base + m] = t;
+            pillar_log_basis_[base + m] = log_basis;
+            m++;
+        }
+    }
+
+    const double* x = pillar_T_.data() + base;
+    const double* y = pillar_log_basis_.data() + base;
+    for (std::size_t k = expiry_offsets_[underlying]; k < expiry_offsets_[underlying + 1]; ++k)
+    {
+        const std::size_t e = expiry_order_[k];
+        const double t = T[expiry_year_fraction_indices_[e]];
+        if (m == 1)
+        {
+            expiry_forward_[e] = expiry_carry_[e] = nan;
+            continue;
+        }
+        double annualized;
+        if (t <= 0.){annualized = y[1]/x[1];}
+        else if (t >= x[m - 1]){annualized = y[m - 1]/x[m - 1];}
+        else
+        {
+            const std::size_t i = locate_interval(x, m, t);
+            annualized = (y[i] + (t - x[i])*(y[i + 1] - y[i])/(x[i + 1] - x[i]))/t;
+        }
+        expiry_forward_[e] = S*std::exp(annualized*std::max(t, 0.));
+        expiry_carry_[e] = r - annualized;
+    }
+};
+
+/**
+ * @brief Recomputes every underlying from the book.
+ * @throw CarryDuplicatedQuote
+ */
+void CarryTermStructure::compute()
+{
+    if (!prepared_){prepare();}
+    for (std::size_t u = 0; u < spots_.size(); ++u){build(u);}
+};
+
+/**
+ * @brief Recomputes the underlyings whose spot or futures are among the updated quotes, each
+ * one once.
+ * With ARBITRAGE_INSTRUMENTATION, the tick to price latency of each of these quotes is recorded
+ * from its exchange timestamp.
+ * @param quotes The indices in the book of the updated quotes, the others are ignored.
+ * @param n The number of quotes.
+ * @return The number of underlyings recomputed.
+ * @throw CarryDuplicatedQuote
+ */
+std::size_t CarryTermStructure::update(const std::size_t* quotes, const std::size_t n)
+{
+    if (!prepared_){prepare();}
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        if (quotes[k] >= quote_underlyings_.size()){continue;}
+        const std::size_t u = quote_underlyings_[quotes[k]];
+        if (u == CARRY_NONE || is_dirty_[u]){continue;}
+        is_dirty_[u] = 1;
+        dirty_.push_back(u);
+    }
+    const std::size_t n_dirty = dirty_.size();
+    for (const std::size_t u : dirty_)
+    {
+        build(u);
+        is_dirty_[u] = 0;
+    }
+    dirty_.clear();
+    if constexpr (INSTRUMENTATION_ENABLED)
+    {
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            if (quotes[k] >= quote_underlyings_.size() || quote_underlyings_[quotes[k]] == CARRY_NONE){continue;}
+            ARBITRAGE_INSTRUMENT_TICK_TO_PRICE(book_.get_timestamp(quotes[k]).ns);
+        }
+    }
+    return n_dirty;
+};
+
+/**
+ * @param i The index of the future.
+ * @return Its mid.
+ */
+double CarryTermStructure::get_forward(const std::size_t i)
+{
+    return forward_[i];
+};
+
+/**
+ * @param i The index of the future.
+ * @return Its basis F - S.
+ */
+double CarryTermStructure::get_basis(const std::size_t i)
+{
+    return basis_[i];
+};
+
+/**
+ * @param i The index of the future.
+ * @return Its annualized basis ln(F/S)/T.
+ */
+double CarryTermStructure::get_annualized_basis(const std::size_t i)
+{
+    return annualized_basis_[i];
+};
+
+/**
+ * @param i The index of the future.
+ * @return Its implied carry r - ln(F/S)/T.
+ */
+double CarryTermStructure::get_carry(const std::size_t i)
+{
+    return carry_[i];
+};
+
+/**
+ * @param i The index of the option expiry.
+ * @return The interpolated forward.
+ */
+double CarryTermStructure::get_expiry_forward(const std::size_t i)
+{
+    return expiry_forward_[i];
+};
+
+/**
+ * @param i The index of the option expiry.
+ * @return The interpolated carry.
+ */
+double CarryTermStructure::get_expiry_carry(const std::size_t i)
+{
+    return expiry_carry_[i];
+};
+
+/**
+ * @return The interpolated forwards of the option expiries, in the order of add_expiry.
+ */
+const double* CarryTermStructure::get_expiry_forwards()
+{
+    return expiry_forward_.data();
+};
+
+/**
+ * @return The interpolated carries of the option expiries, in the order of add_expiry, the q
+ * input of the Black-Scholes batch.
+ */
+const double* CarryTermStructure::get_expiry_carries()
+{
+    return expiry_carry_.data();
+};
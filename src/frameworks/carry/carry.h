@@ -0,0 +1,76 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "../../datastructure/datetime/yearfraction/yearfraction.h"
+#include "../../datastructure/market/assets/crypto/cryptoassets.h"
+#include "../../datastructure/market/quotebook/quotebook.h"
+#include "../../math/interpolation2D/interpolation.h"
+#include "../../instrumentation/instrumentation.h"
+
+constexpr std::size_t CARRY_NONE = std::numeric_limits<std::size_t>::max();
+
+class CarryPerpetualFuture:  public std::exception
+{public: const char * what() const throw();};
+
+class CarryUnknownUnderlying:  public std::exception
+{public: const char * what() const throw();};
+
+class CarryDuplicatedQuote:  public std::exception
+{public: const char * what() const throw();};
+
+struct CarryTermStructure
+{
+    const QuoteBook& book_;
+    std::vector<std::size_t> spots_;
+    std::vector<double> rates_;
+    std::vector<std::size_t> future_underlyings_;
+    std::vector<std::size_t> future_quotes_;
+    std::vector<std::size_t> expiry_underlyings_;
+    YearFractionTable year_fractions_;
+    std::vector<std::size_t> future_year_fraction_indices_;
+    std::vector<std::size_t> expiry_year_fraction_indices_;
+    bool prepared_;
+    std::vector<std::size_t> future_offsets_;
+    std::vector<std::size_t> future_order_;
+    std::vector<std::size_t> expiry_offsets_;
+    std::vector<std::size_t> expiry_order_;
+    std::vector<std::size_t> quote_underlyings_;
+    std::vector<double> spot_;
+    std::vector<double> forward_;
+    std::vector<double> basis_;
+    std::vector<double> annualized_basis_;
+    std::vector<double> carry_;
+    std::vector<unsigned char> is_valid_;
+    std::vector<double> pillar_T_;
+    std::vector<double> pillar_log_basis_;
+    std::vector<double> expiry_forward_;
+    std::vector<double> expiry_carry_;
+    std::vector<unsigned char> is_dirty_;
+    std::vector<std::size_t> dirty_;
+    CarryTermStructure(const QuoteBook& book, const Timestamp reference_timestamp);
+    ~CarryTermStructure(){};
+    std::size_t add_underlying(const std::size_t spot_quote, const double rate);
+    std::size_t add_future(const std::size_t underlying, const std::size_t future_quote, const std::shared_ptr<CryptoFuture>& future);
+    std::size_t add_expiry(const std::size_t underlying, const Timestamp expiry_timestamp, const DayCountConvention day_count);
+    std::size_t get_number_underlyings();
+    std::size_t get_number_futures();
+    std::size_t get_number_expiries();
+    void set_rate(const std::size_t underlying, const double rate);
+    void set_reference_timestamp(const Timestamp reference_timestamp);
+    void prepare();
+    void build(const std::size_t underlying);
+    void compute();
+    std::size_t update(const std::size_t* quotes, const std::size_t n);
+    double get_forward(const std::size_t i);
+    double get_basis(const std::size_t i);
+    double get_annualized_basis(const std::size_t i);
+    double get_carry(const std::size_t i);
+    double get_expiry_forward(const std::size_t i);
+    double get_expiry_carry(const std::size_t i);
+    const double* get_expiry_forwards();
+    const double* get_expiry_carries();
+};
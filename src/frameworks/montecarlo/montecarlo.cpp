@@ -0,0 +1,430 @@
+#include "montecarlo.h"
+
+/**
+* @file montecarlo.h
+* @brief This file defines the Monte Carlo pricer of the barrier and structured options under
+* the Black-Scholes dynamics.
+*
+* References :
+* - "Parallel random numbers: as easy as 1, 2, 3", Salmon, Moraes, Dror, Shaw, 2011.
+* - "A continuity correction for discrete barrier options", Broadie, Glasserman, Kou, 1997.
+*/
+
+/**
+ * @class MonteCarloNonPositiveParameter
+ * @brief Definition of the error when the spot, the volatility, the year fraction, the number 
+ * of paths or the number of steps is not positive.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * MonteCarloNonPositiveParameter::what() const throw(){
+    return "The spot, the volatility, the year fraction, the number of paths and the number of steps must be positive.";
+};
+
+/**
+ * @class MonteCarloEmptyPayoff
+ * @brief Definition of the error when a payoff has no leg.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * MonteCarloEmptyPayoff::what() const throw(){
+    return "The payoff must have at least one leg.";
+};
+
+/**
+ * @class MonteCarloWrongBarrier
+ * @brief Definition of the error when the levels of a barrier are not positive or not ordered.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * MonteCarloWrongBarrier::what() const throw(){
+    return "The barrier levels must be positive, and the lower level below the upper level for a double barrier.";
+};
+
+/**
+ * @class MonteCarloMismatchedExpiries
+ * @brief Definition of the error when the options of a structured option do not share their expiry.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * MonteCarloMismatchedExpiries::what() const throw(){
+    return "The options of a structured option must have the same expiry.";
+};
+
+/**
+ * @struct MonteCarloLeg
+ * @brief One vanilla leg of a payoff: weight*max(call_put_flag*(S_T - strike), 0).
+ */
+
+/**
+ * @struct MonteCarloBarrier
+ * @brief The barrier of a payoff, monitored at each time step. Only the level(s) of the type 
+ * are read: upper for UP_*, lower for DOWN_*, both for DOUBLE_*.
+ */
+
+/**
+ * @struct MonteCarloResult
+ * @brief The discounted price, its standard error, the control variate coefficient, the number 
+ * of simulated paths and the computation time.
+ */
+
+/**
+ * @struct MonteCarloEngine
+ * @brief The Monte Carlo pricer of the weighted sums of vanilla legs, with or without a knock-in
+ * or a knock-out barrier, under the Black-Scholes dynamics dS = (r - q)S dt + sigma S dW.
+ *
+ * The paths are simulated by blocks of MONTE_CARLO_BLOCK, each block has its own Philox stream 
+ * (the block index) and keeps its log-spots, minima and maxima in arrays (one value per path), 
+ * updated SIMD_WIDTH paths at a time. The blocks are independent and run on the thread pool, 
+ * their moments are merged in the block order: the result only depends on the seed, not on 
+ * the number of threads. Without barrier the spot is drawn at expiry in a single step. 
+ *
+ * The variance is reduced with antithetic pairs (the second half of a block uses the opposite
+ * normals) and with the vanilla legs without barrier as control variate, their expectation being
+ * the BlackScholesClosedForm prices: the price of a structured option without barrier is exact.
+ */
+
+ /**
+ * @var bool MonteCarloEngine::antithetic_
+ * @brief Whether the paths are simulated by antithetic pairs (true by default).
+ */
+
+ /**
+ * @var bool MonteCarloEngine::control_variate_
+ * @brief Whether the vanilla legs are used as control variate (true by default).
+ */
+
+ /**
+ * @var bool MonteCarloEngine::continuity_correction_
+ * @brief Whether the barrier is shifted by exp(-/+0.5826*sigma*sqrt(dt)) towards the spot, to 
+ * price a continuously monitored barrier from the discrete monitoring (false by default).
+ */
+
+static const std::size_t MONTE_CARLO_BLOCK = 1024;
+static const double BGK_BETA = 0.5826;
+
+/**
+ * @struct MonteCarloMoments
+ * @brief The number of samples, the means and the centered second moments of the payoff X and 
+ * of the control Y.
+ */
+struct MonteCarloMoments
+{
+    double n;
+    double mean_x;
+    double mean_y;
+    double m2_x;
+    double m2_y;
+    double c_xy;
+};
+
+/**
+ * @brief Merges the moments of two sets of samples (Chan, Golub, LeVeque, 1979).
+ * @param a The moments of the first set, updated.
+ * @param b The moments of the second set.
+ */
+static void merge_moments(MonteCarloMoments& a, const MonteCarloMoments& b)
+{
+    if (b.n==0){return;}
+    const double n = a.n + b.n;
+    const double dx = b.mean_x - a.mean_x;
+    const double dy = b.mean_y - a.mean_y;
+    const double f = a.n*b.n/n;
+    a.m2_x += b.m2_x + dx*dx*f;
+    a.m2_y += b.m2_y + dy*dy*f;
+    a.c_xy += b.c_xy + dx*dy*f;
+    a.mean_x += dx*b.n/n;
+    a.mean_y += dy*b.n/n;
+    a.n = n;
+};
+
+/**
+ * @brief Moves n log-spots by one step: x += drift + sign*vol*z.
+ * @param x The log-spots.
+ * @param z The normals.
+ * @param drift The drift of the step.
+ * @param vol The volatility of the step, with the sign of the antithetic side.
+ * @param n The number of paths.
+ */
+static void advance(double* x, const double* z, double drift, double vol, std::size_t n)
+{
+    const simd_double drift_v = simd_set1(drift);
+    const simd_double vol_v = simd_set1(vol);
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_store(x + i, simd_add(simd_load(x + i), simd_add(drift_v, simd_mul(vol_v, simd_load(z + i)))));
+    }
+    for (; i < n; ++i){x[i] += drift + vol*z[i];}
+};
+
+/**
+ * @brief Updates the running minima and maxima of n log-spots.
+ * @param x The log-spots.
+ * @param lo The minima.
+ * @param hi The maxima.
+ * @param n The number of paths.
+ */
+static void track_extremes(const double* x, double* lo, double* hi, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        const simd_double v = simd_load(x + i);
+        const simd_double l = simd_load(lo + i);
+        simd_store(lo + i, simd_select(simd_lt(v, l), v, l));
+        simd_store(hi + i, simd_max(v, simd_load(hi + i)));
+    }
+    for (; i < n; ++i){lo[i] = std::min(lo[i], x[i]); hi[i] = std::max(hi[i], x[i]);}
+};
+
+/**
+ * @brief Checks the inputs of a pricing.
+ * @param engine The engine.
+ * @param legs The legs of the payoff.
+ * @param T The year fraction to expiry.
+ * @param barrier The barrier, or nullptr.
+ * @throw MonteCarloNonPositiveParameter
+ * @throw MonteCarloEmptyPayoff
+ * @throw MonteCarloWrongBarrier
+ */
+static void check_inputs(
+    const MonteCarloEngine& engine, const std::vector<MonteCarloLeg>& legs, double T, const MonteCarloBarrier* barrier)
+{
+    if (!(engine.S_>0 && engine.sigma_>0 && T>0) || engine.n_paths_==0 || engine.n_steps_==0)
+    {
+        throw MonteCarloNonPositiveParameter();
+    }
+    if (legs.empty()){throw MonteCarloEmptyPayoff();}
+    if (!barrier){return;}
+    const bool up = barrier->type==UP_AND_IN || barrier->type==UP_AND_OUT;
+    const bool down = barrier->type==DOWN_AND_IN || barrier->type==DOWN_AND_OUT;
+    if ((!down && !(barrier->upper>0)) || (!up && !(barrier->lower>0))){throw MonteCarloWrongBarrier();}
+    if (!up && !down && !(barrier->lower<barrier->upper)){throw MonteCarloWrongBarrier();}
+};
+
+/**
+ * @brief Simulates one block of paths.
+ * @param engine The engine.
+ * @param legs The legs of the payoff.
+ * @param T The year fraction to expiry.
+ * @param barrier The barrier, or nullptr.
+ * @param block The index of the block, its Philox stream.
+ * @param m The number of paths of the block (even for antithetic pairs).
+ * @return The moments of the samples of the block (a sample is a pair with antithetic paths).
+ */
+static MonteCarloMoments simulate_block(
+    const MonteCarloEngine& engine, 
+    const std::vector<MonteCarloLeg>& legs, 
+    double T, 
+    const MonteCarloBarrier* barrier, 
+    std::size_t block, 
+    std::size_t m)
+{
+    const std::size_t n_draws = engine.antithetic_ ? m/2 : m;
+    const std::size_t n_steps = barrier ? engine.n_steps_ : 1;
+    const double dt = T/n_steps;
+    const double drift = (engine.r_ - engine.q_ - .5*engine.sigma_*engine.sigma_)*dt;
+    const double vol = engine.sigma_*sqrt(dt);
+
+    std::vector<double> x(m, 0.0), z(n_draws), lo, hi;
+    if (barrier){lo.assign(m, 0.0); hi.assign(m, 0.0);}
+    Philox rng(engine.seed_, block);
+    for (std::size_t j = 0; j < n_steps; ++j)
+    {
+        rng.normal_n(z.data(), n_draws);
+        advance(x.data(), z.data(), drift, vol, n_draws);
+        if (engine.antithetic_){advance(x.data() + n_draws, z.data(), drift, -vol, n_draws);}
+        if (barrier){track_extremes(x.data(), lo.data(), hi.data(), m);}
+    }
+
+    std::vector<double>& spot = z;
+    spot.resize(m);
+    const simd_double S = simd_set1(engine.S_);
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= m; i += SIMD_WIDTH){simd_store(spot.data() + i, simd_mul(S, simd_exp(simd_load(x.data() + i))));}
+    for (; i < m; ++i){spot[i] = engine.S_*exp(x[i]);}
+
+    std::vector<double> payoff(m), control(m);
+    for (std::size_t p = 0; p < m; ++p)
+    {
+        double y = 0.0;
+        for (const MonteCarloLeg& leg : legs){y += leg.weight*std::max(leg.call_put_flag*(spot[p] - leg.strike), 0.0);}
+        control[p] = y;
+        payoff[p] = y;
+    }
+    if (barrier)
+    {
+        const double shift = engine.continuity_correction_ ? BGK_BETA*vol : 0.0;
+        const double log_upper = barrier->upper > 0 ? log(barrier->upper/engine.S_) - shift : 0.0;
+        const double log_lower = barrier->lower > 0 ? log(barrier->lower/engine.S_) + shift : 0.0;
+        const bool up = barrier->type==UP_AND_IN || barrier->type==UP_AND_OUT || 
+            barrier->type==DOUBLE_KNOCK_IN || barrier->type==DOUBLE_KNOCK_OUT;
+        const bool down = barrier->type==DOWN_AND_IN || barrier->type==DOWN_AND_OUT || 
+            barrier->type==DOUBLE_KNOCK_IN || barrier->type==DOUBLE_KNOCK_OUT;
+        const bool knock_in = barrier->type==UP_AND_IN || barrier->type==DOWN_AND_IN || barrier->type==DOUBLE_KNOCK_IN;
+        for (std::size_t p = 0; p < m; ++p)
+        {
+            const bool touched = (up && hi[p] >= log_upper) || (down && lo[p] <= log_lower);
+            if (touched!=knock_in){payoff[p] = 0.0;}
+        }
+    }
+
+    const std::size_t n_samples = n_draws;
+    if (engine.antithetic_)
+    {
+        for (std::size_t k = 0; k < n_samples; ++k)
+        {
+            payoff[k] = .5*(payoff[k] + payoff[k + n_samples]);
+            control[k] = .5*(control[k] + control[k + n_samples]);
+        }
+    }
+    MonteCarloMoments moments{static_cast<double>(n_samples), 0.0, 0.0, 0.0, 0.0, 0.0};
+    for (std::size_t k = 0; k < n_samples; ++k){moments.mean_x += payoff[k]; moments.mean_y += control[k];}
+    moments.mean_x /= n_samples;
+    moments.mean_y /= n_samples;
+    for (std::size_t k = 0; k < n_samples; ++k)
+    {
+        const double dx = payoff[k] - moments.mean_x;
+        const double dy = control[k] - moments.mean_y;
+        moments.m2_x += dx*dx;
+        moments.m2_y += dy*dy;
+        moments.c_xy += dx*dy;
+    }
+    return moments;
+};
+
+/**
+ * @brief Runs a task for each index, on the pool if there is one.
+ * @param pool The thread pool, or nullptr to run serially.
+ * @param n The number of indices.
+ * @param task The task.
+ */
+static void for_each_index(ThreadPool* pool, std::size_t n, const std::function<void(std::size_t)>& task)
+{
+    if (pool){pool->parallel_for(n, task);}
+    else{for (std::size_t i = 0; i < n; ++i){task(i);}}
+};
+
+/**
+ * @brief The main constructor, with antithetic pairs and the control variate and without 
+ * continuity correction.
+ * @param S The spot.
+ * @param r The risk free rate.
+ * @param q The dividend (or repo, or foreign) rate.
+ * @param sigma The volatility.
+ * @param n_paths The number of paths (rounded up to an even number with antithetic pairs).
+ * @param n_steps The number of monitoring steps of a barrier.
+ * @param seed The seed of the Philox streams.
+ * @param pool The thread pool, or nullptr to run serially.
+ */
+MonteCarloEngine::MonteCarloEngine(
+    double S, 
+    double r, 
+    double q, 
+    double sigma, 
+    std::size_t n_paths, 
+    std::size_t n_steps, 
+    std::uint64_t seed, 
+    std::shared_ptr<ThreadPool> pool):
+    S_(S), r_(r), q_(q), sigma_(sigma), n_paths_(n_paths), n_steps_(n_steps), seed_(seed), 
+    antithetic_(true), control_variate_(true), continuity_correction_(false), pool_(pool){};
+
+/**
+ * @brief Prices a weighted sum of vanilla legs, with or without a barrier.
+ * @param legs The legs of the payoff.
+ * @param T The year fraction to expiry.
+ * @param barrier The barrier, or nullptr.
+ * @return The discounted price and its standard error.
+ * @throw MonteCarloNonPositiveParameter
+ * @throw MonteCarloEmptyPayoff
+ * @throw MonteCarloWrongBarrier
+ */
+MonteCarloResult MonteCarloEngine::price(const std::vector<MonteCarloLeg>& legs, double T, const MonteCarloBarrier* barrier)
+{
+    const auto start = std::chrono::steady_clock::now();
+    check_inputs(*this, legs, T, barrier);
+    const std::size_t n_paths = antithetic_ ? n_paths_ + n_paths_%2 : n_paths_;
+    const std::size_t n_blocks = (n_paths + MONTE_CARLO_BLOCK - 1)/MONTE_CARLO_BLOCK;
+
+    std::vector<MonteCarloMoments> blocks(n_blocks);
+    for_each_index(pool_.get(), n_blocks, [&](std::size_t b)
+    {
+        const std::size_t m = std::min(MONTE_CARLO_BLOCK, n_paths - b*MONTE_CARLO_BLOCK);
+        blocks[b] = simulate_block(*this, legs, T, barrier, b, m);
+    });
+    MonteCarloMoments total = blocks[0];
+    for (std::size_t b = 1; b < n_blocks; ++b){merge_moments(total, blocks[b]);}
+
+    const double df = exp(-r_*T);
+    double expected_control = 0.0;
+    for (const MonteCarloLeg& leg : legs)
+    {
+        BlackScholesClosedForm vanilla(S_, leg.strike, r_, q_, sigma_, T, leg.call_put_flag==CALL, false);
+        expected_control += leg.weight*vanilla.price()/df;
+    }
+    const double beta = control_variate_ && total.m2_y > 0 ? total.c_xy/total.m2_y : 0.0;
+    const double estimate = total.mean_x - beta*(total.mean_y - expected_control);
+    const double variance = total.n > 1 ? 
+        std::max(total.m2_x - 2*beta*total.c_xy + beta*beta*total.m2_y, 0.0)/(total.n - 1) : 0.0;
+
+    MonteCarloResult result{df*estimate, df*sqrt(variance/total.n), beta, n_paths, 0.0};
+    result.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return result;
+};
+
+/**
+ * @brief Prices an option, with or without a barrier.
+ * @param option The option.
+ * @param reference_timestamp The pricing time.
+ * @param barrier The barrier, or nullptr.
+ * @return The discounted price and its standard error.
+ * @throw NonPositiveYearFractionError
+ * @throw MonteCarloNonPositiveParameter
+ * @throw MonteCarloWrongBarrier
+ */
+MonteCarloResult MonteCarloEngine::price_option(Option& option, const Timestamp reference_timestamp, const MonteCarloBarrier* barrier)
+{
+    const std::vector<MonteCarloLeg> legs{{1.0, option.get_strike(), option.get_option_type()}};
+    return price(legs, option.get_year_fraction(reference_timestamp), barrier);
+};
+
+/**
+ * @brief Prices a structured option (a weighted basket of options with the same expiry), with 
+ * or without a barrier.
+ * @param option The structured option.
+ * @param reference_timestamp The pricing time.
+ * @param barrier The barrier, or nullptr.
+ * @return The discounted price and its standard error.
+ * @throw MonteCarloMismatchedExpiries
+ * @throw NonPositiveYearFractionError
+ * @throw MonteCarloNonPositiveParameter
+ * @throw MonteCarloEmptyPayoff
+ * @throw MonteCarloWrongBarrier
+ */
+MonteCarloResult MonteCarloEngine::price_structured_option(
+    StructuredOption& option, 
+    const Timestamp reference_timestamp, 
+    const MonteCarloBarrier* barrier)
+{
+    const std::vector<std::shared_ptr<Option>> options = option.get_options();
+    const std::vector<double> weights = option.get_weights();
+    if (options.empty()){throw MonteCarloEmptyPayoff();}
+    std::vector<MonteCarloLeg> legs;
+    legs.reserve(options.size());
+    const Timestamp expiry = options[0]->get_expiry_timestamp();
+    for (std::size_t i = 0; i < options.size(); ++i)
+    {
+        if (options[i]->get_expiry_timestamp()!=expiry){throw MonteCarloMismatchedExpiries();}
+        legs.push_back(MonteCarloLeg{weights[i], options[i]->get_strike(), options[i]->get_option_type()});
+    }
+    return price(legs, options[0]->get_year_fraction(reference_timestamp), barrier);
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include "../../frameworks/blackscholes/blackscholes.h"
+#include "../../datastructure/market/instruments/options/options.h"
+#include "../../math/random/philox/philox.h"
+#include "../../math/simd/simd.h"
+#include "../../parallel/threadpool/threadpool.h"
+
+class MonteCarloNonPositiveParameter:  public std::exception
+{public: const char * what() const throw();};
+
+class MonteCarloEmptyPayoff:  public std::exception
+{public: const char * what() const throw();};
+
+class MonteCarloWrongBarrier:  public std::exception
+{public: const char * what() const throw();};
+
+class MonteCarloMismatchedExpiries:  public std::exception
+{public: const char * what() const throw();};
+
+struct MonteCarloLeg
+{
+    double weight;
+    double strike;
+    int call_put_flag;
+};
+
+struct MonteCarloBarrier
+{
+    BarrierType type;
+    double lower;
+    double upper;
+};
+
+struct MonteCarloResult
+{
+    double price;
+    double standard_error;
+    double control_variate_beta;
+    std::size_t n_paths;
+    double elapsed_us;
+};
+
+struct MonteCarloEngine
+{
+    double S_;
+    double r_;
+    double q_;
+    double sigma_;
+    std::size_t n_paths_;
+    std::size_t n_steps_;
+    std::uint64_t seed_;
+    bool antithetic_;
+    bool control_variate_;
+    bool continuity_correction_;
+    std::shared_ptr<ThreadPool> pool_;
+    MonteCarloEngine(
+        double S, 
+        double r, 
+        double q, 
+        double sigma, 
+        std::size_t n_paths, 
+        std::size_t n_steps, 
+        std::uint64_t seed, 
+        std::shared_ptr<ThreadPool> pool
+    );
+    ~MonteCarloEngine(){};
+    MonteCarloResult price(const std::vector<MonteCarloLeg>& legs, double T, const MonteCarloBarrier* barrier);
+    MonteCarloResult price_option(Option& option, const Timestamp reference_timestamp, const MonteCarloBarrier* barrier);
+    MonteCarloResult price_structured_option(
+        StructuredOption& option, 
+        const Timestamp reference_timestamp, 
+        const MonteCarloBarrier* barrier
+    );
+};
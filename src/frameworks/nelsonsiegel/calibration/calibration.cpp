@@ -0,0 +1,519 @@
+#include "calibration.h"
+
+/**
+* @file calibration.h
+* @brief This file defines the calibration of the Nelson-Siegel and Nelson-Siegel-Svensson
+* curves to zero-coupon rates.
+*
+* The fitted Nelson-Siegel curves are zero-coupon curves: they are evaluated with
+* NelsonSiegel::get_zero_rate and NelsonSiegel::get_zero_rates, NelsonSiegel::get_rate being the
+* instantaneous forward rate of the same parameters.
+*
+* For fixed decay parameters the rate is linear in the betas, so the betas are the solution of a
+* weighted linear least squares problem, solved exactly with the normal equations. Only the taus
+* are searched: first on a log spaced grid of [tau_min, tau_max] (the rows of the grid are
+* evaluated in parallel on a ThreadPool, the loadings of every grid tau are computed once), then
+* the best grid point is refined with a Nelder-Mead simplex on the log taus. Svensson taus are
+* kept ordered and apart (tau2 >= NS_MIN_TAU_RATIO*tau1), two close humps being collinear.
+*
+* Curves of different currencies are independent: NelsonSiegelCalibrator::calibrate_nelson_siegel
+* and NelsonSiegelCalibrator::calibrate_nelson_siegel_svensson fit them in parallel, each grid
+* being then searched sequentially.
+*
+* References :
+* - Parsimlonious modeling of yield curve (Nelson & Siegel, 1987).
+* - "Estimating forward interest rates with the extended Nelson & Siegel method" (Svensson, 1994).
+*/
+
+/**
+ * @class NelsonSiegelCalibrationWrongQuotes
+ * @brief Definition of the error when the calibration quotes are inconsistent.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NelsonSiegelCalibrationWrongQuotes::what() const throw(){
+    return "The quotes must have positive year fractions, and as many rates (and non negative weights) as year fractions.";
+};
+
+/**
+ * @class NelsonSiegelCalibrationNotEnoughQuotes
+ * @brief Definition of the error when a curve has less quotes than parameters.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NelsonSiegelCalibrationNotEnoughQuotes::what() const throw(){
+    return "A Nelson-Siegel curve needs at least 4 quotes and a Svensson curve at least 6 quotes to be calibrated.";
+};
+
+/**
+ * @class NelsonSiegelCalibrationWrongTaus
+ * @brief Definition of the error when the tau search range is not correct.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NelsonSiegelCalibrationWrongTaus::what() const throw(){
+    return "The tau search range must satisfy 0 < tau_min < tau_max with at least 3 grid points.";
+};
+
+static const std::size_t NS_MIN_QUOTES = 4;
+static const std::size_t NSS_MIN_QUOTES = 6;
+static const double NS_MIN_TAU_RATIO = 1.25;
+static const double NS_SINGULAR_PIVOT = 1e-13;
+
+/**
+ * @struct NelsonSiegelQuotes
+ * @brief The zero-coupon rates of one curve at the year fractions t. The weights are optional
+ * (empty means equal weights).
+ */
+
+/**
+ * @brief Adds the continuously compounded rate -log(price)/t implied by a zero-coupon bond price.
+ * @param bond The zero-coupon bond.
+ * @param reference_datetime The valuation date.
+ * @param price The price of the bond for a unit notional.
+ * @throw NelsonSiegelCalibrationWrongQuotes
+ * @throw NonPositiveYearFractionError
+ */
+void NelsonSiegelQuotes::add_zero_coupon_bond(
+    std::shared_ptr<ZeroCouponBond> bond,
+    std::shared_ptr<DateTime> reference_datetime,
+    double price)
+{
+    if (!(price > 0)){throw NelsonSiegelCalibrationWrongQuotes();}
+    const double year_fraction = bond->get_year_fraction(reference_datetime);
+    t.push_back(year_fraction);
+    rates.push_back(-log(price)/year_fraction);
+    if (!weights.empty()){weights.push_back(1.0);}
+};
+
+/**
+ * @struct NelsonSiegelFit
+ * @brief The fitted Nelson-Siegel curve, with its root mean square error, the number of
+ * objective evaluations (grid and simplex), the time spent in microseconds and whether the
+ * simplex converged.
+ */
+
+/**
+ * @struct NelsonSiegelSvenssonFit
+ * @brief The fitted Nelson-Siegel-Svensson curve, with the same statistics as NelsonSiegelFit.
+ */
+
+/**
+ * @param quotes The quotes of a curve.
+ * @param min_quotes The minimal number of quotes.
+ * @throw NelsonSiegelCalibrationWrongQuotes
+ * @throw NelsonSiegelCalibrationNotEnoughQuotes
+ */
+static void check_quotes(const NelsonSiegelQuotes& quotes, std::size_t min_quotes)
+{
+    const std::size_t n = quotes.t.size();
+    if (quotes.rates.size()!=n){throw NelsonSiegelCalibrationWrongQuotes();}
+    if (!quotes.weights.empty() && quotes.weights.size()!=n){throw NelsonSiegelCalibrationWrongQuotes();}
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (!(quotes.t[i] > 0) || !std::isfinite(quotes.rates[i])){throw NelsonSiegelCalibrationWrongQuotes();}
+        if (!quotes.weights.empty() && !(quotes.weights[i] >= 0)){throw NelsonSiegelCalibrationWrongQuotes();}
+    }
+    if (n < min_quotes){throw NelsonSiegelCalibrationNotEnoughQuotes();}
+};
+
+/**
+ * @param quotes The quotes of a curve.
+ * @return The sum of the weights.
+ */
+static double total_weight(const NelsonSiegelQuotes& quotes)
+{
+    if (quotes.weights.empty()){return static_cast<double>(quotes.t.size());}
+    double total = 0.0;
+    for (double weight : quotes.weights){total += weight;}
+    return total;
+};
+
+/**
+ * @brief Solves the weighted linear least squares problem of the betas for fixed loadings,
+ * with the normal equations and Gaussian elimination with partial pivoting.
+ *
+ * The regressors are 1, slope1, curvature1 and, if curvature2 is not null, curvature2.
+ *
+ * @param quotes The quotes of the curve.
+ * @param slope1 The slope loadings of tau (tau1).
+ * @param curvature1 The curvature loadings of tau (tau1).
+ * @param curvature2 The curvature loadings of tau2, or null for a Nelson-Siegel curve.
+ * @param beta The betas, 3 or 4 values.
+ * @return The weighted sum of squared errors, infinity if the regressors are collinear.
+ */
+static double solve_betas(
+    const NelsonSiegelQuotes& quotes,
+    const double* slope1,
+    const double* curvature1,
+    const double* curvature2,
+    double* beta)
+{
+    const int p = curvature2 ? 4 : 3;
+    const bool weighted = !quotes.weights.empty();
+    const std::size_t n = quotes.t.size();
+    double M[16] = {0};
+    double rhs[4] = {0};
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double weight = weighted ? quotes.weights[i] : 1.0;
+        const double x[4] = {1.0, slope1[i], curvature1[i], curvature2 ? curvature2[i] : 0.0};
+        for (int r = 0; r < p; ++r)
+        {
+            const double wx = weight*x[r];
+            rhs[r] += wx*quotes.rates[i];
+            for (int c = r; c < p; ++c){M[r*p+c] += wx*x[c];}
+        }
+    }
+    double scale = 0.0;
+    for (int r = 0; r < p; ++r)
+    {
+        scale = std::max(scale, M[r*p+r]);
+        for (int c = 0; c < r; ++c){M[r*p+c] = M[c*p+r];}
+    }
+
+    for (int col = 0; col < p; ++col)
+    {
+        int pivot = col;
+        for (int row = col+1; row < p; ++row)
+            if (fabs(M[row*p+col]) > fabs(M[pivot*p+col])){pivot = row;}
+        if (!(fabs(M[pivot*p+col]) > NS_SINGULAR_PIVOT*scale)){return std::numeric_limits<double>::infinity();}
+        if (pivot != col)
+        {
+            for (int j = 0; j < p; ++j){std::swap(M[col*p+j], M[pivot*p+j]);}
+            std::swap(rhs[col], rhs[pivot]);
+        }
+        for (int row = col+1; row < p; ++row)
+        {
+            const double factor = M[row*p+col]/M[col*p+col];
+            for (int j = col; j < p; ++j){M[row*p+j] -= factor*M[col*p+j];}
+            rhs[row] -= factor*rhs[col];
+        }
+    }
+    for (int row = p-1; row >= 0; --row)
+    {
+        double value = rhs[row];
+        for (int j = row+1; j < p; ++j){value -= M[row*p+j]*beta[j];}
+        beta[row] = value/M[row*p+row];
+    }
+
+    double sse = 0.0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double weight = weighted ? quotes.weights[i] : 1.0;
+        double error = quotes.rates[i] - beta[0] - beta[1]*slope1[i] - beta[2]*curvature1[i];
+        if (curvature2){error -= beta[3]*curvature2[i];}
+        sse += weight*error*error;
+    }
+    return sse;
+};
+
+/**
+ * @brief Runs task(i) for i in [0, n), on the pool if it is not null.
+ * @param pool The thread pool, or null.
+ * @param n The number of tasks.
+ * @param task The task, called with its index.
+ */
+static void for_each_index(ThreadPool* pool, std::size_t n, const std::function<void(std::size_t)>& task)
+{
+    if (pool){pool->parallel_for(n, task);}
+    else{for (std::size_t i = 0; i < n; ++i){task(i);}}
+};
+
+/**
+ * @struct NelsonSiegelTauGrid
+ * @brief The log spaced taus of the grid search and their loadings at the quotes year fractions,
+ * row major (one row of n values per tau).
+ */
+struct NelsonSiegelTauGrid
+{
+    std::vector<double> taus;
+    std::vector<double> slope;
+    std::vector<double> curvature;
+};
+
+/**
+ * @param calibrator The calibrator defining the grid.
+ * @param quotes The quotes of the curve.
+ * @return The grid and its loadings.
+ */
+static NelsonSiegelTauGrid build_tau_grid(const NelsonSiegelCalibrator& calibrator, const NelsonSiegelQuotes& quotes)
+{
+    const std::size_t n = quotes.t.size();
+    const std::size_t n_tau = calibrator.n_tau_;
+    NelsonSiegelTauGrid grid;
+    grid.taus.resize(n_tau);
+    grid.slope.resize(n_tau*n);
+    grid.curvature.resize(n_tau*n);
+    const double log_ratio = log(calibrator.tau_max_/calibrator.tau_min_)/(n_tau-1);
+    for (std::size_t k = 0; k < n_tau; ++k)
+    {
+        grid.taus[k] = calibrator.tau_min_*exp(log_ratio*k);
+        get_nelson_siegel_loadings(
+            quotes.t.data(), n, grid.taus[k], grid.slope.data() + k*n, grid.curvature.data() + k*n);
+    }
+    return grid;
+};
+
+/**
+ * @brief Fits a Nelson-Siegel curve: grid search of tau, then simplex refinement of log(tau).
+ * @param calibrator The calibrator.
+ * @param quotes The quotes of the curve.
+ * @param pool The pool evaluating the grid, or null.
+ * @return The fit of the curve.
+ */
+static NelsonSiegelFit fit_nelson_siegel_curve(
+    const NelsonSiegelCalibrator& calibrator, const NelsonSiegelQuotes& quotes, ThreadPool* pool)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_CALIBRATION);
+    const auto start = std::chrono::steady_clock::now();
+    check_quotes(quotes, NS_MIN_QUOTES);
+    const std::size_t n = quotes.t.size();
+    const NelsonSiegelTauGrid grid = build_tau_grid(calibrator, quotes);
+
+    std::vector<double> sse(grid.taus.size());
+    for_each_index(pool, grid.taus.size(), [&](std::size_t k)
+    {
+        double beta[3];
+        sse[k] = solve_betas(quotes, grid.slope.data() + k*n, grid.curvature.data() + k*n, nullptr, beta);
+    });
+    const std::size_t best = std::min_element(sse.begin(), sse.end()) - sse.begin();
+
+    std::vector<double> slope(n), curvature(n);
+    const double log_tau_min = log(calibrator.tau_min_);
+    const double log_tau_max = log(calibrator.tau_max_);
+    auto objective = [&](const std::vector<double>& v)
+    {
+        if (!(v[0] >= log_tau_min && v[0] <= log_tau_max)){return std::numeric_limits<double>::infinity();}
+        double beta[3];
+        get_nelson_siegel_loadings(quotes.t.data(), n, exp(v[0]), slope.data(), curvature.data());
+        return solve_betas(quotes, slope.data(), curvature.data(), nullptr, beta);
+    };
+    const double log_step = (log_tau_max - log_tau_min)/(grid.taus.size()-1);
+    NelderMead minimizer = calibrator.minimizer_;
+    minimizer.f_tolerance_ = calibrator.minimizer_.f_tolerance_*total_weight(quotes);
+    const NelderMeadResult result = minimizer.minimize(objective, {log(grid.taus[best])}, {.5*log_step});
+
+    const double tau = exp(result.x[0]);
+    double beta[3];
+    get_nelson_siegel_loadings(quotes.t.data(), n, tau, slope.data(), curvature.data());
+    const double value = solve_betas(quotes, slope.data(), curvature.data(), nullptr, beta);
+    NelsonSiegelFit fit = {
+        NelsonSiegel(beta[0], beta[1], beta[2], tau),
+        sqrt(value/total_weight(quotes)),
+        static_cast<int>(grid.taus.size()) + result.evaluations,
+        0.0,
+        result.converged
+    };
+    ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_CALIBRATION_ITERATIONS, result.iterations);
+    fit.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return fit;
+};
+
+/**
+ * @brief Fits a Nelson-Siegel-Svensson curve: grid search of (tau1, tau2) with
+ * tau2 >= NS_MIN_TAU_RATIO*tau1, then simplex refinement of (log(tau1), log(tau2)).
+ * @param calibrator The calibrator.
+ * @param quotes The quotes of the curve.
+ * @param pool The pool evaluating the rows of the grid, or null.
+ * @return The fit of the curve.
+ */
+static NelsonSiegelSvenssonFit fit_nelson_siegel_svensson_curve(
+    const NelsonSiegelCalibrator& calibrator, const NelsonSiegelQuotes& quotes, ThreadPool* pool)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_CALIBRATION);
+    const auto start = std::chrono::steady_clock::now();
+    check_quotes(quotes, NSS_MIN_QUOTES);
+    const std::size_t n = quotes.t.size();
+    const std::size_t n_tau = calibrator.n_tau_;
+    const NelsonSiegelTauGrid grid = build_tau_grid(calibrator, quotes);
+
+    std::vector<double> row_sse(n_tau, std::numeric_limits<double>::infinity());
+    std::vector<std::size_t> row_best(n_tau, 0);
+    std::vector<int> row_evaluations(n_tau, 0);
+    for_each_index(pool, n_tau, [&](std::size_t k1)
+    {
+        double beta[4];
+        for (std::size_t k2 = k1+1; k2 < n_tau; ++k2)
+        {
+            if (grid.taus[k2] < NS_MIN_TAU_RATIO*grid.taus[k1]){continue;}
+            const double value = solve_betas(
+                quotes, grid.slope.data() + k1*n, grid.curvature.data() + k1*n, grid.curvature.data() + k2*n, beta);
+            row_evaluations[k1]++;
+            if (value < row_sse[k1]){row_sse[k1] = value; row_best[k1] = k2;}
+        }
+    });
+    const std::size_t best1 = std::min_element(row_sse.begin(), row_sse.end()) - row_sse.begin();
+    const std::size_t best2 = row_best[best1];
+    int evaluations = 0;
+    for (int count : row_evaluations){evaluations += count;}
+
+    std::vector<double> slope1(n), curvature1(n), slope2(n), curvature2(n);
+    const double log_tau_min = log(calibrator.tau_min_);
+    const double log_tau_max = log(calibrator.tau_max_);
+    const double log_min_ratio = log(NS_MIN_TAU_RATIO);
+    auto objective = [&](const std::vector<double>& v)
+    {
+        if (!(v[0] >= log_tau_min && v[1] <= log_tau_max && v[1] - v[0] >= log_min_ratio))
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+        double beta[4];
+        get_nelson_siegel_loadings(quotes.t.data(), n, exp(v[0]), slope1.data(), curvature1.data());
+        get_nelson_siegel_loadings(quotes.t.data(), n, exp(v[1]), slope2.data(), curvature2.data());
+        return solve_betas(quotes, slope1.data(), curvature1.data(), curvature2.data(), beta);
+    };
+    const double log_step = (log_tau_max - log_tau_min)/(n_tau-1);
+    NelderMead minimizer = calibrator.minimizer_;
+    minimizer.f_tolerance_ = calibrator.minimizer_.f_tolerance_*total_weight(quotes);
+    const NelderMeadResult result = minimizer.minimize(
+        objective, {log(grid.taus[best1]), log(grid.taus[best2])}, {.5*log_step, .5*log_step});
+
+    const double tau1 = exp(result.x[0]);
+    const double tau2 = exp(result.x[1]);
+    double beta[4];
+    get_nelson_siegel_loadings(quotes.t.data(), n, tau1, slope1.data(), curvature1.data());
+    get_nelson_siegel_loadings(quotes.t.data(), n, tau2, slope2.data(), curvature2.data());
+    const double value = solve_betas(quotes, slope1.data(), curvature1.data(), curvature2.data(), beta);
+    NelsonSiegelSvenssonFit fit = {
+        NelsonSiegelSvensson(beta[0], beta[1], beta[2], beta[3], tau1, tau2),
+        sqrt(value/total_weight(quotes)),
+        evaluations + result.evaluations,
+        0.0,
+        result.converged
+    };
+    ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_CALIBRATION_ITERATIONS, result.iterations);
+    fit.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return fit;
+};
+
+/**
+ * @struct NelsonSiegelCalibrator
+ * @brief The calibrator of the Nelson-Siegel type curves.
+ */
+
+ /**
+ * @var std::shared_ptr<ThreadPool> NelsonSiegelCalibrator::pool_
+ * @brief The thread pool searching the taus or fitting the curves, everything is sequential if null.
+ */
+
+ /**
+ * @var NelderMead NelsonSiegelCalibrator::minimizer_
+ * @brief The minimizer refining the log taus, its function tolerance is on the mean squared error.
+ */
+
+ /**
+ * @var double NelsonSiegelCalibrator::tau_min_
+ * @brief The lower bound of the taus.
+ */
+
+ /**
+ * @var double NelsonSiegelCalibrator::tau_max_
+ * @brief The upper bound of the taus.
+ */
+
+ /**
+ * @var std::size_t NelsonSiegelCalibrator::n_tau_
+ * @brief The number of log spaced taus of the grid search.
+ */
+
+/**
+ * @brief The standard constructor, the taus are searched in [0.05, 30] on a grid of 40 taus, the
+ * log tau tolerance is set to 1e-6 and the maximal number of Nelder-Mead iterations to 200.
+ * @param pool The thread pool (can be null).
+ */
+NelsonSiegelCalibrator::NelsonSiegelCalibrator(std::shared_ptr<ThreadPool> pool):
+    NelsonSiegelCalibrator(pool, 0.05, 30.0, 40, 1e-6, 200){};
+
+/**
+ * @brief The main constructor.
+ * @param pool The thread pool (can be null).
+ * @param tau_min The lower bound of the taus.
+ * @param tau_max The upper bound of the taus.
+ * @param n_tau The number of log spaced taus of the grid search.
+ * @param tolerance The tolerance on the log taus, the tolerance on the mean squared error is its square.
+ * @param max_iterations The maximal number of Nelder-Mead iterations of each fit.
+ * @throw NelsonSiegelCalibrationWrongTaus
+ */
+NelsonSiegelCalibrator::NelsonSiegelCalibrator(
+    std::shared_ptr<ThreadPool> pool,
+    double tau_min,
+    double tau_max,
+    std::size_t n_tau,
+    double tolerance,
+    int max_iterations):
+    pool_(pool),
+    minimizer_(tolerance, tolerance*tolerance, max_iterations),
+    tau_min_(tau_min),
+    tau_max_(tau_max),
+    n_tau_(n_tau)
+{
+    if (!(tau_min > 0 && tau_max > tau_min) || n_tau < 3){throw NelsonSiegelCalibrationWrongTaus();}
+};
+
+/**
+ * @brief Fits a Nelson-Siegel curve, the tau grid is evaluated on the pool.
+ * @param quotes The quotes of the curve.
+ * @return The fit of the curve.
+ * @throw NelsonSiegelCalibrationWrongQuotes
+ * @throw NelsonSiegelCalibrationNotEnoughQuotes
+ */
+NelsonSiegelFit NelsonSiegelCalibrator::fit_nelson_siegel(const NelsonSiegelQuotes& quotes)
+{
+    return fit_nelson_siegel_curve(*this, quotes, pool_.get());
+};
+
+/**
+ * @brief Fits a Nelson-Siegel-Svensson curve, the rows of the (tau1, tau2) grid are evaluated on the pool.
+ * @param quotes The quotes of the curve.
+ * @return The fit of the curve.
+ * @throw NelsonSiegelCalibrationWrongQuotes
+ * @throw NelsonSiegelCalibrationNotEnoughQuotes
+ */
+NelsonSiegelSvenssonFit NelsonSiegelCalibrator::fit_nelson_siegel_svensson(const NelsonSiegelQuotes& quotes)
+{
+    return fit_nelson_siegel_svensson_curve(*this, quotes, pool_.get());
+};
+
+/**
+ * @brief Fits independent Nelson-Siegel curves (one per currency for instance), in parallel on the pool.
+ * @param quotes The quotes of every curve.
+ * @return The fits, in the order of the quotes.
+ * @throw NelsonSiegelCalibrationWrongQuotes
+ * @throw NelsonSiegelCalibrationNotEnoughQuotes
+ */
+std::vector<NelsonSiegelFit> NelsonSiegelCalibrator::calibrate_nelson_siegel(
+    const std::vector<NelsonSiegelQuotes>& quotes)
+{
+    std::vector<NelsonSiegelFit> fits(quotes.size(), {NelsonSiegel(0, 0, 0, 1), 0, 0, 0, false});
+    for_each_index(pool_.get(), quotes.size(), [this, &quotes, &fits](std::size_t i)
+    {
+        fits[i] = fit_nelson_siegel_curve(*this, quotes[i], nullptr);
+    });
+    return fits;
+};
+
+/**
+ * @brief Fits independent Nelson-Siegel-Svensson curves (one per currency for instance), in parallel on the pool.
+ * @param quotes The quotes of every curve.
+ * @return The fits, in the order of the quotes.
+ * @throw NelsonSiegelCalibrationWrongQuotes
+ * @throw NelsonSiegelCalibrationNotEnoughQuotes
+ */
+std::vector<NelsonSiegelSvenssonFit> NelsonSiegelCalibrator::calibrate_nelson_siegel_svensson(
+    const std::vector<NelsonSiegelQuotes>& quotes)
+{
+    std::vector<NelsonSiegelSvenssonFit> fits(
+        quotes.size(), {NelsonSiegelSvensson(0, 0, 0, 0, 1, 2), 0, 0, 0, false});
+    for_each_index(pool_.get(), quotes.size(), [this, &quotes, &fits](std::size_t i)
+    {
+        fits[i] = fit_nelson_siegel_svensson_curve(*this, quotes[i], nullptr);
+    });
+    return fits;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+#include "../../../frameworks/nelsonsiegel/nelsonsiegel.h"
+#include "../../../datastructure/market/assets/interestrate/irassets.h"
+#include "../../../math/optimization/neldermead/neldermead.h"
+#include "../../../parallel/threadpool/threadpool.h"
+#include "../../../instrumentation/instrumentation.h"
+
+class NelsonSiegelCalibrationWrongQuotes:  public std::exception
+{public: const char * what() const throw();};
+
+class NelsonSiegelCalibrationNotEnoughQuotes:  public std::exception
+{public: const char * what() const throw();};
+
+class NelsonSiegelCalibrationWrongTaus:  public std::exception
+{public: const char * what() const throw();};
+
+struct NelsonSiegelQuotes
+{
+    std::vector<double> t;
+    std::vector<double> rates;
+    std::vector<double> weights;
+    void add_zero_coupon_bond(
+        std::shared_ptr<ZeroCouponBond> bond,
+        std::shared_ptr<DateTime> reference_datetime,
+        double price
+    );
+};
+
+struct NelsonSiegelFit
+{
+    NelsonSiegel curve;
+    double rmse;
+    int evaluations;
+    double elapsed_us;
+    bool converged;
+};
+
+struct NelsonSiegelSvenssonFit
+{
+    NelsonSiegelSvensson curve;
+    double rmse;
+    int evaluations;
+    double elapsed_us;
+    bool converged;
+};
+
+struct NelsonSiegelCalibrator
+{
+    std::shared_ptr<ThreadPool> pool_;
+    NelderMead minimizer_;
+    double tau_min_;
+    double tau_max_;
+    std::size_t n_tau_;
+    NelsonSiegelCalibrator(std::shared_ptr<ThreadPool> pool);
+    NelsonSiegelCalibrator(
+        std::shared_ptr<ThreadPool> pool,
+        double tau_min,
+        double tau_max,
+        std::size_t n_tau,
+        double tolerance,
+        int max_iterations
+    );
+    ~NelsonSiegelCalibrator(){};
+    NelsonSiegelFit fit_nelson_siegel(const NelsonSiegelQuotes& quotes);
+    NelsonSiegelSvenssonFit fit_nelson_siegel_svensson(const NelsonSiegelQuotes& quotes);
+    std::vector<NelsonSiegelFit> calibrate_nelson_siegel(
+        const std::vector<NelsonSiegelQuotes>& quotes);
+    std::vector<NelsonSiegelSvenssonFit> calibrate_nelson_siegel_svensson(
+        const std::vector<NelsonSiegelQuotes>& quotes);
+};
@@ -0,0 +1,238 @@
+#include "curve.h"
+
+/**
+* @file curve.h
+* @brief This file defines a Nelson-Siegel type yield curve cached on a fixed maturity grid.
+*
+* The pricers of a book ask the curve at a small and repeated set of year fractions (the option
+* expiries and the future maturities). The zero-coupon rates, the discount factors exp(-r*t)
+* and the instantaneous forward rates of these maturities are computed once, with the batched
+* loadings of get_nelson_siegel_loadings, and handed out in O(1) by index. The cache is only
+* rebuilt when NelsonSiegelCurve::set_parameters is given different parameters.
+*/
+
+/**
+ * @class NelsonSiegelCurveWrongMaturities
+ * @brief Definition of the error when the maturity grid is not correct.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NelsonSiegelCurveWrongMaturities::what() const throw(){
+    return "The maturities must be distinct non negative year fractions.";
+};
+
+/**
+ * @class NelsonSiegelCurveUnknownMaturity
+ * @brief Definition of the error when a maturity is not on the grid of the curve.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NelsonSiegelCurveUnknownMaturity::what() const throw(){
+    return "The maturity is not on the grid of the curve.";
+};
+
+/**
+ * @struct NelsonSiegelCurve
+ * @brief The cached yield curve. A Nelson-Siegel model is stored as a Svensson model with b3 = 0.
+ */
+
+ /**
+ * @var NelsonSiegelSvensson NelsonSiegelCurve::model_
+ * @brief The model of the curve.
+ */
+
+ /**
+ * @var std::vector<double> NelsonSiegelCurve::maturities_
+ * @brief The maturity grid (year fractions), in the order given by the user.
+ */
+
+ /**
+ * @var std::unordered_map<double, std::size_t> NelsonSiegelCurve::indices_
+ * @brief The index of each maturity of the grid.
+ */
+
+ /**
+ * @var std::vector<double> NelsonSiegelCurve::rates_
+ * @brief The zero-coupon rates of the grid.
+ */
+
+ /**
+ * @var std::vector<double> NelsonSiegelCurve::discount_factors_
+ * @brief The discount factors exp(-r*t) of the grid.
+ */
+
+ /**
+ * @var std::vector<double> NelsonSiegelCurve::forwards_
+ * @brief The instantaneous forward rates of the grid.
+ */
+
+ /**
+ * @var std::vector<double> NelsonSiegelCurve::slope_
+ * @brief The workspace of the slope loadings, allocated once.
+ */
+
+ /**
+ * @var std::vector<double> NelsonSiegelCurve::curvature_
+ * @brief The workspace of the curvature loadings, allocated once.
+ */
+
+ /**
+ * @var std::size_t NelsonSiegelCurve::version_
+ * @brief The number of rebuilds of the cache, so that a consumer can tell whether its copies are stale.
+ */
+
+/**
+ * @brief The constructor from a Nelson-Siegel model.
+ * @param model The model.
+ * @param maturities The maturity grid.
+ * @throw NelsonSiegelCurveWrongMaturities
+ */
+NelsonSiegelCurve::NelsonSiegelCurve(const NelsonSiegel& model, std::vector<double> maturities):
+    NelsonSiegelCurve(
+        NelsonSiegelSvensson(model.b0_, model.b1_, model.b2_, 0.0, model.tau_, model.tau_),
+        std::move(maturities)){};
+
+/**
+ * @brief The main constructor.
+ * @param model The model.
+ * @param maturities The maturity grid.
+ * @throw NelsonSiegelCurveWrongMaturities
+ */
+NelsonSiegelCurve::NelsonSiegelCurve(const NelsonSiegelSvensson& model, std::vector<double> maturities):
+    model_(model), maturities_(std::move(maturities)), version_(0)
+{
+    indices_.reserve(maturities_.size());
+    for (std::size_t i = 0; i < maturities_.size(); ++i)
+    {
+        if (!(maturities_[i] >= 0) || !std::isfinite(maturities_[i])){throw NelsonSiegelCurveWrongMaturities();}
+        if (!indices_.emplace(maturities_[i], i).second){throw NelsonSiegelCurveWrongMaturities();}
+    }
+    rates_.resize(maturities_.size());
+    discount_factors_.resize(maturities_.size());
+    forwards_.resize(maturities_.size());
+    slope_.resize(maturities_.size());
+    curvature_.resize(maturities_.size());
+    build();
+};
+
+/**
+ * @brief Sets the parameters of a Nelson-Siegel model, see NelsonSiegelCurve::set_parameters.
+ * @param model The model.
+ * @return True if the cache was rebuilt.
+ */
+bool NelsonSiegelCurve::set_parameters(const NelsonSiegel& model)
+{
+    return set_parameters(NelsonSiegelSvensson(model.b0_, model.b1_, model.b2_, 0.0, model.tau_, model.tau_));
+};
+
+/**
+ * @brief Sets the parameters of the model, the cache is rebuilt only if they changed.
+ * @param model The model.
+ * @return True if the cache was rebuilt.
+ */
+bool NelsonSiegelCurve::set_parameters(const NelsonSiegelSvensson& model)
+{
+    if (model.b0_==model_.b0_ && model.b1_==model_.b1_ && model.b2_==model_.b2_ && model.b3_==model_.b3_ 
+        && model.tau1_==model_.tau1_ && model.tau2_==model_.tau2_)
+    {
+        ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_CACHE_HITS, 1);
+        return false;
+    }
+    ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_CACHE_MISSES, 1);
+    model_ = model;
+    build();
+    return true;
+};
+
+/**
+ * @brief Rebuilds the cache. With the loadings slope = (1-e)/tt and curvature = slope - e of
+ * each tau (e = exp(-tt), tt = t/tau), the rate is b0 + b1*slope1 + b2*curvature1 + b3*curvature2
+ * and the instantaneous forward rate is b0 + b1*e1 + b2*tt1*e1 + b3*tt2*e2. The second tau
+ * is skipped when b3 = 0.
+ */
+void NelsonSiegelCurve::build()
+{
+    const std::size_t n = maturities_.size();
+    const double* t = maturities_.data();
+    get_nelson_siegel_loadings(t, n, model_.tau1_, slope_.data(), curvature_.data());
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double e = slope_[i] - curvature_[i];
+        rates_[i] = model_.b0_ + model_.b1_*slope_[i] + model_.b2_*curvature_[i];
+        forwards_[i] = model_.b0_ + model_.b1_*e + model_.b2_*(t[i]/model_.tau1_)*e;
+    }
+    if (model_.b3_ != 0.0)
+    {
+        get_nelson_siegel_loadings(t, n, model_.tau2_, slope_.data(), curvature_.data());
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const double e = slope_[i] - curvature_[i];
+            rates_[i] += model_.b3_*curvature_[i];
+            forwards_[i] += model_.b3_*(t[i]/model_.tau2_)*e;
+        }
+    }
+    for (std::size_t i = 0; i < n; ++i){discount_factors_[i] = exp(-rates_[i]*t[i]);}
+    version_++;
+};
+
+/**
+ * @return The number of maturities of the grid.
+ */
+std::size_t NelsonSiegelCurve::size()
+{
+    return maturities_.size();
+};
+
+/**
+ * @param t A maturity of the grid.
+ * @return Its index, in O(1).
+ * @throw NelsonSiegelCurveUnknownMaturity
+ */
+std::size_t NelsonSiegelCurve::find_maturity(double t)
+{
+    const auto it = indices_.find(t);
+    if (it==indices_.end()){throw NelsonSiegelCurveUnknownMaturity();}
+    return it->second;
+};
+
+/**
+ * @param i The index of a maturity of the grid.
+ * @return The cached zero-coupon rate.
+ */
+double NelsonSiegelCurve::get_rate(std::size_t i)
+{
+    return rates_[i];
+};
+
+/**
+ * @param i The index of a maturity of the grid.
+ * @return The cached discount factor.
+ */
+double NelsonSiegelCurve::get_discount_factor(std::size_t i)
+{
+    return discount_factors_[i];
+};
+
+/**
+ * @param i The index of a maturity of the grid.
+ * @return The cached instantaneous forward rate.
+ */
+double NelsonSiegelCurve::get_forward(std::size_t i)
+{
+    return forwards_[i];
+};
+
+/**
+ * @brief Gathers the discount factors of a batch, for instance as BlackScholesBatchInput::df.
+ * @param i The indices of the maturities.
+ * @param out The discount factors.
+ * @param n The number of indices.
+ */
+void NelsonSiegelCurve::get_discount_factors(const std::size_t* i, double* out, std::size_t n)
+{
+    for (std::size_t k = 0; k < n; ++k){out[k] = discount_factors_[i[k]];}
+};
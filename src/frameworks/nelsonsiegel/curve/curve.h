@@ -0,0 +1,38 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <unordered_map>
+#include "../../../frameworks/nelsonsiegel/nelsonsiegel.h"
+#include "../../../instrumentation/instrumentation.h"
+
+class NelsonSiegelCurveWrongMaturities:  public std::exception
+{public: const char * what() const throw();};
+
+class NelsonSiegelCurveUnknownMaturity:  public std::exception
+{public: const char * what() const throw();};
+
+struct NelsonSiegelCurve
+{
+    NelsonSiegelSvensson model_;
+    std::vector<double> maturities_;
+    std::unordered_map<double, std::size_t> indices_;
+    std::vector<double> rates_;
+    std::vector<double> discount_factors_;
+    std::vector<double> forwards_;
+    std::vector<double> slope_;
+    std::vector<double> curvature_;
+    std::size_t version_;
+    NelsonSiegelCurve(const NelsonSiegel& model, std::vector<double> maturities);
+    NelsonSiegelCurve(const NelsonSiegelSvensson& model, std::vector<double> maturities);
+    ~NelsonSiegelCurve(){};
+    bool set_parameters(const NelsonSiegel& model);
+    bool set_parameters(const NelsonSiegelSvensson& model);
+    void build();
+    std::size_t size();
+    std::size_t find_maturity(double t);
+    double get_rate(std::size_t i);
+    double get_discount_factor(std::size_t i);
+    double get_forward(std::size_t i);
+    void get_discount_factors(const std::size_t* i, double* out, std::size_t n);
+};
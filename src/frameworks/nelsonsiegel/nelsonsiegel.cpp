@@ -9,6 +9,43 @@
 * - "Estimating forward interest rates with the extended Nelson & Siegel method" (Svensson, 1994).
 */
 
+/**
+ * @brief Computes the Nelson-Siegel factor loadings of a batch of year fractions, with one
+ * exponential per point: slope(t) = (1-exp(-t/tau))/(t/tau) and curvature(t) = slope(t) - exp(-t/tau).
+ * The batch is evaluated SIMD_WIDTH points at a time with simd_exp.
+ * @param t The year fractions, non negative.
+ * @param n The number of year fractions.
+ * @param tau The decay parameter.
+ * @param slope The slope loadings.
+ * @param curvature The curvature loadings.
+ */
+void get_nelson_siegel_loadings(
+    const double* t, std::size_t n, double tau, double* slope, double* curvature)
+{
+    const double inverse_tau = 1.0/tau;
+    const simd_double one = simd_set1(1.0);
+    const simd_double half = simd_set1(0.5);
+    const simd_double small = simd_set1(1e-8);
+    const simd_double inverse_tau_v = simd_set1(inverse_tau);
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        const simd_double tt = simd_mul(simd_load(t + i), inverse_tau_v);
+        const simd_double e = simd_exp(simd_sub(simd_set1(0.0), tt));
+        const simd_double s = simd_select(
+            simd_lt(tt, small), simd_sub(one, simd_mul(half, tt)), simd_div(simd_sub(one, e), tt));
+        simd_store(slope + i, s);
+        simd_store(curvature + i, simd_sub(s, e));
+    }
+    for (; i < n; ++i)
+    {
+        const double tt = t[i]*inverse_tau;
+        const double e = exp(-tt);
+        slope[i] = tt < 1e-8 ? 1.0 - 0.5*tt : (1.0 - e)/tt;
+        curvature[i] = slope[i] - e;
+    }
+};
+
 /** 
  * @struct NelsonSiegel
  * @brief The Nelson-Siegel model framework.
@@ -55,6 +92,37 @@ double NelsonSiegel::get_rate(double t)
    return b0_ + b1_*exp(-tt) + b2_*(tt*exp(-tt));
 };
 
+/**
+ * @param t The year fraction to evaluate the model from.
+ * @return The corresponding zero-coupon rate, b0 + b1*slope(t) + b2*curvature(t), the average
+ * of the rate of get_rate over [0, t]. 
+ */
+double NelsonSiegel::get_zero_rate(double t)
+{
+   double slope, curvature;
+   get_nelson_siegel_loadings(&t, 1, tau_, &slope, &curvature);
+   return b0_ + b1_*slope + b2_*curvature;
+};
+
+/**
+ * @brief Evaluates the zero-coupon rates on a batch of year fractions, see
+ * get_nelson_siegel_loadings.
+ * @param t The year fractions to evaluate the model from.
+ * @param out The corresponding zero-coupon rates.
+ * @param n The number of year fractions.
+ */
+void NelsonSiegel::get_zero_rates(const double* t, double* out, std::size_t n)
+{
+   constexpr std::size_t block = 256;
+   double slope[block], curvature[block];
+   for (std::size_t start = 0; start < n; start += block)
+   {
+      const std::size_t m = std::min(block, n - start);
+      get_nelson_siegel_loadings(t + start, m, tau_, slope, curvature);
+      for (std::size_t i = 0; i < m; ++i){out[start + i] = b0_ + b1_*slope[i] + b2_*curvature[i];}
+   }
+};
+
 /** 
  * @struct NelsonSiegelSvensson
  * @brief The Svensson's extension of the Nelson-Siegel model framework.
@@ -109,7 +177,30 @@ double NelsonSiegel::get_rate(double t)
  */
 double NelsonSiegelSvensson::get_rate(double t)
 {
-   double tt1 = t/tau1_; 
-   double tt2 = t/tau2_; 
-   return b0_ + b1_*(1-exp(-tt1))/tt1 + b2_*((1-exp(-tt1))/tt1 - exp(-tt1)) + b3_*((1-exp(-tt2))/tt2 - exp(-tt2));
+   double slope1, curvature1, slope2, curvature2;
+   get_nelson_siegel_loadings(&t, 1, tau1_, &slope1, &curvature1);
+   get_nelson_siegel_loadings(&t, 1, tau2_, &slope2, &curvature2);
+   return b0_ + b1_*slope1 + b2_*curvature1 + b3_*curvature2;
+};
+
+/**
+ * @brief Evaluates the model on a batch of year fractions, see get_nelson_siegel_loadings.
+ * @param t The year fractions to evaluate the model from.
+ * @param out The corresponding rates.
+ * @param n The number of year fractions.
+ */
+void NelsonSiegelSvensson::get_rates(const double* t, double* out, std::size_t n)
+{
+   constexpr std::size_t block = 256;
+   double slope1[block], curvature1[block], slope2[block], curvature2[block];
+   for (std::size_t start = 0; start < n; start += block)
+   {
+      const std::size_t m = std::min(block, n - start);
+      get_nelson_siegel_loadings(t + start, m, tau1_, slope1, curvature1);
+      get_nelson_siegel_loadings(t + start, m, tau2_, slope2, curvature2);
+      for (std::size_t i = 0; i < m; ++i)
+      {
+         out[start + i] = b0_ + b1_*slope1[i] + b2_*curvature1[i] + b3_*curvature2[i];
+      }
+   }
 };
\ No newline at end of file
@@ -1,5 +1,11 @@
 #pragma once 
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+#include "../../math/simd/simd.h"
+
+void get_nelson_siegel_loadings(
+    const double* t, std::size_t n, double tau, double* slope, double* curvature);
 
 struct NelsonSiegel
 {
@@ -10,6 +16,8 @@ struct NelsonSiegel
     NelsonSiegel(double b0, double b1, double b2, double tau); 
     ~NelsonSiegel(){}; 
     double get_rate(double t);
+    double get_zero_rate(double t);
+    void get_zero_rates(const double* t, double* out, std::size_t n);
 }; 
 
 struct NelsonSiegelSvensson
@@ -23,5 +31,6 @@ struct NelsonSiegelSvensson
     NelsonSiegelSvensson(double b0, double b1, double b2, double b3, double tau1, double tau2); 
     ~NelsonSiegelSvensson(){}; 
     double get_rate(double t);
+    void get_rates(const double* t, double* out, std::size_t n);
 }; 
 
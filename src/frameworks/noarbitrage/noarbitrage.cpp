@@ -0,0 +1,1017 @@
+#include "noarbitrage.h"
+
+/**
+* @file noarbitrage.h
+* @brief This file defines the incremental scanner of the static arbitrages between the quotes of
+* the QuoteBook: the options (European, on one underlying), its spot, its dated futures and the
+* zero coupon bonds of its quote currency.
+*
+* The checks are the model free bounds, each one net of the bid/ask spreads (a violation is a
+* trade buying at the asks and selling at the bids with a positive edge today and a non negative
+* payoff):
+* - the put-call parity of the call and the put of a strike against the future of the expiry
+*   (or the spot when the expiry has no future): conversions and reversals;
+* - the vertical spreads of two adjacent strikes, monotonic and bounded by the discounted strike
+*   difference;
+* - the butterflies of three adjacent strikes, the convexity in the strike;
+* - the calendar spreads of two adjacent expiries at the same forward moneyness: the total
+*   variance is increasing in the expiry if and only if the prices normalized by the discounted
+*   forward, C/(D F) at K/F, are, so that the check needs no implied volatility. Between two
+*   strikes of the longer expiry the convex combination of their asks is the super replicating
+*   bound;
+* - the cash and carry of a future against the spot and the bonds, and its reverse.
+*
+* The discount factors of the expiries are interpolated linearly in the log prices of the bonds
+* of the underlying (their bids for the borrowing, their asks for the lending), from (0, 0) and
+* at a flat zero rate after the last one, or computed at the rate of the underlying without bond.
+* A positive cash flow at the expiry is worth its discounted value at the bid discount factor, a
+* negative one at the ask discount factor. The forwards used to normalize the calendar spreads are
+* the mids of the futures, or the mid spot over the discount factor.
+*
+* The options are grouped by (underlying, expiry) into contiguous buckets of strikes sorted by
+* prepare. An update re-checks the neighbours of the quoted instruments only: an option quote the
+* parity of its strike, the two verticals and three butterflies around it and the calendar spreads
+* of the points of the adjacent expiries bracketing it (found by binary search), a future quote
+* the basis and the parities of its expiry, a spot quote the bases and the parities against the
+* spot of the underlying, a bond quote the bases, parities and verticals of every expiry of the
+* underlying (the verticals only depend on the discount factors). The calendar spreads, whose
+* moneyness moves with the forwards, are re-checked with the parities: when the forward or the
+* discount factors of an expiry move, the calendar spreads of its points and of the points of the
+* previous expiry are re-checked. Every check runs at most once per update.
+*
+* References :
+* - "The relation between put and call option prices", Stoll, 1969.
+* - "Static arbitrage bounds on basket option prices", Davis, Hobson, 2007.
+* - "A note on sufficient conditions for no arbitrage", Carr, Madan, 2005.
+* - "Arbitrage-free SVI volatility surfaces", Gatheral, Jacquier, 2014.
+*/
+
+/**
+ * @var std::size_t NOARBITRAGE_NONE
+ * @brief The missing quote, future, expiry or point.
+ */
+
+/**
+ * @enum NoArbitrageViolationType
+ * @brief The arbitrages.
+ *
+ * - NOARBITRAGE_PARITY_CONVERSION: sell the call, buy the put and the forward.
+ * - NOARBITRAGE_PARITY_REVERSAL: buy the call, sell the put and the forward.
+ * - NOARBITRAGE_VERTICAL_MONOTONICITY: buy the option of the cheaper side of the strikes (the
+ *   lower strike call, the higher strike put) and sell the other one.
+ * - NOARBITRAGE_VERTICAL_BOUND: sell the option of the cheaper side, buy the other one and
+ *   lend the strike difference.
+ * - NOARBITRAGE_BUTTERFLY: buy the wings and sell the body.
+ * - NOARBITRAGE_CALENDAR: sell the shorter expiry option and buy the longer expiry ones.
+ * - NOARBITRAGE_CASH_AND_CARRY: borrow, buy the spot and sell the future.
+ * - NOARBITRAGE_REVERSE_CASH_AND_CARRY: sell the spot, lend, and buy the future.
+ */
+
+/**
+ * @enum NoArbitrageQuoteKind
+ * @brief The role of a quote of the book in the scanner.
+ */
+
+/**
+ * @class NoArbitrageUnknownUnderlying
+ * @brief Definition of the error when an underlying index is not in the scanner.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NoArbitrageUnknownUnderlying::what() const throw(){
+    return "The underlying is not in the no arbitrage scanner.";
+};
+
+/**
+ * @class NoArbitrageUnsupportedOption
+ * @brief Definition of the error when an option is not a European vanilla option.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NoArbitrageUnsupportedOption::what() const throw(){
+    return "Only European vanilla options are checked by the no arbitrage scanner.";
+};
+
+/**
+ * @class NoArbitragePerpetualFuture
+ * @brief Definition of the error when a perpetual future is added: it has no expiry.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NoArbitragePerpetualFuture::what() const throw(){
+    return "A perpetual future has no expiry, it can not be the forward of an expiry.";
+};
+
+/**
+ * @class NoArbitrageDuplicatedQuote
+ * @brief Definition of the error when a quote of the book is used twice, when an expiry gets a
+ * second future or a strike a second call or put.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NoArbitrageDuplicatedQuote::what() const throw(){
+    return "The quote, or the future of the expiry, or the option of the strike, is already in the scanner.";
+};
+
+/**
+ * @class NoArbitrageUnknownQuote
+ * @brief Definition of the error when a quote index is beyond the assets of the book.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NoArbitrageUnknownQuote::what() const throw(){
+    return "The quote is beyond the assets of the book.";
+};
+
+/**
+ * @struct NoArbitrageViolation
+ * @brief A violation found by an update.
+ * @var NoArbitrageViolation::quotes
+ * The quotes of the legs in the book, NOARBITRAGE_NONE for the unused ones: the call, the put and
+ * the forward of a parity; the lower and the higher strike of a vertical; the three strikes of a
+ * butterfly; the shorter expiry option and the two (or twice the same) longer expiry options of
+ * a calendar; the spot and the future of a basis.
+ * @var NoArbitrageViolation::strike
+ * The strike of the parity, the lower strike of the vertical, the body of the butterfly, the
+ * strike of the shorter expiry of the calendar, NaN for the basis.
+ * @var NoArbitrageViolation::edge
+ * The cash earned today net of the spreads, per unit of the structure: one call (or one shorter
+ * expiry option for a calendar, one body for a butterfly), one future for a basis.
+ * @var NoArbitrageViolation::timestamp
+ * The latest timestamp of the quotes of the legs.
+ */
+
+/**
+ * @struct NoArbitrageScanner
+ * @brief The buckets of the options and their spots, futures and bonds in the quote book, and the
+ * violations of the last update.
+ * @var NoArbitrageScanner::book_
+ * The quote book, it must outlive the scanner.
+ * @var NoArbitrageScanner::spots_
+ * The quote of the spot of each underlying.
+ * @var NoArbitrageScanner::rates_
+ * The rate of the quote currency of each underlying, used without a valid bond.
+ * @var NoArbitrageScanner::expiry_future_quotes_
+ * The quote of the future of each expiry, NOARBITRAGE_NONE when the parity uses the spot.
+ * @var NoArbitrageScanner::expiry_indices_
+ * The expiry of each (underlying, expiry timestamp).
+ * @var NoArbitrageScanner::minimum_edge_
+ * The edge above which a violation is emitted.
+ * @var NoArbitrageScanner::expiry_offsets_
+ * The expiries of underlying u are expiry_order_[expiry_offsets_[u], expiry_offsets_[u+1]), sorted
+ * by year fraction, expiry_previous_ and expiry_next_ link them.
+ * @var NoArbitrageScanner::bond_offsets_
+ * The bonds of underlying u are bond_order_[bond_offsets_[u], bond_offsets_[u+1]), sorted by year
+ * fraction, their pillars start at bond_offsets_[u] + u.
+ * @var NoArbitrageScanner::point_offsets_
+ * The strikes of expiry e are the points [point_offsets_[e], point_offsets_[e+1]), sorted, each with
+ * its call and put quotes (NOARBITRAGE_NONE if the strike has no such option).
+ * @var NoArbitrageScanner::quote_kinds_
+ * The role of each quote of the book, and in quote_targets_ its underlying, bond, expiry or point.
+ * @var NoArbitrageScanner::epoch_
+ * The number of updates, the checks (and underlyings, expiries) done by an update are marked with
+ * it in the _epochs_ arrays, curve_epochs_ marks the underlyings whose bonds were quoted.
+ */
+
+/**
+ * @brief Constructor.
+ * @param book The quote book, it must outlive the scanner.
+ * @param reference_timestamp The valuation time.
+ */
+NoArbitrageScanner::NoArbitrageScanner(const QuoteBook& book, const Timestamp reference_timestamp):
+    book_(book), year_fractions_(reference_timestamp), minimum_edge_(0.), prepared_(false), stale_(true), epoch_(0){};
+
+/**
+ * @brief Adds an underlying.
+ * @param spot_quote The index of its spot in the book.
+ * @param rate The rate of its quote currency, used for the expiries without a valid bond.
+ * @return The index of the underlying.
+ * @throw NoArbitrageUnknownQuote
+ */
+std::size_t NoArbitrageScanner::add_underlying(const std::size_t spot_quote, const double rate)
+{
+    if (spot_quote >= book_.size()){throw NoArbitrageUnknownQuote();}
+    spots_.push_back(spot_quote);
+    rates_.push_back(rate);
+    prepared_ = false;
+    return spots_.size() - 1;
+};
+
+/**
+ * @brief Adds a zero coupon bond of the quote currency of an underlying, a pillar of its
+ * discount factors.
+ * @param underlying The index of the underlying.
+ * @param bond_quote The index of the bond in the book, quoted for a notional of 1.
+ * @param bond The bond.
+ * @return The index of the bond.
+ * @throw NoArbitrageUnknownUnderlying
+ * @throw NoArbitrageUnknownQuote
+ */
+std::size_t NoArbitrageScanner::add_bond(
+    const std::size_t underlying,
+    const std::size_t bond_quote,
+    const std::shared_ptr<ZeroCouponBond>& bond)
+{
+    if (underlying >= spots_.size()){throw NoArbitrageUnknownUnderlying();}
+    if (bond_quote >= book_.size()){throw NoArbitrageUnknownQuote();}
+    bond_year_fraction_indices_.push_back(
+        year_fractions_.register_expiry(bond->get_expiry_timestamp(), bond->get_day_count_convention()));
+    bond_underlyings_.push_back(underlying);
+    bond_quotes_.push_back(bond_quote);
+    prepared_ = false;
+    return bond_quotes_.size() - 1;
+};
+
+/**
+ * @brief Adds the dated future of an expiry of an underlying, the forward of its parities.
+ * @param underlying The index of the underlying.
+ * @param future_quote The index of the future in the book.
+ * @param future The future.
+ * @return The index of the expiry.
+ * @throw NoArbitrageUnknownUnderlying
+ * @throw NoArbitrageUnknownQuote
+ * @throw NoArbitragePerpetualFuture
+ * @throw NoArbitrageDuplicatedQuote if the expiry already has a future.
+ */
+std::size_t NoArbitrageScanner::add_future(
+    const std::size_t underlying,
+    const std::size_t future_quote,
+    const std::shared_ptr<CryptoFuture>& future)
+{
+    if (underlying >= spots_.size()){throw NoArbitrageUnknownUnderlying();}
+    if (future_quote >= book_.size()){throw NoArbitrageUnknownQuote();}
+    if (future->is_perpetual()){throw NoArbitragePerpetualFuture();}
+    const std::size_t e = register_expiry(underlying, future->get_expiry_timestamp(), future->get_future()->get_day_count());
+    if (expiry_future_quotes_[e] != NOARBITRAGE_NONE){throw NoArbitrageDuplicatedQuote();}
+    expiry_future_quotes_[e] = future_quote;
+    return e;
+};
+
+/**
+ * @brief Adds an option of an underlying.
+ * @param underlying The index of the underlying.
+ * @param option_quote The index of the option in the book.
+ * @param option The crypto option.
+ * @return The index of the option.
+ * @throw NoArbitrageUnknownUnderlying
+ * @throw NoArbitrageUnknownQuote
+ * @throw NoArbitrageUnsupportedOption if the option is not a European vanilla option.
+ */
+std::size_t NoArbitrageScanner::add_option(
+    const std::size_t underlying,
+    const std::size_t option_quote,
+    const std::shared_ptr<CryptoOption>& option)
+{
+    if (underlying >= spots_.size()){throw NoArbitrageUnknownUnderlying();}
+    if (option_quote >= book_.size()){throw NoArbitrageUnknownQuote();}
+    const std::shared_ptr<Option> leg = option->get_option();
+    if (leg->get_instrument_tag() != INSTRUMENT_EUROPEAN_VANILLA_OPTION){throw NoArbitrageUnsupportedOption();}
+    option_expiries_.push_back(register_expiry(underlying, leg->get_expiry_timestamp(), leg->get_day_count()));
+    option_quotes_.push_back(option_quote);
+    option_strikes_.push_back(leg->get_strike());
+    option_is_call_.push_back(leg->get_option_type() == CALL);
+    prepared_ = false;
+    return option_quotes_.size() - 1;
+};
+
+/**
+ * @brief Gets the expiry of an underlying, registering it if it is new.
+ * @param underlying The index of the underlying.
+ * @param expiry_timestamp The expiry.
+ * @param day_count The day count convention of its year fraction, the one of its first
+ * instrument.
+ * @return The index of the expiry.
+ * @throw NoArbitrageUnknownUnderlying
+ */
+std::size_t NoArbitrageScanner::register_expiry(
+    const std::size_t underlying,
+    const Timestamp expiry_timestamp,
+    const DayCountConvention day_count)
+{
+    if (underlying >= spots_.size()){throw NoArbitrageUnknownUnderlying();}
+    const auto inserted = expiry_indices_.emplace(
+        std::make_pair(underlying, expiry_timestamp.ns), expiry_underlyings_.size());
+    if (!inserted.second){return inserted.first->second;}
+    expiry_year_fraction_indices_.push_back(year_fractions_.register_expiry(expiry_timestamp, day_count));
+    expiry_underlyings_.push_back(underlying);
+    expiry_future_quotes_.push_back(NOARBITRAGE_NONE);
+    prepared_ = false;
+    return expiry_underlyings_.size() - 1;
+};
+
+/**
+ * @return The number of underlyings.
+ */
+std::size_t NoArbitrageScanner::get_number_underlyings()
+{
+    return spots_.size();
+};
+
+/**
+ * @return The number of expiries.
+ */
+std::size_t NoArbitrageScanner::get_number_expiries()
+{
+    return expiry_underlyings_.size();
+};
+
+/**
+ * @return The number of options.
+ */
+std::size_t NoArbitrageScanner::get_number_options()
+{
+    return option_quotes_.size();
+};
+
+/**
+ * @brief Sets the rate of an underlying, the discount factors are refreshed by the next update.
+ * @param underlying The index of the underlying.
+ * @param rate The rate of its quote currency.
+ * @throw NoArbitrageUnknownUnderlying
+ */
+void NoArbitrageScanner::set_rate(const std::size_t underlying, const double rate)
+{
+    if (underlying >= spots_.size()){throw NoArbitrageUnknownUnderlying();}
+    rates_[underlying] = rate;
+    stale_ = true;
+};
+
+/**
+ * @brief Moves the valuation time, the discount factors are refreshed by the next update.
+ * @param reference_timestamp The valuation time.
+ */
+void NoArbitrageScanner::set_reference_timestamp(const Timestamp reference_timestamp)
+{
+    year_fractions_.set_reference_timestamp(reference_timestamp);
+    stale_ = true;
+};
+
+/**
+ * @brief Sets the edge above which a violation is emitted, 0 by default. A positive minimum
+ * covers the fees and the noise of the quotes.
+ * @param minimum_edge The minimum edge.
+ */
+void NoArbitrageScanner::set_minimum_edge(const double minimum_edge)
+{
+    minimum_edge_ = minimum_edge;
+};
+
+/**
+ * @brief Groups the expiries and the bonds by underlying sorted by year fraction, builds the
+ * sorted buckets of strikes of the expiries, maps the quotes of the book and allocates the
+ * workspace. Called by scan and update after an add.
+ * @throw NoArbitrageDuplicatedQuote
+ */
+void NoArbitrageScanner::prepare()
+{
+    const std::size_t n_underlyings = spots_.size();
+    const std::size_t n_expiries = expiry_underlyings_.size();
+    const std::size_t n_bonds = bond_quotes_.size();
+    const std::size_t n_options = option_quotes_.size();
+    const double* T = year_fractions_.get_year_fractions();
+
+    auto group = [n_underlyings, T](
+        const std::vector<std::size_t>& owners,
+        const std::vector<std::size_t>& year_fraction_indices,
+        std::vector<std::size_t>& offsets,
+        std::vector<std::size_t>& order)
+    {
+        offsets.assign(n_underlyings + 1, 0);
+        for (const std::size_t u : owners){offsets[u + 1]++;}
+        for (std::size_t u = 0; u < n_underlyings; ++u){offsets[u + 1] += offsets[u];}
+        order.resize(owners.size());
+        std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < owners.size(); ++i){order[next[owners[i]]++] = i;}
+        for (std::size_t u = 0; u < n_underlyings; ++u)
+        {
+            std::stable_sort(order.begin() + offsets[u], order.begin() + offsets[u + 1],
+                [&](std::size_t a, std::size_t b){
+                    return T[year_fraction_indices[a]] < T[year_fraction_indices[b]];});
+        }
+    };
+    group(expiry_underlyings_, expiry_year_fraction_indices_, expiry_offsets_, expiry_order_);
+    group(bond_underlyings_, bond_year_fraction_indices_, bond_offsets_, bond_order_);
+    expiry_previous_.assign(n_expiries, NOARBITRAGE_NONE);
+    expiry_next_.assign(n_expiries, NOARBITRAGE_NONE);
+    for (std::size_t u = 0; u < n_underlyings; ++u)
+    {
+        for (std::size_t k = expiry_offsets_[u] + 1; k < expiry_offsets_[u + 1]; ++k)
+        {
+            expiry_previous_[expiry_order_[k]] = expiry_order_[k - 1];
+            expiry_next_[expiry_order_[k - 1]] = expiry_order_[k];
+        }
+    }
+
+    std::vector<std::size_t> sorted(n_options);
+    for (std::size_t i = 0; i < n_options; ++i){sorted[i] = i;}
+    std::sort(sorted.begin(), sorted.end(), [&](std::size_t a, std::size_t b){
+        if (option_expiries_[a] != option_expiries_[b]){return option_expiries_[a] < option_expiries_[b];}
+        return option_strikes_[a] < option_strikes_[b];});
+    std::vector<std::size_t> option_points(n_options);
+    point_offsets_.assign(n_expiries + 1, 0);
+    point_expiries_.clear();
+    point_K_.clear();
+    point_calls_.clear();
+    point_puts_.clear();
+    for (const std::size_t i : sorted)
+    {
+        const std::size_t e = option_expiries_[i];
+        if (point_K_.empty() || point_expiries_.back() != e || point_K_.back() != option_strikes_[i])
+        {
+            point_expiries_.push_back(e);
+            point_K_.push_back(option_strikes_[i]);
+            point_calls_.push_back(NOARBITRAGE_NONE);
+            point_puts_.push_back(NOARBITRAGE_NONE);
+            point_offsets_[e + 1]++;
+        }
+        std::size_t& slot = option_is_call_[i] ? point_calls_.back() : point_puts_.back();
+        if (slot != NOARBITRAGE_NONE){throw NoArbitrageDuplicatedQuote();}
+        slot = option_quotes_[i];
+        option_points[i] = point_K_.size() - 1;
+    }
+    for (std::size_t e = 0; e < n_expiries; ++e){point_offsets_[e + 1] += point_offsets_[e];}
+    const std::size_t n_points = point_K_.size();
+
+    const std::size_t n_quotes = book_.size();
+    quote_kinds_.assign(n_quotes, NOARBITRAGE_QUOTE_NONE);
+    quote_targets_.assign(n_quotes, NOARBITRAGE_NONE);
+    auto map_quote = [&](const std::size_t q, const NoArbitrageQuoteKind kind, const std::size_t target)
+    {
+        if (quote_kinds_[q] != NOARBITRAGE_QUOTE_NONE){throw NoArbitrageDuplicatedQuote();}
+        quote_kinds_[q] = kind;
+        quote_targets_[q] = target;
+    };
+    for (std::size_t u = 0; u < n_underlyings; ++u){map_quote(spots_[u], NOARBITRAGE_QUOTE_SPOT, u);}
+    for (std::size_t b = 0; b < n_bonds; ++b){map_quote(bond_quotes_[b], NOARBITRAGE_QUOTE_BOND, b);}
+    for (std::size_t e = 0; e < n_expiries; ++e)
+    {
+        if (expiry_future_quotes_[e] != NOARBITRAGE_NONE){map_quote(expiry_future_quotes_[e], NOARBITRAGE_QUOTE_FUTURE, e);}
+    }
+    for (std::size_t i = 0; i < n_options; ++i)
+    {
+        map_quote(option_quotes_[i], option_is_call_[i] ? NOARBITRAGE_QUOTE_CALL : NOARBITRAGE_QUOTE_PUT, option_points[i]);
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    pillar_T_.assign(n_bonds + n_underlyings, 0.);
+    pillar_log_bid_.assign(n_bonds + n_underlyings, 0.);
+    pillar_log_ask_.assign(n_bonds + n_underlyings, 0.);
+    expiry_valid_.assign(n_expiries, 0);
+    expiry_df_bid_.assign(n_expiries, nan);
+    expiry_df_ask_.assign(n_expiries, nan);
+    expiry_df_.assign(n_expiries, nan);
+    expiry_forward_.assign(n_expiries, nan);
+    epoch_ = 0;
+    underlying_epochs_.assign(n_underlyings, 0);
+    curve_epochs_.assign(n_underlyings, 0);
+    expiry_epochs_.assign(n_expiries, 0);
+    parity_epochs_.assign(n_points, 0);
+    vertical_epochs_.assign(n_points, 0);
+    butterfly_epochs_.assign(n_points, 0);
+    calendar_epochs_.assign(n_points, 0);
+    dirty_underlyings_.clear();
+    dirty_underlyings_.reserve(n_underlyings);
+    dirty_expiries_.clear();
+    dirty_expiries_.reserve(n_quotes);
+    dirty_points_.clear();
+    dirty_points_.reserve(n_quotes);
+    violations_.clear();
+    violations_.reserve(n_quotes);
+    prepared_ = true;
+    stale_ = true;
+};
+
+/**
+ * @brief Checks a quote of a spot, a future or a bond.
+ * @param bid The bid.
+ * @param ask The ask.
+ * @param mid The mid, set if the quote is valid.
+ * @return True if the quote is valid: a positive bid and a finite ask not below it.
+ */
+static bool get_mid(const double bid, const double ask, double& mid)
+{
+    if (!(bid > 0.) || !(ask >= bid) || !std::isfinite(ask)){return false;}
+    mid = 0.5*(bid + ask);
+    return true;
+};
+
+/**
+ * @brief Checks a quote of an option, a deep out of the money option can have a zero bid.
+ * @param bid The bid.
+ * @param ask The ask.
+ * @return True if the quote is valid: a non negative bid and a finite ask not below it.
+ */
+static bool is_tradable(const double bid, const double ask)
+{
+    return bid >= 0. && ask >= bid && std::isfinite(ask);
+};
+
+/**
+ * @brief Recomputes the discount factors and the forwards of the expiries of an underlying from
+ * the book.
+ * @param underlying The index of the underlying.
+ */
+void NoArbitrageScanner::refresh(const std::size_t underlying)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double* bids = book_.get_bids();
+    const double* asks = book_.get_asks();
+    const double* T = year_fractions_.get_year_fractions();
+    const std::size_t base = bond_offsets_[underlying] + underlying;
+    std::size_t m = 1;
+    for (std::size_t k = bond_offsets_[underlying]; k < bond_offsets_[underlying + 1]; ++k)
+    {
+        const std::size_t b = bond_order_[k];
+        const double t = T[bond_year_fraction_indices_[b]];
+        const double bid = bids[bond_quotes_[b]];
+        const double ask = asks[bond_quotes_[b]];
+        double mid;
+        if (!(t > pillar_T_[base + m - 1]) || !get_mid(bid, ask, mid)){continue;}
+        pillar_T_[base + m] = t;
+        pillar_log_bid_[base + m] = std::log(bid);
+        pillar_log_ask_[base + m] = std::log(ask);
+        m++;
+    }
+    const double* x = pillar_T_.data() + base;
+    const double* y_bid = pillar_log_bid_.data() + base;
+    const double* y_ask = pillar_log_ask_.data() + base;
+    for (std::size_t k = expiry_offsets_[underlying]; k < expiry_offsets_[underlying + 1]; ++k)
+    {
+        const std::size_t e = expiry_order_[k];
+        const double t = T[expiry_year_fraction_indices_[e]];
+        expiry_valid_[e] = t > 0.;
+        if (!expiry_valid_[e])
+        {
+            expiry_df_bid_[e] = expiry_df_ask_[e] = expiry_df_[e] = expiry_forward_[e] = nan;
+            continue;
+        }
+        if (m == 1)
+        {
+            expiry_df_bid_[e] = expiry_df_ask_[e] = std::exp(-rates_[underlying]*t);
+        }
+        else if (t >= x[m - 1])
+        {
+            expiry_df_bid_[e] = std::exp(y_bid[m - 1]*t/x[m - 1]);
+            expiry_df_ask_[e] = std::exp(y_ask[m - 1]*t/x[m - 1]);
+        }
+        else
+        {
+            const std::size_t i = locate_interval(x, m, t);
+            const double w = (t - x[i])/(x[i + 1] - x[i]);
+            expiry_df_bid_[e] = std::exp(y_bid[i] + w*(y_bid[i + 1] - y_bid[i]));
+            expiry_df_ask_[e] = std::exp(y_ask[i] + w*(y_ask[i + 1] - y_ask[i]));
+        }
+        expiry_df_[e] = 0.5*(expiry_df_bid_[e] + expiry_df_ask_[e]);
+        refresh_forward(e);
+    }
+};
+
+/**
+ * @brief Recomputes the forward of an expiry from the book: the mid of its future, or the mid
+ * spot over the discount factor. NaN if the quotes are missing or crossed.
+ * @param expiry The index of the expiry.
+ */
+void NoArbitrageScanner::refresh_forward(const std::size_t expiry)
+{
+    double mid = std::numeric_limits<double>::quiet_NaN();
+    if (expiry_valid_[expiry])
+    {
+        const std::size_t q = expiry_future_quotes_[expiry];
+        if (q != NOARBITRAGE_NONE)
+        {
+            if (!get_mid(book_.get_bid(q), book_.get_ask(q), mid)){mid = std::numeric_limits<double>::quiet_NaN();}
+        }
+        else
+        {
+            const std::size_t s = spots_[expiry_underlyings_[expiry]];
+            if (get_mid(book_.get_bid(s), book_.get_ask(s), mid)){mid /= expiry_df_[expiry];}
+            else{mid = std::numeric_limits<double>::quiet_NaN();}
+        }
+    }
+    expiry_forward_[expiry] = mid;
+};
+
+/**
+ * @brief The present value of a certain cash flow at an expiry: borrowed against at the bid
+ * discount factor if positive, lent at the ask discount factor if negative.
+ * @param expiry The index of the expiry.
+ * @param cash_flow The cash flow at the expiry.
+ * @return The present value.
+ */
+double NoArbitrageScanner::get_present_value(const std::size_t expiry, const double cash_flow)
+{
+    return cash_flow*(cash_flow > 0. ? expiry_df_bid_[expiry] : expiry_df_ask_[expiry]);
+};
+
+/**
+ * @brief Emits a violation if its edge is greater than the minimum edge.
+ * @param type The arbitrage.
+ * @param expiry The index of the expiry.
+ * @param q0 The quote of the first leg.
+ * @param q1 The quote of the second leg.
+ * @param q2 The quote of the third leg, or NOARBITRAGE_NONE.
+ * @param is_call True for the calls.
+ * @param strike The strike.
+ * @param edge The edge.
+ */
+void NoArbitrageScanner::emit(
+    const NoArbitrageViolationType type,
+    const std::size_t expiry,
+    const std::size_t q0,
+    const std::size_t q1,
+    const std::size_t q2,
+    const bool is_call,
+    const double strike,
+    const double edge)
+{
+    if (!(edge > minimum_edge_)){return;}
+    const Timestamp* timestamps = book_.get_timestamps();
+    long long ns = timestamps[q0].ns;
+    ns = std::max(ns, timestamps[q1].ns);
+    if (q2 != NOARBITRAGE_NONE){ns = std::max(ns, timestamps[q2].ns);}
+    violations_.push_back({type, expiry_underlyings_[expiry], expiry, {q0, q1, q2}, is_call, strike, edge, Timestamp{ns}});
+};
+
+/**
+ * @brief Checks the cash and carry of the future of an expiry.
+ * @param expiry The index of the expiry.
+ */
+void NoArbitrageScanner::check_basis(const std::size_t expiry)
+{
+    const std::size_t f = expiry_future_quotes_[expiry];
+    if (f == NOARBITRAGE_NONE || !expiry_valid_[expiry]){return;}
+    const std::size_t s = spots_[expiry_underlyings_[expiry]];
+    const double S_bid = book_.get_bid(s), S_ask = book_.get_ask(s);
+    const double F_bid = book_.get_bid(f), F_ask = book_.get_ask(f);
+    double mid;
+    if (!get_mid(S_bid, S_ask, mid) || !get_mid(F_bid, F_ask, mid)){return;}
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    emit(NOARBITRAGE_CASH_AND_CARRY, expiry, s, f, NOARBITRAGE_NONE, false, nan, expiry_df_bid_[expiry]*F_bid - S_ask);
+    emit(NOARBITRAGE_REVERSE_CASH_AND_CARRY, expiry, s, f, NOARBITRAGE_NONE, false, nan, S_bid - expiry_df_ask_[expiry]*F_ask);
+};
+
+/**
+ * @brief Checks the put-call parity of a strike.
+ * @param point The index of the point.
+ */
+void NoArbitrageScanner::check_parity(const std::size_t point)
+{
+    if (parity_epochs_[point] == epoch_){return;}
+    parity_epochs_[point] = epoch_;
+    const std::size_t e = point_expiries_[point];
+    const std::size_t c = point_calls_[point];
+    const std::size_t p = point_puts_[point];
+    if (!expiry_valid_[e] || c == NOARBITRAGE_NONE || p == NOARBITRAGE_NONE){return;}
+    const double C_bid = book_.get_bid(c), C_ask = book_.get_ask(c);
+    const double P_bid = book_.get_bid(p), P_ask = book_.get_ask(p);
+    if (!is_tradable(C_bid, C_ask) || !is_tradable(P_bid, P_ask)){return;}
+    const double K = point_K_[point];
+    const std::size_t f = expiry_future_quotes_[e];
+    double mid;
+    if (f != NOARBITRAGE_NONE)
+    {
+        const double F_bid = book_.get_bid(f), F_ask = book_.get_ask(f);
+        if (!get_mid(F_bid, F_ask, mid)){return;}
+        emit(NOARBITRAGE_PARITY_REVERSAL, e, c, p, f, true, K, get_present_value(e, F_bid - K) - (C_ask - P_bid));
+        emit(NOARBITRAGE_PARITY_CONVERSION, e, c, p, f, true, K, (C_bid - P_ask) + get_present_value(e, K - F_ask));
+        return;
+    }
+    const std::size_t s = spots_[expiry_underlyings_[e]];
+    const double S_bid = book_.get_bid(s), S_ask = book_.get_ask(s);
+    if (!get_mid(S_bid, S_ask, mid)){return;}
+    emit(NOARBITRAGE_PARITY_REVERSAL, e, c, p, s, true, K, S_bid - (C_ask - P_bid) + get_present_value(e, -K));
+    emit(NOARBITRAGE_PARITY_CONVERSION, e, c, p, s, true, K, (C_bid - P_ask) - S_ask + get_present_value(e, K));
+};
+
+/**
+ * @brief Checks the vertical spreads of a strike and of the next strike of its expiry.
+ * @param point The index of the lower strike point.
+ */
+void NoArbitrageScanner::check_vertical(const std::size_t point)
+{
+    if (point + 1 >= point_K_.size() || vertical_epochs_[point] == epoch_){return;}
+    vertical_epochs_[point] = epoch_;
+    const std::size_t e = point_expiries_[point];
+    if (!expiry_valid_[e] || point_expiries_[point + 1] != e){return;}
+    const double K1 = point_K_[point];
+    const double K2 = point_K_[point + 1];
+    const double bound = get_present_value(e, -(K2 - K1));
+    const std::size_t c1 = point_calls_[point], c2 = point_calls_[point + 1];
+    if (c1 != NOARBITRAGE_NONE && c2 != NOARBITRAGE_NONE)
+    {
+        const double bid1 = book_.get_bid(c1), ask1 = book_.get_ask(c1);
+        const double bid2 = book_.get_bid(c2), ask2 = book_.get_ask(c2);
+        if (is_tradable(bid1, ask1) && is_tradable(bid2, ask2))
+        {
+            emit(NOARBITRAGE_VERTICAL_MONOTONICITY, e, c1, c2, NOARBITRAGE_NONE, true, K1, bid2 - ask1);
+            emit(NOARBITRAGE_VERTICAL_BOUND, e, c1, c2, NOARBITRAGE_NONE, true, K1, bid1 - ask2 + bound);
+        }
+    }
+    const std::size_t p1 = point_puts_[point], p2 = point_puts_[point + 1];
+    if (p1 != NOARBITRAGE_NONE && p2 != NOARBITRAGE_NONE)
+    {
+        const double bid1 = book_.get_bid(p1), ask1 = book_.get_ask(p1);
+        const double bid2 = book_.get_bid(p2), ask2 = book_.get_ask(p2);
+        if (is_tradable(bid1, ask1) && is_tradable(bid2, ask2))
+        {
+            emit(NOARBITRAGE_VERTICAL_MONOTONICITY, e, p1, p2, NOARBITRAGE_NONE, false, K1, bid1 - ask2);
+            emit(NOARBITRAGE_VERTICAL_BOUND, e, p1, p2, NOARBITRAGE_NONE, false, K1, bid2 - ask1 + bound);
+        }
+    }
+};
+
+/**
+ * @brief Checks the butterflies centered on a strike, with the previous and the next strikes of
+ * its expiry as wings, weighted by the strike distances.
+ * @param point The index of the body point.
+ */
+void NoArbitrageScanner::check_butterfly(const std::size_t point)
+{
+    if (point == 0 || point + 1 >= point_K_.size() || butterfly_epochs_[point] == epoch_){return;}
+    butterfly_epochs_[point] = epoch_;
+    const std::size_t e = point_expiries_[point];
+    if (!expiry_valid_[e] || point_expiries_[point - 1] != e || point_expiries_[point + 1] != e){return;}
+    const double K1 = point_K_[point - 1], K2 = point_K_[point], K3 = point_K_[point + 1];
+    const double lambda = (K3 - K2)/(K3 - K1);
+    const std::size_t* sides[2] = {point_calls_.data(), point_puts_.data()};
+    for (int side = 0; side < 2; ++side)
+    {
+        const std::size_t q1 = sides[side][point - 1], q2 = sides[side][point], q3 = sides[side][point + 1];
+        if (q1 == NOARBITRAGE_NONE || q2 == NOARBITRAGE_NONE || q3 == NOARBITRAGE_NONE){continue;}
+        const double bid1 = book_.get_bid(q1), ask1 = book_.get_ask(q1);
+        const double bid2 = book_.get_bid(q2), ask2 = book_.get_ask(q2);
+        const double bid3 = book_.get_bid(q3), ask3 = book_.get_ask(q3);
+        if (!is_tradable(bid1, ask1) || !is_tradable(bid2, ask2) || !is_tradable(bid3, ask3)){continue;}
+        emit(NOARBITRAGE_BUTTERFLY, e, q1, q2, q3, side == 0, K2, bid2 - lambda*ask1 - (1 - lambda)*ask3);
+    }
+};
+
+/**
+ * @brief Checks the calendar spreads of a strike against the next expiry of its underlying, at
+ * the same forward moneyness: the normalized bid of the strike against the convex combination of
+ * the normalized asks of the two strikes of the next expiry bracketing it (or of the same
+ * moneyness). Nothing is checked outside the strikes of the next expiry.
+ * @param point The index of the shorter expiry point.
+ */
+void NoArbitrageScanner::check_calendar(const std::size_t point)
+{
+    if (calendar_epochs_[point] == epoch_){return;}
+    calendar_epochs_[point] = epoch_;
+    const std::size_t e1 = point_expiries_[point];
+    const std::size_t e2 = expiry_next_[e1];
+    if (e2 == NOARBITRAGE_NONE || !expiry_valid_[e1] || !expiry_valid_[e2]){return;}
+    const double F1 = expiry_forward_[e1], F2 = expiry_forward_[e2];
+    if (!(F1 > 0.) || !(F2 > 0.)){return;}
+    const double K = point_K_[point]*F2/F1;
+    const double* begin = point_K_.data() + point_offsets_[e2];
+    const double* end = point_K_.data() + point_offsets_[e2 + 1];
+    const double* upper = std::lower_bound(begin, end, K);
+    if (upper == end){return;}
+    std::size_t b = upper - point_K_.data();
+    std::size_t a = b;
+    double lambda = 1.;
+    if (*upper != K)
+    {
+        if (upper == begin){return;}
+        a = b - 1;
+        lambda = (point_K_[b] - K)/(point_K_[b] - point_K_[a]);
+    }
+    const double scale = expiry_df_[e1]*F1/(expiry_df_[e2]*F2);
+    const std::size_t* sides[2] = {point_calls_.data(), point_puts_.data()};
+    for (int side = 0; side < 2; ++side)
+    {
+        const std::size_t q = sides[side][point], qa = sides[side][a], qb = sides[side][b];
+        if (q == NOARBITRAGE_NONE || qa == NOARBITRAGE_NONE || qb == NOARBITRAGE_NONE){continue;}
+        const double bid = book_.get_bid(q), ask = book_.get_ask(q);
+        const double bid_a = book_.get_bid(qa), ask_a = book_.get_ask(qa);
+        const double bid_b = book_.get_bid(qb), ask_b = book_.get_ask(qb);
+        if (!is_tradable(bid, ask) || !is_tradable(bid_a, ask_a) || !is_tradable(bid_b, ask_b)){continue;}
+        emit(NOARBITRAGE_CALENDAR, e1, q, qa, qb, side == 0, point_K_[point],
+            bid - scale*(lambda*ask_a + (1 - lambda)*ask_b));
+    }
+};
+
+/**
+ * @brief Checks the calendar spreads of the previous expiry whose bracketing strikes include a
+ * strike: the points of the previous expiry between the neighbours of the strike, in forward
+ * moneyness.
+ * @param point The index of the longer expiry point.
+ */
+void NoArbitrageScanner::check_calendar_shorter(const std::size_t point)
+{
+    const std::size_t e2 = point_expiries_[point];
+    const std::size_t e1 = expiry_previous_[e2];
+    if (e1 == NOARBITRAGE_NONE){return;}
+    const double F1 = expiry_forward_[e1], F2 = expiry_forward_[e2];
+    if (!(F1 > 0.) || !(F2 > 0.)){return;}
+    const double ratio = F1/F2;
+    const double low = point_K_[point > point_offsets_[e2] ? point - 1 : point]*ratio;
+    const double high = point_K_[point + 1 < point_offsets_[e2 + 1] ? point + 1 : point]*ratio;
+    const double* begin = point_K_.data() + point_offsets_[e1];
+    const double* end = point_K_.data() + point_offsets_[e1 + 1];
+    for (const double* K = std::lower_bound(begin, end, low); K != end && *K <= high; ++K)
+    {
+        check_calendar(K - point_K_.data());
+    }
+};
+
+/**
+ * @brief Checks the basis, the parities and the calendar spreads of an expiry, the checks
+ * depending on its forward: the calendar spreads of its points against the next expiry and of the
+ * points of the previous expiry against it.
+ * @param expiry The index of the expiry.
+ */
+void NoArbitrageScanner::check_forward(const std::size_t expiry)
+{
+    if (expiry_epochs_[expiry] == epoch_){return;}
+    expiry_epochs_[expiry] = epoch_;
+    check_basis(expiry);
+    for (std::size_t p = point_offsets_[expiry]; p < point_offsets_[expiry + 1]; ++p)
+    {
+        check_parity(p);
+        check_calendar(p);
+    }
+    const std::size_t previous = expiry_previous_[expiry];
+    if (previous == NOARBITRAGE_NONE){return;}
+    for (std::size_t p = point_offsets_[previous]; p < point_offsets_[previous + 1]; ++p){check_calendar(p);}
+};
+
+/**
+ * @brief Checks the basis, the parities, the calendar spreads and the verticals of an expiry, the
+ * checks depending on its forward and its discount factors.
+ * @param expiry The index of the expiry.
+ */
+void NoArbitrageScanner::check_expiry(const std::size_t expiry)
+{
+    check_forward(expiry);
+    for (std::size_t p = point_offsets_[expiry]; p < point_offsets_[expiry + 1]; ++p){check_vertical(p);}
+};
+
+/**
+ * @brief Checks the arbitrages of the spot of an underlying: the basis of the expiries with a
+ * future, the basis and the parities of the ones without.
+ * @param underlying The index of the underlying.
+ */
+void NoArbitrageScanner::check_spot(const std::size_t underlying)
+{
+    for (std::size_t k = expiry_offsets_[underlying]; k < expiry_offsets_[underlying + 1]; ++k)
+    {
+        const std::size_t e = expiry_order_[k];
+        if (expiry_future_quotes_[e] == NOARBITRAGE_NONE){check_forward(e);}
+        else if (expiry_epochs_[e] != epoch_){check_basis(e);}
+    }
+};
+
+/**
+ * @brief Checks the neighbours of a strike whose call or put was quoted.
+ * @param point The index of the point.
+ */
+void NoArbitrageScanner::check_point(const std::size_t point)
+{
+    check_parity(point);
+    check_vertical(point);
+    if (point > 0)
+    {
+        check_vertical(point - 1);
+        check_butterfly(point - 1);
+    }
+    check_butterfly(point);
+    check_butterfly(point + 1);
+    check_calendar(point);
+    check_calendar_shorter(point);
+};
+
+/**
+ * @brief Checks every arbitrage of the book.
+ * @return The number of violations, see get_violations.
+ * @throw NoArbitrageDuplicatedQuote
+ */
+std::size_t NoArbitrageScanner::scan()
+{
+    if (!prepared_){prepare();}
+    epoch_++;
+    violations_.clear();
+    for (std::size_t u = 0; u < spots_.size(); ++u){refresh(u);}
+    stale_ = false;
+    for (std::size_t e = 0; e < expiry_underlyings_.size(); ++e){check_expiry(e);}
+    for (std::size_t p = 0; p < point_K_.size(); ++p){check_point(p);}
+    return violations_.size();
+};
+
+/**
+ * @brief Checks the arbitrages involving the quotes just updated in the book, only their
+ * neighbours are re-checked. The quotes which are not in the scanner are ignored. After a new
+ * rate or reference timestamp the bases, parities, calendar spreads and verticals of every expiry
+ * are re-checked.
+ * @param quotes The indices of the updated quotes in the book.
+ * @param n The number of quotes.
+ * @return The number of violations, see get_violations.
+ * @throw NoArbitrageDuplicatedQuote
+ */
+std::size_t NoArbitrageScanner::update(const std::size_t* quotes, const std::size_t n)
+{
+    if (!prepared_){prepare();}
+    epoch_++;
+    violations_.clear();
+    if (stale_)
+    {
+        for (std::size_t u = 0; u < spots_.size(); ++u)
+        {
+            underlying_epochs_[u] = epoch_;
+            curve_epochs_[u] = epoch_;
+            dirty_underlyings_.push_back(u);
+        }
+        stale_ = false;
+    }
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        if (quotes[k] >= quote_kinds_.size()){continue;}
+        const std::size_t target = quote_targets_[quotes[k]];
+        switch (quote_kinds_[quotes[k]])
+        {
+            case NOARBITRAGE_QUOTE_SPOT:
+            case NOARBITRAGE_QUOTE_BOND:
+            {
+                const std::size_t u = quote_kinds_[quotes[k]] == NOARBITRAGE_QUOTE_SPOT ? target : bond_underlyings_[target];
+                if (quote_kinds_[quotes[k]] == NOARBITRAGE_QUOTE_BOND){curve_epochs_[u] = epoch_;}
+                if (underlying_epochs_[u] == epoch_){break;}
+                underlying_epochs_[u] = epoch_;
+                dirty_underlyings_.push_back(u);
+                break;
+            }
+            case NOARBITRAGE_QUOTE_FUTURE:
+                dirty_expiries_.push_back(target);
+                break;
+            case NOARBITRAGE_QUOTE_CALL:
+            case NOARBITRAGE_QUOTE_PUT:
+                dirty_points_.push_back(target);
+                break;
+            default:
+                break;
+        }
+    }
+    for (const std::size_t u : dirty_underlyings_){refresh(u);}
+    for (const std::size_t e : dirty_expiries_)
+    {
+        if (underlying_epochs_[expiry_underlyings_[e]] != epoch_){refresh_forward(e);}
+    }
+    for (const std::size_t u : dirty_underlyings_)
+    {
+        if (curve_epochs_[u] != epoch_){continue;}
+        for (std::size_t k = expiry_offsets_[u]; k < expiry_offsets_[u + 1]; ++k){check_expiry(expiry_order_[k]);}
+    }
+    for (const std::size_t e : dirty_expiries_){check_forward(e);}
+    for (const std::size_t u : dirty_underlyings_)
+    {
+        if (curve_epochs_[u] != epoch_){check_spot(u);}
+    }
+    for (const std::size_t p : dirty_points_){check_point(p);}
+    dirty_underlyings_.clear();
+    dirty_expiries_.clear();
+    dirty_points_.clear();
+    if constexpr (INSTRUMENTATION_ENABLED)
+    {
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            if (quotes[k] >= quote_kinds_.size() || quote_kinds_[quotes[k]] == NOARBITRAGE_QUOTE_NONE){continue;}
+            ARBITRAGE_INSTRUMENT_TICK_TO_PRICE(book_.get_timestamp(quotes[k]).ns);
+        }
+    }
+    return violations_.size();
+};
+
+/**
+ * @return The violations of the last scan or update.
+ */
+const std::vector<NoArbitrageViolation>& NoArbitrageScanner::get_violations() const
+{
+    return violations_;
+};
+
+/**
+ * @param expiry The index of the expiry.
+ * @return Its mid discount factor.
+ */
+double NoArbitrageScanner::get_discount_factor(const std::size_t expiry)
+{
+    return expiry_df_[expiry];
+};
+
+/**
+ * @param expiry The index of the expiry.
+ * @return Its mid forward.
+ */
+double NoArbitrageScanner::get_forward(const std::size_t expiry)
+{
+    return expiry_forward_[expiry];
+};
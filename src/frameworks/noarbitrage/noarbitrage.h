@@ -0,0 +1,162 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "../../datastructure/datetime/yearfraction/yearfraction.h"
+#include "../../datastructure/market/instruments/options/options.h"
+#include "../../datastructure/market/assets/crypto/cryptoassets.h"
+#include "../../datastructure/market/assets/interestrate/irassets.h"
+#include "../../datastructure/market/quotebook/quotebook.h"
+#include "../../math/interpolation2D/interpolation.h"
+#include "../../instrumentation/instrumentation.h"
+
+constexpr std::size_t NOARBITRAGE_NONE = std::numeric_limits<std::size_t>::max();
+
+enum NoArbitrageViolationType
+{
+    NOARBITRAGE_PARITY_CONVERSION = 0,
+    NOARBITRAGE_PARITY_REVERSAL = 1,
+    NOARBITRAGE_VERTICAL_MONOTONICITY = 2,
+    NOARBITRAGE_VERTICAL_BOUND = 3,
+    NOARBITRAGE_BUTTERFLY = 4,
+    NOARBITRAGE_CALENDAR = 5,
+    NOARBITRAGE_CASH_AND_CARRY = 6,
+    NOARBITRAGE_REVERSE_CASH_AND_CARRY = 7
+};
+
+enum NoArbitrageQuoteKind
+{
+    NOARBITRAGE_QUOTE_NONE = 0,
+    NOARBITRAGE_QUOTE_SPOT = 1,
+    NOARBITRAGE_QUOTE_BOND = 2,
+    NOARBITRAGE_QUOTE_FUTURE = 3,
+    NOARBITRAGE_QUOTE_CALL = 4,
+    NOARBITRAGE_QUOTE_PUT = 5
+};
+
+class NoArbitrageUnknownUnderlying:  public std::exception
+{public: const char * what() const throw();};
+
+class NoArbitrageUnsupportedOption:  public std::exception
+{public: const char * what() const throw();};
+
+class NoArbitragePerpetualFuture:  public std::exception
+{public: const char * what() const throw();};
+
+class NoArbitrageDuplicatedQuote:  public std::exception
+{public: const char * what() const throw();};
+
+class NoArbitrageUnknownQuote:  public std::exception
+{public: const char * what() const throw();};
+
+struct NoArbitrageViolation
+{
+    NoArbitrageViolationType type;
+    std::size_t underlying;
+    std::size_t expiry;
+    std::size_t quotes[3];
+    bool is_call;
+    double strike;
+    double edge;
+    Timestamp timestamp;
+};
+
+struct NoArbitrageScanner
+{
+    const QuoteBook& book_;
+    std::vector<std::size_t> spots_;
+    std::vector<double> rates_;
+    std::vector<std::size_t> bond_underlyings_;
+    std::vector<std::size_t> bond_quotes_;
+    std::vector<std::size_t> bond_year_fraction_indices_;
+    std::vector<std::size_t> expiry_underlyings_;
+    std::vector<std::size_t> expiry_year_fraction_indices_;
+    std::vector<std::size_t> expiry_future_quotes_;
+    std::map<std::pair<std::size_t, long long>, std::size_t> expiry_indices_;
+    std::vector<std::size_t> option_quotes_;
+    std::vector<std::size_t> option_expiries_;
+    std::vector<double> option_strikes_;
+    std::vector<unsigned char> option_is_call_;
+    YearFractionTable year_fractions_;
+    double minimum_edge_;
+    bool prepared_;
+    bool stale_;
+    std::vector<std::size_t> expiry_offsets_;
+    std::vector<std::size_t> expiry_order_;
+    std::vector<std::size_t> expiry_previous_;
+    std::vector<std::size_t> expiry_next_;
+    std::vector<std::size_t> bond_offsets_;
+    std::vector<std::size_t> bond_order_;
+    std::vector<std::size_t> point_offsets_;
+    std::vector<std::size_t> point_expiries_;
+    std::vector<double> point_K_;
+    std::vector<std::size_t> point_calls_;
+    std::vector<std::size_t> point_puts_;
+    std::vector<unsigned char> quote_kinds_;
+    std::vector<std::size_t> quote_targets_;
+    std::vector<double> pillar_T_;
+    std::vector<double> pillar_log_bid_;
+    std::vector<double> pillar_log_ask_;
+    std::vector<unsigned char> expiry_valid_;
+    std::vector<double> expiry_df_bid_;
+    std::vector<double> expiry_df_ask_;
+    std::vector<double> expiry_df_;
+    std::vector<double> expiry_forward_;
+    std::size_t epoch_;
+    std::vector<std::size_t> underlying_epochs_;
+    std::vector<std::size_t> curve_epochs_;
+    std::vector<std::size_t> expiry_epochs_;
+    std::vector<std::size_t> parity_epochs_;
+    std::vector<std::size_t> vertical_epochs_;
+    std::vector<std::size_t> butterfly_epochs_;
+    std::vector<std::size_t> calendar_epochs_;
+    std::vector<std::size_t> dirty_underlyings_;
+    std::vector<std::size_t> dirty_expiries_;
+    std::vector<std::size_t> dirty_points_;
+    std::vector<NoArbitrageViolation> violations_;
+    NoArbitrageScanner(const QuoteBook& book, const Timestamp reference_timestamp);
+    ~NoArbitrageScanner(){};
+    std::size_t add_underlying(const std::size_t spot_quote, const double rate);
+    std::size_t add_bond(const std::size_t underlying, const std::size_t bond_quote, const std::shared_ptr<ZeroCouponBond>& bond);
+    std::size_t add_future(const std::size_t underlying, const std::size_t future_quote, const std::shared_ptr<CryptoFuture>& future);
+    std::size_t add_option(const std::size_t underlying, const std::size_t option_quote, const std::shared_ptr<CryptoOption>& option);
+    std::size_t register_expiry(const std::size_t underlying, const Timestamp expiry_timestamp, const DayCountConvention day_count);
+    std::size_t get_number_underlyings();
+    std::size_t get_number_expiries();
+    std::size_t get_number_options();
+    void set_rate(const std::size_t underlying, const double rate);
+    void set_reference_timestamp(const Timestamp reference_timestamp);
+    void set_minimum_edge(const double minimum_edge);
+    void prepare();
+    void refresh(const std::size_t underlying);
+    void refresh_forward(const std::size_t expiry);
+    double get_present_value(const std::size_t expiry, const double cash_flow);
+    void emit(
+        const NoArbitrageViolationType type,
+        const std::size_t expiry,
+        const std::size_t q0,
+        const std::size_t q1,
+        const std::size_t q2,
+        const bool is_call,
+        const double strike,
+        const double edge);
+    void check_basis(const std::size_t expiry);
+    void check_parity(const std::size_t point);
+    void check_vertical(const std::size_t point);
+    void check_butterfly(const std::size_t point);
+    void check_calendar(const std::size_t point);
+    void check_calendar_shorter(const std::size_t point);
+    void check_forward(const std::size_t expiry);
+    void check_expiry(const std::size_t expiry);
+    void check_spot(const std::size_t underlying);
+    void check_point(const std::size_t point);
+    std::size_t scan();
+    std::size_t update(const std::size_t* quotes, const std::size_t n);
+    const std::vector<NoArbitrageViolation>& get_violations() const;
+    double get_discount_factor(const std::size_t expiry);
+    double get_forward(const std::size_t expiry);
+};
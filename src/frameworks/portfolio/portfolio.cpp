@@ -0,0 +1,450 @@
+#include "portfolio.h"
+
+/**
+* @file portfolio.h
+* @brief This file defines the portfolio level pricing of options, futures and their structures.
+*
+* Structures of a book (straddles, spreads, calendar futures...) share most of their legs: the
+* aggregator keeps every leg once, prices the set of unique legs in one call of the vectorized
+* Black-Scholes batch engine, and reduces the prices and Greeks back to each structure with a
+* sparse weight matrix (one compressed row per structure, one column per unique leg).
+*
+* References :
+* - "Sparse matrix technology", Pissanetzky, 1984.
+*/
+
+/**
+ * @class PortfolioUnsupportedLeg
+ * @brief Definition of the error when a leg is an American option, which the Black-Scholes
+ * batch engine does not price.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * PortfolioUnsupportedLeg::what() const throw(){
+    return "American options can not be priced by the portfolio aggregator.";
+};
+
+/**
+ * @class PortfolioMissingMarket
+ * @brief Definition of the error when the market data of a kind of leg is missing.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * PortfolioMissingMarket::what() const throw(){
+    return "The market data of the option legs or of the future legs is missing.";
+};
+
+/**
+ * @struct PortfolioMarket
+ * @brief The market data of the unique legs, in the order of PortfolioAggregator::options_ and
+ * PortfolioAggregator::futures_. The pointers of a kind of leg may be null when the book has no
+ * leg of that kind.
+ *
+ * @var const double* PortfolioMarket::option_S
+ *  The spot of the underlying of each unique option.
+ * @var const double* PortfolioMarket::option_r
+ *  The risk free rate of each unique option.
+ * @var const double* PortfolioMarket::option_q
+ *  The dividend (or foreign, or staking) rate of each unique option.
+ * @var const double* PortfolioMarket::option_sigma
+ *  The implied volatility of each unique option.
+ * @var const double* PortfolioMarket::future_S
+ *  The spot of the underlying of each unique future.
+ * @var const double* PortfolioMarket::future_r
+ *  The risk free rate of each unique future.
+ * @var const double* PortfolioMarket::future_q
+ *  The dividend (or foreign, or staking) rate of each unique future.
+ */
+
+/**
+ * @struct PortfolioRisk
+ * @brief The price and the first order Greeks (and gamma) of a structure or of the book.
+ * A future is valued at its fair forward S*exp((r-q)*T), with delta exp((r-q)*T), zero gamma
+ * and vega, theta -(r-q)*F and rho T*F.
+ */
+
+/**
+ * @struct PortfolioResult
+ * @brief The result of the pricing of a book.
+ *
+ * @var std::vector<PortfolioRisk> PortfolioResult::structures
+ *  The risk of one unit of each structure, in the order of registration.
+ * @var PortfolioRisk PortfolioResult::total
+ *  The risk of the book, the sum of the structures times their quantities.
+ * @var std::size_t PortfolioResult::n_bad_legs
+ *  The number of unique legs with a non positive volatility or year fraction, their risk
+ *  is NaN, and so is the risk of every structure holding them.
+ * @var double PortfolioResult::elapsed_us
+ *  The time of the pricing and of the reduction, in microseconds.
+ */
+
+/**
+ * @struct PortfolioAggregator
+ * @brief The book of structures with deduplicated legs. Two legs are the same leg when they
+ * are the same instrument object, which is the case of structures built from the listed
+ * instruments of a market snapshot. American option legs are rejected.
+ *
+ * @var std::vector<std::shared_ptr<Option>> PortfolioAggregator::options_
+ *  The unique option legs, the columns of the option weight matrix.
+ * @var std::vector<std::shared_ptr<Future>> PortfolioAggregator::futures_
+ *  The unique future legs, the columns of the future weight matrix.
+ * @var std::unordered_map<const Option*, std::size_t> PortfolioAggregator::option_indices_
+ *  The column of each unique option.
+ * @var std::unordered_map<const Future*, std::size_t> PortfolioAggregator::future_indices_
+ *  The column of each unique future.
+ * @var std::vector<double> PortfolioAggregator::quantities_
+ *  The quantity of each structure in the book.
+ * @var std::vector<std::size_t> PortfolioAggregator::option_row_offsets_
+ *  The compressed rows of the option weight matrix, the entries of structure s are in
+ *  [option_row_offsets[s], option_row_offsets[s+1]).
+ * @var std::vector<std::size_t> PortfolioAggregator::option_columns_
+ *  The option column of each entry.
+ * @var std::vector<double> PortfolioAggregator::option_weights_
+ *  The weight of each entry.
+ * @var std::vector<std::size_t> PortfolioAggregator::future_row_offsets_
+ *  The compressed rows of the future weight matrix.
+ * @var std::vector<std::size_t> PortfolioAggregator::future_columns_
+ *  The future column of each entry.
+ * @var std::vector<double> PortfolioAggregator::future_weights_
+ *  The weight of each entry.
+ * @var std::shared_ptr<ThreadPool> PortfolioAggregator::pool_
+ *  The thread pool pricing the legs and reducing the structures, everything is serial if null.
+ * @var YearFractionTable PortfolioAggregator::year_fractions_
+ *  The year fractions of the distinct expiries of the legs.
+ * @var bool PortfolioAggregator::prepared_
+ *  Whether the workspace matches the unique legs, it is reset by each new leg.
+ *
+ * The other members are the workspace: the static inputs (strikes, year fractions, flags) and
+ * the outputs of the unique legs, in structure of arrays.
+ */
+
+/**
+ * @brief The serial constructor.
+ * @param reference_timestamp The first reference time of the year fractions.
+ */
+PortfolioAggregator::PortfolioAggregator(const Timestamp reference_timestamp):
+    PortfolioAggregator(reference_timestamp, nullptr){};
+
+/**
+ * @brief The constructor.
+ * @param reference_timestamp The first reference time of the year fractions.
+ * @param pool The thread pool (can be null).
+ */
+PortfolioAggregator::PortfolioAggregator(const Timestamp reference_timestamp, std::shared_ptr<ThreadPool> pool):
+    pool_(pool), year_fractions_(reference_timestamp), prepared_(false)
+{
+    option_row_offsets_.push_back(0);
+    future_row_offsets_.push_back(0);
+};
+
+/**
+ * @brief Gets the column of an option leg, registering it if it is new.
+ * @param option The option leg.
+ * @return The column of the option.
+ * @throw PortfolioUnsupportedLeg if the option is American.
+ */
+std::size_t PortfolioAggregator::register_option(const std::shared_ptr<Option>& option)
+{
+    auto found = option_indices_.find(option.get());
+    if (found != option_indices_.end()){return found->second;}
+    if (option->get_instrument_tag() == INSTRUMENT_AMERICAN_VANILLA_OPTION)
+    {
+        throw PortfolioUnsupportedLeg();
+    }
+    std::size_t column = options_.size();
+    options_.push_back(option);
+    option_indices_.emplace(option.get(), column);
+    prepared_ = false;
+    return column;
+};
+
+/**
+ * @brief Gets the column of a future leg, registering it if it is new.
+ * @param future The future leg.
+ * @return The column of the future.
+ */
+std::size_t PortfolioAggregator::register_future(const std::shared_ptr<Future>& future)
+{
+    auto found = future_indices_.find(future.get());
+    if (found != future_indices_.end()){return found->second;}
+    std::size_t column = futures_.size();
+    futures_.push_back(future);
+    future_indices_.emplace(future.get(), column);
+    prepared_ = false;
+    return column;
+};
+
+/**
+ * @brief Closes the row of the structure whose entries were just pushed.
+ * @param quantity The quantity of the structure in the book.
+ */
+void PortfolioAggregator::close_row(const double quantity)
+{
+    quantities_.push_back(quantity);
+    option_row_offsets_.push_back(option_columns_.size());
+    future_row_offsets_.push_back(future_columns_.size());
+};
+
+/**
+ * @brief Adds an option position to the book, as a structure of one leg of unit weight.
+ * @param option The option.
+ * @param quantity The quantity held.
+ * @return The index of the structure.
+ * @throw PortfolioUnsupportedLeg if the option is American.
+ */
+std::size_t PortfolioAggregator::add_option(const std::shared_ptr<Option> option, const double quantity)
+{
+    option_columns_.push_back(register_option(option));
+    option_weights_.push_back(1.);
+    close_row(quantity);
+    return quantities_.size() - 1;
+};
+
+/**
+ * @brief Adds a future position to the book, as a structure of one leg of unit weight.
+ * @param future The future.
+ * @param quantity The quantity held.
+ * @return The index of the structure.
+ */
+std::size_t PortfolioAggregator::add_future(const std::shared_ptr<Future> future, const double quantity)
+{
+    future_columns_.push_back(register_future(future));
+    future_weights_.push_back(1.);
+    close_row(quantity);
+    return quantities_.size() - 1;
+};
+
+/**
+ * @brief Adds a structured option position to the book.
+ * @param structure The structured option.
+ * @param quantity The quantity held.
+ * @return The index of the structure.
+ * @throw PortfolioUnsupportedLeg if a leg is American, the book is then left unchanged.
+ */
+std::size_t PortfolioAggregator::add_structured_option(
+    const std::shared_ptr<StructuredOption> structure,
+    const double quantity)
+{
+    const std::vector<std::shared_ptr<Option>> legs = structure->get_options();
+    const std::vector<double> weights = structure->get_weights();
+    for (const std::shared_ptr<Option>& leg: legs)
+    {
+        if (leg->get_instrument_tag() == INSTRUMENT_AMERICAN_VANILLA_OPTION)
+        {
+            throw PortfolioUnsupportedLeg();
+        }
+    }
+    for (std::size_t i = 0; i < legs.size(); ++i)
+    {
+        option_columns_.push_back(register_option(legs[i]));
+        option_weights_.push_back(weights[i]);
+    }
+    close_row(quantity);
+    return quantities_.size() - 1;
+};
+
+/**
+ * @brief Adds a structured future position to the book.
+ * @param structure The structured future.
+ * @param quantity The quantity held.
+ * @return The index of the structure.
+ */
+std::size_t PortfolioAggregator::add_structured_future(
+    const std::shared_ptr<StructuredFuture> structure,
+    const double quantity)
+{
+    const std::vector<std::shared_ptr<Future>> legs = structure->get_futures();
+    const std::vector<double> weights = structure->get_weights();
+    for (std::size_t i = 0; i < legs.size(); ++i)
+    {
+        future_columns_.push_back(register_future(legs[i]));
+        future_weights_.push_back(weights[i]);
+    }
+    close_row(quantity);
+    return quantities_.size() - 1;
+};
+
+/**
+ * @brief Gets the number of structures of the book.
+ * @return The number of structures.
+ */
+std::size_t PortfolioAggregator::get_number_structures()
+{
+    return quantities_.size();
+};
+
+/**
+ * @brief Gets the number of unique legs, options and futures, priced by each call of price.
+ * @return The number of unique legs.
+ */
+std::size_t PortfolioAggregator::get_number_legs()
+{
+    return options_.size() + futures_.size();
+};
+
+/**
+ * @brief Builds the workspace of the unique legs: registers their expiries in the year fraction
+ * table, fills the strikes and flags, and sizes the outputs. Called by price when a leg was
+ * added since the last call.
+ */
+void PortfolioAggregator::prepare()
+{
+    const std::size_t n_options = options_.size();
+    const std::size_t n_futures = futures_.size();
+    option_year_fraction_indices_.resize(n_options);
+    K_.resize(n_options);
+    T_.resize(n_options);
+    is_call_.reset(new bool[n_options]);
+    is_future_.reset(new bool[n_options]);
+    for (std::size_t i = 0; i < n_options; ++i)
+    {
+        Option& option = *options_[i];
+        option_year_fraction_indices_[i] = year_fractions_.register_expiry(
+            option.get_expiry_timestamp(), option.get_day_count());
+        K_[i] = option.get_strike();
+        is_call_[i] = option.get_option_type() == CALL;
+        is_future_[i] = false;
+    }
+    future_year_fraction_indices_.resize(n_futures);
+    for (std::size_t i = 0; i < n_futures; ++i)
+    {
+        Future& future = *futures_[i];
+        future_year_fraction_indices_[i] = future.is_perpetual() ? UNREGISTERED_YEAR_FRACTION :
+            year_fractions_.register_expiry(future.get_expiry_timestamp(), future.get_day_count());
+    }
+    option_price_.resize(n_options);
+    option_delta_.resize(n_options);
+    option_gamma_.resize(n_options);
+    option_theta_.resize(n_options);
+    option_vega_.resize(n_options);
+    option_rho_.resize(n_options);
+    option_bad_input_.resize(n_options);
+    future_price_.resize(n_futures);
+    future_delta_.resize(n_futures);
+    future_theta_.resize(n_futures);
+    future_rho_.resize(n_futures);
+    future_bad_input_.resize(n_futures);
+    prepared_ = true;
+};
+
+/**
+ * @brief Prices the book: the unique option legs in one vectorized Black-Scholes batch, the
+ * unique future legs at their fair forward, then the weighted sums of each structure and the
+ * book total. The batch and the structures are split in chunks on the pool, the book total is
+ * summed serially so that it does not depend on the number of threads.
+ * @param market The market data of the unique legs.
+ * @param reference_timestamp The pricing time.
+ * @return The risk of each structure and of the book.
+ * @throw PortfolioMissingMarket if the market data of a kind of leg held by the book is null.
+ * @throw UndefinedDayCountConventionError if the day count convention of a leg is invalid.
+ */
+PortfolioResult PortfolioAggregator::price(const PortfolioMarket& market, const Timestamp reference_timestamp)
+{
+    auto start = std::chrono::steady_clock::now();
+    const std::size_t n_options = options_.size();
+    const std::size_t n_futures = futures_.size();
+    if (n_options > 0 && !(market.option_S && market.option_r && market.option_q && market.option_sigma))
+    {
+        throw PortfolioMissingMarket();
+    }
+    if (n_futures > 0 && !(market.future_S && market.future_r && market.future_q))
+    {
+        throw PortfolioMissingMarket();
+    }
+    if (!prepared_){prepare();}
+    year_fractions_.set_reference_timestamp(reference_timestamp);
+    const double* fractions = year_fractions_.get_year_fractions();
+
+    PortfolioResult result;
+    result.n_bad_legs = 0;
+    for (std::size_t i = 0; i < n_options; ++i){T_[i] = fractions[option_year_fraction_indices_[i]];}
+    if (n_options > 0)
+    {
+        BlackScholesBatchInput input{
+            n_options, market.option_S, K_.data(), market.option_r, market.option_q,
+            market.option_sigma, T_.data(), is_call_.get(), is_future_.get(), nullptr
+        };
+        BlackScholesBatchOutput output{};
+        output.price = option_price_.data();
+        output.delta = option_delta_.data();
+        output.gamma = option_gamma_.data();
+        output.theta = option_theta_.data();
+        output.vega = option_vega_.data();
+        output.rho = option_rho_.data();
+        output.bad_input = option_bad_input_.data();
+        result.n_bad_legs += black_scholes_batch_parallel(
+            input, output, BS_PRICE | BS_DELTA | BS_GAMMA | BS_THETA | BS_VEGA | BS_RHO, pool_.get(), 0);
+    }
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (std::size_t i = 0; i < n_futures; ++i)
+    {
+        const std::size_t index = future_year_fraction_indices_[i];
+        const double t = index == UNREGISTERED_YEAR_FRACTION ? 0. : fractions[index];
+        if (t < 0)
+        {
+            future_bad_input_[i] = 1;
+            future_price_[i] = nan; future_delta_[i] = nan; future_theta_[i] = nan; future_rho_[i] = nan;
+            result.n_bad_legs++;
+            continue;
+        }
+        const double carry = market.future_r[i] - market.future_q[i];
+        const double growth = exp(carry*t);
+        const double F = market.future_S[i]*growth;
+        future_bad_input_[i] = 0;
+        future_price_[i] = F;
+        future_delta_[i] = growth;
+        future_theta_[i] = -carry*F;
+        future_rho_[i] = t*F;
+    }
+
+    const std::size_t n_structures = quantities_.size();
+    result.structures.resize(n_structures);
+    auto reduce_rows = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t s = begin; s < end; ++s)
+        {
+            PortfolioRisk risk{0., 0., 0., 0., 0., 0.};
+            for (std::size_t e = option_row_offsets_[s]; e < option_row_offsets_[s+1]; ++e)
+            {
+                const std::size_t j = option_columns_[e];
+                const double w = option_weights_[e];
+                risk.price += w*option_price_[j];
+                risk.delta += w*option_delta_[j];
+                risk.gamma += w*option_gamma_[j];
+                risk.theta += w*option_theta_[j];
+                risk.vega += w*option_vega_[j];
+                risk.rho += w*option_rho_[j];
+            }
+            for (std::size_t e = future_row_offsets_[s]; e < future_row_offsets_[s+1]; ++e)
+            {
+                const std::size_t j = future_columns_[e];
+                const double w = future_weights_[e];
+                risk.price += w*future_price_[j];
+                risk.delta += w*future_delta_[j];
+                risk.theta += w*future_theta_[j];
+                risk.rho += w*future_rho_[j];
+            }
+            result.structures[s] = risk;
+        }
+    };
+    if (pool_){pool_->parallel_for(n_structures, 0, reduce_rows);}
+    else{reduce_rows(0, n_structures);}
+    result.total = PortfolioRisk{0., 0., 0., 0., 0., 0.};
+    for (std::size_t s = 0; s < n_structures; ++s)
+    {
+        const PortfolioRisk& risk = result.structures[s];
+        const double quantity = quantities_[s];
+        result.total.price += quantity*risk.price;
+        result.total.delta += quantity*risk.delta;
+        result.total.gamma += quantity*risk.gamma;
+        result.total.theta += quantity*risk.theta;
+        result.total.vega += quantity*risk.vega;
+        result.total.rho += quantity*risk.rho;
+    }
+    result.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return result;
+};
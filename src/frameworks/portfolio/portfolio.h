@@ -0,0 +1,98 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <unordered_map>
+#include "../../datastructure/datetime/yearfraction/yearfraction.h"
+#include "../../datastructure/market/instruments/options/options.h"
+#include "../../datastructure/market/instruments/futures/futures.h"
+#include "../../frameworks/blackscholes/batch/batch.h"
+#include "../../parallel/threadpool/threadpool.h"
+
+class PortfolioUnsupportedLeg:  public std::exception
+{public: const char * what() const throw();};
+
+class PortfolioMissingMarket:  public std::exception
+{public: const char * what() const throw();};
+
+struct PortfolioMarket
+{
+    const double* option_S;
+    const double* option_r;
+    const double* option_q;
+    const double* option_sigma;
+    const double* future_S;
+    const double* future_r;
+    const double* future_q;
+};
+
+struct PortfolioRisk
+{
+    double price;
+    double delta;
+    double gamma;
+    double theta;
+    double vega;
+    double rho;
+};
+
+struct PortfolioResult
+{
+    std::vector<PortfolioRisk> structures;
+    PortfolioRisk total;
+    std::size_t n_bad_legs;
+    double elapsed_us;
+};
+
+struct PortfolioAggregator
+{
+    std::vector<std::shared_ptr<Option>> options_;
+    std::vector<std::shared_ptr<Future>> futures_;
+    std::unordered_map<const Option*, std::size_t> option_indices_;
+    std::unordered_map<const Future*, std::size_t> future_indices_;
+    std::vector<double> quantities_;
+    std::vector<std::size_t> option_row_offsets_;
+    std::vector<std::size_t> option_columns_;
+    std::vector<double> option_weights_;
+    std::vector<std::size_t> future_row_offsets_;
+    std::vector<std::size_t> future_columns_;
+    std::vector<double> future_weights_;
+    std::shared_ptr<ThreadPool> pool_;
+    YearFractionTable year_fractions_;
+    bool prepared_;
+    std::vector<std::size_t> option_year_fraction_indices_;
+    std::vector<std::size_t> future_year_fraction_indices_;
+    std::vector<double> K_;
+    std::vector<double> T_;
+    std::unique_ptr<bool[]> is_call_;
+    std::unique_ptr<bool[]> is_future_;
+    std::vector<double> option_price_;
+    std::vector<double> option_delta_;
+    std::vector<double> option_gamma_;
+    std::vector<double> option_theta_;
+    std::vector<double> option_vega_;
+    std::vector<double> option_rho_;
+    std::vector<unsigned char> option_bad_input_;
+    std::vector<double> future_price_;
+    std::vector<double> future_delta_;
+    std::vector<double> future_theta_;
+    std::vector<double> future_rho_;
+    std::vector<unsigned char> future_bad_input_;
+    PortfolioAggregator(const Timestamp reference_timestamp);
+    PortfolioAggregator(const Timestamp reference_timestamp, std::shared_ptr<ThreadPool> pool);
+    ~PortfolioAggregator(){};
+    std::size_t add_option(const std::shared_ptr<Option> option, const double quantity);
+    std::size_t add_future(const std::shared_ptr<Future> future, const double quantity);
+    std::size_t add_structured_option(const std::shared_ptr<StructuredOption> structure, const double quantity);
+    std::size_t add_structured_future(const std::shared_ptr<StructuredFuture> structure, const double quantity);
+    std::size_t get_number_structures();
+    std::size_t get_number_legs();
+    std::size_t register_option(const std::shared_ptr<Option>& option);
+    std::size_t register_future(const std::shared_ptr<Future>& future);
+    void close_row(const double quantity);
+    void prepare();
+    PortfolioResult price(const PortfolioMarket& market, const Timestamp reference_timestamp);
+};
@@ -0,0 +1,771 @@
+#include "scenario.h"
+
+/**
+* @file scenario.h
+* @brief This file defines the full revaluation of a book of crypto options, crypto futures and
+* zero coupon bonds over a grid of market scenarios: spot, volatility and rate shock ladders
+* crossed with time decays, or historical daily moves for a historical value at risk.
+*
+* The grid is a structure of arrays, one row of shocks per scenario. Nothing that does not
+* depend on the shocks is computed in the scenario loop: the year fractions come from one
+* YearFractionTable, and for every distinct time shift (a horizon) of the grid the year fraction,
+* its square root, the discount factor, the forward and the log moneyness log(F/K) of every
+* position are computed once per run. A scenario then costs, per option, a handful of
+* multiplications and two normal cdf, evaluated by blocks of BLACK_SCHOLES_BATCH_BLOCK with
+* NormalDistribution::cdf_n, and per future or bond one multiplication (plus one exp when the
+* scenario shocks the rates). The spot shocks are log returns, exp is taken once per scenario
+* and risk factor.
+*
+* The scenarios are split in chunks on the thread pool, each chunk computes the P&L of its
+* scenarios against the base value of the book and hands them to a sink, no object is built per
+* scenario or per position. The P&L of a scenario is summed serially over the positions, it does
+* not depend on the number of threads.
+*
+* References :
+* - "Value at Risk: The New Benchmark for Managing Financial Risk", Jorion, 2006.
+* - "Quantitative Risk Management", McNeil, Frey, Embrechts, 2015.
+*/
+
+/**
+ * @class ScenarioUnsupportedAsset
+ * @brief Definition of the error when a position is an American option, which the scenario
+ * engine does not price.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ScenarioUnsupportedAsset::what() const throw(){
+    return "American options can not be revalued by the scenario engine.";
+};
+
+/**
+ * @class ScenarioMissingMarket
+ * @brief Definition of the error when the market data of a kind of position is missing.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ScenarioMissingMarket::what() const throw(){
+    return "The market data of the option, future or bond positions is missing.";
+};
+
+/**
+ * @class ScenarioGridMismatch
+ * @brief Definition of the error when the number of risk factors of a grid is not the one of
+ * the engine.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ScenarioGridMismatch::what() const throw(){
+    return "The scenario grid does not have one shock per risk factor of the engine.";
+};
+
+/**
+ * @class ScenarioWrongConfidence
+ * @brief Definition of the error when a confidence level is not in (0, 1).
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ScenarioWrongConfidence::what() const throw(){
+    return "The confidence level must be in (0, 1).";
+};
+
+/**
+ * @var SCENARIO_MIN_VOLATILITY
+ * @brief The floor of the shocked volatilities, a volatility shock can not make them non
+ * positive.
+ */
+
+/**
+ * @struct ScenarioGrid
+ * @brief The scenarios, in structure of arrays.
+ *
+ * @var std::size_t ScenarioGrid::n_factors
+ *  The number of risk factors, see ScenarioEngine::factors_.
+ * @var std::size_t ScenarioGrid::n_scenarios
+ *  The number of scenarios.
+ * @var std::vector<double> ScenarioGrid::spot_shocks
+ *  The log returns of the spots, n_factors per scenario: the spot of the factor f in the
+ *  scenario s is S*exp(spot_shocks[s*n_factors + f]).
+ * @var std::vector<double> ScenarioGrid::vol_shocks
+ *  The absolute shifts of the implied volatilities, n_factors per scenario.
+ * @var std::vector<double> ScenarioGrid::rate_shocks
+ *  The parallel shift of the interest rates, one per scenario. It moves the discount factors
+ *  and the carry of the spot underlyings.
+ * @var std::vector<double> ScenarioGrid::time_shifts
+ *  The time decay of each scenario, in years: the year fractions of the positions are
+ *  shortened by it. The positions expiring before it are valued at their payoff.
+ */
+
+/**
+ * @brief The constructor of an empty grid.
+ * @param n_factors The number of risk factors.
+ */
+ScenarioGrid::ScenarioGrid(const std::size_t n_factors): n_factors(n_factors), n_scenarios(0){};
+
+/**
+ * @brief Reserves the memory of a number of scenarios.
+ * @param n_scenarios The number of scenarios.
+ */
+void ScenarioGrid::reserve(const std::size_t n_scenarios)
+{
+    spot_shocks.reserve(n_scenarios*n_factors);
+    vol_shocks.reserve(n_scenarios*n_factors);
+    rate_shocks.reserve(n_scenarios);
+    time_shifts.reserve(n_scenarios);
+};
+
+/**
+ * @brief Adds a scenario.
+ * @param spot_shocks The log returns of the spots, n_factors values (null for none).
+ * @param vol_shocks The shifts of the volatilities, n_factors values (null for none).
+ * @param rate_shock The shift of the interest rates.
+ * @param time_shift The time decay in years.
+ * @return The index of the scenario.
+ */
+std::size_t ScenarioGrid::add_scenario(const double* spot_shocks, const double* vol_shocks, const double rate_shock, const double time_shift)
+{
+    for (std::size_t f = 0; f < n_factors; ++f)
+    {
+        this->spot_shocks.push_back(spot_shocks ? spot_shocks[f] : 0.);
+        this->vol_shocks.push_back(vol_shocks ? vol_shocks[f] : 0.);
+    }
+    rate_shocks.push_back(rate_shock);
+    time_shifts.push_back(time_shift);
+    return n_scenarios++;
+};
+
+/**
+ * @brief Builds the ladder grid spot shocks x volatility shocks x time shifts, every factor
+ * being shocked alike. The time shifts are the outer loop, the spot shocks the inner one.
+ * @param n_factors The number of risk factors.
+ * @param spot_shocks The relative moves of the spots, -0.1 for a 10% drop, each greater than -1.
+ * @param vol_shocks The absolute shifts of the volatilities.
+ * @param time_shifts The time decays in years.
+ * @return The grid.
+ */
+ScenarioGrid make_scenario_ladder(
+    const std::size_t n_factors,
+    const std::vector<double>& spot_shocks,
+    const std::vector<double>& vol_shocks,
+    const std::vector<double>& time_shifts)
+{
+    ScenarioGrid grid(n_factors);
+    grid.reserve(spot_shocks.size()*vol_shocks.size()*time_shifts.size());
+    std::vector<double> spots(n_factors);
+    std::vector<double> vols(n_factors);
+    for (const double time_shift : time_shifts)
+    {
+        for (const double vol_shock : vol_shocks)
+        {
+            std::fill(vols.begin(), vols.end(), vol_shock);
+            for (const double spot_shock : spot_shocks)
+            {
+                std::fill(spots.begin(), spots.end(), log1p(spot_shock));
+                grid.add_scenario(spots.data(), vols.data(), 0., time_shift);
+            }
+        }
+    }
+    return grid;
+};
+
+/**
+ * @brief Builds the historical grid, one scenario per day of history applied to today's market.
+ * @param n_factors The number of risk factors.
+ * @param n_days The number of days.
+ * @param spot_returns The daily log returns of the spots, n_factors per day.
+ * @param vol_changes The daily changes of the implied volatilities, n_factors per day (null
+ * for none).
+ * @param rate_changes The daily changes of the interest rates, one per day (null for none).
+ * @param horizon The time decay of every scenario in years, 1/365 for a one day value at risk
+ * with theta, 0 without.
+ * @return The grid.
+ */
+ScenarioGrid make_historical_scenarios(
+    const std::size_t n_factors,
+    const std::size_t n_days,
+    const double* spot_returns,
+    const double* vol_changes,
+    const double* rate_changes,
+    const double horizon)
+{
+    ScenarioGrid grid(n_factors);
+    grid.reserve(n_days);
+    for (std::size_t d = 0; d < n_days; ++d)
+    {
+        grid.add_scenario(
+            spot_returns + d*n_factors,
+            vol_changes ? vol_changes + d*n_factors : nullptr,
+            rate_changes ? rate_changes[d] : 0.,
+            horizon);
+    }
+    return grid;
+};
+
+/**
+ * @struct ScenarioMarket
+ * @brief The base market data of the positions, in the order of ScenarioEngine::options_,
+ * ScenarioEngine::futures_ and ScenarioEngine::bonds_. The pointers of a kind of position may be
+ * null when the book has no position of that kind.
+ *
+ * @var const double* ScenarioMarket::option_S
+ *  The spot (or future price for the options on futures) of the underlying of each option.
+ * @var const double* ScenarioMarket::option_r
+ *  The risk free rate of each option.
+ * @var const double* ScenarioMarket::option_q
+ *  The dividend (or foreign, or staking) rate of each option.
+ * @var const double* ScenarioMarket::option_sigma
+ *  The implied volatility of each option.
+ * @var const double* ScenarioMarket::future_S
+ *  The spot of the underlying of each future.
+ * @var const double* ScenarioMarket::future_r
+ *  The risk free rate of each future.
+ * @var const double* ScenarioMarket::future_q
+ *  The dividend (or foreign, or staking) rate of each future.
+ * @var const double* ScenarioMarket::bond_r
+ *  The zero rate of each bond.
+ */
+
+/**
+ * @struct ScenarioResult
+ * @brief The result of a scenario run.
+ *
+ * @var double ScenarioResult::base_value
+ *  The value of the book in the base market.
+ * @var std::vector<double> ScenarioResult::pnl
+ *  The P&L of each scenario against the base value, empty when the run streams them to a sink.
+ * @var std::size_t ScenarioResult::n_bad_positions
+ *  The number of positions with a non positive base volatility or an expired base year
+ *  fraction, they are left out of the base value and of every scenario.
+ * @var double ScenarioResult::elapsed_us
+ *  The time of the run, in microseconds.
+ */
+
+/**
+ * @typedef ScenarioSink
+ * @brief The consumer of the P&L of the scenarios [begin, end), called once per chunk and from
+ * the threads of the pool: it must be safe to call concurrently on disjoint ranges.
+ */
+
+/**
+ * @struct ScenarioEngine
+ * @brief The book of positions and its scenario workspace. A position is a crypto option, a leg
+ * of a crypto structured option, a crypto future or a zero coupon bond with its quantity. The
+ * options and the futures are mapped to the risk factor of their asset, which selects their
+ * spot and volatility shocks in the grid.
+ *
+ * @var std::vector<std::shared_ptr<RiskFactor>> ScenarioEngine::factors_
+ *  The risk factors of the book, in the order of the shocks of a ScenarioGrid.
+ * @var std::unordered_map<const RiskFactor*, std::size_t> ScenarioEngine::factor_indices_
+ *  The index of each risk factor.
+ * @var std::vector<std::shared_ptr<Option>> ScenarioEngine::options_
+ *  The option positions.
+ * @var std::vector<std::size_t> ScenarioEngine::option_factors_
+ *  The risk factor of each option.
+ * @var std::vector<double> ScenarioEngine::option_quantities_
+ *  The quantity of each option, times its weight in its structure.
+ * @var std::vector<std::shared_ptr<Future>> ScenarioEngine::futures_
+ *  The future positions.
+ * @var std::vector<std::size_t> ScenarioEngine::future_factors_
+ *  The risk factor of each future.
+ * @var std::vector<double> ScenarioEngine::future_quantities_
+ *  The quantity of each future.
+ * @var std::vector<std::shared_ptr<ZeroCouponBond>> ScenarioEngine::bonds_
+ *  The bond positions, they only move with the rate shocks and the time decay.
+ * @var std::vector<double> ScenarioEngine::bond_quantities_
+ *  The notional of each bond.
+ * @var std::shared_ptr<ThreadPool> ScenarioEngine::pool_
+ *  The thread pool running the scenarios, everything is serial if null.
+ * @var YearFractionTable ScenarioEngine::year_fractions_
+ *  The year fractions of the distinct expiries of the positions.
+ * @var bool ScenarioEngine::prepared_
+ *  Whether the static workspace matches the positions, it is reset by each new position.
+ * @var std::vector<double> ScenarioEngine::horizons_
+ *  The distinct time shifts of the last grid, the first one is 0 (the base market).
+ * @var std::vector<std::size_t> ScenarioEngine::scenario_horizons_
+ *  The horizon of each scenario of the last grid.
+ *
+ * The option_, future_ and bond_ arrays of the year fractions, square roots, discount factors,
+ * forwards and log moneyness hold one value per horizon and position, horizon-major: they are
+ * the terms hoisted out of the scenario loop.
+ */
+
+/**
+ * @brief The serial constructor.
+ * @param reference_timestamp The first reference time of the year fractions.
+ */
+ScenarioEngine::ScenarioEngine(const Timestamp reference_timestamp):
+    ScenarioEngine(reference_timestamp, nullptr){};
+
+/**
+ * @brief The constructor.
+ * @param reference_timestamp The first reference time of the year fractions.
+ * @param pool The thread pool (can be null).
+ */
+ScenarioEngine::ScenarioEngine(const Timestamp reference_timestamp, std::shared_ptr<ThreadPool> pool):
+    pool_(pool), year_fractions_(reference_timestamp), prepared_(false){};
+
+/**
+ * @brief Gets the index of a risk factor, registering it if it is new.
+ * @param factor The risk factor.
+ * @return The index of the risk factor.
+ */
+std::size_t ScenarioEngine::register_factor(const std::shared_ptr<RiskFactor>& factor)
+{
+    auto found = factor_indices_.find(factor.get());
+    if (found != factor_indices_.end()){return found->second;}
+    const std::size_t index = factors_.size();
+    factors_.push_back(factor);
+    factor_indices_.emplace(factor.get(), index);
+    return index;
+};
+
+/**
+ * @brief Adds a crypto option position.
+ * @param option The crypto option, on a spot or on a future.
+ * @param quantity The quantity held.
+ * @return The number of positions.
+ * @throw ScenarioUnsupportedAsset if the option is American.
+ */
+std::size_t ScenarioEngine::add_crypto_option(const std::shared_ptr<CryptoOption> option, const double quantity)
+{
+    const std::shared_ptr<Option> leg = option->get_option();
+    if (leg->get_instrument_tag() == INSTRUMENT_AMERICAN_VANILLA_OPTION){throw ScenarioUnsupportedAsset();}
+    options_.push_back(leg);
+    option_factors_.push_back(register_factor(option->get_risk_factor()));
+    option_quantities_.push_back(quantity);
+    future_flags_.push_back(option->get_underlying_crypto_asset()->get_asset_tag() == ASSET_CRYPTO_FUTURE ? 0. : 1.);
+    prepared_ = false;
+    return get_number_positions();
+};
+
+/**
+ * @brief Adds the legs of a crypto structured option position.
+ * @param structure The crypto structured option.
+ * @param quantity The quantity held, each leg is held quantity times its weight.
+ * @return The number of positions.
+ * @throw ScenarioUnsupportedAsset if a leg is American, the book is then left unchanged.
+ */
+std::size_t ScenarioEngine::add_crypto_structured_option(const std::shared_ptr<CryptoStructuredOption> structure, const double quantity)
+{
+    const std::shared_ptr<StructuredOption> structured_option = structure->get_structured_option();
+    const std::vector<std::shared_ptr<Option>> legs = structured_option->get_options();
+    const std::vector<double> weights = structured_option->get_weights();
+    for (const std::shared_ptr<Option>& leg: legs)
+    {
+        if (leg->get_instrument_tag() == INSTRUMENT_AMERICAN_VANILLA_OPTION){throw ScenarioUnsupportedAsset();}
+    }
+    const std::size_t factor = register_factor(structure->get_risk_factor());
+    const double future_flag = structure->get_underlying_crypto_asset()->get_asset_tag() == ASSET_CRYPTO_FUTURE ? 0. : 1.;
+    for (std::size_t i = 0; i < legs.size(); ++i)
+    {
+        options_.push_back(legs[i]);
+        option_factors_.push_back(factor);
+        option_quantities_.push_back(quantity*weights[i]);
+        future_flags_.push_back(future_flag);
+    }
+    prepared_ = false;
+    return get_number_positions();
+};
+
+/**
+ * @brief Adds a crypto future position, valued at its fair forward.
+ * @param future The crypto future.
+ * @param quantity The quantity held.
+ * @return The number of positions.
+ */
+std::size_t ScenarioEngine::add_crypto_future(const std::shared_ptr<CryptoFuture> future, const double quantity)
+{
+    futures_.push_back(future->get_future());
+    future_factors_.push_back(register_factor(future->get_risk_factor()));
+    future_quantities_.push_back(quantity);
+    prepared_ = false;
+    return get_number_positions();
+};
+
+/**
+ * @brief Adds a zero coupon bond position.
+ * @param bond The zero coupon bond.
+ * @param quantity The notional held.
+ * @return The number of positions.
+ */
+std::size_t ScenarioEngine::add_zero_coupon_bond(const std::shared_ptr<ZeroCouponBond> bond, const double quantity)
+{
+    bonds_.push_back(bond);
+    bond_quantities_.push_back(quantity);
+    prepared_ = false;
+    return get_number_positions();
+};
+
+/**
+ * @return The number of risk factors, the number of spot and volatility shocks per scenario.
+ */
+std::size_t ScenarioEngine::get_number_factors()
+{
+    return factors_.size();
+};
+
+/**
+ * @return The number of positions, options, futures and bonds.
+ */
+std::size_t ScenarioEngine::get_number_positions()
+{
+    return options_.size() + futures_.size() + bonds_.size();
+};
+
+/**
+ * @brief Builds the static workspace of the positions: registers their expiries in the year
+ * fraction table and fills the strikes and flags. Called by run when a position was added
+ * since the last call.
+ * @throw UndefinedDayCountConventionError if the day count convention of a position is invalid.
+ */
+void ScenarioEngine::prepare()
+{
+    const std::size_t n_options = options_.size();
+    option_year_fraction_indices_.resize(n_options);
+    K_.resize(n_options);
+    call_put_flags_.resize(n_options);
+    for (std::size_t i = 0; i < n_options; ++i)
+    {
+        Option& option = *options_[i];
+        option_year_fraction_indices_[i] = year_fractions_.register_expiry(
+            option.get_expiry_timestamp(), option.get_day_count());
+        K_[i] = option.get_strike();
+        call_put_flags_[i] = option.get_option_type() == CALL ? 1. : -1.;
+    }
+    future_year_fraction_indices_.resize(futures_.size());
+    for (std::size_t i = 0; i < futures_.size(); ++i)
+    {
+        Future& future = *futures_[i];
+        future_year_fraction_indices_[i] = future.is_perpetual() ? UNREGISTERED_YEAR_FRACTION :
+            year_fractions_.register_expiry(future.get_expiry_timestamp(), future.get_day_count());
+    }
+    bond_year_fraction_indices_.resize(bonds_.size());
+    for (std::size_t i = 0; i < bonds_.size(); ++i)
+    {
+        ZeroCouponBond& bond = *bonds_[i];
+        bond_year_fraction_indices_[i] = year_fractions_.register_expiry(
+            bond.get_expiry_timestamp(), bond.get_day_count_convention());
+    }
+    option_bad_.resize(n_options);
+    future_bad_.resize(futures_.size());
+    bond_bad_.resize(bonds_.size());
+    prepared_ = true;
+};
+
+/**
+ * @brief Computes the terms of the positions that do not depend on the shocks, for every
+ * horizon of the grid, and flags the bad positions.
+ * @param market The base market data.
+ * @param grid The scenario grid.
+ * @param reference_timestamp The pricing time.
+ * @return The number of bad positions.
+ */
+std::size_t ScenarioEngine::hoist(const ScenarioMarket& market, const ScenarioGrid& grid, const Timestamp reference_timestamp)
+{
+    horizons_.assign(1, 0.);
+    scenario_horizons_.resize(grid.n_scenarios);
+    std::unordered_map<double, std::size_t> horizon_indices{{0., 0}};
+    for (std::size_t s = 0; s < grid.n_scenarios; ++s)
+    {
+        const auto inserted = horizon_indices.emplace(grid.time_shifts[s], horizons_.size());
+        if (inserted.second){horizons_.push_back(grid.time_shifts[s]);}
+        scenario_horizons_[s] = inserted.first->second;
+    }
+    year_fractions_.set_reference_timestamp(reference_timestamp);
+    const double* fractions = year_fractions_.get_year_fractions();
+    const std::size_t n_horizons = horizons_.size();
+    const std::size_t n_options = options_.size();
+    const std::size_t n_futures = futures_.size();
+    const std::size_t n_bonds = bonds_.size();
+    std::size_t n_bad = 0;
+
+    option_T_.resize(n_horizons*n_options);
+    option_sqrt_T_.resize(n_horizons*n_options);
+    option_df_.resize(n_horizons*n_options);
+    option_F_.resize(n_horizons*n_options);
+    option_log_moneyness_.resize(n_horizons*n_options);
+    for (std::size_t i = 0; i < n_options; ++i)
+    {
+        const double T0 = fractions[option_year_fraction_indices_[i]];
+        option_bad_[i] = !(T0 > 0) || !(market.option_sigma[i] > 0);
+        n_bad += option_bad_[i];
+        const double mu = future_flags_[i]*(market.option_r[i] - market.option_q[i]);
+        for (std::size_t h = 0; h < n_horizons; ++h)
+        {
+            const std::size_t j = h*n_options + i;
+            const double T = T0 - horizons_[h];
+            const double t = std::max(T, 0.);
+            option_T_[j] = T;
+            option_sqrt_T_[j] = sqrt(t);
+            option_df_[j] = exp(-market.option_r[i]*t);
+            option_F_[j] = market.option_S[i]*exp(mu*t);
+            option_log_moneyness_[j] = log(option_F_[j]/K_[i]);
+        }
+    }
+    future_T_.resize(n_horizons*n_futures);
+    future_F_.resize(n_horizons*n_futures);
+    for (std::size_t i = 0; i < n_futures; ++i)
+    {
+        const std::size_t index = future_year_fraction_indices_[i];
+        const double T0 = index == UNREGISTERED_YEAR_FRACTION ? 0. : fractions[index];
+        future_bad_[i] = T0 < 0;
+        n_bad += future_bad_[i];
+        const double carry = market.future_r[i] - market.future_q[i];
+        for (std::size_t h = 0; h < n_horizons; ++h)
+        {
+            const std::size_t j = h*n_futures + i;
+            const double t = std::max(T0 - horizons_[h], 0.);
+            future_T_[j] = t;
+            future_F_[j] = market.future_S[i]*exp(carry*t);
+        }
+    }
+    bond_T_.resize(n_horizons*n_bonds);
+    bond_df_.resize(n_horizons*n_bonds);
+    for (std::size_t i = 0; i < n_bonds; ++i)
+    {
+        const double T0 = fractions[bond_year_fraction_indices_[i]];
+        bond_bad_[i] = T0 < 0;
+        n_bad += bond_bad_[i];
+        for (std::size_t h = 0; h < n_horizons; ++h)
+        {
+            const std::size_t j = h*n_bonds + i;
+            const double t = std::max(T0 - horizons_[h], 0.);
+            bond_T_[j] = t;
+            bond_df_[j] = exp(-market.bond_r[i]*t);
+        }
+    }
+    return n_bad;
+};
+
+/**
+ * @brief Values the book in one scenario from the hoisted terms of its horizon. The options
+ * are processed in blocks of BLACK_SCHOLES_BATCH_BLOCK: their d1 and d2 first, then the normal
+ * cdf of the whole block with NormalDistribution::cdf_n, then their values. The options expired
+ * at the horizon are valued at their payoff on the shocked spot.
+ * @param engine The engine, hoisted.
+ * @param market The base market data.
+ * @param h The horizon of the scenario.
+ * @param spot_shocks The log returns of the spots of the factors.
+ * @param vol_shocks The shifts of the volatilities of the factors.
+ * @param rate_shock The shift of the rates.
+ * @param spot_factors The scratch of the spot moves exp(spot_shocks), one per factor.
+ * @return The value of the book.
+ */
+static double value_scenario(
+    const ScenarioEngine& engine,
+    const ScenarioMarket& market,
+    const std::size_t h,
+    const double* spot_shocks,
+    const double* vol_shocks,
+    const double rate_shock,
+    double* spot_factors)
+{
+    NormalDistribution stdnorm = NormalDistribution();
+    double x[2*BLACK_SCHOLES_BATCH_BLOCK];
+    double cdfs[2*BLACK_SCHOLES_BATCH_BLOCK];
+    for (std::size_t f = 0; f < engine.factors_.size(); ++f){spot_factors[f] = exp(spot_shocks[f]);}
+    double value = 0.;
+
+    const std::size_t n_options = engine.options_.size();
+    const std::size_t offset = h*n_options;
+    for (std::size_t start = 0; start < n_options; start += BLACK_SCHOLES_BATCH_BLOCK)
+    {
+        const std::size_t m = std::min(BLACK_SCHOLES_BATCH_BLOCK, n_options - start);
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            const std::size_t i = start + j;
+            const double T = engine.option_T_[offset + i];
+            if (engine.option_bad_[i] || !(T > 0)){x[j] = x[m+j] = 0.; continue;}
+            const std::size_t f = engine.option_factors_[i];
+            const double sigma = std::max(market.option_sigma[i] + vol_shocks[f], SCENARIO_MIN_VOLATILITY);
+            const double sd = sigma*engine.option_sqrt_T_[offset + i];
+            const double log_moneyness = engine.option_log_moneyness_[offset + i] + spot_shocks[f]
+                + engine.future_flags_[i]*rate_shock*T;
+            const double d1 = log_moneyness/sd + .5*sd;
+            x[j] = engine.call_put_flags_[i]*d1;
+            x[m+j] = engine.call_put_flags_[i]*(d1 - sd);
+        }
+        stdnorm.cdf_n(x, cdfs, 2*m);
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            const std::size_t i = start + j;
+            if (engine.option_bad_[i]){continue;}
+            const std::size_t f = engine.option_factors_[i];
+            const double T = engine.option_T_[offset + i];
+            const double cp = engine.call_put_flags_[i];
+            double v;
+            if (!(T > 0))
+            {
+                v = std::max(cp*(market.option_S[i]*spot_factors[f] - engine.K_[i]), 0.);
+            }
+            else
+            {
+                double F = engine.option_F_[offset + i]*spot_factors[f];
+                double df = engine.option_df_[offset + i];
+                if (rate_shock != 0.)
+                {
+                    F *= exp(engine.future_flags_[i]*rate_shock*T);
+                    df *= exp(-rate_shock*T);
+                }
+                v = df*cp*(F*cdfs[j] - engine.K_[i]*cdfs[m+j]);
+            }
+            value += engine.option_quantities_[i]*v;
+        }
+    }
+
+    const std::size_t n_futures = engine.futures_.size();
+    for (std::size_t i = 0; i < n_futures; ++i)
+    {
+        if (engine.future_bad_[i]){continue;}
+        const std::size_t j = h*n_futures + i;
+        double F = engine.future_F_[j]*spot_factors[engine.future_factors_[i]];
+        if (rate_shock != 0.){F *= exp(rate_shock*engine.future_T_[j]);}
+        value += engine.future_quantities_[i]*F;
+    }
+
+    const std::size_t n_bonds = engine.bonds_.size();
+    for (std::size_t i = 0; i < n_bonds; ++i)
+    {
+        if (engine.bond_bad_[i]){continue;}
+        const std::size_t j = h*n_bonds + i;
+        double df = engine.bond_df_[j];
+        if (rate_shock != 0.){df *= exp(-rate_shock*engine.bond_T_[j]);}
+        value += engine.bond_quantities_[i]*df;
+    }
+    return value;
+};
+
+/**
+ * @brief Revalues the book over a grid and returns the P&L of every scenario.
+ * @param market The base market data.
+ * @param grid The scenario grid.
+ * @param reference_timestamp The pricing time.
+ * @return The base value and the P&L of each scenario.
+ * @throw ScenarioMissingMarket if the market data of a kind of position held by the book is null.
+ * @throw ScenarioGridMismatch if the grid does not have one shock per risk factor.
+ * @throw UndefinedDayCountConventionError if the day count convention of a position is invalid.
+ */
+ScenarioResult ScenarioEngine::run(const ScenarioMarket& market, const ScenarioGrid& grid, const Timestamp reference_timestamp)
+{
+    std::vector<double> pnl(grid.n_scenarios);
+    ScenarioResult result = run(market, grid, reference_timestamp,
+        [&pnl](std::size_t begin, std::size_t end, const double* values){
+            std::copy(values, values + (end - begin), pnl.begin() + begin);
+        });
+    result.pnl = std::move(pnl);
+    return result;
+};
+
+/**
+ * @brief Revalues the book over a grid and streams the P&L of the scenarios to a sink, chunk by
+ * chunk, without keeping them. The chunks are run on the pool.
+ * @param market The base market data.
+ * @param grid The scenario grid.
+ * @param reference_timestamp The pricing time.
+ * @param sink The consumer of the P&L.
+ * @return The base value, the P&L are left empty.
+ * @throw ScenarioMissingMarket if the market data of a kind of position held by the book is null.
+ * @throw ScenarioGridMismatch if the grid does not have one shock per risk factor.
+ * @throw UndefinedDayCountConventionError if the day count convention of a position is invalid.
+ */
+ScenarioResult ScenarioEngine::run(
+    const ScenarioMarket& market,
+    const ScenarioGrid& grid,
+    const Timestamp reference_timestamp,
+    const ScenarioSink& sink)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_PRICING);
+    auto start = std::chrono::steady_clock::now();
+    if (!options_.empty() && !(market.option_S && market.option_r && market.option_q && market.option_sigma))
+    {
+        throw ScenarioMissingMarket();
+    }
+    if (!futures_.empty() && !(market.future_S && market.future_r && market.future_q)){throw ScenarioMissingMarket();}
+    if (!bonds_.empty() && !market.bond_r){throw ScenarioMissingMarket();}
+    if (grid.n_factors != factors_.size()){throw ScenarioGridMismatch();}
+    if (!prepared_){prepare();}
+
+    ScenarioResult result;
+    result.n_bad_positions = hoist(market, grid, reference_timestamp);
+    const std::size_t n_factors = factors_.size();
+    std::vector<double> base_shocks(n_factors, 0.);
+    std::vector<double> base_factors(n_factors);
+    result.base_value = value_scenario(*this, market, 0, base_shocks.data(), base_shocks.data(), 0., base_factors.data());
+    const double base_value = result.base_value;
+
+    auto run_chunk = [&](std::size_t begin, std::size_t end)
+    {
+        std::vector<double> spot_factors(n_factors);
+        std::vector<double> pnl(end - begin);
+        for (std::size_t s = begin; s < end; ++s)
+        {
+            pnl[s - begin] = value_scenario(
+                *this, market, scenario_horizons_[s], grid.spot_shocks.data() + s*n_factors,
+                grid.vol_shocks.data() + s*n_factors, grid.rate_shocks[s], spot_factors.data()) - base_value;
+        }
+        sink(begin, end, pnl.data());
+        ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_INSTRUMENTS_PRICED, (end - begin)*get_number_positions());
+    };
+    if (pool_){pool_->parallel_for(grid.n_scenarios, 0, run_chunk);}
+    else{run_chunk(0, grid.n_scenarios);}
+    result.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return result;
+};
+
+/**
+ * @brief Sorts the P&L and gets the index of the tail quantile.
+ * @param pnl The P&L of the scenarios.
+ * @param confidence The confidence level.
+ * @param sorted The sorted P&L.
+ * @return The index of the last P&L of the tail in the sorted P&L.
+ * @throw ScenarioWrongConfidence
+ */
+static std::size_t sort_tail(const std::vector<double>& pnl, const double confidence, std::vector<double>& sorted)
+{
+    if (!(confidence > 0 && confidence < 1)){throw ScenarioWrongConfidence();}
+    sorted = pnl;
+    std::sort(sorted.begin(), sorted.end());
+    if (sorted.empty()){return 0;}
+    return std::min(static_cast<std::size_t>((1 - confidence)*sorted.size()), sorted.size() - 1);
+};
+
+/**
+ * @brief The historical value at risk: the loss of the sorted P&L at the rank
+ * floor((1 - confidence)*n), the 6th worst of 500 scenarios at 99%.
+ * @param pnl The P&L of the scenarios.
+ * @param confidence The confidence level, 0.99 for example.
+ * @return The value at risk, positive for a loss, 0 without scenario.
+ * @throw ScenarioWrongConfidence
+ */
+double get_value_at_risk(const std::vector<double>& pnl, const double confidence)
+{
+    std::vector<double> sorted;
+    const std::size_t index = sort_tail(pnl, confidence, sorted);
+    if (sorted.empty()){return 0.;}
+    return -sorted[index];
+};
+
+/**
+ * @brief The historical expected shortfall: the mean loss of the sorted P&L up to the rank of
+ * the value at risk included.
+ * @param pnl The P&L of the scenarios.
+ * @param confidence The confidence level, 0.975 for example.
+ * @return The expected shortfall, positive for a loss, 0 without scenario.
+ * @throw ScenarioWrongConfidence
+ */
+double get_expected_shortfall(const std::vector<double>& pnl, const double confidence)
+{
+    std::vector<double> sorted;
+    const std::size_t index = sort_tail(pnl, confidence, sorted);
+    if (sorted.empty()){return 0.;}
+    double sum = 0.;
+    for (std::size_t i = 0; i <= index; ++i){sum += sorted[i];}
+    return -sum/(index + 1);
+};
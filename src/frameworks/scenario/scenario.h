@@ -0,0 +1,142 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <unordered_map>
+#include "../../datastructure/datetime/yearfraction/yearfraction.h"
+#include "../../datastructure/market/riskfactors/riskfactors.h"
+#include "../../datastructure/market/instruments/options/options.h"
+#include "../../datastructure/market/instruments/futures/futures.h"
+#include "../../datastructure/market/assets/crypto/cryptoassets.h"
+#include "../../datastructure/market/assets/interestrate/irassets.h"
+#include "../../frameworks/blackscholes/batch/batch.h"
+#include "../../math/probability/normal/normal.h"
+#include "../../parallel/threadpool/threadpool.h"
+#include "../../instrumentation/instrumentation.h"
+
+constexpr double SCENARIO_MIN_VOLATILITY = 1e-4;
+
+class ScenarioUnsupportedAsset:  public std::exception
+{public: const char * what() const throw();};
+
+class ScenarioMissingMarket:  public std::exception
+{public: const char * what() const throw();};
+
+class ScenarioGridMismatch:  public std::exception
+{public: const char * what() const throw();};
+
+class ScenarioWrongConfidence:  public std::exception
+{public: const char * what() const throw();};
+
+struct ScenarioGrid
+{
+    std::size_t n_factors;
+    std::size_t n_scenarios;
+    std::vector<double> spot_shocks;
+    std::vector<double> vol_shocks;
+    std::vector<double> rate_shocks;
+    std::vector<double> time_shifts;
+    ScenarioGrid(const std::size_t n_factors);
+    ~ScenarioGrid(){};
+    std::size_t add_scenario(const double* spot_shocks, const double* vol_shocks, const double rate_shock, const double time_shift);
+    void reserve(const std::size_t n_scenarios);
+};
+
+ScenarioGrid make_scenario_ladder(
+    const std::size_t n_factors,
+    const std::vector<double>& spot_shocks,
+    const std::vector<double>& vol_shocks,
+    const std::vector<double>& time_shifts);
+
+ScenarioGrid make_historical_scenarios(
+    const std::size_t n_factors,
+    const std::size_t n_days,
+    const double* spot_returns,
+    const double* vol_changes,
+    const double* rate_changes,
+    const double horizon);
+
+struct ScenarioMarket
+{
+    const double* option_S;
+    const double* option_r;
+    const double* option_q;
+    const double* option_sigma;
+    const double* future_S;
+    const double* future_r;
+    const double* future_q;
+    const double* bond_r;
+};
+
+struct ScenarioResult
+{
+    double base_value;
+    std::vector<double> pnl;
+    std::size_t n_bad_positions;
+    double elapsed_us;
+};
+
+typedef std::function<void(std::size_t begin, std::size_t end, const double* pnl)> ScenarioSink;
+
+struct ScenarioEngine
+{
+    std::vector<std::shared_ptr<RiskFactor>> factors_;
+    std::unordered_map<const RiskFactor*, std::size_t> factor_indices_;
+    std::vector<std::shared_ptr<Option>> options_;
+    std::vector<std::size_t> option_factors_;
+    std::vector<double> option_quantities_;
+    std::vector<std::shared_ptr<Future>> futures_;
+    std::vector<std::size_t> future_factors_;
+    std::vector<double> future_quantities_;
+    std::vector<std::shared_ptr<ZeroCouponBond>> bonds_;
+    std::vector<double> bond_quantities_;
+    std::shared_ptr<ThreadPool> pool_;
+    YearFractionTable year_fractions_;
+    bool prepared_;
+    std::vector<std::size_t> option_year_fraction_indices_;
+    std::vector<std::size_t> future_year_fraction_indices_;
+    std::vector<std::size_t> bond_year_fraction_indices_;
+    std::vector<double> K_;
+    std::vector<double> call_put_flags_;
+    std::vector<double> future_flags_;
+    std::vector<unsigned char> option_bad_;
+    std::vector<unsigned char> future_bad_;
+    std::vector<unsigned char> bond_bad_;
+    std::vector<double> horizons_;
+    std::vector<std::size_t> scenario_horizons_;
+    std::vector<double> option_T_;
+    std::vector<double> option_sqrt_T_;
+    std::vector<double> option_df_;
+    std::vector<double> option_F_;
+    std::vector<double> option_log_moneyness_;
+    std::vector<double> future_T_;
+    std::vector<double> future_F_;
+    std::vector<double> bond_T_;
+    std::vector<double> bond_df_;
+    ScenarioEngine(const Timestamp reference_timestamp);
+    ScenarioEngine(const Timestamp reference_timestamp, std::shared_ptr<ThreadPool> pool);
+    ~ScenarioEngine(){};
+    std::size_t register_factor(const std::shared_ptr<RiskFactor>& factor);
+    std::size_t add_crypto_option(const std::shared_ptr<CryptoOption> option, const double quantity);
+    std::size_t add_crypto_structured_option(const std::shared_ptr<CryptoStructuredOption> structure, const double quantity);
+    std::size_t add_crypto_future(const std::shared_ptr<CryptoFuture> future, const double quantity);
+    std::size_t add_zero_coupon_bond(const std::shared_ptr<ZeroCouponBond> bond, const double quantity);
+    std::size_t get_number_factors();
+    std::size_t get_number_positions();
+    void prepare();
+    std::size_t hoist(const ScenarioMarket& market, const ScenarioGrid& grid, const Timestamp reference_timestamp);
+    ScenarioResult run(const ScenarioMarket& market, const ScenarioGrid& grid, const Timestamp reference_timestamp);
+    ScenarioResult run(
+        const ScenarioMarket& market,
+        const ScenarioGrid& grid,
+        const Timestamp reference_timestamp,
+        const ScenarioSink& sink);
+};
+
+double get_value_at_risk(const std::vector<double>& pnl, const double confidence);
+
+double get_expected_shortfall(const std::vector<double>& pnl, const double confidence);
@@ -0,0 +1,600 @@
+#include "calibration.h"
+
+/**
+* @file calibration.h
+* @brief This file defines the two stage calibration of the SVI and SSVI models to market total variances.
+*
+* Stage one fits a raw SVI slice w(k) = a + b*(rho*(k-m) + sqrt((k-m)^2 + sigma^2)) per expiry with
+* the quasi-explicit method: for fixed (m, sigma) the total variance is linear in (a, d, c) =
+* (a, rho*b*sigma, b*sigma) and the constrained least squares problem is solved exactly, the outer
+* (m, sigma) problem is minimized with a Nelder-Mead simplex. The slices are independent and are
+* fitted in parallel on a ThreadPool. The linear constraints keep b*(1+|rho|) below 2
+* (first condition of SVI::butterfly_arbitrage_check) and a in [0, max w], the second butterfly
+* condition is enforced with a penalty.
+*
+* Stage two fits the global power law SSVI (rho, nu, gamma) on all quotes, the ATM total
+* variances being read from the stage one slices. A parameter set is admissible only if
+* SSVI::butterfly_arbitrage_check and SSVI::calendar_spread_arbitrage_check hold for every slice.
+*
+* Both stages warm start from the parameters of the previous call of SVICalibrator::calibrate,
+* when the objective is finite there (the previous SSVI can violate the arbitrage conditions on
+* the new ATM total variances, the previous slice can give a negative ATM total variance), and cold
+* start otherwise. A slice simplex is started from the previous minimum with a size of
+* SVI_WARM_START_STEP times the tolerance: (m, sigma) barely move between two refits and the
+* simplex only expands as far as they moved. The SSVI simplex has a size of SSVI_WARM_START_STEP,
+* a tenth of the cold start one: its minimum moves with every ATM total variance and a simplex of
+* the size of the tolerance needs more iterations to expand than a cold start to shrink.
+*
+* References :
+* - "Quasi-explicit calibration of Gatheral's SVI model", Zeliade Systems, 2009.
+* - "Arbitrage-free SVI volatility surface", Gatheral, Jacquier, 2013.
+*/
+
+/**
+ * @class SVICalibrationWrongQuotes
+ * @brief Definition of the error when the calibration quotes are inconsistent.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SVICalibrationWrongQuotes::what() const throw(){
+    return "The slices must have positive increasing year fractions, and as many total variances (and weights) as log moneyness values.";
+};
+
+/**
+ * @class SVICalibrationNotEnoughQuotes
+ * @brief Definition of the error when a slice has less quotes than SVI parameters.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SVICalibrationNotEnoughQuotes::what() const throw(){
+    return "A SVI slice needs at least 5 quotes to be calibrated.";
+};
+
+static const std::size_t SVI_MIN_QUOTES = 5;
+static const double SVI_MIN_SIGMA = 1e-6;
+static const double SVI_WING_BOUND = 2*(1 - 1e-9);
+static const double SVI_WARM_START_STEP = 10;
+static const double SSVI_WARM_START_STEP = 1e-2;
+static const double SVI_COLD_START_STEP = 1e-1;
+
+/**
+ * @struct SVISliceQuotes
+ * @brief The quotes of one expiry: the year fraction t, the log moneyness values k and the
+ * market total variances w. The weights are optional (empty means equal weights).
+ */
+
+/**
+ * @struct SVIRawParameters
+ * @brief The raw SVI parameters (a, b, rho, m, sigma).
+ */
+
+/**
+ * @struct SVISliceFit
+ * @brief The stage one fit of one slice, with its root mean square error, the number of
+ * Nelder-Mead iterations, the time spent in microseconds, whether it converged, whether it was
+ * warm started and the result of SVI::butterfly_arbitrage_check.
+ */
+
+/**
+ * @param k The log moneyness.
+ * @return The fitted total variance.
+ */
+double SVISliceFit::total_variance(double k)
+{
+    const double km = k - raw.m;
+    return raw.a + raw.b*(raw.rho*km + sqrt(km*km + raw.sigma*raw.sigma));
+};
+
+/**
+ * @return The fitted ATM total variance.
+ */
+double SVISliceFit::atm_total_variance()
+{
+    return total_variance(0.0);
+};
+
+/**
+ * @brief Translates the raw parameters into the Jump-Wings parametrization.
+ * @return The fitted slice as a SVI.
+ * @throw SVIWrongParameterValue
+ */
+SVI SVISliceFit::get_svi()
+{
+    const double w = atm_total_variance();
+    const double sqrt_w = sqrt(w);
+    const double r = sqrt(raw.m*raw.m + raw.sigma*raw.sigma);
+    return SVI(
+        w/t,
+        .5*raw.b*(raw.rho - raw.m/r)/sqrt_w,
+        raw.b*(1 + raw.rho)/sqrt_w,
+        raw.b*(1 - raw.rho)/sqrt_w,
+        (raw.a + raw.b*raw.sigma*sqrt(1 - raw.rho*raw.rho))/t,
+        t);
+};
+
+/**
+ * @struct SSVIFit
+ * @brief The stage two fit of the SSVI, with its root mean square error, the number of
+ * Nelder-Mead iterations, the time spent in microseconds, whether it converged, whether it was
+ * warm started and whether the arbitrage checks hold on every slice.
+ */
+
+/**
+ * @return The fitted SSVI.
+ * @throw SSVIWrongParameterValue
+ */
+SSVI SSVIFit::get_ssvi()
+{
+    return SSVI(rho, nu, gamma);
+};
+
+/**
+ * @struct SVICalibrationReport
+ * @brief The result of SVICalibrator::calibrate: the slices in the order of the quotes, the
+ * result of SVI::calendar_spread_arbitrage_check for each pair of consecutive slices, the SSVI
+ * fit and the total time spent in microseconds.
+ */
+
+/**
+ * @struct SVISliceSums
+ * @brief The weighted sums defining the least squares problem of a slice at fixed (m, sigma),
+ * with y = (k-m)/sigma and z = sqrt(y^2+1).
+ */
+struct SVISliceSums
+{
+    double s1, sy, sz, syy, szz, syz;
+    double sw, swy, swz, sww;
+    double w_max;
+};
+
+/**
+ * @param quotes The quotes of the slice.
+ * @param m The raw SVI parameter m.
+ * @param sigma The raw SVI parameter sigma.
+ * @return The weighted sums of the slice.
+ */
+static SVISliceSums accumulate_sums(const SVISliceQuotes& quotes, double m, double sigma)
+{
+    SVISliceSums sums = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    const bool weighted = !quotes.weights.empty();
+    for (std::size_t i = 0; i < quotes.k.size(); ++i)
+    {
+        const double weight = weighted ? quotes.weights[i] : 1.0;
+        const double y = (quotes.k[i] - m)/sigma;
+        const double z = sqrt(y*y + 1);
+        const double w = quotes.w[i];
+        sums.s1 += weight;
+        sums.sy += weight*y;
+        sums.sz += weight*z;
+        sums.syy += weight*y*y;
+        sums.szz += weight*z*z;
+        sums.syz += weight*y*z;
+        sums.sw += weight*w;
+        sums.swy += weight*w*y;
+        sums.swz += weight*w*z;
+        sums.sww += weight*w*w;
+        sums.w_max = std::max(sums.w_max, w);
+    }
+    return sums;
+};
+
+/**
+ * @brief Solves a small dense linear system with Gaussian elimination and partial pivoting.
+ * @param M The row major matrix of size n*n, overwritten.
+ * @param rhs The right hand side of size n, overwritten by the solution.
+ * @param n The size of the system.
+ * @return False if the matrix is singular.
+ */
+static bool solve_linear_system(double* M, double* rhs, int n)
+{
+    for (int col = 0; col < n; ++col)
+    {
+        int pivot = col;
+        for (int row = col+1; row < n; ++row)
+            if (fabs(M[row*n+col]) > fabs(M[pivot*n+col])){pivot = row;}
+        if (fabs(M[pivot*n+col]) < 1e-300){return false;}
+        if (pivot != col)
+        {
+            for (int j = 0; j < n; ++j){std::swap(M[col*n+j], M[pivot*n+j]);}
+            std::swap(rhs[col], rhs[pivot]);
+        }
+        for (int row = col+1; row < n; ++row)
+        {
+            const double factor = M[row*n+col]/M[col*n+col];
+            for (int j = col; j < n; ++j){M[row*n+j] -= factor*M[col*n+j];}
+            rhs[row] -= factor*rhs[col];
+        }
+    }
+    for (int row = n-1; row >= 0; --row)
+    {
+        for (int j = row+1; j < n; ++j){rhs[row] -= M[row*n+j]*rhs[j];}
+        rhs[row] /= M[row*n+row];
+    }
+    return true;
+};
+
+/**
+ * @brief Solves the least squares problem of a slice at fixed (m, sigma) in x = (a, d, c)
+ * under the constraints |d| <= c, |d| <= B*sigma - c and 0 <= a <= max w (B = SVI_WING_BOUND).
+ *
+ * The problem is a convex quadratic program with 6 linear constraints: its minimum is the
+ * best feasible point among the minima of the objective on every set of at most 3 active
+ * constraints, each one given by a small KKT linear system. The unconstrained minimum is
+ * tried first.
+ *
+ * @param sums The weighted sums of the slice.
+ * @param sigma The raw SVI parameter sigma.
+ * @param x The optimal (a, d, c).
+ * @return The optimal weighted sum of squared errors.
+ */
+static double quasi_explicit_fit(const SVISliceSums& sums, double sigma, double x[3])
+{
+    const double A[9] = {sums.s1, sums.sy, sums.sz, sums.sy, sums.syy, sums.syz, sums.sz, sums.syz, sums.szz};
+    const double rhs[3] = {sums.sw, sums.swy, sums.swz};
+    const double normals[6][3] = {{0, 1, -1}, {0, -1, -1}, {0, 1, 1}, {0, -1, 1}, {-1, 0, 0}, {1, 0, 0}};
+    const double bounds[6] = {0, 0, SVI_WING_BOUND*sigma, SVI_WING_BOUND*sigma, 0, sums.w_max};
+    const double feasibility = 1e-12*(sigma + sums.w_max);
+
+    double best = std::numeric_limits<double>::infinity();
+    x[0] = x[1] = x[2] = 0.0;
+    for (int active = 0; active < 64; ++active)
+    {
+        int constraints[6];
+        int n_active = 0;
+        for (int j = 0; j < 6; ++j){if (active & (1<<j)){constraints[n_active++] = j;}}
+        if (n_active > 3){continue;}
+
+        const int n = 3 + n_active;
+        double M[36] = {0};
+        double v[6];
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j){M[i*n+j] = A[i*3+j];}
+            v[i] = rhs[i];
+        }
+        for (int c = 0; c < n_active; ++c)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                M[(3+c)*n+j] = normals[constraints[c]][j];
+                M[j*n+3+c] = normals[constraints[c]][j];
+            }
+            v[3+c] = bounds[constraints[c]];
+        }
+        if (!solve_linear_system(M, v, n)){continue;}
+
+        bool feasible = true;
+        for (int j = 0; j < 6 && feasible; ++j)
+        {
+            const double g = normals[j][0]*v[0] + normals[j][1]*v[1] + normals[j][2]*v[2] - bounds[j];
+            feasible = g <= feasibility;
+        }
+        if (!feasible){continue;}
+
+        double value = sums.sww;
+        for (int i = 0; i < 3; ++i)
+        {
+            value -= 2*rhs[i]*v[i];
+            for (int j = 0; j < 3; ++j){value += v[i]*A[i*3+j]*v[j];}
+        }
+        if (value < best)
+        {
+            best = value;
+            x[0] = v[0]; x[1] = v[1]; x[2] = v[2];
+        }
+        if (active == 0){break;}
+    }
+    return std::max(best, 0.0);
+};
+
+/**
+ * @brief Translates the solution of the quasi-explicit problem into raw SVI parameters.
+ * @param x The optimal (a, d, c).
+ * @param m The raw SVI parameter m.
+ * @param sigma The raw SVI parameter sigma.
+ * @return The raw SVI parameters.
+ */
+static SVIRawParameters to_raw_parameters(const double x[3], double m, double sigma)
+{
+    const double b = x[2]/sigma;
+    const double rho = x[2] > 0 ? std::max(-1.0, std::min(1.0, x[1]/x[2])) : 0.0;
+    return SVIRawParameters{x[0], b, rho, m, sigma};
+};
+
+/**
+ * @brief Checks the quotes of a slice.
+ * @param quotes The quotes of the slice.
+ * @throw SVICalibrationWrongQuotes
+ * @throw SVICalibrationNotEnoughQuotes
+ */
+static void check_slice_quotes(const SVISliceQuotes& quotes)
+{
+    if (!(quotes.t>0) || quotes.k.size()!=quotes.w.size()){throw SVICalibrationWrongQuotes();}
+    if (!quotes.weights.empty() && quotes.weights.size()!=quotes.k.size()){throw SVICalibrationWrongQuotes();}
+    if (quotes.k.size() < SVI_MIN_QUOTES){throw SVICalibrationNotEnoughQuotes();}
+};
+
+/**
+ * @param quotes The quotes of the slice.
+ * @return The sum of the weights of the slice.
+ */
+static double total_weight(const SVISliceQuotes& quotes)
+{
+    if (quotes.weights.empty()){return quotes.k.size();}
+    double total = 0.0;
+    for (double weight : quotes.weights){total += weight;}
+    return total;
+};
+
+/**
+ * @struct SVICalibrator
+ * @brief The two stage SVI/SSVI calibrator, remembering its last report for warm starts.
+ */
+
+ /**
+ * @var std::shared_ptr<ThreadPool> SVICalibrator::pool_
+ * @brief The thread pool fitting the slices, the slices are fitted sequentially if null.
+ */
+
+ /**
+ * @var NelderMead SVICalibrator::slice_minimizer_
+ * @brief The minimizer of the stage one (m, sigma) problems.
+ */
+
+ /**
+ * @var NelderMead SVICalibrator::ssvi_minimizer_
+ * @brief The minimizer of the stage two (rho, nu, gamma) problem.
+ */
+
+ /**
+ * @var double SVICalibrator::warm_start_max_dt_
+ * @brief The maximal year fraction difference between a slice and a previous slice to warm start from it.
+ */
+
+ /**
+ * @var bool SVICalibrator::has_previous_
+ * @brief True if a previous report is available for warm starts.
+ */
+
+ /**
+ * @var SVICalibrationReport SVICalibrator::previous_
+ * @brief The report of the last call of SVICalibrator::calibrate.
+ */
+
+/**
+ * @brief The standard constructor, the parameter tolerance is set to 1e-7, the maximal number
+ * of Nelder-Mead iterations to 500 and the warm start year fraction window to one day.
+ * @param pool The thread pool fitting the slices (can be null).
+ */
+SVICalibrator::SVICalibrator(std::shared_ptr<ThreadPool> pool):
+    SVICalibrator(pool, 1e-7, 500, 1.0/365){};
+
+/**
+ * @brief The main constructor.
+ * @param pool The thread pool fitting the slices (can be null).
+ * @param tolerance The tolerance on the parameters, the tolerance on the squared errors is its square.
+ * @param max_iterations The maximal number of Nelder-Mead iterations of each fit.
+ * @param warm_start_max_dt The maximal year fraction difference to warm start a slice from a previous one.
+ */
+SVICalibrator::SVICalibrator(
+    std::shared_ptr<ThreadPool> pool, double tolerance, int max_iterations, double warm_start_max_dt):
+    pool_(pool),
+    slice_minimizer_(tolerance, tolerance*tolerance, max_iterations),
+    ssvi_minimizer_(tolerance, tolerance*tolerance, max_iterations),
+    warm_start_max_dt_(warm_start_max_dt),
+    has_previous_(false){};
+
+/**
+ * @brief Forgets the previous report, the next calibration is a cold start.
+ */
+void SVICalibrator::reset()
+{
+    has_previous_ = false;
+    previous_ = SVICalibrationReport();
+};
+
+/**
+ * @brief Fits a raw SVI slice (stage one).
+ * @param quotes The quotes of the slice.
+ * @param warm_start A previous fit to start from, or null for a cold start. The fit is cold
+ * started as well if the objective is not finite at the previous fit.
+ * @return The fit of the slice.
+ * @throw SVICalibrationWrongQuotes
+ * @throw SVICalibrationNotEnoughQuotes
+ */
+SVISliceFit SVICalibrator::fit_slice(const SVISliceQuotes& quotes, const SVISliceFit* warm_start)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_CALIBRATION);
+    const auto start = std::chrono::steady_clock::now();
+    check_slice_quotes(quotes);
+
+    auto objective = [&quotes](const std::vector<double>& v)
+    {
+        const double m = v[0];
+        const double sigma = v[1];
+        if (!(sigma > SVI_MIN_SIGMA)){return std::numeric_limits<double>::infinity();}
+        const SVISliceSums sums = accumulate_sums(quotes, m, sigma);
+        double x[3];
+        const double value = quasi_explicit_fit(sums, sigma, x);
+        const SVIRawParameters raw = to_raw_parameters(x, m, sigma);
+        const double atm = raw.a + raw.b*(-raw.rho*m + sqrt(m*m + sigma*sigma));
+        if (!(atm > 0)){return std::numeric_limits<double>::infinity();}
+        const double excess = 2*raw.b*raw.b*(1 + fabs(raw.rho))/atm - 2;
+        return excess > 0 ? value + excess*excess*sums.sww : value;
+    };
+
+    std::vector<double> x0(2), step(2);
+    const bool warm = warm_start && std::isfinite(objective({warm_start->raw.m, warm_start->raw.sigma}));
+    if (warm)
+    {
+        x0[0] = warm_start->raw.m;
+        x0[1] = warm_start->raw.sigma;
+        step[0] = step[1] = SVI_WARM_START_STEP*slice_minimizer_.x_tolerance_;
+    }
+    else
+    {
+        const std::size_t i_min = std::min_element(quotes.w.begin(), quotes.w.end()) - quotes.w.begin();
+        x0[0] = quotes.k[i_min];
+        x0[1] = SVI_COLD_START_STEP;
+        step[0] = step[1] = .5*SVI_COLD_START_STEP;
+    }
+    const NelderMeadResult result = slice_minimizer_.minimize(objective, x0, step);
+
+    const SVISliceSums sums = accumulate_sums(quotes, result.x[0], result.x[1]);
+    double x[3];
+    const double value = quasi_explicit_fit(sums, result.x[1], x);
+
+    SVISliceFit fit;
+    fit.t = quotes.t;
+    fit.raw = to_raw_parameters(x, result.x[0], result.x[1]);
+    fit.rmse = sqrt(value/total_weight(quotes));
+    fit.iterations = result.iterations;
+    fit.converged = result.converged;
+    fit.warm_started = warm;
+    ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_CALIBRATION_ITERATIONS, result.iterations);
+    try{fit.butterfly_arbitrage_free = fit.get_svi().butterfly_arbitrage_check();}
+    catch (SVIWrongParameterValue&){fit.butterfly_arbitrage_free = false;}
+    fit.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return fit;
+};
+
+/**
+ * @brief Fits the power law SSVI on all the quotes (stage two). The ATM total variance of
+ * each expiry is the one of its stage one slice.
+ * @param quotes The quotes of every slice.
+ * @param slices The stage one fits, in the same order as the quotes.
+ * @param warm_start A previous fit to start from, or null for a cold start. The fit is cold
+ * started as well if the objective is not finite at the previous fit.
+ * @return The fit of the SSVI.
+ * @throw SVICalibrationWrongQuotes
+ */
+SSVIFit SVICalibrator::fit_ssvi(
+    const std::vector<SVISliceQuotes>& quotes,
+    const std::vector<SVISliceFit>& slices,
+    const SSVIFit* warm_start)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_CALIBRATION);
+    const auto start = std::chrono::steady_clock::now();
+    if (quotes.size()!=slices.size() || quotes.empty()){throw SVICalibrationWrongQuotes();}
+    std::vector<double> thetas(slices.size());
+    double weight_sum = 0.0;
+    double rho_mean = 0.0;
+    for (std::size_t i = 0; i < slices.size(); ++i)
+    {
+        SVISliceFit slice = slices[i];
+        thetas[i] = slice.atm_total_variance();
+        rho_mean += slice.raw.rho/slices.size();
+        weight_sum += total_weight(quotes[i]);
+    }
+
+    auto objective = [&quotes, &thetas](const std::vector<double>& v)
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        if (!(fabs(v[0]) < 1) || !(v[1] > 0) || !(v[2] >= 0 && v[2] <= 1)){return inf;}
+        SSVI ssvi(v[0], v[1], v[2]);
+        double value = 0.0;
+        for (std::size_t i = 0; i < quotes.size(); ++i)
+        {
+            const double theta = thetas[i];
+            if (!(theta > 0)){continue;}
+            if (!ssvi.butterfly_arbitrage_check(theta) || !ssvi.calendar_spread_arbitrage_check(theta)){return inf;}
+            const SVISliceQuotes& slice = quotes[i];
+            const bool weighted = !slice.weights.empty();
+            for (std::size_t j = 0; j < slice.k.size(); ++j)
+            {
+                const double error = ssvi.total_variance(slice.k[j], theta) - slice.w[j];
+                value += (weighted ? slice.weights[j] : 1.0)*error*error;
+            }
+        }
+        return value;
+    };
+
+    std::vector<double> x0(3), step(3);
+    const bool warm = warm_start && std::isfinite(objective({warm_start->rho, warm_start->nu, warm_start->gamma}));
+    if (warm)
+    {
+        x0 = {warm_start->rho, warm_start->nu, warm_start->gamma};
+        step = {SSVI_WARM_START_STEP, SSVI_WARM_START_STEP*x0[1], SSVI_WARM_START_STEP};
+    }
+    else
+    {
+        x0 = {std::max(-.9, std::min(.9, rho_mean)), 1.0, .5};
+        for (int i = 0; i < 40 && !std::isfinite(objective(x0)); ++i){x0[1] *= .5;}
+        step = {SVI_COLD_START_STEP, SVI_COLD_START_STEP*x0[1], SVI_COLD_START_STEP};
+    }
+    const NelderMeadResult result = ssvi_minimizer_.minimize(objective, x0, step);
+
+    SSVIFit fit;
+    fit.rho = result.x[0];
+    fit.nu = result.x[1];
+    fit.gamma = result.x[2];
+    fit.rmse = sqrt(result.value/weight_sum);
+    fit.iterations = result.iterations;
+    fit.converged = result.converged;
+    fit.warm_started = warm;
+    fit.arbitrage_free = std::isfinite(result.value);
+    ARBITRAGE_INSTRUMENT_COUNT(INSTRUMENTATION_CALIBRATION_ITERATIONS, result.iterations);
+    fit.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return fit;
+};
+
+/**
+ * @brief Calibrates the slices in parallel, checks the calendar spread arbitrage between
+ * consecutive slices, then calibrates the SSVI. Each slice is warm started from the previous
+ * slice with the closest year fraction (within warm_start_max_dt_), the SSVI from the previous SSVI.
+ * @param quotes The quotes of every slice, sorted by increasing year fraction.
+ * @return The calibration report, kept for the warm start of the next call.
+ * @throw SVICalibrationWrongQuotes
+ * @throw SVICalibrationNotEnoughQuotes
+ */
+SVICalibrationReport SVICalibrator::calibrate(const std::vector<SVISliceQuotes>& quotes)
+{
+    const auto start = std::chrono::steady_clock::now();
+    if (quotes.empty()){throw SVICalibrationWrongQuotes();}
+    for (std::size_t i = 0; i < quotes.size(); ++i)
+    {
+        check_slice_quotes(quotes[i]);
+        if (i>0 && !(quotes[i].t > quotes[i-1].t)){throw SVICalibrationWrongQuotes();}
+    }
+
+    std::vector<const SVISliceFit*> warm_starts(quotes.size(), nullptr);
+    if (has_previous_)
+    {
+        for (std::size_t i = 0; i < quotes.size(); ++i)
+        {
+            double best_dt = warm_start_max_dt_;
+            for (const SVISliceFit& slice : previous_.slices)
+            {
+                const double dt = fabs(slice.t - quotes[i].t);
+                if (dt <= best_dt){best_dt = dt; warm_starts[i] = &slice;}
+            }
+        }
+    }
+
+    SVICalibrationReport report;
+    report.slices.resize(quotes.size());
+    auto fit = [this, &quotes, &warm_starts, &report](std::size_t i)
+    {
+        report.slices[i] = fit_slice(quotes[i], warm_starts[i]);
+    };
+    if (pool_){pool_->parallel_for(quotes.size(), fit);}
+    else{for (std::size_t i = 0; i < quotes.size(); ++i){fit(i);}}
+
+    report.calendar_arbitrage_free.resize(quotes.size()-1);
+    for (std::size_t i = 0; i+1 < quotes.size(); ++i)
+    {
+        try{report.calendar_arbitrage_free[i] =
+            report.slices[i].get_svi().calendar_spread_arbitrage_check(report.slices[i+1].get_svi());}
+        catch (SVIWrongParameterValue&){report.calendar_arbitrage_free[i] = false;}
+    }
+
+    report.ssvi = fit_ssvi(quotes, report.slices, has_previous_ ? &previous_.ssvi : nullptr);
+    report.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    previous_ = report;
+    has_previous_ = true;
+    return report;
+};
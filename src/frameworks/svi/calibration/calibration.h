@@ -0,0 +1,98 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+#include "../../../frameworks/svi/svi.h"
+#include "../../../math/optimization/neldermead/neldermead.h"
+#include "../../../parallel/threadpool/threadpool.h"
+#include "../../../instrumentation/instrumentation.h"
+
+class SVICalibrationWrongQuotes:  public std::exception
+{public: const char * what() const throw();};
+
+class SVICalibrationNotEnoughQuotes:  public std::exception
+{public: const char * what() const throw();};
+
+struct SVISliceQuotes
+{
+    double t;
+    std::vector<double> k;
+    std::vector<double> w;
+    std::vector<double> weights;
+};
+
+struct SVIRawParameters
+{
+    double a;
+    double b;
+    double rho;
+    double m;
+    double sigma;
+};
+
+struct SVISliceFit
+{
+    double t;
+    SVIRawParameters raw;
+    double rmse;
+    int iterations;
+    double elapsed_us;
+    bool converged;
+    bool warm_started;
+    bool butterfly_arbitrage_free;
+    double total_variance(double k);
+    double atm_total_variance();
+    SVI get_svi();
+};
+
+struct SSVIFit
+{
+    double rho;
+    double nu;
+    double gamma;
+    double rmse;
+    int iterations;
+    double elapsed_us;
+    bool converged;
+    bool warm_started;
+    bool arbitrage_free;
+    SSVI get_ssvi();
+};
+
+struct SVICalibrationReport
+{
+    std::vector<SVISliceFit> slices;
+    std::vector<bool> calendar_arbitrage_free;
+    SSVIFit ssvi;
+    double elapsed_us;
+};
+
+struct SVICalibrator
+{
+    std::shared_ptr<ThreadPool> pool_;
+    NelderMead slice_minimizer_;
+    NelderMead ssvi_minimizer_;
+    double warm_start_max_dt_;
+    bool has_previous_;
+    SVICalibrationReport previous_;
+    SVICalibrator(std::shared_ptr<ThreadPool> pool);
+    SVICalibrator(
+        std::shared_ptr<ThreadPool> pool,
+        double tolerance,
+        int max_iterations,
+        double warm_start_max_dt
+    );
+    ~SVICalibrator(){};
+    SVISliceFit fit_slice(const SVISliceQuotes& quotes, const SVISliceFit* warm_start);
+    SSVIFit fit_ssvi(
+        const std::vector<SVISliceQuotes>& quotes,
+        const std::vector<SVISliceFit>& slices,
+        const SSVIFit* warm_start
+    );
+    SVICalibrationReport calibrate(const std::vector<SVISliceQuotes>& quotes);
+    void reset();
+};
@@ -0,0 +1,520 @@
+#include "sensitivities.h"
+
+/**
+* @file sensitivities.h
+* @brief This file defines the adjoint (AAD) sensitivities of an option book to the parameters of
+* the SVI slices or of the SSVI surface of its underlying.
+*
+* Each leg is priced as SVI::implied_volatility (or SSVI::implied_volatility) followed by
+* BlackScholesClosedForm::price, with the same expressions in the same order written as
+* templates of the number type, and weighted by its StructuredOption weight times the quantity
+* of the structure. SVIAdjointBook::price and SVIAdjointBook::price_ssvi evaluate them with
+* doubles, and match the scalar classes. SVIAdjointBook::compute and SVIAdjointBook::compute_ssvi
+* record them on an AdjointTape and sweep it back: the derivatives of the whole book with
+* respect to the raw parameters (a, b, rho, m, sigma) of every slice, or to (rho, nu, gamma) and
+* the ATM total variance of every slice, come out of one pass, where bumping and repricing would
+* cost one revaluation of the book per parameter.
+*
+* The parameters are recorded first. Every leg is then recorded, swept and rewound on its own,
+* about 40 nodes, so that the tape stays in the cache whatever the size of the book; the shared
+* nodes (the power law of each SSVI slice) are swept last.
+*
+* References :
+* - "Arbitrage-free SVI volatility surfaces", Gatheral, Jacquier, 2014.
+* - "Smoking adjoints: fast Monte Carlo Greeks", Giles, Glasserman, 2006.
+* - "Modern Computational Finance: AAD and Parallel Simulations", Savine, 2018.
+*/
+
+/**
+ * @brief The number of raw parameters of a slice, recorded in the order a, b, rho, m, sigma.
+ */
+static const std::uint32_t SVI_ADJOINT_RAW_PARAMETERS = 5;
+
+/**
+ * @class SVIAdjointUnknownExpiry
+ * @brief Definition of the error when the expiry of a leg is not one of the slices.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SVIAdjointUnknownExpiry::what() const throw(){
+    return "The expiry of the option is not one of the slices of the book.";
+};
+
+/**
+ * @class SVIAdjointUnsupportedLeg
+ * @brief Definition of the error when a leg is not a european option.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SVIAdjointUnsupportedLeg::what() const throw(){
+    return "The adjoint sensitivities only support european options.";
+};
+
+/**
+ * @class SVIAdjointMissingSSVI
+ * @brief Definition of the error when the SSVI sensitivities are computed without a SSVI.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SVIAdjointMissingSSVI::what() const throw(){
+    return "The SSVI of the book must be set before computing its sensitivities.";
+};
+
+/**
+ * @fn V svi_adjoint_total_variance(const V& a, const V& b, const V& rho, const V& m, const V& sigma, const double k)
+ * @brief The raw SVI total variance, as SVI::total_variance.
+ * @param a The raw parameter a.
+ * @param b The raw parameter b.
+ * @param rho The raw parameter rho.
+ * @param m The raw parameter m.
+ * @param sigma The raw parameter sigma.
+ * @param k The log moneyness.
+ * @return The total variance.
+ */
+
+/**
+ * @fn V ssvi_adjoint_total_variance(const V& rho, const V& phi, const V& theta, const double k)
+ * @brief The SSVI total variance, as SSVI::total_variance.
+ * @param rho The parameter rho.
+ * @param phi The power law parametrization of the slice, SSVI::prmtrzt.
+ * @param theta The ATM total variance of the slice.
+ * @param k The log moneyness.
+ * @return The total variance.
+ */
+
+/**
+ * @fn V black_scholes_adjoint_price(const double S, const double K, const double r, const double q, const V& sigma, const double T, const bool is_call, const bool is_future)
+ * @brief The european vanilla price, as BlackScholesClosedForm::price.
+ * @param S The spot/future price of the underlying.
+ * @param K The strike price of the option.
+ * @param r The interest rate.
+ * @param q The carry cost rate.
+ * @param sigma The implied volatility.
+ * @param T The year fraction.
+ * @param is_call True for a call.
+ * @param is_future True if the underlying is a future.
+ * @return The price.
+ */
+
+/**
+ * @struct SVIAdjointSliceRisk
+ * @brief The derivatives of the book with respect to the raw parameters of a slice.
+ */
+
+/**
+ * @struct SVIAdjointResult
+ * @brief The price of the book and its derivatives: the slices for SVIAdjointBook::compute,
+ * the SSVI parameters and the ATM total variances for SVIAdjointBook::compute_ssvi, the others
+ * stay zero or empty. n_bad_legs counts the legs skipped for a non positive year fraction or
+ * total variance, tape_size the largest number of nodes of the tape.
+ */
+
+/**
+ * @struct SVIAdjointBook
+ * @brief The book of european options on one underlying, and the slices of its volatility surface.
+ */
+
+/**
+ * @var std::vector<Timestamp> SVIAdjointBook::expiries_
+ * @brief The expiries of the slices, the legs are mapped to the slice of their expiry.
+ */
+
+/**
+ * @var std::vector<double> SVIAdjointBook::t_
+ * @brief The year fractions of the slices, the T of their implied volatilities.
+ */
+
+/**
+ * @var std::vector<SVIRawParameters> SVIAdjointBook::raw_
+ * @brief The raw SVI parameters of the slices.
+ */
+
+/**
+ * @var std::vector<double> SVIAdjointBook::atm_total_variances_
+ * @brief The ATM total variances of the slices, the thetas of the SSVI.
+ */
+
+/**
+ * @var std::vector<double> SVIAdjointBook::leg_k_
+ * @brief The log moneyness log(K/F) of the legs, with the forward of their year fraction.
+ */
+
+/**
+ * @var std::vector<double> SVIAdjointBook::leg_weights_
+ * @brief The weights of the legs in the structures times the quantities of the structures.
+ */
+
+/**
+ * @var std::vector<AdjointDouble> SVIAdjointBook::phis_
+ * @brief The scratch power law nodes of the slices, for SVIAdjointBook::compute_ssvi.
+ */
+
+/**
+ * @brief The constructor.
+ * @param reference_timestamp The pricing timestamp.
+ * @param S The spot/future price of the underlying.
+ * @param r The interest rate.
+ * @param q The carry cost rate.
+ * @param is_future True if the underlying is a future.
+ */
+SVIAdjointBook::SVIAdjointBook(
+    const Timestamp reference_timestamp, const double S, const double r, const double q, const bool is_future):
+    reference_timestamp_(reference_timestamp), S_(S), r_(r), q_(q), is_future_(is_future),
+    has_ssvi_(false), ssvi_rho_(0.0), ssvi_nu_(0.0), ssvi_gamma_(0.0){};
+
+/**
+ * @brief Gets the raw parameters of a SVI.
+ * @param svi The SVI.
+ * @return Its raw parameters.
+ */
+static SVIRawParameters get_raw_parameters(const SVI& svi)
+{
+    return {svi.a, svi.b, svi.p, svi.m, svi.s};
+};
+
+/**
+ * @brief Gets the ATM total variance of raw parameters.
+ * @param raw The raw parameters.
+ * @return The total variance at k = 0.
+ */
+static double get_atm_total_variance(const SVIRawParameters& raw)
+{
+    return svi_adjoint_total_variance(raw.a, raw.b, raw.rho, raw.m, raw.sigma, 0.0);
+};
+
+/**
+ * @brief Adds a slice.
+ * @param expiry The expiry of the slice.
+ * @param svi The SVI of the slice, its year fraction is the one of the slice.
+ * @return The index of the slice.
+ */
+std::size_t SVIAdjointBook::add_slice(const Timestamp expiry, const SVI& svi)
+{
+    expiries_.push_back(expiry);
+    t_.push_back(svi.T_);
+    raw_.push_back(get_raw_parameters(svi));
+    atm_total_variances_.push_back(get_atm_total_variance(raw_.back()));
+    return expiries_.size() - 1;
+};
+
+/**
+ * @brief Adds a calibrated slice.
+ * @param expiry The expiry of the slice.
+ * @param fit The stage one fit of the slice.
+ * @return The index of the slice.
+ */
+std::size_t SVIAdjointBook::add_slice(const Timestamp expiry, SVISliceFit fit)
+{
+    expiries_.push_back(expiry);
+    t_.push_back(fit.t);
+    raw_.push_back(fit.raw);
+    atm_total_variances_.push_back(fit.atm_total_variance());
+    return expiries_.size() - 1;
+};
+
+/**
+ * @brief Replaces the SVI of a slice, and its ATM total variance.
+ * @param i The index of the slice.
+ * @param svi The SVI.
+ */
+void SVIAdjointBook::set_slice(const std::size_t i, const SVI& svi)
+{
+    t_[i] = svi.T_;
+    raw_[i] = get_raw_parameters(svi);
+    atm_total_variances_[i] = get_atm_total_variance(raw_[i]);
+};
+
+/**
+ * @brief Replaces the SVI of a slice by a new fit, and its ATM total variance.
+ * @param i The index of the slice.
+ * @param fit The stage one fit of the slice.
+ */
+void SVIAdjointBook::set_slice(const std::size_t i, SVISliceFit fit)
+{
+    t_[i] = fit.t;
+    raw_[i] = fit.raw;
+    atm_total_variances_[i] = fit.atm_total_variance();
+};
+
+/**
+ * @brief Sets the SSVI of the surface, its thetas are the ATM total variances of the slices.
+ * @param ssvi The SSVI.
+ */
+void SVIAdjointBook::set_ssvi(const SSVI& ssvi)
+{
+    ssvi_rho_ = ssvi.rho_;
+    ssvi_nu_ = ssvi.nu_;
+    ssvi_gamma_ = ssvi.gamma_;
+    has_ssvi_ = true;
+};
+
+/**
+ * @brief Sets the ATM total variance of a slice, the theta of the SSVI.
+ * @param i The index of the slice.
+ * @param atm_total_variance The ATM total variance.
+ */
+void SVIAdjointBook::set_atm_total_variance(const std::size_t i, const double atm_total_variance)
+{
+    atm_total_variances_[i] = atm_total_variance;
+};
+
+/**
+ * @brief Sets the market of the underlying, the log moneyness of the legs are updated.
+ * @param S The spot/future price of the underlying.
+ * @param r The interest rate.
+ * @param q The carry cost rate.
+ */
+void SVIAdjointBook::set_market(const double S, const double r, const double q)
+{
+    S_ = S;
+    r_ = r;
+    q_ = q;
+    update_legs();
+};
+
+/**
+ * @brief Sets the pricing timestamp, the year fractions of the legs are updated.
+ * @param reference_timestamp The pricing timestamp.
+ */
+void SVIAdjointBook::set_reference_timestamp(const Timestamp reference_timestamp)
+{
+    reference_timestamp_ = reference_timestamp;
+    update_legs();
+};
+
+/**
+ * @brief Finds the slice of an expiry.
+ * @param expiry The expiry.
+ * @return The index of the slice.
+ * @throw SVIAdjointUnknownExpiry
+ */
+std::size_t SVIAdjointBook::find_slice(const Timestamp expiry) const
+{
+    for (std::size_t i = 0; i < expiries_.size(); ++i)
+    {
+        if (expiries_[i] == expiry){return i;}
+    }
+    throw SVIAdjointUnknownExpiry();
+};
+
+/**
+ * @brief Adds an option position to the book, as a structure of one leg of unit weight.
+ * @param option The option.
+ * @param quantity The quantity held.
+ * @return The number of legs of the book.
+ * @throw SVIAdjointUnsupportedLeg if the option is not european.
+ * @throw SVIAdjointUnknownExpiry
+ */
+std::size_t SVIAdjointBook::add_option(const std::shared_ptr<Option> option, const double quantity)
+{
+    if (option->get_instrument_tag() != INSTRUMENT_EUROPEAN_VANILLA_OPTION){throw SVIAdjointUnsupportedLeg();}
+    const std::size_t slice = find_slice(option->get_expiry_timestamp());
+    legs_.push_back(option);
+    leg_slices_.push_back(slice);
+    leg_K_.push_back(option->get_strike());
+    leg_is_call_.push_back(option->get_option_type() == CALL ? 1 : 0);
+    leg_weights_.push_back(quantity);
+    leg_T_.push_back(0.0);
+    leg_k_.push_back(0.0);
+    update_legs();
+    return legs_.size();
+};
+
+/**
+ * @brief Adds a structured option position to the book, one leg per option of the structure.
+ * @param structure The structured option.
+ * @param quantity The quantity held.
+ * @return The number of legs of the book.
+ * @throw SVIAdjointUnsupportedLeg if a leg is not european, the book is then left unchanged.
+ * @throw SVIAdjointUnknownExpiry if the expiry of a leg is not a slice, the book is then left unchanged.
+ */
+std::size_t SVIAdjointBook::add_structured_option(const std::shared_ptr<StructuredOption> structure, const double quantity)
+{
+    const std::vector<std::shared_ptr<Option>> options = structure->get_options();
+    const std::vector<double> weights = structure->get_weights();
+    for (const std::shared_ptr<Option>& option : options)
+    {
+        if (option->get_instrument_tag() != INSTRUMENT_EUROPEAN_VANILLA_OPTION){throw SVIAdjointUnsupportedLeg();}
+        find_slice(option->get_expiry_timestamp());
+    }
+    for (std::size_t i = 0; i < options.size(); ++i){add_option(options[i], quantity*weights[i]);}
+    return legs_.size();
+};
+
+/**
+ * @return The number of legs of the book.
+ */
+std::size_t SVIAdjointBook::get_number_legs() const
+{
+    return legs_.size();
+};
+
+/**
+ * @brief Recomputes the year fractions and the log moneyness of the legs.
+ */
+void SVIAdjointBook::update_legs()
+{
+    const double future_flag = is_future_ ? 0 : 1;
+    for (std::size_t j = 0; j < legs_.size(); ++j)
+    {
+        leg_T_[j] = legs_[j]->get_year_fraction(reference_timestamp_);
+        const double F = S_*exp(future_flag*(r_-q_)*leg_T_[j]);
+        leg_k_[j] = log(leg_K_[j]/F);
+    }
+};
+
+/**
+ * @brief Prices the book with the SVI of the slices, without recording anything.
+ * @return The price of the book, the legs with a non positive year fraction or total variance
+ * are skipped.
+ */
+double SVIAdjointBook::price()
+{
+    double value = 0.0;
+    for (std::size_t j = 0; j < legs_.size(); ++j)
+    {
+        const SVIRawParameters& p = raw_[leg_slices_[j]];
+        const double w = svi_adjoint_total_variance(p.a, p.b, p.rho, p.m, p.sigma, leg_k_[j]);
+        if (!(w > 0) || !(leg_T_[j] > 0)){continue;}
+        const double sigma = sqrt(w/t_[leg_slices_[j]]);
+        value += leg_weights_[j]*black_scholes_adjoint_price(S_, leg_K_[j], r_, q_, sigma, leg_T_[j], leg_is_call_[j], is_future_);
+    }
+    return value;
+};
+
+/**
+ * @brief Prices the book with the SSVI, without recording anything.
+ * @return The price of the book, the legs with a non positive year fraction or total variance
+ * are skipped.
+ * @throw SVIAdjointMissingSSVI
+ */
+double SVIAdjointBook::price_ssvi()
+{
+    if (!has_ssvi_){throw SVIAdjointMissingSSVI();}
+    double value = 0.0;
+    for (std::size_t j = 0; j < legs_.size(); ++j)
+    {
+        const std::size_t s = leg_slices_[j];
+        const double theta = atm_total_variances_[s];
+        const double phi = ssvi_nu_*pow(theta, -ssvi_gamma_);
+        const double w = ssvi_adjoint_total_variance(ssvi_rho_, phi, theta, leg_k_[j]);
+        if (!(w > 0) || !(leg_T_[j] > 0)){continue;}
+        const double sigma = sqrt(w/t_[s]);
+        value += leg_weights_[j]*black_scholes_adjoint_price(S_, leg_K_[j], r_, q_, sigma, leg_T_[j], leg_is_call_[j], is_future_);
+    }
+    return value;
+};
+
+/**
+ * @brief Prices a leg on the tape from its total variance, then sweeps and rewinds it.
+ * @param book The book.
+ * @param j The index of the leg.
+ * @param w The total variance of the leg.
+ * @param begin The first node of the leg.
+ * @param result The result, whose price, bad legs and tape size are updated.
+ */
+static void sweep_leg(SVIAdjointBook& book, const std::size_t j, const AdjointDouble& w, const std::size_t begin, SVIAdjointResult& result)
+{
+    if (!(w.value > 0) || !(book.leg_T_[j] > 0))
+    {
+        result.n_bad_legs++;
+        book.tape_.rewind(begin);
+        return;
+    }
+    const AdjointDouble sigma = sqrt(w/book.t_[book.leg_slices_[j]]);
+    const AdjointDouble price = black_scholes_adjoint_price(
+        book.S_, book.leg_K_[j], book.r_, book.q_, sigma, book.leg_T_[j], book.leg_is_call_[j], book.is_future_);
+    result.price += book.leg_weights_[j]*price.value;
+    result.tape_size = std::max(result.tape_size, book.tape_.size());
+    book.tape_.seed(price, book.leg_weights_[j]);
+    book.tape_.reverse(begin);
+    book.tape_.rewind(begin);
+};
+
+/**
+ * @brief Prices the book with the SVI of the slices and computes its derivatives with respect
+ * to their raw parameters, in one adjoint pass.
+ * @return The price and the derivatives of every slice.
+ * @throw AdjointTapeFull
+ */
+SVIAdjointResult SVIAdjointBook::compute()
+{
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t n_slices = raw_.size();
+    SVIAdjointResult result = {0.0, std::vector<SVIAdjointSliceRisk>(n_slices), 0.0, 0.0, 0.0, {}, 0, 0, 0.0};
+    tape_.clear();
+    for (const SVIRawParameters& p : raw_)
+    {
+        tape_.variable(p.a);
+        tape_.variable(p.b);
+        tape_.variable(p.rho);
+        tape_.variable(p.m);
+        tape_.variable(p.sigma);
+    }
+    const std::size_t begin = tape_.size();
+    for (std::size_t j = 0; j < legs_.size(); ++j)
+    {
+        const SVIRawParameters& p = raw_[leg_slices_[j]];
+        const std::uint32_t base = static_cast<std::uint32_t>(SVI_ADJOINT_RAW_PARAMETERS*leg_slices_[j]);
+        const AdjointDouble w = svi_adjoint_total_variance(
+            AdjointDouble{p.a, base, &tape_}, AdjointDouble{p.b, base+1, &tape_}, AdjointDouble{p.rho, base+2, &tape_},
+            AdjointDouble{p.m, base+3, &tape_}, AdjointDouble{p.sigma, base+4, &tape_}, leg_k_[j]);
+        sweep_leg(*this, j, w, begin, result);
+    }
+    for (std::size_t s = 0; s < n_slices; ++s)
+    {
+        const double* adjoint = tape_.adjoints.data() + SVI_ADJOINT_RAW_PARAMETERS*s;
+        result.slices[s] = {adjoint[0], adjoint[1], adjoint[2], adjoint[3], adjoint[4]};
+    }
+    result.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return result;
+};
+
+/**
+ * @brief Prices the book with the SSVI and computes its derivatives with respect to rho, nu,
+ * gamma and the ATM total variance of every slice, in one adjoint pass.
+ * @return The price and the derivatives.
+ * @throw SVIAdjointMissingSSVI
+ * @throw AdjointTapeFull
+ */
+SVIAdjointResult SVIAdjointBook::compute_ssvi()
+{
+    if (!has_ssvi_){throw SVIAdjointMissingSSVI();}
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t n_slices = atm_total_variances_.size();
+    SVIAdjointResult result = {0.0, {}, 0.0, 0.0, 0.0, std::vector<double>(n_slices), 0, 0, 0.0};
+    tape_.clear();
+    const AdjointDouble rho = tape_.variable(ssvi_rho_);
+    const AdjointDouble nu = tape_.variable(ssvi_nu_);
+    const AdjointDouble gamma = tape_.variable(ssvi_gamma_);
+    const std::uint32_t theta_base = static_cast<std::uint32_t>(tape_.size());
+    for (const double theta : atm_total_variances_){tape_.variable(theta);}
+    const AdjointDouble minus_gamma = -gamma;
+    phis_.clear();
+    for (std::size_t s = 0; s < n_slices; ++s)
+    {
+        const AdjointDouble theta{atm_total_variances_[s], static_cast<std::uint32_t>(theta_base + s), &tape_};
+        phis_.push_back(nu*pow(theta, minus_gamma));
+    }
+    const std::size_t begin = tape_.size();
+    for (std::size_t j = 0; j < legs_.size(); ++j)
+    {
+        const std::size_t s = leg_slices_[j];
+        const AdjointDouble theta{atm_total_variances_[s], static_cast<std::uint32_t>(theta_base + s), &tape_};
+        const AdjointDouble w = ssvi_adjoint_total_variance(rho, phis_[s], theta, leg_k_[j]);
+        sweep_leg(*this, j, w, begin, result);
+    }
+    tape_.reverse(0);
+    result.ssvi_rho = tape_.get_adjoint(rho);
+    result.ssvi_nu = tape_.get_adjoint(nu);
+    result.ssvi_gamma = tape_.get_adjoint(gamma);
+    for (std::size_t s = 0; s < n_slices; ++s){result.atm_total_variances[s] = tape_.adjoints[theta_base + s];}
+    result.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return result;
+};
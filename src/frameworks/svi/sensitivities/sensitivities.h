@@ -0,0 +1,121 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <chrono>
+#include "../../../frameworks/svi/svi.h"
+#include "../../../frameworks/svi/calibration/calibration.h"
+#include "../../../math/adjoint/adjoint.h"
+#include "../../../datastructure/datetime/datetime.h"
+#include "../../../datastructure/market/instruments/options/options.h"
+
+class SVIAdjointUnknownExpiry:  public std::exception
+{public: const char * what() const throw();};
+
+class SVIAdjointUnsupportedLeg:  public std::exception
+{public: const char * what() const throw();};
+
+class SVIAdjointMissingSSVI:  public std::exception
+{public: const char * what() const throw();};
+
+template <typename V>
+V svi_adjoint_total_variance(const V& a, const V& b, const V& rho, const V& m, const V& sigma, const double k)
+{
+    const V x = k - m;
+    return a + b*(rho*x + sqrt(x*x + sigma*sigma));
+};
+
+template <typename V>
+V ssvi_adjoint_total_variance(const V& rho, const V& phi, const V& theta, const double k)
+{
+    const V term1 = phi*k + rho;
+    const V term2 = sqrt(term1*term1 + (1 - rho*rho));
+    return .5*theta*(1 + rho*k*phi + term2);
+};
+
+template <typename V>
+V black_scholes_adjoint_price(
+    const double S, const double K, const double r, const double q, const V& sigma, const double T,
+    const bool is_call, const bool is_future)
+{
+    const double future_flag = is_future ? 0 : 1;
+    const double call_put_flag = is_call ? 1 : -1;
+    const double mu = future_flag*(r-q);
+    const double df = exp(-r*T);
+    const double drift = exp(mu*T);
+    const double F = S*drift;
+    const double sqrt_T = sqrt(T);
+    const V d1 = (log(F/K) + T*.5*sigma*sigma)/(sigma*sqrt_T);
+    const V d2 = d1 - sigma*sqrt_T;
+    const V Nd1 = adjoint_normal_cdf(call_put_flag*d1);
+    const V Nd2 = adjoint_normal_cdf(call_put_flag*d2);
+    return df*call_put_flag*(F*Nd1 - K*Nd2);
+};
+
+struct SVIAdjointSliceRisk
+{
+    double a;
+    double b;
+    double rho;
+    double m;
+    double sigma;
+};
+
+struct SVIAdjointResult
+{
+    double price;
+    std::vector<SVIAdjointSliceRisk> slices;
+    double ssvi_rho;
+    double ssvi_nu;
+    double ssvi_gamma;
+    std::vector<double> atm_total_variances;
+    std::size_t n_bad_legs;
+    std::size_t tape_size;
+    double elapsed_us;
+};
+
+struct SVIAdjointBook
+{
+    Timestamp reference_timestamp_;
+    double S_;
+    double r_;
+    double q_;
+    bool is_future_;
+    std::vector<Timestamp> expiries_;
+    std::vector<double> t_;
+    std::vector<SVIRawParameters> raw_;
+    std::vector<double> atm_total_variances_;
+    bool has_ssvi_;
+    double ssvi_rho_;
+    double ssvi_nu_;
+    double ssvi_gamma_;
+    std::vector<std::shared_ptr<Option>> legs_;
+    std::vector<std::size_t> leg_slices_;
+    std::vector<double> leg_K_;
+    std::vector<double> leg_T_;
+    std::vector<double> leg_k_;
+    std::vector<double> leg_weights_;
+    std::vector<unsigned char> leg_is_call_;
+    AdjointTape tape_;
+    std::vector<AdjointDouble> phis_;
+    SVIAdjointBook(const Timestamp reference_timestamp, const double S, const double r, const double q, const bool is_future);
+    ~SVIAdjointBook(){};
+    std::size_t add_slice(const Timestamp expiry, const SVI& svi);
+    std::size_t add_slice(const Timestamp expiry, SVISliceFit fit);
+    void set_slice(const std::size_t i, const SVI& svi);
+    void set_slice(const std::size_t i, SVISliceFit fit);
+    void set_ssvi(const SSVI& ssvi);
+    void set_atm_total_variance(const std::size_t i, const double atm_total_variance);
+    void set_market(const double S, const double r, const double q);
+    void set_reference_timestamp(const Timestamp reference_timestamp);
+    std::size_t find_slice(const Timestamp expiry) const;
+    std::size_t add_option(const std::shared_ptr<Option> option, const double quantity);
+    std::size_t add_structured_option(const std::shared_ptr<StructuredOption> structure, const double quantity);
+    std::size_t get_number_legs() const;
+    void update_legs();
+    double price();
+    double price_ssvi();
+    SVIAdjointResult compute();
+    SVIAdjointResult compute_ssvi();
+};
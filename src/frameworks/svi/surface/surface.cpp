@@ -0,0 +1,246 @@
+#include "surface.h"
+
+/**
+* @file surface.h
+* @brief This file defines the SVI term structure and its arbitrage sweep.
+*
+* The slices are kept sorted by year fraction and are evaluated once each on a shared log
+* moneyness grid with the vectorized SVI::evaluate_grid, so that a sweep of n slices costs n
+* grid evaluations instead of the O(n^2) slice copies of pairwise SVI checks:
+* - butterfly arbitrage: the Durrleman function g(k) (SVI::risk_neutral_density) must be non
+* negative on the grid, and the wing slopes b*(1+p) and b*(1-p) must not exceed 2 (Lee's moment bound).
+* - calendar spread arbitrage: the total variance of each slice must not exceed the one of
+* the next slice on the grid, and neither must its wing slopes.
+*
+* References :
+* - "Arbitrage-free SVI volatility surface", Gatheral, Jacquier, 2013.
+*/
+
+/**
+ * @class SVISurfaceWrongGrid
+ * @brief Definition of the error when the log moneyness grid is not strictly increasing or too small.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * SVISurfaceWrongGrid::what() const throw(){
+    return "The log moneyness grid must have at least 2 strictly increasing values.";
+};
+
+/**
+ * @enum SVIArbitrageType
+ * @brief The kind of arbitrage of a SVIArbitrageViolation.
+ */
+
+/**
+ * @struct SVIArbitrageViolation
+ * @brief A log moneyness interval [k_begin, k_end] on which an arbitrage condition fails.
+ * For a calendar spread arbitrage, slice is the index of the shortest slice of the pair
+ * (slice, slice+1). A violation of the wings is reported beyond the grid, with an infinite bound.
+ */
+
+/**
+ * @struct SVIArbitrageReport
+ * @brief The result of SVISurface::check_arbitrage: a flag per slice, a flag per pair of
+ * consecutive slices and the list of the failing intervals.
+ */
+
+static const double SVI_MAX_WING_SLOPE = 2.0;
+
+/**
+ * @brief Appends the maximal runs of consecutive failing grid points as violations.
+ * @param k_grid The log moneyness grid.
+ * @param fails The predicate telling whether the grid point j fails.
+ * @param type The kind of arbitrage.
+ * @param slice The index of the slice.
+ * @param violations The violations to append to.
+ * @return True if no point fails.
+ */
+template <typename Predicate>
+static bool record_runs(
+    const std::vector<double>& k_grid, Predicate fails, SVIArbitrageType type,
+    std::size_t slice, std::vector<SVIArbitrageViolation>& violations)
+{
+    bool ok = true;
+    std::size_t j = 0;
+    const std::size_t n = k_grid.size();
+    while (j < n)
+    {
+        if (!fails(j)){++j; continue;}
+        const std::size_t begin = j;
+        while (j + 1 < n && fails(j + 1)){++j;}
+        violations.push_back(SVIArbitrageViolation{type, slice, k_grid[begin], k_grid[j]});
+        ok = false;
+        ++j;
+    }
+    return ok;
+};
+
+/**
+ * @param k_min The first value.
+ * @param k_max The last value.
+ * @param n_k The number of values.
+ * @return The n_k evenly spaced values from k_min to k_max.
+ */
+static std::vector<double> linear_grid(double k_min, double k_max, std::size_t n_k)
+{
+    std::vector<double> grid(n_k);
+    for (std::size_t j = 0; j < n_k; ++j){grid[j] = k_min + (k_max - k_min)*j/(n_k > 1 ? n_k - 1 : 1);}
+    return grid;
+};
+
+/**
+ * @struct SVISurface
+ * @brief A term structure of SVI slices sorted by year fraction, with a shared log moneyness grid.
+ */
+
+ /**
+ * @var std::vector<SVI> SVISurface::slices_
+ * @brief The slices sorted by increasing year fraction.
+ */
+
+ /**
+ * @var std::vector<double> SVISurface::k_grid_
+ * @brief The log moneyness grid shared by the checks.
+ */
+
+ /**
+ * @var std::vector<double> SVISurface::total_variance_
+ * @brief Scratch buffer, the total variances of the current slice on the grid.
+ */
+
+ /**
+ * @var std::vector<double> SVISurface::next_total_variance_
+ * @brief Scratch buffer, the total variances of the next slice on the grid.
+ */
+
+ /**
+ * @var std::vector<double> SVISurface::density_
+ * @brief Scratch buffer, the Durrleman function of the current slice on the grid.
+ */
+
+/**
+ * @brief The main constructor.
+ * @param slices The slices, in any order.
+ * @param k_grid The log moneyness grid, strictly increasing.
+ * @throw SVISurfaceWrongGrid
+ */
+SVISurface::SVISurface(std::vector<SVI> slices, std::vector<double> k_grid):
+    slices_(slices), k_grid_(k_grid),
+    total_variance_(k_grid.size()), next_total_variance_(k_grid.size()), density_(k_grid.size())
+{
+    if (k_grid_.size() < 2){throw SVISurfaceWrongGrid();}
+    for (std::size_t j = 1; j < k_grid_.size(); ++j)
+    {
+        if (!(k_grid_[j] > k_grid_[j-1])){throw SVISurfaceWrongGrid();}
+    }
+    std::stable_sort(slices_.begin(), slices_.end(), [](const SVI& x, const SVI& y){return x.T_ < y.T_;});
+};
+
+/**
+ * @brief The constructor with an evenly spaced grid.
+ * @param slices The slices, in any order.
+ * @param k_min The first log moneyness of the grid.
+ * @param k_max The last log moneyness of the grid.
+ * @param n_k The number of grid values.
+ * @throw SVISurfaceWrongGrid
+ */
+SVISurface::SVISurface(std::vector<SVI> slices, double k_min, double k_max, std::size_t n_k):
+    SVISurface(slices, linear_grid(k_min, k_max, n_k)){};
+
+/**
+ * @return The number of slices.
+ */
+std::size_t SVISurface::size()
+{
+    return slices_.size();
+};
+
+/**
+ * @brief Inserts a slice at its place in the term structure.
+ * @param slice The slice.
+ */
+void SVISurface::add_slice(SVI slice)
+{
+    auto position = std::upper_bound(slices_.begin(), slices_.end(), slice.T_,
+        [](double t, const SVI& x){return t < x.T_;});
+    slices_.insert(position, slice);
+};
+
+/**
+ * @brief Checks every butterfly and calendar spread condition of the surface in one pass over
+ * the slices: each slice is evaluated once on the grid and compared with the next one. The
+ * report buffers are reused, so that repeated checks do not allocate when the surface is
+ * arbitrage free.
+ * @param report The report to fill.
+ * @return True if no arbitrage, false else.
+ */
+bool SVISurface::check_arbitrage(SVIArbitrageReport& report)
+{
+    const std::size_t n = slices_.size();
+    const std::size_t n_k = k_grid_.size();
+    const double inf = std::numeric_limits<double>::infinity();
+    report.arbitrage_free = true;
+    report.butterfly_arbitrage_free.assign(n, true);
+    report.calendar_spread_arbitrage_free.assign(n > 0 ? n - 1 : 0, true);
+    report.violations.clear();
+    if (n == 0){return true;}
+
+    SVIGridOutput output = {};
+    output.total_variance = total_variance_.data();
+    output.risk_neutral_density = density_.data();
+    slices_[0].evaluate_grid(k_grid_.data(), n_k, SVI_TOTAL_VARIANCE | SVI_RISK_NEUTRAL_DENSITY, output);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        SVI& slice = slices_[i];
+        bool butterfly = record_runs(k_grid_, [this](std::size_t j){return density_[j] < 0;},
+            SVI_BUTTERFLY_ARBITRAGE, i, report.violations);
+        if (slice.b*(1 - slice.p) > SVI_MAX_WING_SLOPE)
+        {
+            report.violations.push_back(SVIArbitrageViolation{SVI_BUTTERFLY_ARBITRAGE, i, -inf, k_grid_.front()});
+            butterfly = false;
+        }
+        if (slice.b*(1 + slice.p) > SVI_MAX_WING_SLOPE)
+        {
+            report.violations.push_back(SVIArbitrageViolation{SVI_BUTTERFLY_ARBITRAGE, i, k_grid_.back(), inf});
+            butterfly = false;
+        }
+        report.butterfly_arbitrage_free[i] = butterfly;
+        report.arbitrage_free = report.arbitrage_free && butterfly;
+        if (i + 1 == n){break;}
+
+        SVI& next = slices_[i+1];
+        output.total_variance = next_total_variance_.data();
+        next.evaluate_grid(k_grid_.data(), n_k, SVI_TOTAL_VARIANCE | SVI_RISK_NEUTRAL_DENSITY, output);
+        bool calendar = record_runs(k_grid_,
+            [this](std::size_t j){return total_variance_[j] > next_total_variance_[j];},
+            SVI_CALENDAR_SPREAD_ARBITRAGE, i, report.violations);
+        if (slice.b*(1 - slice.p) > next.b*(1 - next.p))
+        {
+            report.violations.push_back(SVIArbitrageViolation{SVI_CALENDAR_SPREAD_ARBITRAGE, i, -inf, k_grid_.front()});
+            calendar = false;
+        }
+        if (slice.b*(1 + slice.p) > next.b*(1 + next.p))
+        {
+            report.violations.push_back(SVIArbitrageViolation{SVI_CALENDAR_SPREAD_ARBITRAGE, i, k_grid_.back(), inf});
+            calendar = false;
+        }
+        report.calendar_spread_arbitrage_free[i] = calendar;
+        report.arbitrage_free = report.arbitrage_free && calendar;
+        std::swap(total_variance_, next_total_variance_);
+    }
+    return report.arbitrage_free;
+};
+
+/**
+ * @brief Checks every butterfly and calendar spread condition of the surface.
+ * @return The arbitrage report.
+ */
+SVIArbitrageReport SVISurface::check_arbitrage()
+{
+    SVIArbitrageReport report;
+    check_arbitrage(report);
+    return report;
+};
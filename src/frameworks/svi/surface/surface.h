@@ -0,0 +1,48 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "../../../frameworks/svi/svi.h"
+
+class SVISurfaceWrongGrid:  public std::exception
+{public: const char * what() const throw();};
+
+enum SVIArbitrageType
+{
+    SVI_BUTTERFLY_ARBITRAGE = 0,
+    SVI_CALENDAR_SPREAD_ARBITRAGE = 1
+};
+
+struct SVIArbitrageViolation
+{
+    SVIArbitrageType type;
+    std::size_t slice;
+    double k_begin;
+    double k_end;
+};
+
+struct SVIArbitrageReport
+{
+    bool arbitrage_free;
+    std::vector<bool> butterfly_arbitrage_free;
+    std::vector<bool> calendar_spread_arbitrage_free;
+    std::vector<SVIArbitrageViolation> violations;
+};
+
+struct SVISurface
+{
+    std::vector<SVI> slices_;
+    std::vector<double> k_grid_;
+    std::vector<double> total_variance_;
+    std::vector<double> next_total_variance_;
+    std::vector<double> density_;
+    SVISurface(std::vector<SVI> slices, std::vector<double> k_grid);
+    SVISurface(std::vector<SVI> slices, double k_min, double k_max, std::size_t n_k);
+    ~SVISurface(){};
+    std::size_t size();
+    void add_slice(SVI slice);
+    bool check_arbitrage(SVIArbitrageReport& report);
+    SVIArbitrageReport check_arbitrage();
+};
@@ -36,6 +36,79 @@ const char * SSVIWrongParameterValue::what() const throw(){
     return "There is an error in the SSVI input parameters.";
 };
 
+/**
+ * @enum SVIQuantity
+ * @brief The bitmask of the quantities computed by SVI::evaluate_grid and SSVI::evaluate_grid.
+ * Each one matches the scalar function of the same name.
+ */
+
+/**
+ * @struct SVIGridOutput
+ * @brief The output arrays of SVI::evaluate_grid and SSVI::evaluate_grid. Only the arrays
+ * selected with the SVIQuantity bitmask are written, the other ones can be null.
+ */
+
+static const int SVI_GRID_QUANTITIES = 6;
+
+/**
+ * @brief Runs a grid kernel over a span of log moneyness values, SIMD_WIDTH values at a time.
+ * The tail is padded with the last value and only the valid lanes are written.
+ * @param k The log moneyness values.
+ * @param n The number of values.
+ * @param quantities The SVIQuantity bitmask of the quantities to write.
+ * @param destinations The output arrays, in the order of the SVIQuantity bits.
+ * @param kernel The kernel filling the SVI_GRID_QUANTITIES values of a simd_double of log moneyness.
+ */
+template <typename Kernel>
+static void evaluate_grid_row(
+    const double* k, std::size_t n, int quantities,
+    double* const destinations[SVI_GRID_QUANTITIES], Kernel kernel)
+{
+    simd_double values[SVI_GRID_QUANTITIES];
+    for (int q = 0; q < SVI_GRID_QUANTITIES; ++q){values[q] = simd_set1(0.0);}
+    std::size_t i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        kernel(simd_load(k + i), values);
+        for (int q = 0; q < SVI_GRID_QUANTITIES; ++q)
+        {
+            if (quantities & (1<<q)){simd_store(destinations[q] + i, values[q]);}
+        }
+    }
+    if (i < n)
+    {
+        double buffer[SIMD_WIDTH];
+        for (std::size_t j = 0; j < SIMD_WIDTH; ++j){buffer[j] = i + j < n ? k[i + j] : k[n - 1];}
+        kernel(simd_load(buffer), values);
+        for (int q = 0; q < SVI_GRID_QUANTITIES; ++q)
+        {
+            if (!(quantities & (1<<q))){continue;}
+            simd_store(buffer, values[q]);
+            for (std::size_t j = i; j < n; ++j){destinations[q][j] = buffer[j - i];}
+        }
+    }
+};
+
+/**
+ * @brief Computes the Durrleman function g(k) from the total variance and its derivatives,
+ * as in SVI::risk_neutral_density.
+ * @param k The log moneyness.
+ * @param w The total variance.
+ * @param dwdk The first derivative of the total variance with respect to k.
+ * @param dw2dk2 The second derivative of the total variance with respect to k.
+ * @return The value of g(k).
+ */
+static inline simd_double durrleman_kernel(simd_double k, simd_double w, simd_double dwdk, simd_double dw2dk2)
+{
+    const simd_double half = simd_set1(.5);
+    const simd_double quarter = simd_set1(.25);
+    const simd_double one = simd_set1(1.0);
+    const simd_double inv_w = simd_div(one, w);
+    const simd_double term1 = simd_sub(one, simd_mul(half, simd_mul(simd_mul(k, dwdk), inv_w)));
+    const simd_double term2 = simd_mul(simd_mul(quarter, simd_mul(dwdk, dwdk)), simd_add(quarter, inv_w));
+    return simd_add(simd_sub(simd_mul(term1, term1), term2), simd_mul(half, dw2dk2));
+};
+
 /** 
  * @struct SSVI
  * @brief The Surface stochastic volatility inspired model (Power-Law parametrization).
@@ -65,20 +138,20 @@ const char * SSVIWrongParameterValue::what() const throw(){
  * @throw SSVIWrongParameterValue
  */
  SSVI::SSVI(double rho, double nu, double gamma): 
-    rho_(rho), nu_(nu_), gamma_(gamma) 
+    rho_(rho), nu_(nu), gamma_(gamma) 
 {
-    if(abs(rho) > 1){throw SSVIWrongParameterValue();}
+    if(fabs(rho) > 1){throw SSVIWrongParameterValue();}
     if(gamma > 1 or gamma<0){throw SSVIWrongParameterValue();}
     if(nu < 0){throw SSVIWrongParameterValue();}
 };
 
 /**
  * @param atm_total_variance the ATM total variance. 
- * @return The power law parametrization function value. 
+ * @return The power law parametrization function value nu*theta^(-gamma). 
  */
 double SSVI::prmtrzt(double atm_total_variance)
 {
-    return nu_*pow(atm_total_variance, gamma_);
+    return nu_*pow(atm_total_variance, -gamma_);
 };
 
 /**
@@ -97,7 +170,7 @@ double SSVI::dprmtrzt(double atm_total_variance)
 bool SSVI::butterfly_arbitrage_check(double atm_total_variance)
 {
     double prmtrzt_ = prmtrzt(atm_total_variance);
-    double cond1 = atm_total_variance*prmtrzt_*(1+abs(rho_));
+    double cond1 = atm_total_variance*prmtrzt_*(1+fabs(rho_));
     double cond2 = cond1*prmtrzt_;
     if (cond1<=4 and cond2<=4){return true;}
     else{return false;}
@@ -151,6 +224,92 @@ double SSVI::implied_volatility(double k, double atm_total_variance, double t)
     return sqrt(implied_variance(k,atm_total_variance,t));
 };
 
+/**
+ * @param atm_total_variance the ATM total variance. 
+ * @param k The log moneyness.
+ * @param t The year fraction, unused: the slice only depends on the ATM total variance.
+ * @return The Durrleman function g(k) of the slice, as in SVI::risk_neutral_density. 
+ */
+double SSVI::risk_neutral_density(double k, double atm_total_variance, [[maybe_unused]] double t)
+{
+    double prmtrzt_ = prmtrzt(atm_total_variance);
+    double u = prmtrzt_*k+rho_;
+    double r = sqrt(u*u + (1-rho_*rho_));
+    double w = .5*atm_total_variance*(1+rho_*k*prmtrzt_+r);
+    double dwdk_ = .5*atm_total_variance*prmtrzt_*(rho_+u/r);
+    double dw2dk2_ = .5*atm_total_variance*prmtrzt_*prmtrzt_*(1-rho_*rho_)/(r*r*r);
+    double term1 = (1-k*dwdk_/(2*w));
+    double term2 = .25*dwdk_*dwdk_*(.25+1/w);
+    return term1*term1 - term2 + .5*dw2dk2_;
+};
+
+/**
+ * @brief Evaluates the surface on a grid of ATM total variances (rows) and log moneyness
+ * values (columns) in one vectorized pass per row. The power law parametrization is evaluated
+ * once per row and the square root term once per point. The outputs are row major arrays of
+ * n_theta*n_k values. SVI_LOCAL_VOLATILITY needs the time derivative of the ATM total
+ * variance, which is not part of the SSVI, its output is filled with NaN.
+ * @param k The log moneyness values.
+ * @param n_k The number of log moneyness values.
+ * @param atm_total_variance The ATM total variances.
+ * @param t The year fractions of the ATM total variances.
+ * @param n_theta The number of ATM total variances.
+ * @param quantities The SVIQuantity bitmask of the quantities to compute.
+ * @param output The output arrays.
+ */
+void SSVI::evaluate_grid(
+    const double* k, std::size_t n_k,
+    const double* atm_total_variance, const double* t, std::size_t n_theta,
+    int quantities, const SVIGridOutput& output)
+{
+    const simd_double half = simd_set1(.5);
+    const simd_double one = simd_set1(1.0);
+    const simd_double rho = simd_set1(rho_);
+    const simd_double one_m_rho2 = simd_set1(1-rho_*rho_);
+    const bool volatility = quantities & SVI_IMPLIED_VOLATILITY;
+    const bool derivatives = quantities & (SVI_DWDK | SVI_DW2DK2 | SVI_RISK_NEUTRAL_DENSITY);
+    for (std::size_t row = 0; row < n_theta; ++row)
+    {
+        const std::size_t offset = row*n_k;
+        const double theta_ = atm_total_variance[row];
+        const double prmtrzt_ = prmtrzt(theta_);
+        const simd_double theta = simd_set1(theta_);
+        const simd_double phi = simd_set1(prmtrzt_);
+        const simd_double half_theta_phi = simd_set1(.5*theta_*prmtrzt_);
+        const simd_double half_theta_phi2 = simd_set1(.5*theta_*prmtrzt_*prmtrzt_*(1-rho_*rho_));
+        const simd_double inv_t = simd_set1(1/t[row]);
+        double* const destinations[SVI_GRID_QUANTITIES] = {
+            output.total_variance ? output.total_variance + offset : nullptr,
+            output.implied_volatility ? output.implied_volatility + offset : nullptr,
+            output.dwdk ? output.dwdk + offset : nullptr,
+            output.dw2dk2 ? output.dw2dk2 + offset : nullptr,
+            output.risk_neutral_density ? output.risk_neutral_density + offset : nullptr,
+            nullptr};
+        evaluate_grid_row(k, n_k, quantities & ~SVI_LOCAL_VOLATILITY, destinations,
+            [&](simd_double x, simd_double* values)
+            {
+                const simd_double u = simd_add(simd_mul(phi, x), rho);
+                const simd_double r = simd_sqrt(simd_add(simd_mul(u, u), one_m_rho2));
+                const simd_double w = simd_mul(simd_mul(half, theta),
+                    simd_add(simd_add(one, simd_mul(rho, simd_mul(phi, x))), r));
+                values[0] = w;
+                if (volatility){values[1] = simd_sqrt(simd_mul(w, inv_t));}
+                if (derivatives)
+                {
+                    const simd_double inv_r = simd_div(one, r);
+                    values[2] = simd_mul(half_theta_phi, simd_add(rho, simd_mul(u, inv_r)));
+                    values[3] = simd_mul(half_theta_phi2, simd_mul(inv_r, simd_mul(inv_r, inv_r)));
+                    values[4] = durrleman_kernel(x, w, values[2], values[3]);
+                }
+            });
+        if ((quantities & SVI_LOCAL_VOLATILITY) && output.local_volatility)
+        {
+            std::fill(output.local_volatility + offset, output.local_volatility + offset + n_k,
+                std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+};
+
 /** 
  * @struct SVI
  * @brief The stochastic volatility inspired model (Jump-wings parametrization).
@@ -253,7 +412,7 @@ double SSVI::implied_volatility(double k, double atm_total_variance, double t)
  */
  SVI::SVI(double vt, double ut, double ct, double pt, double vmt, double t): 
     vt_(vt), ut_(ut), ct_(ct), pt_(pt), vmt_(vmt), T_(t),
-    b(get_b()), p(get_p()),beta(get_beta()), alpha(get_alpha()), 
+    b(get_b()), p(get_p()), beta(get_beta()), alpha(get_alpha()), 
     m(get_m()), a(get_a()), s(get_s()), dbdt(get_dbdt()), 
     dmdt(get_dmdt()), dsdt(get_dsdt()), dadt(get_dadt())
 {
@@ -284,7 +443,7 @@ double SVI::get_p()
     double p_;
     if (b==0){p_ = 0.0;}
     else{p_ = 1 - pt_*sqrt(vt_*T_)/b;}
-    if (abs(p_)>1.0){throw SVIWrongParameterValue();}
+    if (fabs(p_)>1.0){throw SVIWrongParameterValue();}
     return p_;
 };
 
@@ -298,7 +457,7 @@ double SVI::get_beta()
     else
     {
         double beta_ = p - 2*ut_*sqrt(vt_*T_)/b;
-        if (abs(beta_)>1.0){throw SVIWrongParameterValue();}
+        if (fabs(beta_)>1.0){throw SVIWrongParameterValue();}
         return beta_;
     }
 };
@@ -324,7 +483,7 @@ double SVI::get_m()
         double intterm;
         if (alpha<0){intterm = -sqrt(1+alpha*alpha);}
         else{intterm = sqrt(1+alpha*alpha);}
-        return (T_*(vmt_-vt_)/(b*(-p+intterm-alpha*sqrt(1-p*p))));
+        return (T_*(vt_-vmt_)/(b*(-p+intterm-alpha*sqrt(1-p*p))));
     }
 };
 
@@ -335,7 +494,7 @@ double SVI::get_m()
 double SVI::get_a()
 {
     if(m==0){
-        return T_*(vmt_+vt_*sqrt(1-p*p))/(1-sqrt(1-p*p));
+        return T_*(vmt_-vt_*sqrt(1-p*p))/(1-sqrt(1-p*p));
     }
     else{
         double s_ = alpha*m;
@@ -367,6 +526,29 @@ bool SVI::butterfly_arbitrage_check()
     else{return false;}
 };
 
+/**
+ * @brief Checks the absence of calendar spread arbitrage between two slices: the total variance
+ * of the shortest slice must not exceed the one of the longest slice. The wings are compared
+ * through their asymptotic slopes b*(1+p) and b*(1-p), the body on SVI_CALENDAR_GRID_SIZE
+ * log moneyness values evenly spaced on [-SVI_CALENDAR_K_MAX, SVI_CALENDAR_K_MAX].
+ * @param svi The other slice.
+ * @return True if no calendar spread arbitrage, false else. 
+ */
+bool SVI::calendar_spread_arbitrage_check(SVI svi)
+{
+    SVI& shortest = T_<=svi.T_ ? *this : svi;
+    SVI& longest = T_<=svi.T_ ? svi : *this;
+    if (shortest.b*(1+shortest.p) > longest.b*(1+longest.p)){return false;}
+    if (shortest.b*(1-shortest.p) > longest.b*(1-longest.p)){return false;}
+    const double step = 2*SVI_CALENDAR_K_MAX/(SVI_CALENDAR_GRID_SIZE-1);
+    for (int i = 0; i < SVI_CALENDAR_GRID_SIZE; ++i)
+    {
+        double k = -SVI_CALENDAR_K_MAX + i*step;
+        if (shortest.total_variance(k) > longest.total_variance(k)){return false;}
+    }
+    return true;
+};
+
 /**
  * @param k The log moneyness.
  * @return The total variance for a specific log moneyness value. 
@@ -410,7 +592,9 @@ double SVI::dwdk(double k)
  */
 double SVI::dw2dk2(double k)
 {
-    return sqrt(implied_variance(k));
+    double km = k-m;
+    double r = sqrt(km*km + s*s);
+    return b*s*s/(r*r*r);
 };
 
 /**
@@ -430,10 +614,10 @@ double SVI::get_dmdt()
     else{
         double factor;
         if (alpha<0){
-            double factor = (-p - sqrt(1+alpha*alpha) - alpha*sqrt(1-p*p));
+            factor = (-p - sqrt(1+alpha*alpha) - alpha*sqrt(1-p*p));
         }
         else{
-            double factor = (-p + sqrt(1+alpha*alpha) - alpha*sqrt(1-p*p));
+            factor = (-p + sqrt(1+alpha*alpha) - alpha*sqrt(1-p*p));
         }
         return (vt_-vmt_)*(b-T_*dbdt)/(factor*b*b);
     }
@@ -547,3 +731,57 @@ SVI SSVI::get_svi(double atm_total_variance, double t)
         t);
 };
 
+/**
+ * @brief Evaluates the slice on a span of log moneyness values in one vectorized pass. The
+ * square root term sqrt((k-m)^2+s^2) is computed once per point and shared by all the
+ * requested quantities.
+ * @param k The log moneyness values.
+ * @param n The number of log moneyness values.
+ * @param quantities The SVIQuantity bitmask of the quantities to compute.
+ * @param output The output arrays of n values.
+ */
+void SVI::evaluate_grid(const double* k, std::size_t n, int quantities, const SVIGridOutput& output)
+{
+    const simd_double one = simd_set1(1.0);
+    const simd_double a_ = simd_set1(a);
+    const simd_double b_ = simd_set1(b);
+    const simd_double p_ = simd_set1(p);
+    const simd_double m_ = simd_set1(m);
+    const simd_double s2 = simd_set1(s*s);
+    const simd_double b_s2 = simd_set1(b*s*s);
+    const simd_double inv_T = simd_set1(1/T_);
+    const simd_double dadt_ = simd_set1(dadt);
+    const simd_double dbdt_ = simd_set1(dbdt);
+    const simd_double dgdt_0 = simd_set1(-p*dmdt);
+    const simd_double dsdt_s = simd_set1(dsdt*s);
+    const simd_double dmdt_ = simd_set1(dmdt);
+    const bool volatility = quantities & SVI_IMPLIED_VOLATILITY;
+    const bool derivatives = quantities & (SVI_DWDK | SVI_DW2DK2 | SVI_RISK_NEUTRAL_DENSITY | SVI_LOCAL_VOLATILITY);
+    const bool local_volatility_ = quantities & SVI_LOCAL_VOLATILITY;
+    double* const destinations[SVI_GRID_QUANTITIES] = {
+        output.total_variance, output.implied_volatility, output.dwdk,
+        output.dw2dk2, output.risk_neutral_density, output.local_volatility};
+    evaluate_grid_row(k, n, quantities, destinations,
+        [&](simd_double x, simd_double* values)
+        {
+            const simd_double km = simd_sub(x, m_);
+            const simd_double r = simd_sqrt(simd_add(simd_mul(km, km), s2));
+            const simd_double smile = simd_add(simd_mul(p_, km), r);
+            const simd_double w = simd_add(a_, simd_mul(b_, smile));
+            values[0] = w;
+            if (volatility){values[1] = simd_sqrt(simd_mul(w, inv_T));}
+            if (derivatives)
+            {
+                const simd_double inv_r = simd_div(one, r);
+                values[2] = simd_mul(b_, simd_add(p_, simd_mul(km, inv_r)));
+                values[3] = simd_mul(b_s2, simd_mul(inv_r, simd_mul(inv_r, inv_r)));
+                values[4] = durrleman_kernel(x, w, values[2], values[3]);
+                if (local_volatility_)
+                {
+                    const simd_double dgdt_ = simd_add(dgdt_0, simd_mul(simd_sub(dsdt_s, simd_mul(dmdt_, km)), inv_r));
+                    const simd_double dwdt_ = simd_add(dadt_, simd_add(simd_mul(b_, dgdt_), simd_mul(dbdt_, smile)));
+                    values[5] = simd_sqrt(simd_div(dwdt_, values[4]));
+                }
+            }
+        });
+};
@@ -1,5 +1,9 @@
 #pragma once 
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "../../math/simd/simd.h"
 
 class SSVIWrongParameterValue:  public std::exception 
 {public: const char * what() const throw();};
@@ -8,6 +12,32 @@ class SSVIWrongParameterValue:  public std::exception
 class SVIWrongParameterValue:  public std::exception 
 {public: const char * what() const throw();};
 
+constexpr int SVI_CALENDAR_GRID_SIZE = 101;
+constexpr double SVI_CALENDAR_K_MAX = 2.0;
+
+enum SVIQuantity
+{
+    SVI_TOTAL_VARIANCE = 1<<0,
+    SVI_IMPLIED_VOLATILITY = 1<<1,
+    SVI_DWDK = 1<<2,
+    SVI_DW2DK2 = 1<<3,
+    SVI_RISK_NEUTRAL_DENSITY = 1<<4,
+    SVI_LOCAL_VOLATILITY = 1<<5,
+    SVI_ALL = (1<<6)-1
+};
+
+struct SVIGridOutput
+{
+    double* total_variance;
+    double* implied_volatility;
+    double* dwdk;
+    double* dw2dk2;
+    double* risk_neutral_density;
+    double* local_volatility;
+};
+
+struct SVI;
+
 struct SSVI
 {
     double rho_; 
@@ -26,6 +56,15 @@ struct SSVI
     double risk_neutral_density(double k, double atm_total_variance, double t); 
     double local_volatility(double k, double atm_total_variance, double t); 
     double atm_volatility_skew(double k, double atm_total_variance, double t);
+    void evaluate_grid(
+        const double* k,
+        std::size_t n_k,
+        const double* atm_total_variance,
+        const double* t,
+        std::size_t n_theta,
+        int quantities,
+        const SVIGridOutput& output
+    );
 };
 
 struct SVI
@@ -36,17 +75,17 @@ struct SVI
     double pt_;
     double vmt_; 
     double T_; 
-    double a; 
+    double b; 
+    double p; 
     double beta; 
     double alpha;
-    double b; 
     double m; 
+    double a; 
     double s; 
-    double p; 
+    double dbdt; 
     double dmdt; 
-    double dadt; 
     double dsdt; 
-    double dbdt; 
+    double dadt; 
     SVI(double vt, double ut, double ct, double pt, double vmt, double t); 
     ~SVI(){}; 
     double get_a(); 
@@ -74,6 +113,7 @@ struct SVI
     double risk_neutral_density(double k); 
     double local_variance(double k); 
     double local_volatility(double k); 
+    void evaluate_grid(const double* k, std::size_t n, int quantities, const SVIGridOutput& output);
 };
 
 struct ReducedSVI
@@ -0,0 +1,501 @@
+#include "instrumentation.h"
+
+/**
+* @file instrumentation.h
+* @brief This file defines the opt-in instrumentation of the hot paths: scoped timers, per thread
+* latency histograms and counters, and their snapshots.
+*
+* The instrumentation is compiled in with -DARBITRAGE_INSTRUMENTATION, without it every
+* ARBITRAGE_INSTRUMENT_* macro expands to nothing and its arguments are not evaluated. The
+* timers use the steady clock, or the time stamp counter with -DARBITRAGE_INSTRUMENTATION_RDTSC
+* on x86 (calibrated against the steady clock at start up, the counter must be invariant).
+* -DARBITRAGE_INSTRUMENTATION_ALLOCATIONS also replaces the global operator new to count the
+* allocations of the instrumented threads (it cannot be linked with the benchmark binary, which
+* replaces it too).
+*
+* Each thread records into its own InstrumentationThreadData, registered on its first use and
+* kept until the end of the process: a record is a few relaxed loads and stores without any
+* lock or read-modify-write instruction. get_instrumentation_snapshot reads every thread while
+* they keep recording, so a snapshot is not an exact cut in time but never stops the workers,
+* and the difference of two snapshots (InstrumentationSnapshot::since) gives the statistics of
+* an interval.
+*
+* The histograms are log-linear in the manner of HdrHistogram: the values below 32 ns have one
+* bucket each, and every power of two above is split into 32 buckets, so that a percentile is
+* known within 1/32 (about 3%) of its value, up to 2^48 ns (about 78 hours).
+*
+* References :
+* - "HdrHistogram: A High Dynamic Range Histogram", Tene, http://hdrhistogram.org.
+* - "How NOT to Measure Latency", Tene, 2015.
+* - "Intel 64 and IA-32 Architectures Software Developer's Manual", Volume 3, 18.17 Time-Stamp Counter.
+*/
+
+/**
+ * @brief The data of the current thread, null until its first record.
+ */
+thread_local InstrumentationThreadData* instrumentation_thread_data = nullptr;
+
+/**
+ * @brief The mutex of the registration of the threads and of the snapshots.
+ * @return The mutex, never destroyed.
+ */
+static std::mutex& get_instrumentation_mutex()
+{
+    static std::mutex* mutex = new std::mutex();
+    return *mutex;
+};
+
+/**
+ * @brief The data of every thread which recorded, leaked on purpose so that the threads still
+ * running at the exit of the process never record into destroyed data.
+ * @return The data of the threads.
+ */
+static std::vector<InstrumentationThreadData*>& get_instrumentation_threads()
+{
+    static std::vector<InstrumentationThreadData*>* threads = new std::vector<InstrumentationThreadData*>();
+    return *threads;
+};
+
+/**
+ * @brief Measures the nanoseconds per time stamp counter tick against the steady clock, over
+ * 10 ms. Without ARBITRAGE_INSTRUMENTATION_RDTSC the ticks are nanoseconds.
+ * @return The nanoseconds per tick.
+ */
+static double calibrate_instrumentation_ticks()
+{
+#if defined(ARBITRAGE_INSTRUMENTATION_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+    const auto start = std::chrono::steady_clock::now();
+    const long long start_ticks = instrumentation_ticks();
+    auto now = start;
+    while (now - start < std::chrono::milliseconds(10)){now = std::chrono::steady_clock::now();}
+    const long long ticks = instrumentation_ticks() - start_ticks;
+    const double ns = std::chrono::duration<double, std::nano>(now - start).count();
+    return ticks > 0 ? ns/ticks : 1.0;
+#else
+    return 1.0;
+#endif
+};
+
+/**
+ * @brief The nanoseconds per tick of instrumentation_ticks.
+ */
+double instrumentation_ns_per_tick = calibrate_instrumentation_ticks();
+
+/**
+ * @fn std::size_t get_latency_histogram_bucket(std::uint64_t ns)
+ * @brief Gets the bucket of a value, the values above 2^48 - 1 ns are clamped.
+ * @param ns The value in nanoseconds.
+ * @return The index of its bucket.
+ */
+
+/**
+ * @brief Gets the smallest value of a bucket.
+ * @param bucket The index of the bucket.
+ * @return The value in nanoseconds.
+ */
+std::uint64_t get_latency_histogram_bucket_lower(const std::size_t bucket)
+{
+    if (bucket < LATENCY_HISTOGRAM_SUB_BUCKETS){return bucket;}
+    const std::size_t shift = bucket/LATENCY_HISTOGRAM_SUB_BUCKETS - 1;
+    return (LATENCY_HISTOGRAM_SUB_BUCKETS + bucket%LATENCY_HISTOGRAM_SUB_BUCKETS) << shift;
+};
+
+/**
+ * @brief Gets the largest value of a bucket.
+ * @param bucket The index of the bucket.
+ * @return The value in nanoseconds.
+ */
+std::uint64_t get_latency_histogram_bucket_upper(const std::size_t bucket)
+{
+    if (bucket < LATENCY_HISTOGRAM_SUB_BUCKETS){return bucket;}
+    const std::size_t shift = bucket/LATENCY_HISTOGRAM_SUB_BUCKETS - 1;
+    return get_latency_histogram_bucket_lower(bucket) + (std::uint64_t(1) << shift) - 1;
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief The log-linear histogram of the latencies of a stage on one thread. It has a single
+ * writer, its owner thread, and any number of readers.
+ */
+
+/**
+ * @brief The constructor, the histogram is empty.
+ */
+LatencyHistogram::LatencyHistogram(): sum_(0), max_(0)
+{
+    for (std::size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; ++i){buckets_[i].store(0, std::memory_order_relaxed);}
+};
+
+/**
+ * @fn void LatencyHistogram::record(const std::uint64_t ns)
+ * @brief Records a value, only from the thread owning the histogram.
+ * @param ns The value in nanoseconds.
+ */
+
+/**
+ * @brief Reads the histogram, from any thread, while its owner keeps recording.
+ * @param buckets The LATENCY_HISTOGRAM_BUCKETS counts, added to.
+ * @param sum The sum of the values, added to.
+ * @param max The maximal value, raised to it.
+ */
+void LatencyHistogram::read(std::uint64_t* buckets, std::uint64_t& sum, std::uint64_t& max) const
+{
+    for (std::size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; ++i){buckets[i] += buckets_[i].load(std::memory_order_relaxed);}
+    sum += sum_.load(std::memory_order_relaxed);
+    max = std::max(max, max_.load(std::memory_order_relaxed));
+};
+
+/**
+ * @struct InstrumentationThreadData
+ * @brief The histograms of the stages and the counters of one thread, on their own cache lines.
+ */
+
+/**
+ * @brief The constructor, everything is zero.
+ */
+InstrumentationThreadData::InstrumentationThreadData()
+{
+    for (std::size_t i = 0; i < INSTRUMENTATION_N_COUNTERS; ++i){counters[i].store(0, std::memory_order_relaxed);}
+};
+
+/**
+ * @brief Registers the current thread, called on its first record.
+ * @return The data of the thread.
+ */
+InstrumentationThreadData& register_instrumentation_thread()
+{
+    InstrumentationThreadData* data = new InstrumentationThreadData();
+    {
+        std::lock_guard<std::mutex> lock(get_instrumentation_mutex());
+        get_instrumentation_threads().push_back(data);
+    }
+    instrumentation_thread_data = data;
+    return *data;
+};
+
+/**
+ * @fn InstrumentationThreadData& get_instrumentation_thread_data()
+ * @brief Gets the data of the current thread, registering it on its first call.
+ * @return The data of the thread.
+ */
+
+/**
+ * @fn void instrumentation_add(const InstrumentationCounter counter, const std::uint64_t n)
+ * @brief Adds to a counter of the current thread.
+ * @param counter The counter.
+ * @param n The increment.
+ */
+
+/**
+ * @fn void instrumentation_record(const InstrumentationStage stage, const long long ns)
+ * @brief Records a latency of the current thread, the negative ones (clock skews) are recorded as 0.
+ * @param stage The stage.
+ * @param ns The latency in nanoseconds.
+ */
+
+/**
+ * @fn long long instrumentation_ticks()
+ * @return The steady clock in nanoseconds, or the time stamp counter with ARBITRAGE_INSTRUMENTATION_RDTSC.
+ */
+
+/**
+ * @fn long long instrumentation_ticks_to_ns(const long long ticks)
+ * @param ticks A difference of instrumentation_ticks.
+ * @return The difference in nanoseconds.
+ */
+
+/**
+ * @fn long long instrumentation_wall_clock_ns()
+ * @return The system clock in nanoseconds since the epoch, the clock of the exchange timestamps.
+ */
+
+/**
+ * @class InstrumentationScopedTimer
+ * @brief The timer recording the time spent in its scope into the histogram of a stage, use it
+ * with ARBITRAGE_INSTRUMENT_SCOPE.
+ */
+
+/**
+ * @fn InstrumentationScopedTimer::InstrumentationScopedTimer(const InstrumentationStage stage)
+ * @brief The constructor, starts the timer.
+ * @param stage The stage.
+ */
+
+/**
+ * @struct LatencyHistogramSnapshot
+ * @brief The histogram of a stage summed over the threads.
+ */
+
+/**
+ * @var std::vector<std::uint64_t> LatencyHistogramSnapshot::buckets
+ * @brief The counts of the LATENCY_HISTOGRAM_BUCKETS buckets.
+ */
+
+/**
+ * @var std::uint64_t LatencyHistogramSnapshot::count
+ * @brief The number of values, the sum of the buckets.
+ */
+
+/**
+ * @var std::uint64_t LatencyHistogramSnapshot::sum_ns
+ * @brief The sum of the values.
+ */
+
+/**
+ * @var std::uint64_t LatencyHistogramSnapshot::max_ns
+ * @brief The maximal value.
+ */
+
+/**
+ * @brief The constructor, the histogram is empty.
+ */
+LatencyHistogramSnapshot::LatencyHistogramSnapshot(): buckets(LATENCY_HISTOGRAM_BUCKETS, 0), count(0), sum_ns(0), max_ns(0){};
+
+/**
+ * @brief Adds the values of a thread histogram.
+ * @param histogram The histogram.
+ */
+void LatencyHistogramSnapshot::add(const LatencyHistogram& histogram)
+{
+    histogram.read(buckets.data(), sum_ns, max_ns);
+    count = 0;
+    for (const std::uint64_t n : buckets){count += n;}
+};
+
+/**
+ * @brief Gets a percentile, the largest value of the bucket holding it (it is at most 1/32 above
+ * the true value) and never more than the maximum.
+ * @param q The quantile in [0, 1], 0.99 for the p99.
+ * @return The percentile in nanoseconds, 0 for an empty histogram.
+ */
+double LatencyHistogramSnapshot::get_percentile(const double q) const
+{
+    if (count == 0){return 0.0;}
+    const double clamped = std::min(1.0, std::max(0.0, q));
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(clamped*count)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank){return static_cast<double>(std::min(get_latency_histogram_bucket_upper(i), max_ns));}
+    }
+    return static_cast<double>(max_ns);
+};
+
+/**
+ * @return The mean of the values in nanoseconds, 0 for an empty histogram.
+ */
+double LatencyHistogramSnapshot::get_mean() const
+{
+    return count == 0 ? 0.0 : static_cast<double>(sum_ns)/count;
+};
+
+/**
+ * @struct InstrumentationSnapshot
+ * @brief The histograms and the counters summed over the threads.
+ */
+
+/**
+ * @var std::vector<LatencyHistogramSnapshot> InstrumentationSnapshot::stages
+ * @brief The histograms, indexed by InstrumentationStage.
+ */
+
+/**
+ * @var std::vector<std::uint64_t> InstrumentationSnapshot::counters
+ * @brief The counters, indexed by InstrumentationCounter.
+ */
+
+/**
+ * @var std::size_t InstrumentationSnapshot::n_threads
+ * @brief The number of threads which recorded.
+ */
+
+/**
+ * @brief The constructor, the snapshot is empty.
+ */
+InstrumentationSnapshot::InstrumentationSnapshot():
+    stages(INSTRUMENTATION_N_STAGES), counters(INSTRUMENTATION_N_COUNTERS, 0), n_threads(0){};
+
+/**
+ * @brief Gets the statistics of the interval between an earlier snapshot and this one. As the
+ * maximum of an interval is not known, it is the largest value of its highest bucket.
+ * @param earlier The earlier snapshot.
+ * @return The snapshot of the interval.
+ */
+InstrumentationSnapshot InstrumentationSnapshot::since(const InstrumentationSnapshot& earlier) const
+{
+    InstrumentationSnapshot interval;
+    interval.n_threads = n_threads;
+    for (std::size_t s = 0; s < INSTRUMENTATION_N_STAGES; ++s)
+    {
+        const LatencyHistogramSnapshot& later_stage = stages[s];
+        const LatencyHistogramSnapshot& earlier_stage = earlier.stages[s];
+        LatencyHistogramSnapshot& stage = interval.stages[s];
+        for (std::size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; ++i)
+        {
+            const std::uint64_t n = later_stage.buckets[i] - std::min(later_stage.buckets[i], earlier_stage.buckets[i]);
+            stage.buckets[i] = n;
+            stage.count += n;
+            if (n > 0){stage.max_ns = std::min(get_latency_histogram_bucket_upper(i), later_stage.max_ns);}
+        }
+        stage.sum_ns = later_stage.sum_ns - std::min(later_stage.sum_ns, earlier_stage.sum_ns);
+    }
+    for (std::size_t c = 0; c < INSTRUMENTATION_N_COUNTERS; ++c)
+    {
+        interval.counters[c] = counters[c] - std::min(counters[c], earlier.counters[c]);
+    }
+    return interval;
+};
+
+/**
+ * @brief Takes a snapshot of every thread, without stopping them: only the registration of new
+ * threads waits for it.
+ * @return The snapshot, empty without ARBITRAGE_INSTRUMENTATION.
+ */
+InstrumentationSnapshot get_instrumentation_snapshot()
+{
+    InstrumentationSnapshot snapshot;
+    std::lock_guard<std::mutex> lock(get_instrumentation_mutex());
+    const std::vector<InstrumentationThreadData*>& threads = get_instrumentation_threads();
+    snapshot.n_threads = threads.size();
+    for (const InstrumentationThreadData* data : threads)
+    {
+        for (std::size_t s = 0; s < INSTRUMENTATION_N_STAGES; ++s){snapshot.stages[s].add(data->histograms[s]);}
+        for (std::size_t c = 0; c < INSTRUMENTATION_N_COUNTERS; ++c)
+        {
+            snapshot.counters[c] += data->counters[c].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+};
+
+/**
+ * @brief Gets the name of a stage.
+ * @param stage The stage.
+ * @return Its name.
+ */
+const char* get_instrumentation_stage_name(const InstrumentationStage stage)
+{
+    switch (stage)
+    {
+        case INSTRUMENTATION_INGESTION: return "ingestion";
+        case INSTRUMENTATION_INTERPOLATION: return "interpolation";
+        case INSTRUMENTATION_CALIBRATION: return "calibration";
+        case INSTRUMENTATION_PRICING: return "pricing";
+        case INSTRUMENTATION_TICK_TO_PRICE: return "tick_to_price";
+        default: return "unknown";
+    }
+};
+
+/**
+ * @brief Gets the name of a counter.
+ * @param counter The counter.
+ * @return Its name.
+ */
+const char* get_instrumentation_counter_name(const InstrumentationCounter counter)
+{
+    switch (counter)
+    {
+        case INSTRUMENTATION_INSTRUMENTS_PRICED: return "instruments_priced";
+        case INSTRUMENTATION_CALIBRATION_ITERATIONS: return "calibration_iterations";
+        case INSTRUMENTATION_CACHE_HITS: return "cache_hits";
+        case INSTRUMENTATION_CACHE_MISSES: return "cache_misses";
+        case INSTRUMENTATION_ALLOCATIONS: return "allocations";
+        default: return "unknown";
+    }
+};
+
+/**
+ * @brief Writes a snapshot, one line per stage (count, mean, p50, p99, p999 and max in
+ * nanoseconds) and one line per counter.
+ * @param out The stream.
+ * @param snapshot The snapshot.
+ */
+void write_instrumentation_snapshot(std::ostream& out, const InstrumentationSnapshot& snapshot)
+{
+    out << std::left << std::setw(16) << "stage" << std::right
+        << std::setw(12) << "count" << std::setw(12) << "mean ns" << std::setw(12) << "p50 ns"
+        << std::setw(12) << "p99 ns" << std::setw(12) << "p999 ns" << std::setw(12) << "max ns" << "\n";
+    for (std::size_t s = 0; s < INSTRUMENTATION_N_STAGES; ++s)
+    {
+        const LatencyHistogramSnapshot& stage = snapshot.stages[s];
+        out << std::left << std::setw(16) << get_instrumentation_stage_name(static_cast<InstrumentationStage>(s))
+            << std::right << std::fixed << std::setprecision(0)
+            << std::setw(12) << stage.count << std::setw(12) << stage.get_mean()
+            << std::setw(12) << stage.get_percentile(0.5) << std::setw(12) << stage.get_percentile(0.99)
+            << std::setw(12) << stage.get_percentile(0.999) << std::setw(12) << stage.max_ns << "\n";
+    }
+    for (std::size_t c = 0; c < INSTRUMENTATION_N_COUNTERS; ++c)
+    {
+        out << std::left << std::setw(28) << get_instrumentation_counter_name(static_cast<InstrumentationCounter>(c))
+            << std::right << std::setw(16) << snapshot.counters[c] << "\n";
+    }
+    out << std::left << std::setw(28) << "threads" << std::right << std::setw(16) << snapshot.n_threads << std::endl;
+};
+
+#if defined(ARBITRAGE_INSTRUMENTATION_ALLOCATIONS)
+/**
+ * @brief The global operator new, counts the allocations of the registered threads (the
+ * registration itself is not counted, the pointer of the thread is still null).
+ * @param size The size of the allocation.
+ * @return The allocated memory.
+ * @throw std::bad_alloc
+ */
+void* operator new(std::size_t size)
+{
+    if (InstrumentationThreadData* data = instrumentation_thread_data)
+    {
+        std::atomic<std::uint64_t>& value = data->counters[INSTRUMENTATION_ALLOCATIONS];
+        value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)){return p;}
+    throw std::bad_alloc();
+};
+
+/**
+ * @brief The global operator new[], counts the allocations like operator new.
+ * @param size The size of the allocation.
+ * @return The allocated memory.
+ * @throw std::bad_alloc
+ */
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+};
+
+/**
+ * @brief The global operator delete matching operator new.
+ * @param p The memory.
+ */
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+};
+
+/**
+ * @brief The global operator delete[] matching operator new[].
+ * @param p The memory.
+ */
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+};
+
+/**
+ * @brief The sized global operator delete matching operator new.
+ * @param p The memory.
+ */
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+};
+
+/**
+ * @brief The sized global operator delete[] matching operator new[].
+ * @param p The memory.
+ */
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+};
+#endif
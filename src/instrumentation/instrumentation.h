@@ -0,0 +1,202 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#if defined(ARBITRAGE_INSTRUMENTATION_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#if defined(ARBITRAGE_INSTRUMENTATION)
+constexpr bool INSTRUMENTATION_ENABLED = true;
+#else
+constexpr bool INSTRUMENTATION_ENABLED = false;
+#endif
+
+constexpr int LATENCY_HISTOGRAM_SUB_BUCKET_BITS = 5;
+
+constexpr int LATENCY_HISTOGRAM_MAX_BITS = 48;
+
+constexpr std::size_t LATENCY_HISTOGRAM_SUB_BUCKETS = std::size_t(1) << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+
+constexpr std::size_t LATENCY_HISTOGRAM_BUCKETS =
+    (LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1)*LATENCY_HISTOGRAM_SUB_BUCKETS;
+
+enum InstrumentationStage
+{
+    INSTRUMENTATION_INGESTION = 0,
+    INSTRUMENTATION_INTERPOLATION = 1,
+    INSTRUMENTATION_CALIBRATION = 2,
+    INSTRUMENTATION_PRICING = 3,
+    INSTRUMENTATION_TICK_TO_PRICE = 4,
+    INSTRUMENTATION_N_STAGES = 5
+};
+
+enum InstrumentationCounter
+{
+    INSTRUMENTATION_INSTRUMENTS_PRICED = 0,
+    INSTRUMENTATION_CALIBRATION_ITERATIONS = 1,
+    INSTRUMENTATION_CACHE_HITS = 2,
+    INSTRUMENTATION_CACHE_MISSES = 3,
+    INSTRUMENTATION_ALLOCATIONS = 4,
+    INSTRUMENTATION_N_COUNTERS = 5
+};
+
+constexpr std::size_t get_latency_histogram_bucket(std::uint64_t ns)
+{
+    constexpr std::uint64_t max_ns = (std::uint64_t(1) << LATENCY_HISTOGRAM_MAX_BITS) - 1;
+    if (ns > max_ns){ns = max_ns;}
+    if (ns < LATENCY_HISTOGRAM_SUB_BUCKETS){return static_cast<std::size_t>(ns);}
+    const int e = 63 - __builtin_clzll(ns);
+    const int shift = e - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    return (shift + 1)*LATENCY_HISTOGRAM_SUB_BUCKETS
+        + static_cast<std::size_t>((ns >> shift) & (LATENCY_HISTOGRAM_SUB_BUCKETS - 1));
+};
+
+std::uint64_t get_latency_histogram_bucket_lower(const std::size_t bucket);
+
+std::uint64_t get_latency_histogram_bucket_upper(const std::size_t bucket);
+
+class LatencyHistogram
+{
+    public:
+        LatencyHistogram();
+        ~LatencyHistogram(){};
+        inline void record(const std::uint64_t ns)
+        {
+            std::atomic<std::uint64_t>& bucket = buckets_[get_latency_histogram_bucket(ns)];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            sum_.store(sum_.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+            if (ns > max_.load(std::memory_order_relaxed)){max_.store(ns, std::memory_order_relaxed);}
+        };
+        void read(std::uint64_t* buckets, std::uint64_t& sum, std::uint64_t& max) const;
+    private:
+        std::atomic<std::uint64_t> buckets_[LATENCY_HISTOGRAM_BUCKETS];
+        std::atomic<std::uint64_t> sum_;
+        std::atomic<std::uint64_t> max_;
+};
+
+struct alignas(64) InstrumentationThreadData
+{
+    LatencyHistogram histograms[INSTRUMENTATION_N_STAGES];
+    std::atomic<std::uint64_t> counters[INSTRUMENTATION_N_COUNTERS];
+    InstrumentationThreadData();
+    ~InstrumentationThreadData(){};
+};
+
+extern thread_local InstrumentationThreadData* instrumentation_thread_data;
+
+extern double instrumentation_ns_per_tick;
+
+InstrumentationThreadData& register_instrumentation_thread();
+
+inline InstrumentationThreadData& get_instrumentation_thread_data()
+{
+    InstrumentationThreadData* data = instrumentation_thread_data;
+    return data ? *data : register_instrumentation_thread();
+};
+
+inline void instrumentation_add(const InstrumentationCounter counter, const std::uint64_t n)
+{
+    std::atomic<std::uint64_t>& value = get_instrumentation_thread_data().counters[counter];
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+};
+
+inline void instrumentation_record(const InstrumentationStage stage, const long long ns)
+{
+    get_instrumentation_thread_data().histograms[stage].record(ns > 0 ? static_cast<std::uint64_t>(ns) : 0);
+};
+
+inline long long instrumentation_ticks()
+{
+#if defined(ARBITRAGE_INSTRUMENTATION_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+    return static_cast<long long>(__rdtsc());
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+};
+
+inline long long instrumentation_ticks_to_ns(const long long ticks)
+{
+#if defined(ARBITRAGE_INSTRUMENTATION_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+    return static_cast<long long>(ticks*instrumentation_ns_per_tick);
+#else
+    return ticks;
+#endif
+};
+
+inline long long instrumentation_wall_clock_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+};
+
+class InstrumentationScopedTimer
+{
+    public:
+        InstrumentationScopedTimer(const InstrumentationStage stage): stage_(stage), start_(instrumentation_ticks()){};
+        ~InstrumentationScopedTimer(){instrumentation_record(stage_, instrumentation_ticks_to_ns(instrumentation_ticks() - start_));};
+        InstrumentationScopedTimer(const InstrumentationScopedTimer&) = delete;
+        InstrumentationScopedTimer& operator=(const InstrumentationScopedTimer&) = delete;
+    private:
+        const InstrumentationStage stage_;
+        const long long start_;
+};
+
+struct LatencyHistogramSnapshot
+{
+    std::vector<std::uint64_t> buckets;
+    std::uint64_t count;
+    std::uint64_t sum_ns;
+    std::uint64_t max_ns;
+    LatencyHistogramSnapshot();
+    ~LatencyHistogramSnapshot(){};
+    void add(const LatencyHistogram& histogram);
+    double get_percentile(const double q) const;
+    double get_mean() const;
+};
+
+struct InstrumentationSnapshot
+{
+    std::vector<LatencyHistogramSnapshot> stages;
+    std::vector<std::uint64_t> counters;
+    std::size_t n_threads;
+    InstrumentationSnapshot();
+    ~InstrumentationSnapshot(){};
+    InstrumentationSnapshot since(const InstrumentationSnapshot& earlier) const;
+};
+
+InstrumentationSnapshot get_instrumentation_snapshot();
+
+const char* get_instrumentation_stage_name(const InstrumentationStage stage);
+
+const char* get_instrumentation_counter_name(const InstrumentationCounter counter);
+
+void write_instrumentation_snapshot(std::ostream& out, const InstrumentationSnapshot& snapshot);
+
+#define ARBITRAGE_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define ARBITRAGE_INSTRUMENTATION_CONCAT(a, b) ARBITRAGE_INSTRUMENTATION_CONCAT_(a, b)
+
+#if defined(ARBITRAGE_INSTRUMENTATION)
+#define ARBITRAGE_INSTRUMENT_SCOPE(stage) \
+    InstrumentationScopedTimer ARBITRAGE_INSTRUMENTATION_CONCAT(instrumentation_timer_, __LINE__)(stage)
+#define ARBITRAGE_INSTRUMENT_COUNT(counter, n) instrumentation_add(counter, n)
+#define ARBITRAGE_INSTRUMENT_LATENCY(stage, ns) instrumentation_record(stage, ns)
+#define ARBITRAGE_INSTRUMENT_TICK_TO_PRICE(exchange_ns) \
+    instrumentation_record(INSTRUMENTATION_TICK_TO_PRICE, instrumentation_wall_clock_ns() - (exchange_ns))
+#else
+#define ARBITRAGE_INSTRUMENT_SCOPE(stage)
+#define ARBITRAGE_INSTRUMENT_COUNT(counter, n)
+#define ARBITRAGE_INSTRUMENT_LATENCY(stage, ns)
+#define ARBITRAGE_INSTRUMENT_TICK_TO_PRICE(exchange_ns)
+#endif
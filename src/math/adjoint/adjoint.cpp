@@ -0,0 +1,228 @@
+#include "adjoint.h"
+
+/**
+* @file adjoint.h
+* @brief This file defines a tape based reverse mode automatic differentiation (AAD).
+*
+* The computations are written once as templates of their number type: with double they only
+* compute values, with AdjointDouble every elementary operation also records a node (its at
+* most two parents and the partial derivatives with respect to them) on an AdjointTape. A
+* reverse sweep of the tape then propagates the adjoint of an output back to every input, so
+* that all the sensitivities of a scalar cost a small multiple of its evaluation, whatever the
+* number of inputs.
+*
+* The tape is a flat vector reused between the calls, it does not allocate once it reached its
+* working size. For a sum of independent terms (the legs of a book), each term can be swept
+* and rewound on its own (AdjointTape::reverse then AdjointTape::rewind) so that the tape stays
+* in the cache, the shared nodes recorded before accumulating the adjoints of every term.
+*
+* References :
+* - "Evaluating Derivatives: Principles and Techniques of Algorithmic Differentiation", Griewank,
+* Walther, 2008.
+* - "Smoking adjoints: fast Monte Carlo Greeks", Giles, Glasserman, 2006.
+* - "Modern Computational Finance: AAD and Parallel Simulations", Savine, 2018.
+*/
+
+/**
+ * @class AdjointTapeFull
+ * @brief Definition of the error when the tape exceeds the 2^32 - 1 nodes of its indices.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * AdjointTapeFull::what() const throw(){
+    return "The adjoint tape cannot hold more than 2^32 - 1 nodes, sweep and rewind it before.";
+};
+
+/**
+ * @struct AdjointNode
+ * @brief A node of the tape: the indices of its (at most two) parents and its partial
+ * derivatives with respect to them. A variable has zero partials, a unary operation a zero
+ * second partial.
+ */
+
+/**
+ * @struct AdjointDouble
+ * @brief The active number type: its value, the index of its node and its tape.
+ */
+
+/**
+ * @struct AdjointTape
+ * @brief The tape of the nodes and their adjoints.
+ */
+
+/**
+ * @var std::vector<AdjointNode> AdjointTape::nodes
+ * @brief The nodes, in the order of the evaluation.
+ */
+
+/**
+ * @var std::vector<double> AdjointTape::adjoints
+ * @brief The adjoints of the nodes.
+ */
+
+/**
+ * @brief The constructor reserving the nodes.
+ * @param capacity The number of nodes reserved.
+ */
+AdjointTape::AdjointTape(const std::size_t capacity)
+{
+    nodes.reserve(capacity);
+    adjoints.reserve(capacity);
+};
+
+/**
+ * @brief Records an input.
+ * @param value The value of the input.
+ * @return The input.
+ * @throw AdjointTapeFull
+ */
+AdjointDouble AdjointTape::variable(const double value)
+{
+    const std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+    return push(value, index, 0.0, index, 0.0);
+};
+
+/**
+ * @fn AdjointDouble AdjointTape::push(const double value, const std::uint32_t p0, const double d0, const std::uint32_t p1, const double d1)
+ * @brief Records a binary operation.
+ * @param value The value of the result.
+ * @param p0 The index of the first operand.
+ * @param d0 The partial derivative with respect to the first operand.
+ * @param p1 The index of the second operand.
+ * @param d1 The partial derivative with respect to the second operand.
+ * @return The result.
+ * @throw AdjointTapeFull
+ */
+
+/**
+ * @fn AdjointDouble AdjointTape::push(const double value, const std::uint32_t p0, const double d0)
+ * @brief Records a unary operation.
+ * @param value The value of the result.
+ * @param p0 The index of the operand.
+ * @param d0 The derivative with respect to the operand.
+ * @return The result.
+ * @throw AdjointTapeFull
+ */
+
+/**
+ * @fn AdjointDouble operator+(const AdjointDouble& x, const AdjointDouble& y)
+ * @brief The arithmetic operators +, -, * and / of two active numbers, or of an active and a
+ * passive number (only the active operand gets a partial derivative), and the unary minus.
+ * @param x The first operand.
+ * @param y The second operand.
+ * @return The result, recorded on the tape of the active operand.
+ * @throw AdjointTapeFull
+ */
+
+/**
+ * @fn AdjointDouble sqrt(const AdjointDouble& x)
+ * @brief The functions sqrt, exp and log of an active number.
+ * @param x The operand.
+ * @return The result, recorded on the tape of the operand.
+ * @throw AdjointTapeFull
+ */
+
+/**
+ * @fn AdjointDouble pow(const AdjointDouble& x, const AdjointDouble& y)
+ * @brief The power of two active numbers.
+ * @param x The base, positive.
+ * @param y The exponent.
+ * @return The result, recorded on the tape of the base.
+ * @throw AdjointTapeFull
+ */
+
+/**
+ * @fn double get_value(const AdjointDouble& x)
+ * @param x A passive or an active number.
+ * @return Its value.
+ */
+
+/**
+ * @return The number of nodes.
+ */
+std::size_t AdjointTape::size() const
+{
+    return nodes.size();
+};
+
+/**
+ * @brief Adds to the adjoint of an output, its weight in the differentiated scalar.
+ * @param y The output.
+ * @param adjoint The adjoint added.
+ */
+void AdjointTape::seed(const AdjointDouble& y, const double adjoint)
+{
+    adjoints[y.index] += adjoint;
+};
+
+/**
+ * @brief Propagates the adjoints of the nodes from the last one down to the node begin, into
+ * their parents. The adjoints of the nodes before begin accumulate: after a sweep the range
+ * must be rewound before the next seed, and the nodes before it swept last.
+ * @param begin The first node swept.
+ */
+void AdjointTape::reverse(const std::size_t begin)
+{
+    const AdjointNode* node = nodes.data();
+    double* adjoint = adjoints.data();
+    for (std::size_t i = nodes.size(); i-- > begin;){
+        const double a = adjoint[i];
+        if (a == 0.0){continue;}
+        adjoint[node[i].parent[0]] += node[i].partial[0]*a;
+        adjoint[node[i].parent[1]] += node[i].partial[1]*a;
+    }
+};
+
+/**
+ * @brief Removes the nodes from the node begin, their memory is kept.
+ * @param begin The first node removed.
+ */
+void AdjointTape::rewind(const std::size_t begin)
+{
+    if (begin < nodes.size()){
+        nodes.resize(begin);
+        adjoints.resize(begin);
+    }
+};
+
+/**
+ * @param x A node.
+ * @return Its adjoint.
+ */
+double AdjointTape::get_adjoint(const AdjointDouble& x) const
+{
+    return adjoints[x.index];
+};
+
+/**
+ * @brief Removes every node, their memory is kept.
+ */
+void AdjointTape::clear()
+{
+    rewind(0);
+};
+
+/**
+ * @brief The standard normal cdf of a passive number.
+ * @param x The value.
+ * @return The cdf, see NormalDistribution::cdf.
+ */
+double adjoint_normal_cdf(const double x)
+{
+    NormalDistribution stdnorm = NormalDistribution();
+    return stdnorm.cdf(x);
+};
+
+/**
+ * @brief The standard normal cdf of an active number, its derivative is the pdf.
+ * @param x The value.
+ * @return The cdf, see NormalDistribution::cdf.
+ * @throw AdjointTapeFull
+ */
+AdjointDouble adjoint_normal_cdf(const AdjointDouble& x)
+{
+    NormalDistribution stdnorm = NormalDistribution();
+    return x.tape->push(stdnorm.cdf(x.value), x.index, stdnorm.pdf(x.value));
+};
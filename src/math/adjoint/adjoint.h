@@ -0,0 +1,119 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "../../math/probability/normal/normal.h"
+
+class AdjointTapeFull:  public std::exception
+{public: const char * what() const throw();};
+
+struct AdjointNode
+{
+    double partial[2];
+    std::uint32_t parent[2];
+};
+
+struct AdjointTape;
+
+struct AdjointDouble
+{
+    double value;
+    std::uint32_t index;
+    AdjointTape* tape;
+};
+
+struct AdjointTape
+{
+    std::vector<AdjointNode> nodes;
+    std::vector<double> adjoints;
+    AdjointTape(){};
+    AdjointTape(const std::size_t capacity);
+    ~AdjointTape(){};
+    AdjointDouble variable(const double value);
+    inline AdjointDouble push(const double value, const std::uint32_t p0, const double d0, const std::uint32_t p1, const double d1)
+    {
+        if (nodes.size() >= std::numeric_limits<std::uint32_t>::max()){throw AdjointTapeFull();}
+        const std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+        nodes.push_back({{d0, d1}, {p0, p1}});
+        adjoints.push_back(0.0);
+        return {value, index, this};
+    };
+    inline AdjointDouble push(const double value, const std::uint32_t p0, const double d0)
+    {
+        return push(value, p0, d0, p0, 0.0);
+    };
+    std::size_t size() const;
+    void seed(const AdjointDouble& y, const double adjoint);
+    void reverse(const std::size_t begin);
+    void rewind(const std::size_t begin);
+    double get_adjoint(const AdjointDouble& x) const;
+    void clear();
+};
+
+inline AdjointDouble operator+(const AdjointDouble& x, const AdjointDouble& y)
+{return x.tape->push(x.value + y.value, x.index, 1.0, y.index, 1.0);};
+inline AdjointDouble operator+(const AdjointDouble& x, const double y)
+{return x.tape->push(x.value + y, x.index, 1.0);};
+inline AdjointDouble operator+(const double x, const AdjointDouble& y)
+{return y.tape->push(x + y.value, y.index, 1.0);};
+
+inline AdjointDouble operator-(const AdjointDouble& x, const AdjointDouble& y)
+{return x.tape->push(x.value - y.value, x.index, 1.0, y.index, -1.0);};
+inline AdjointDouble operator-(const AdjointDouble& x, const double y)
+{return x.tape->push(x.value - y, x.index, 1.0);};
+inline AdjointDouble operator-(const double x, const AdjointDouble& y)
+{return y.tape->push(x - y.value, y.index, -1.0);};
+inline AdjointDouble operator-(const AdjointDouble& x)
+{return x.tape->push(-x.value, x.index, -1.0);};
+
+inline AdjointDouble operator*(const AdjointDouble& x, const AdjointDouble& y)
+{return x.tape->push(x.value*y.value, x.index, y.value, y.index, x.value);};
+inline AdjointDouble operator*(const AdjointDouble& x, const double y)
+{return x.tape->push(x.value*y, x.index, y);};
+inline AdjointDouble operator*(const double x, const AdjointDouble& y)
+{return y.tape->push(x*y.value, y.index, x);};
+
+inline AdjointDouble operator/(const AdjointDouble& x, const AdjointDouble& y)
+{
+    const double inverse = 1.0/y.value;
+    const double value = x.value*inverse;
+    return x.tape->push(value, x.index, inverse, y.index, -value*inverse);
+};
+inline AdjointDouble operator/(const AdjointDouble& x, const double y)
+{return x.tape->push(x.value/y, x.index, 1.0/y);};
+inline AdjointDouble operator/(const double x, const AdjointDouble& y)
+{
+    const double value = x/y.value;
+    return y.tape->push(value, y.index, -value/y.value);
+};
+
+inline AdjointDouble sqrt(const AdjointDouble& x)
+{
+    const double value = std::sqrt(x.value);
+    return x.tape->push(value, x.index, .5/value);
+};
+
+inline AdjointDouble exp(const AdjointDouble& x)
+{
+    const double value = std::exp(x.value);
+    return x.tape->push(value, x.index, value);
+};
+
+inline AdjointDouble log(const AdjointDouble& x)
+{return x.tape->push(std::log(x.value), x.index, 1.0/x.value);};
+
+inline AdjointDouble pow(const AdjointDouble& x, const AdjointDouble& y)
+{
+    const double value = std::pow(x.value, y.value);
+    return x.tape->push(value, x.index, y.value*value/x.value, y.index, value*std::log(x.value));
+};
+
+inline double get_value(const double x){return x;};
+
+inline double get_value(const AdjointDouble& x){return x.value;};
+
+double adjoint_normal_cdf(const double x);
+
+AdjointDouble adjoint_normal_cdf(const AdjointDouble& x);
@@ -11,61 +11,185 @@
 */
 
 /** 
- * @brief The main constructor
+ * @class CubicSpline2DWrongPillar
+ * @brief Definition of the error when updating a pillar which does not exist. 
+ * 
+ */
+
+/** 
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * CubicSpline2DWrongPillar::what() const throw(){
+    return "The pillar to update must be an index of the x-axis.";
+};
+
+/** 
+ * @brief The constructor from a map of the coordinates.
  * @param mapped_x_y_ The map representing the coordinates to interpolate from. 
  * @throw InterpolationMinimalVectorSize
  * @throw Interpolation2DWrongXaxis
  */
-CubicSpline2D::CubicSpline2D(std::map<double, double> mapped_x_y_): 
+CubicSpline2D::CubicSpline2D(const std::map<double, double>& mapped_x_y_): 
     Interpolation2D(mapped_x_y_)
 {
+    initialize();
+};
+
+/** 
+ * @brief The main constructor, the vectors can be moved in.
+ * @param x_ The independant values, strictly increasing.
+ * @param y_ The dependant values.
+ * @throw InterpolationMinimalVectorSize
+ * @throw Interpolation2DWrongXaxis
+ * @throw Interpolation2DWrongYaxis
+ */
+CubicSpline2D::CubicSpline2D(std::vector<double> x_, std::vector<double> y_): 
+    Interpolation2D(std::move(x_), std::move(y_))
+{
+    initialize();
+};
+
+/** 
+ * @brief The constructor from contiguous arrays.
+ * @param x_ The independant values, strictly increasing.
+ * @param y_ The dependant values.
+ * @param n The number of coordinates.
+ * @throw InterpolationMinimalVectorSize
+ * @throw Interpolation2DWrongXaxis
+ */
+CubicSpline2D::CubicSpline2D(const double* x_, const double* y_, std::size_t n): 
+    Interpolation2D(x_, y_, n)
+{
+    initialize();
+};
+
+/**
+ * @brief Allocates the coefficients and the workspace once and fits the spline.
+ */
+void CubicSpline2D::initialize()
+{
+    const std::size_t n = Interpolation2D::x.size() - 1;
+    a_.resize(n + 1);
+    b_.resize(n);
+    c_.resize(n + 1);
+    d_.resize(n);
+    h_.resize(n);
+    l_.resize(n + 1);
+    mu_.resize(n + 1);
+    z_.resize(n + 1);
     get_parameters();
 };
 
 /**
 * @brief Set the cubic spline parameters. This methods basically estimate each polynomial's parameters 
 * by solving a system of equations from: the spline continuity condition and the boundary conditions. 
+* The tridiagonal factorization (h, l, mu) is kept for CubicSpline2D::update_pillar and the 
+* workspace is allocated once at construction.
  */
 void CubicSpline2D::get_parameters()
 {
-    std::vector<double> x = Interpolation2D::x;
-    std::vector<double> y = Interpolation2D::y;
-    int n = x.size() - 1;
-    x_ = Interpolation2D::x;
-    a_ = Interpolation2D::y;
-
-    std::vector<double> h(n), alpha(n);
-    for (int i = 0; i < n; ++i) {
-        h[i] = x[i + 1] - x[i];
-    }
+    const std::vector<double>& x = Interpolation2D::x;
+    const std::size_t n = x.size() - 1;
+    std::copy(Interpolation2D::y.begin(), Interpolation2D::y.end(), a_.begin());
 
-    for (int i = 1; i < n; ++i) {
-        alpha[i] = (3.0 / h[i]) * (a_[i + 1] - a_[i]) - (3.0 / h[i - 1]) * (a_[i] - a_[i - 1]);
+    for (std::size_t i = 0; i < n; ++i) {
+        h_[i] = x[i + 1] - x[i];
     }
 
-    std::vector<double> l(n + 1), mu(n), z(n + 1);
-    l[0] = 1.0;
-    mu[0] = 0.0;
-    z[0] = 0.0;
+    l_[0] = 1.0;
+    mu_[0] = 0.0;
+    z_[0] = 0.0;
 
-    for (int i = 1; i < n; ++i) {
-        l[i] = 2.0 * (x[i + 1] - x[i - 1]) - h[i - 1] * mu[i - 1];
-        mu[i] = h[i] / l[i];
-        z[i] = (alpha[i] - h[i - 1] * z[i - 1]) / l[i];
+    for (std::size_t i = 1; i < n; ++i) {
+        double alpha = (3.0 / h_[i]) * (a_[i + 1] - a_[i]) - (3.0 / h_[i - 1]) * (a_[i] - a_[i - 1]);
+        l_[i] = 2.0 * (x[i + 1] - x[i - 1]) - h_[i - 1] * mu_[i - 1];
+        mu_[i] = h_[i] / l_[i];
+        z_[i] = (alpha - h_[i - 1] * z_[i - 1]) / l_[i];
     }
 
-    l[n] = 1.0;
-    z[n] = 0.0;
-    c_.resize(n + 1);
-    b_.resize(n);
-    d_.resize(n);
+    l_[n] = 1.0;
+    mu_[n] = 0.0;
+    z_[n] = 0.0;
     c_[n] = 0.0;
 
-    for (int j = n - 1; j >= 0; --j) {
-        c_[j] = z[j] - mu[j] * c_[j + 1];
-        b_[j] = (a_[j + 1] - a_[j]) / h[j] - h[j] * (c_[j + 1] + 2.0 * c_[j]) / 3.0;
-        d_[j] = (c_[j + 1] - c_[j]) / (3.0 * h[j]);
+    for (std::size_t k = n; k-- > 0;) {
+        c_[k] = z_[k] - mu_[k] * c_[k + 1];
     }
+    update_polynomials(0, n);
+};
+
+/**
+ * @brief Recomputes the b and d coefficients of the polynomials [begin, end) from a and c.
+ * @param begin The first polynomial.
+ * @param end The polynomial after the last one.
+ */
+void CubicSpline2D::update_polynomials(std::size_t begin, std::size_t end)
+{
+    for (std::size_t j = begin; j < end; ++j) {
+        b_[j] = (a_[j + 1] - a_[j]) / h_[j] - h_[j] * (c_[j + 1] + 2.0 * c_[j]) / 3.0;
+        d_[j] = (c_[j + 1] - c_[j]) / (3.0 * h_[j]);
+    }
+};
+
+/**
+ * @brief Moves the y value of one pillar without refitting the spline and without allocation.
+ *
+ * The tridiagonal matrix only depends on the x-axis, so its factorization is reused and only the
+ * right hand side changes, on at most 3 rows around the pillar. The change of the c coefficients
+ * is the solution of the factorized system for that sparse right hand side: it decays
+ * geometrically (by a factor of at most 2/3 per interval, about 0.27 on an even grid) on both
+ * sides of the pillar, so the forward and backward substitutions stop as soon as the change is
+ * below the rounding error of the largest change. Only the polynomials whose coefficients moved
+ * are recomputed: the cost is a few tens of operations instead of a full O(n) refit, and the
+ * result matches a refit up to rounding.
+ *
+ * @param i The index of the pillar.
+ * @param new_y The new y value of the pillar.
+ * @throw CubicSpline2DWrongPillar
+ */
+void CubicSpline2D::update_pillar(std::size_t i, double new_y)
+{
+    const std::size_t n = Interpolation2D::x.size() - 1;
+    if (i > n){throw CubicSpline2DWrongPillar();}
+    const double delta = new_y - a_[i];
+    a_[i] = new_y;
+    Interpolation2D::y[i] = new_y;
+    if (delta == 0.0){return;}
+    if (n < 2){update_polynomials(0, n); return;}
+
+    const double epsilon = std::numeric_limits<double>::epsilon();
+    const std::size_t first = i > 1 ? i - 1 : 1;
+    const std::size_t last_source = std::min(i + 1, n - 1);
+
+    double delta_z = 0.0;
+    double max_delta = 0.0;
+    std::size_t end = first;
+    for (std::size_t k = first; k < n; ++k) {
+        double delta_alpha = 0.0;
+        if (k + 1 == i) {delta_alpha = 3.0 * delta / h_[k];}
+        else if (k == i) {delta_alpha = -3.0 * delta / h_[k] - 3.0 * delta / h_[k - 1];}
+        else if (k == i + 1) {delta_alpha = 3.0 * delta / h_[k - 1];}
+        delta_z = (delta_alpha - h_[k - 1] * delta_z) / l_[k];
+        z_[k] = delta_z;
+        max_delta = std::max(max_delta, fabs(delta_z));
+        end = k;
+        if (k >= last_source && fabs(delta_z) <= epsilon * max_delta) {break;}
+    }
+
+    double delta_c = 0.0;
+    std::size_t begin = end + 1;
+    for (std::size_t k = end + 1; k-- > 1;) {
+        delta_c = (k >= first ? z_[k] : 0.0) - mu_[k] * delta_c;
+        c_[k] += delta_c;
+        max_delta = std::max(max_delta, fabs(delta_c));
+        begin = k;
+        if (k < first && fabs(delta_c) <= epsilon * max_delta) {break;}
+    }
+
+    const std::size_t poly_begin = std::min(begin - 1, i > 0 ? i - 1 : 0);
+    const std::size_t poly_end = std::min(std::max(end + 1, i + 1), n);
+    update_polynomials(poly_begin, poly_end);
 };
 
 /**
@@ -75,20 +199,57 @@ void CubicSpline2D::get_parameters()
  */
 double CubicSpline2D::evaluate(double x_)
 {
-    if (x_ < Interpolation2D::x_min || x_ > Interpolation2D::x_max){ 
+    if (!(x_ >= Interpolation2D::x_min && x_ <= Interpolation2D::x_max)){ 
         throw Interpolation2DOutOfRange();}
 
-    if(x_==Interpolation2D::x_max){return Interpolation2D::mapped_x_y.at(x_max);}
+    if(x_==Interpolation2D::x_max){return Interpolation2D::y.back();}
 
-    int i = 0;
-    for (int j = 1; j < Interpolation2D::x.size(); ++j) {
-        if (x_ < Interpolation2D::x[j]) {
-            i = j - 1;
-            break;
-        }
-    }
+    std::size_t i = Interpolation2D::find_interval(x_);
     double dx = x_ - Interpolation2D::x[i];
-    return a_[i] + b_[i] * dx + c_[i] * dx * dx + d_[i] * dx * dx * dx;
+    return a_[i] + dx * (b_[i] + dx * (c_[i] + dx * d_[i]));
+};
+
+/**
+ * @param x_ The value to interpolate.
+ * @param hint The interval cursor, see Interpolation2D::find_interval.
+ * @return The cubic spline interpolated value.
+ * @throw Interpolation2DOutOfRange
+ */
+double CubicSpline2D::evaluate(double x_, std::size_t& hint)
+{
+    if (!(x_ >= Interpolation2D::x_min && x_ <= Interpolation2D::x_max)){ 
+        throw Interpolation2DOutOfRange();}
+
+    if(x_==Interpolation2D::x_max){return Interpolation2D::y.back();}
 
+    std::size_t i = Interpolation2D::find_interval(x_, hint);
+    double dx = x_ - Interpolation2D::x[i];
+    return a_[i] + dx * (b_[i] + dx * (c_[i] + dx * d_[i]));
+};
 
+/**
+ * @brief Evaluates the polynomials of a block of values whose intervals are known. The loop
+ * has no branch (the upper bound is handled with a select) so that the compiler can vectorize it.
+ * @param x_ The values to interpolate.
+ * @param intervals The interval of each value.
+ * @param out The interpolated values.
+ * @param n The number of values.
+ */
+void CubicSpline2D::evaluate_intervals(
+    const double* x_, const std::size_t* intervals, double* out, std::size_t n)
+{
+    const double* xs = Interpolation2D::x.data();
+    const double* a = a_.data();
+    const double* b = b_.data();
+    const double* c = c_.data();
+    const double* d = d_.data();
+    const double y_max = Interpolation2D::y.back();
+    const double x_max_ = Interpolation2D::x_max;
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        const std::size_t i = intervals[k];
+        const double dx = x_[k] - xs[i];
+        const double value = a[i] + dx * (b[i] + dx * (c[i] + dx * d[i]));
+        out[k] = x_[k] == x_max_ ? y_max : value;
+    }
 };
\ No newline at end of file
@@ -1,18 +1,31 @@
 #pragma once
 #include <iostream>
 #include <map>
+#include <limits>
 #include "../../../math/interpolation2D/interpolation.h"
 
+class CubicSpline2DWrongPillar:  public std::exception 
+{public: const char * what() const throw();};
+
 class CubicSpline2D: public Interpolation2D
 {
     public :
-        CubicSpline2D(std::map<double, double> mapped_x_y_);
+        CubicSpline2D(const std::map<double, double>& mapped_x_y_);
+        CubicSpline2D(std::vector<double> x_, std::vector<double> y_);
+        CubicSpline2D(const double* x_, const double* y_, std::size_t n);
         double evaluate(double x_) override; 
+        double evaluate(double x_, std::size_t& hint) override; 
+        using Interpolation2D::evaluate;
         void get_parameters();
+        void update_pillar(std::size_t i, double new_y);
         ~CubicSpline2D(){};
+    protected :
+        void evaluate_intervals(
+            const double* x_, const std::size_t* intervals, double* out, std::size_t n) override;
     private : 
-        std::vector<double> x_;
         std::vector<double> a_, b_, c_, d_;
+        std::vector<double> h_, l_, mu_, z_;
+        void initialize();
+        void update_polynomials(std::size_t begin, std::size_t end);
 
-};
-
+};
\ No newline at end of file
@@ -49,14 +49,24 @@ const char * Interpolation2DWrongXaxis::what() const throw(){
 };
 
 /** 
-* @class Interpolation2D
-* @brief Definition of the 2-dimension interpolation base class.  
-*/
+ * @class Interpolation2DWrongYaxis
+ * @brief Definition of the error when the y-axis does not match the x-axis. 
+ * 
+ */
 
-/**
- * @var double Interpolation2D::mapped_x_y
- * @brief The map representing the coordinates to interpolate from.
+/** 
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
  */
+const char * Interpolation2DWrongYaxis::what() const throw(){
+    return "The y-axis must have the same size as the x-axis.";
+};
+
+/** 
+* @class Interpolation2D
+* @brief Definition of the 2-dimension interpolation base class. The coordinates are stored
+* once, in two contiguous vectors, and the map of the coordinates is only built on demand.
+*/
 
 /**
  * @var double Interpolation2D::x
@@ -78,42 +88,269 @@ const char * Interpolation2DWrongXaxis::what() const throw(){
  * @brief The upper bound from which a value can be interpolated.
  */
 
+/**
+ * @var bool Interpolation2D::uniform
+ * @brief True if the x-axis is evenly spaced, the interval of a value is then found in O(1).
+ */
+
+/**
+ * @var double Interpolation2D::inverse_step
+ * @brief The inverse of the x-axis step if the x-axis is evenly spaced.
+ */
+
+/**
+ * @brief Finds the interval of a sorted axis containing a value with a branchless binary search.
+ * The loop has a fixed number of iterations for a given size and the comparison compiles to a
+ * conditional move, so that the search does not suffer from branch mispredictions.
+ * @param x The sorted axis.
+ * @param n The size of the axis, at least 2.
+ * @param value The value to locate.
+ * @return The index i in [0, n-2] of the last node such that x[i] <= value (0 if value < x[0]).
+ */
+std::size_t locate_interval(const double* x, std::size_t n, double value)
+{
+    const double* base = x;
+    std::size_t length = n - 1;
+    while (length > 1)
+    {
+        const std::size_t half = length / 2;
+        base = (base[half] <= value) ? base + half : base;
+        length -= half;
+    }
+    return base - x;
+};
+
 /** 
- * @brief The main constructor
+ * @brief The constructor from a map of the coordinates, which is copied into the vectors.
  * @param mapped_x_y_ The map representing the coordinates to interpolate from. 
  * @throw Interpolation2DMinimalVectorSize
  * @throw Interpolation2DWrongXaxis
  */
-Interpolation2D::Interpolation2D(std::map<double, double> mapped_x_y_): 
-    mapped_x_y(mapped_x_y_), x(get_x_values()), x_max(*std::max_element(x.begin(), x.end())), 
-    y(*std::min_element(x.begin(), x.end())){};
+Interpolation2D::Interpolation2D(const std::map<double, double>& mapped_x_y_): 
+    Interpolation2D(get_keys(mapped_x_y_), get_values(mapped_x_y_)){};
+
+/** 
+ * @brief The main constructor, the vectors can be moved in so that the coordinates are not copied.
+ * @param x_ The independant values, strictly increasing.
+ * @param y_ The dependant values.
+ * @throw Interpolation2DMinimalVectorSize
+ * @throw Interpolation2DWrongXaxis
+ * @throw Interpolation2DWrongYaxis
+ */
+Interpolation2D::Interpolation2D(std::vector<double> x_, std::vector<double> y_): 
+    x(check_x_values(std::move(x_))), y(check_y_values(std::move(y_), x.size())), 
+    x_min(x.front()), x_max(x.back()), uniform(is_uniform()), 
+    inverse_step((x.size()-1)/(x_max-x_min)){};
+
+/** 
+ * @brief The constructor from contiguous arrays, copied once.
+ * @param x_ The independant values, strictly increasing.
+ * @param y_ The dependant values.
+ * @param n The number of coordinates.
+ * @throw Interpolation2DMinimalVectorSize
+ * @throw Interpolation2DWrongXaxis
+ */
+Interpolation2D::Interpolation2D(const double* x_, const double* y_, std::size_t n): 
+    Interpolation2D(std::vector<double>(x_, x_+n), std::vector<double>(y_, y_+n)){};
 
 /**
+ * @brief Checks that the x-axis has at least 2 values and is strictly increasing.
+ * @param x_ The x-axis.
  * @return The x-axis.
+ * @throw Interpolation2DMinimalVectorSize
+ * @throw Interpolation2DWrongXaxis
+ */
+std::vector<double> Interpolation2D::check_x_values(std::vector<double> x_)
+{
+    if (x_.size()<2){throw Interpolation2DMinimalVectorSize();}
+    for (std::size_t i = 1; i < x_.size(); ++i)
+    {
+        if (!(x_[i-1] < x_[i])){throw Interpolation2DWrongXaxis();}
+    }
+    return x_;
+};
+
+/**
+ * @brief Checks that the y-axis has the size of the x-axis.
+ * @param y_ The y-axis.
+ * @param n The size of the x-axis.
+ * @return The y-axis.
+ * @throw Interpolation2DWrongYaxis
+ */
+std::vector<double> Interpolation2D::check_y_values(std::vector<double> y_, std::size_t n)
+{
+    if (y_.size()!=n){throw Interpolation2DWrongYaxis();}
+    return y_;
+};
+
+/**
+ * @param mapped_x_y_ The map representing the coordinates.
+ * @return The keys of the map.
  */
-std::vector<double> Interpolation2D::get_x_values()
+std::vector<double> Interpolation2D::get_keys(const std::map<double, double>& mapped_x_y_)
 {
     std::vector<double> keys;
-    int i = 0;
-    for(auto const& imap: mapped_x_y)
+    keys.reserve(mapped_x_y_.size());
+    for(auto const& imap: mapped_x_y_)
         keys.push_back(imap.first);
-        if (i>0){
-            if (keys[i-1]>keys[i]){throw Interpolation2DWrongXaxis();}
-        }
-        i++;
-        
-        
-    if (keys.size()<2){throw Interpolation2DMinimalVectorSize();}
     return keys;
 };
 
+/**
+ * @param mapped_x_y_ The map representing the coordinates.
+ * @return The values of the map.
+ */
+std::vector<double> Interpolation2D::get_values(const std::map<double, double>& mapped_x_y_)
+{
+    std::vector<double> values;
+    values.reserve(mapped_x_y_.size());
+    for(auto const& imap: mapped_x_y_)
+        values.push_back(imap.second);
+    return values;
+};
+
+/**
+ * @return The x-axis.
+ */
+const std::vector<double>& Interpolation2D::get_x_values()
+{
+    return x;
+};
+
 /**
  * @return The y-axis.
  */
-std::vector<double> Interpolation2D::get_y_values()
+const std::vector<double>& Interpolation2D::get_y_values()
 {
-    std::vector<double> keys;
-    for(auto const& imap: mapped_x_y)
-        keys.push_back(imap.second);
-    return keys;
+    return y;
+};
+
+/**
+ * @brief Builds the map of the coordinates. It is not stored: the evaluation never uses it.
+ * @return The map representing the coordinates.
+ */
+std::map<double, double> Interpolation2D::get_mapped_x_y()
+{
+    std::map<double, double> mapped_x_y;
+    for (std::size_t i = 0; i < x.size(); ++i)
+        mapped_x_y.emplace_hint(mapped_x_y.end(), x[i], y[i]);
+    return mapped_x_y;
 };
+
+/**
+ * @return True if the x-axis steps are all equal up to a relative 1e-12, false else.
+ */
+bool Interpolation2D::is_uniform()
+{
+    const double step = (x.back()-x.front())/(x.size()-1);
+    for (std::size_t i = 1; i < x.size(); ++i)
+    {
+        if (fabs((x[i]-x[i-1]) - step) > 1e-12*step){return false;}
+    }
+    return true;
+};
+
+/**
+ * @brief Finds the interval containing a value: in O(1) by direct indexing on an evenly
+ * spaced x-axis, with a branchless binary search in O(log n) else. The position is clamped to
+ * [0, n-2] before the conversion to an index, a value out of range (or NaN) gets the first or
+ * the last interval.
+ * @param x_ The value, in [x_min, x_max].
+ * @return The index i in [0, n-2] such that x[i] <= x_ <= x[i+1].
+ */
+std::size_t Interpolation2D::find_interval(double x_)
+{
+    const std::size_t last = x.size()-2;
+    if (uniform)
+    {
+        const double position = (x_-x_min)*inverse_step;
+        std::size_t i = 0;
+        if (position >= static_cast<double>(last)){i = last;}
+        else if (position > 0.){i = static_cast<std::size_t>(position);}
+        if (x_ < x[i] && i > 0){--i;}
+        else if (i < last && x_ >= x[i+1]){++i;}
+        return i;
+    }
+    return locate_interval(x.data(), x.size(), x_);
+};
+
+/**
+ * @brief Finds the interval containing a value starting from a cursor. The search
+ * gallops from the cursor (1, 2, 4, ... intervals ahead or behind), so that evaluating
+ * sorted values in order costs amortized O(1) per value. The cursor is owned by the caller,
+ * it can start at 0 and it is moved to the interval found. On an evenly spaced x-axis the
+ * direct indexing is used instead.
+ * @param x_ The value, in [x_min, x_max].
+ * @param hint The cursor, updated.
+ * @return The index i in [0, n-2] such that x[i] <= x_ <= x[i+1].
+ */
+std::size_t Interpolation2D::find_interval(double x_, std::size_t& hint)
+{
+    if (uniform){return hint = find_interval(x_);}
+    const std::size_t n = x.size();
+    std::size_t i = std::min(hint, n-2);
+    if (x[i] <= x_)
+    {
+        if (x_ <= x[i+1]){return hint = i;}
+        std::size_t lo = i+1;
+        std::size_t step = 1;
+        while (lo+step < n-1 && x[lo+step] <= x_){lo += step; step *= 2;}
+        const std::size_t hi = std::min(lo+step, n-1);
+        i = lo + locate_interval(x.data()+lo, hi-lo+1, x_);
+    }
+    else
+    {
+        std::size_t hi = i;
+        std::size_t step = 1;
+        while (hi >= step && x[hi-step] > x_){hi -= step; step *= 2;}
+        const std::size_t lo = hi >= step ? hi-step : 0;
+        i = lo + locate_interval(x.data()+lo, hi-lo+1, x_);
+    }
+    return hint = std::min(i, n-2);
+};
+
+/**
+ * @brief Interpolates a batch of values with one virtual call per block of
+ * INTERPOLATION_BATCH_BLOCK values instead of one per value.
+ *
+ * The intervals of a block are located first: if the block is sorted, the values and the
+ * x-axis are walked together in a single merge pass (O(n + m)), else each value is located with
+ * Interpolation2D::find_interval. The subclass then evaluates the whole block in a loop
+ * free of searches and branches.
+ *
+ * @param x_ The values to interpolate.
+ * @param out The interpolated values.
+ * @param n The number of values.
+ * @throw Interpolation2DOutOfRange
+ */
+void Interpolation2D::evaluate(const double* x_, double* out, std::size_t n)
+{
+    ARBITRAGE_INSTRUMENT_SCOPE(INSTRUMENTATION_INTERPOLATION);
+    std::size_t intervals[INTERPOLATION_BATCH_BLOCK];
+    const std::size_t last = x.size()-2;
+    for (std::size_t start = 0; start < n; start += INTERPOLATION_BATCH_BLOCK)
+    {
+        const std::size_t m = std::min(INTERPOLATION_BATCH_BLOCK, n - start);
+        const double* values = x_ + start;
+        bool sorted = true;
+        for (std::size_t k = 0; k < m; ++k)
+        {
+            if (!(values[k] >= x_min && values[k] <= x_max)){throw Interpolation2DOutOfRange();}
+            if (k > 0 && values[k] < values[k-1]){sorted = false;}
+        }
+        if (sorted)
+        {
+            std::size_t i = find_interval(values[0]);
+            for (std::size_t k = 0; k < m; ++k)
+            {
+                while (i < last && x[i+1] < values[k]){++i;}
+                intervals[k] = i;
+            }
+        }
+        else
+        {
+            for (std::size_t k = 0; k < m; ++k){intervals[k] = find_interval(values[k]);}
+        }
+        evaluate_intervals(values, intervals, out + start, m);
+    }
+};
\ No newline at end of file
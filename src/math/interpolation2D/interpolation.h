@@ -1,7 +1,10 @@
 #pragma once
 #include <iostream>
 #include <map>
+#include <vector>
+#include <cmath>
 #include <algorithm>
+#include "../../instrumentation/instrumentation.h"
 
 class Interpolation2DMinimalVectorSize:  public std::exception 
 {public: const char * what() const throw();};
@@ -12,19 +15,42 @@ class Interpolation2DOutOfRange:  public std::exception
 class Interpolation2DWrongXaxis:  public std::exception 
 {public: const char * what() const throw();};
 
+class Interpolation2DWrongYaxis:  public std::exception 
+{public: const char * what() const throw();};
+
+std::size_t locate_interval(const double* x, std::size_t n, double value);
+
+constexpr std::size_t INTERPOLATION_BATCH_BLOCK = 256;
+
 class Interpolation2D
 {
     public : 
-        Interpolation2D(std::map<double, double> mapped_x_y_);
+        Interpolation2D(const std::map<double, double>& mapped_x_y_);
+        Interpolation2D(std::vector<double> x_, std::vector<double> y_);
+        Interpolation2D(const double* x_, const double* y_, std::size_t n);
         virtual ~Interpolation2D(){};
         virtual double evaluate(double x_) = 0;
-        std::map<double, double> mapped_x_y;
+        virtual double evaluate(double x_, std::size_t& hint) = 0;
         std::vector<double> x; 
         std::vector<double> y; 
         double x_min ;
         double x_max ;
-        std::vector<double> get_x_values();
-        std::vector<double> get_y_values();
+        bool uniform;
+        double inverse_step;
+        const std::vector<double>& get_x_values();
+        const std::vector<double>& get_y_values();
+        std::map<double, double> get_mapped_x_y();
+        bool is_uniform();
+        std::size_t find_interval(double x_);
+        std::size_t find_interval(double x_, std::size_t& hint);
+        void evaluate(const double* x_, double* out, std::size_t n);
+    protected :
+        static std::vector<double> check_x_values(std::vector<double> x_);
+        static std::vector<double> check_y_values(std::vector<double> y_, std::size_t n);
+        static std::vector<double> get_keys(const std::map<double, double>& mapped_x_y_);
+        static std::vector<double> get_values(const std::map<double, double>& mapped_x_y_);
+        virtual void evaluate_intervals(
+            const double* x_, const std::size_t* intervals, double* out, std::size_t n) = 0;
 };
 
 
@@ -11,14 +11,36 @@
 */
 
 /** 
- * @brief The main constructor
+ * @brief The constructor from a map of the coordinates.
  * @param mapped_x_y_ The map representing the coordinates to interpolate from. 
  * @throw InterpolationMinimalVectorSize
  * @throw Interpolation2DWrongXaxis
  */
-LinearInterpolation2D::LinearInterpolation2D(std::map<double, double> mapped_x_y_): 
+LinearInterpolation2D::LinearInterpolation2D(const std::map<double, double>& mapped_x_y_): 
     Interpolation2D(mapped_x_y_){};
 
+/** 
+ * @brief The main constructor, the vectors can be moved in.
+ * @param x_ The independant values, strictly increasing.
+ * @param y_ The dependant values.
+ * @throw InterpolationMinimalVectorSize
+ * @throw Interpolation2DWrongXaxis
+ * @throw Interpolation2DWrongYaxis
+ */
+LinearInterpolation2D::LinearInterpolation2D(std::vector<double> x_, std::vector<double> y_): 
+    Interpolation2D(std::move(x_), std::move(y_)){};
+
+/** 
+ * @brief The constructor from contiguous arrays.
+ * @param x_ The independant values, strictly increasing.
+ * @param y_ The dependant values.
+ * @param n The number of coordinates.
+ * @throw InterpolationMinimalVectorSize
+ * @throw Interpolation2DWrongXaxis
+ */
+LinearInterpolation2D::LinearInterpolation2D(const double* x_, const double* y_, std::size_t n): 
+    Interpolation2D(x_, y_, n){};
+
 /**
  * @param x0 The x-axis value from coordonate 0.
  * @param y0 The y-axis value from coordonate 0.
@@ -39,16 +61,47 @@ double LinearInterpolation2D::linear_interpolate(double x0, double y0, double x1
  */
 double LinearInterpolation2D::evaluate(double x_)
 {
-    if (x_ < Interpolation2D::x_min || x_ > Interpolation2D::x_max){ 
+    if (!(x_ >= Interpolation2D::x_min && x_ <= Interpolation2D::x_max)){ 
         throw Interpolation2DOutOfRange();}
     
-    for (int i = 1; i < Interpolation2D::x.size(); ++i) {
-        if (x_ >= Interpolation2D::x[i-1] && x_ <= Interpolation2D::x[i]) {
-            double x0 = Interpolation2D::x[i-1]; 
-            double x1 = Interpolation2D::x[i];
-            return linear_interpolate(
-                x0, Interpolation2D::mapped_x_y.at(x0),
-                x1, Interpolation2D::mapped_x_y.at(x1), x_);
-        }
+    std::size_t i = Interpolation2D::find_interval(x_);
+    return linear_interpolate(
+        Interpolation2D::x[i], Interpolation2D::y[i],
+        Interpolation2D::x[i+1], Interpolation2D::y[i+1], x_);
+};
+
+/**
+ * @param x_ The value to interpolate.
+ * @param hint The interval cursor, see Interpolation2D::find_interval.
+ * @return The linear interpolated value.
+ * @throw Interpolation2DOutOfRange
+ */
+double LinearInterpolation2D::evaluate(double x_, std::size_t& hint)
+{
+    if (!(x_ >= Interpolation2D::x_min && x_ <= Interpolation2D::x_max)){ 
+        throw Interpolation2DOutOfRange();}
+    
+    std::size_t i = Interpolation2D::find_interval(x_, hint);
+    return linear_interpolate(
+        Interpolation2D::x[i], Interpolation2D::y[i],
+        Interpolation2D::x[i+1], Interpolation2D::y[i+1], x_);
+};
+
+/**
+ * @brief Interpolates a block of values whose intervals are known.
+ * @param x_ The values to interpolate.
+ * @param intervals The interval of each value.
+ * @param out The interpolated values.
+ * @param n The number of values.
+ */
+void LinearInterpolation2D::evaluate_intervals(
+    const double* x_, const std::size_t* intervals, double* out, std::size_t n)
+{
+    const double* xs = Interpolation2D::x.data();
+    const double* ys = Interpolation2D::y.data();
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        const std::size_t i = intervals[k];
+        out[k] = linear_interpolate(xs[i], ys[i], xs[i+1], ys[i+1], x_[k]);
     }
 };
\ No newline at end of file
@@ -6,9 +6,15 @@
 class LinearInterpolation2D: public Interpolation2D
 {
     public :
-        LinearInterpolation2D(std::map<double, double> mapped_x_y_);
+        LinearInterpolation2D(const std::map<double, double>& mapped_x_y_);
+        LinearInterpolation2D(std::vector<double> x_, std::vector<double> y_);
+        LinearInterpolation2D(const double* x_, const double* y_, std::size_t n);
         ~LinearInterpolation2D(){};
         double linear_interpolate(double x0, double y0, double x1, double y1, double x);
         double evaluate(double x_) override; 
-
+        double evaluate(double x_, std::size_t& hint) override; 
+        using Interpolation2D::evaluate;
+    protected :
+        void evaluate_intervals(
+            const double* x_, const std::size_t* intervals, double* out, std::size_t n) override;
 };
\ No newline at end of file
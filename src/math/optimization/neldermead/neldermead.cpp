@@ -0,0 +1,153 @@
+#include "neldermead.h"
+
+/**
+* @file neldermead.h
+* @brief This file defines the Nelder-Mead simplex minimizer.
+*
+* References :
+* - "A simplex method for function minimization", Nelder, Mead, 1965.
+*/
+
+/**
+ * @class NelderMeadWrongDimension
+ * @brief Definition of the error when the initial point and the initial steps do not have the same dimension.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * NelderMeadWrongDimension::what() const throw(){
+    return "The initial point and the initial steps must be non empty and have the same dimension.";
+};
+
+/**
+ * @struct NelderMeadResult
+ * @brief The outcome of a minimization: the best point, its value, the number of iterations
+ * and function evaluations, and whether the tolerances were reached.
+ */
+
+/**
+ * @struct NelderMead
+ * @brief The Nelder-Mead minimizer with the standard coefficients (reflection 1, expansion 2,
+ * contraction 1/2, shrink 1/2).
+ */
+
+ /**
+ * @var double NelderMead::x_tolerance_
+ * @brief The maximal distance (infinity norm) between the best vertex and the other vertices at convergence.
+ */
+
+ /**
+ * @var double NelderMead::f_tolerance_
+ * @brief The maximal spread of the function values of the simplex at convergence.
+ */
+
+ /**
+ * @var int NelderMead::max_iterations_
+ * @brief The maximal number of iterations.
+ */
+
+/**
+ * @brief The main constructor
+ * @param x_tolerance The maximal distance between the vertices at convergence.
+ * @param f_tolerance The maximal spread of the function values at convergence.
+ * @param max_iterations The maximal number of iterations.
+ */
+NelderMead::NelderMead(double x_tolerance, double f_tolerance, int max_iterations):
+    x_tolerance_(x_tolerance), f_tolerance_(f_tolerance), max_iterations_(max_iterations){};
+
+/**
+ * @brief Minimizes a function from an initial simplex made of x0 and of x0 moved by step[i]
+ * along each axis i. A small step gives a fast local refinement, which is how a warm start
+ * from a previous minimum is done.
+ * @param f The function to minimize, it can return infinity outside of its domain. The
+ * minimization stops, without converging, when every vertex of the simplex is outside of it.
+ * @param x0 The initial point.
+ * @param step The initial simplex size along each axis.
+ * @return The result of the minimization.
+ * @throw NelderMeadWrongDimension
+ */
+NelderMeadResult NelderMead::minimize(
+    const std::function<double(const std::vector<double>&)>& f,
+    const std::vector<double>& x0,
+    const std::vector<double>& step)
+{
+    const std::size_t n = x0.size();
+    if (n==0 || step.size()!=n){throw NelderMeadWrongDimension();}
+
+    std::vector<std::vector<double>> simplex(n+1, x0);
+    std::vector<double> values(n+1);
+    for (std::size_t i = 0; i < n; ++i){simplex[i+1][i] += step[i];}
+    for (std::size_t i = 0; i <= n; ++i){values[i] = f(simplex[i]);}
+    int evaluations = n+1;
+
+    std::vector<std::size_t> order(n+1);
+    std::vector<double> centroid(n), reflected(n), trial(n);
+    int iteration = 0;
+    bool converged = false;
+    while (true)
+    {
+        for (std::size_t i = 0; i <= n; ++i){order[i] = i;}
+        std::sort(order.begin(), order.end(), [&values](std::size_t i, std::size_t j){return values[i] < values[j];});
+        const std::size_t best = order[0];
+        const std::size_t worst = order[n];
+        const std::size_t second_worst = order[n-1];
+        if (!std::isfinite(values[best])){break;}
+
+        double x_spread = 0.0;
+        for (std::size_t i = 1; i <= n; ++i)
+            for (std::size_t j = 0; j < n; ++j)
+                x_spread = std::max(x_spread, fabs(simplex[order[i]][j] - simplex[best][j]));
+        if (x_spread <= x_tolerance_ && values[worst] - values[best] <= f_tolerance_){converged = true; break;}
+        if (iteration >= max_iterations_){break;}
+        iteration++;
+
+        std::fill(centroid.begin(), centroid.end(), 0.0);
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t j = 0; j < n; ++j)
+                centroid[j] += simplex[order[i]][j]/n;
+
+        for (std::size_t j = 0; j < n; ++j){reflected[j] = centroid[j] + (centroid[j] - simplex[worst][j]);}
+        const double f_reflected = f(reflected);
+        evaluations++;
+
+        if (f_reflected < values[best])
+        {
+            for (std::size_t j = 0; j < n; ++j){trial[j] = centroid[j] + 2*(centroid[j] - simplex[worst][j]);}
+            const double f_expanded = f(trial);
+            evaluations++;
+            if (f_expanded < f_reflected){simplex[worst] = trial; values[worst] = f_expanded;}
+            else{simplex[worst] = reflected; values[worst] = f_reflected;}
+            continue;
+        }
+        if (f_reflected < values[second_worst])
+        {
+            simplex[worst] = reflected;
+            values[worst] = f_reflected;
+            continue;
+        }
+
+        const bool outside = f_reflected < values[worst];
+        const std::vector<double>& towards = outside ? reflected : simplex[worst];
+        for (std::size_t j = 0; j < n; ++j){trial[j] = centroid[j] + .5*(towards[j] - centroid[j]);}
+        const double f_contracted = f(trial);
+        evaluations++;
+        if (f_contracted < std::min(f_reflected, values[worst]))
+        {
+            simplex[worst] = trial;
+            values[worst] = f_contracted;
+            continue;
+        }
+
+        for (std::size_t i = 1; i <= n; ++i)
+        {
+            std::vector<double>& vertex = simplex[order[i]];
+            for (std::size_t j = 0; j < n; ++j){vertex[j] = simplex[best][j] + .5*(vertex[j] - simplex[best][j]);}
+            values[order[i]] = f(vertex);
+            evaluations++;
+        }
+    }
+
+    const std::size_t best = std::min_element(values.begin(), values.end()) - values.begin();
+    return NelderMeadResult{simplex[best], values[best], iteration, evaluations, converged};
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+class NelderMeadWrongDimension:  public std::exception
+{public: const char * what() const throw();};
+
+struct NelderMeadResult
+{
+    std::vector<double> x;
+    double value;
+    int iterations;
+    int evaluations;
+    bool converged;
+};
+
+struct NelderMead
+{
+    double x_tolerance_;
+    double f_tolerance_;
+    int max_iterations_;
+    NelderMead(double x_tolerance, double f_tolerance, int max_iterations);
+    ~NelderMead(){};
+    NelderMeadResult minimize(
+        const std::function<double(const std::vector<double>&)>& f,
+        const std::vector<double>& x0,
+        const std::vector<double>& step
+    );
+};
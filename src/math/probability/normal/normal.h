@@ -3,20 +3,30 @@
 #include <numbers>
 #include <cmath>
 #include <random>
+#include <limits>
 #include "../../../math/probability/probability.h"
 #include "../../../math/numbers.h"
+#include "../../../math/simd/simd.h"
 
 class NormalDistributionNonPositiveSigma: public std::exception 
 {public: const char * what() const throw();};
 
+class NormalDistributionProbabilityOutOfRange: public std::exception 
+{public: const char * what() const throw();};
+
 struct NormalDistribution: ProbabilityDistribution
 {
     double mu_; 
     double sigma_;
+    double pdf_factor_;
     NormalDistribution(); 
     NormalDistribution(double mu, double sigma); 
     ~NormalDistribution(){};
     double pdf(double x); 
     double cdf(double x); 
+    double inverse_cdf(double p); 
+    void pdf_n(const double* x, double* out, std::size_t n); 
+    void cdf_n(const double* x, double* out, std::size_t n); 
+    void inverse_cdf_n(const double* p, double* out, std::size_t n); 
     double random();
 };
@@ -0,0 +1,201 @@
+#include "philox.h"
+
+/**
+* @file philox.h
+* @brief This file defines the Philox4x32-10 counter-based random number generator.
+*
+* References :
+* - "Parallel random numbers: as easy as 1, 2, 3", Salmon, Moraes, Dror, Shaw, 2011.
+*/
+
+/**
+ * @struct Philox
+ * @brief A Philox4x32-10 stream: the n-th block of 4 random 32-bit words is a bijection of the 
+ * 128-bit counter (n, stream) keyed by the seed, so that the streams of a seed are independent
+ * and any block can be computed without generating the previous ones.
+ *
+ * A simulation gives one stream per fixed block of paths (not per thread): its result does not
+ * depend on the number of threads nor on the order the blocks are run.
+ */
+
+/**
+ * @var std::uint64_t Philox::seed_
+ * @brief The seed, the 64-bit key of the bijection.
+ */
+
+/**
+ * @var std::uint64_t Philox::stream_
+ * @brief The stream, the high 64 bits of the counter.
+ */
+
+/**
+ * @var std::uint64_t Philox::counter_
+ * @brief The index of the next block, the low 64 bits of the counter.
+ */
+
+/**
+ * @var NormalDistribution Philox::standard_normal_
+ * @brief The standard normal distribution, for its vectorized quantile function.
+ */
+
+static const std::uint32_t PHILOX_M0 = 0xD2511F53;
+static const std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const std::uint32_t PHILOX_W0 = 0x9E3779B9;
+static const std::uint32_t PHILOX_W1 = 0xBB67AE85;
+static const std::size_t PHILOX_BATCH = 256;
+static const std::size_t PHILOX_LANES = 8;
+static const double PHILOX_SCALE = 1.0/9007199254740992.0;
+
+/**
+ * @brief The 10 rounds of Philox4x32.
+ * @param counter The 128-bit counter, as 4 words.
+ * @param key The 64-bit key, as 2 words.
+ * @param out The 4 random words.
+ */
+static inline void philox4x32_10(const std::uint32_t* counter, const std::uint32_t* key, std::uint32_t* out)
+{
+    std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    std::uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round)
+    {
+        const std::uint64_t p0 = static_cast<std::uint64_t>(PHILOX_M0)*c0;
+        const std::uint64_t p1 = static_cast<std::uint64_t>(PHILOX_M1)*c2;
+        const std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        const std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<std::uint32_t>(p1);
+        c3 = static_cast<std::uint32_t>(p0);
+        c0 = n0;
+        c2 = n2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+};
+
+/**
+ * @brief The 10 rounds of Philox4x32 on PHILOX_LANES consecutive counters of a stream, written 
+ * lane by lane so that the compiler vectorizes it (the 32x32->64 multiplications map to 
+ * vpmuludq / umull).
+ * @param counter The low 64 bits of the first counter.
+ * @param stream The high 64 bits of the counters.
+ * @param key The 64-bit key, as 2 words.
+ * @param out The 4 random words of each lane, word by word (out[w*PHILOX_LANES + lane]).
+ */
+static inline void philox4x32_10_lanes(
+    const std::uint64_t counter, const std::uint64_t stream, const std::uint32_t* key, std::uint32_t* out)
+{
+    std::uint32_t c0[PHILOX_LANES], c1[PHILOX_LANES], c2[PHILOX_LANES], c3[PHILOX_LANES];
+    for (std::size_t l = 0; l < PHILOX_LANES; ++l)
+    {
+        c0[l] = static_cast<std::uint32_t>(counter + l);
+        c1[l] = static_cast<std::uint32_t>((counter + l) >> 32);
+        c2[l] = static_cast<std::uint32_t>(stream);
+        c3[l] = static_cast<std::uint32_t>(stream >> 32);
+    }
+    std::uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round)
+    {
+        for (std::size_t l = 0; l < PHILOX_LANES; ++l)
+        {
+            const std::uint64_t p0 = static_cast<std::uint64_t>(PHILOX_M0)*c0[l];
+            const std::uint64_t p1 = static_cast<std::uint64_t>(PHILOX_M1)*c2[l];
+            const std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+            const std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+            c1[l] = static_cast<std::uint32_t>(p1);
+            c3[l] = static_cast<std::uint32_t>(p0);
+            c0[l] = n0;
+            c2[l] = n2;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    for (std::size_t l = 0; l < PHILOX_LANES; ++l)
+    {
+        out[l] = c0[l];
+        out[PHILOX_LANES + l] = c1[l];
+        out[2*PHILOX_LANES + l] = c2[l];
+        out[3*PHILOX_LANES + l] = c3[l];
+    }
+};
+
+/**
+ * @brief The main constructor.
+ * @param seed The seed.
+ * @param stream The stream.
+ */
+Philox::Philox(std::uint64_t seed, std::uint64_t stream):
+    seed_(seed), stream_(stream), counter_(0), standard_normal_(){};
+
+/**
+ * @brief Generates the next block of 4 random 32-bit words.
+ * @param out The 4 random words.
+ */
+void Philox::generate(std::uint32_t* out)
+{
+    const std::uint32_t c[4] = {
+        static_cast<std::uint32_t>(counter_), static_cast<std::uint32_t>(counter_ >> 32), 
+        static_cast<std::uint32_t>(stream_), static_cast<std::uint32_t>(stream_ >> 32)};
+    const std::uint32_t k[2] = {static_cast<std::uint32_t>(seed_), static_cast<std::uint32_t>(seed_ >> 32)};
+    philox4x32_10(c, k, out);
+    counter_++;
+};
+
+/**
+ * @brief Skips blocks in O(1).
+ * @param n_blocks The number of blocks (2 uniforms each) to skip.
+ */
+void Philox::skip(std::uint64_t n_blocks)
+{
+    counter_ += n_blocks;
+};
+
+/**
+ * @brief Generates uniforms in (0, 1), 2 per block with 53 random bits each (an odd n discards 
+ * the last one). The blocks are generated PHILOX_LANES at a time, the sequence is the one of 
+ * generate.
+ * @param out The n uniforms.
+ * @param n The number of uniforms.
+ */
+void Philox::uniform_n(double* out, std::size_t n)
+{
+    const std::uint32_t key[2] = {static_cast<std::uint32_t>(seed_), static_cast<std::uint32_t>(seed_ >> 32)};
+    std::uint32_t words[4*PHILOX_LANES];
+    std::size_t i = 0;
+    for (; i + 2*PHILOX_LANES <= n; i += 2*PHILOX_LANES)
+    {
+        philox4x32_10_lanes(counter_, stream_, key, words);
+        for (std::size_t l = 0; l < PHILOX_LANES; ++l)
+        {
+            const std::uint64_t u0 = (static_cast<std::uint64_t>(words[PHILOX_LANES + l]) << 32 | words[l]) >> 11;
+            const std::uint64_t u1 = 
+                (static_cast<std::uint64_t>(words[3*PHILOX_LANES + l]) << 32 | words[2*PHILOX_LANES + l]) >> 11;
+            out[i + 2*l] = (u0 + .5)*PHILOX_SCALE;
+            out[i + 2*l + 1] = (u1 + .5)*PHILOX_SCALE;
+        }
+        counter_ += PHILOX_LANES;
+    }
+    for (; i < n; i += 2)
+    {
+        generate(words);
+        const std::uint64_t u0 = (static_cast<std::uint64_t>(words[1]) << 32 | words[0]) >> 11;
+        const std::uint64_t u1 = (static_cast<std::uint64_t>(words[3]) << 32 | words[2]) >> 11;
+        out[i] = (u0 + .5)*PHILOX_SCALE;
+        if (i + 1 < n){out[i+1] = (u1 + .5)*PHILOX_SCALE;}
+    }
+};
+
+/**
+ * @brief Generates standard normals by inversion of the uniforms (NormalDistribution::inverse_cdf_n),
+ * by batches of 256.
+ * @param out The n normals.
+ * @param n The number of normals.
+ */
+void Philox::normal_n(double* out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i += PHILOX_BATCH)
+    {
+        const std::size_t m = std::min(PHILOX_BATCH, n - i);
+        uniform_n(out + i, m);
+        standard_normal_.inverse_cdf_n(out + i, out + i, m);
+    }
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <iostream>
+#include <cstdint>
+#include <algorithm>
+#include "../../../math/probability/normal/normal.h"
+
+struct Philox
+{
+    std::uint64_t seed_;
+    std::uint64_t stream_;
+    std::uint64_t counter_;
+    NormalDistribution standard_normal_;
+    Philox(std::uint64_t seed, std::uint64_t stream);
+    ~Philox(){};
+    void generate(std::uint32_t* out);
+    void skip(std::uint64_t n_blocks);
+    void uniform_n(double* out, std::size_t n);
+    void normal_n(double* out, std::size_t n);
+};
@@ -0,0 +1,269 @@
+#pragma once
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+/**
+* @file simd.h
+* @brief This file defines the thin SIMD layer used by the vectorized kernels.
+*
+* The instruction set is selected at compile time from the compiler flags:
+* AVX-512 (__AVX512F__, 8 doubles), AVX2 (__AVX2__, 4 doubles), NEON (__aarch64__, 2 doubles),
+* or a portable scalar fallback (1 double). Every kernel is written once against
+* the simd_* functions below.
+*
+* The AVX-512 functions use the masked intrinsics with a full mask and a zero source: the
+* unmasked ones merge into an undefined vector, which GCC reports as uninitialized, and both
+* forms compile to the same instructions.
+*/
+
+#if defined(__AVX512F__)
+    #include <immintrin.h>
+    #define ARBITRAGE_SIMD_AVX512
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+    #define ARBITRAGE_SIMD_AVX2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define ARBITRAGE_SIMD_NEON
+#else
+    #define ARBITRAGE_SIMD_SCALAR
+#endif
+
+#if defined(ARBITRAGE_SIMD_AVX512)
+
+typedef __m512d simd_double;
+typedef __mmask8 simd_mask;
+constexpr std::size_t SIMD_WIDTH = 8;
+
+inline simd_double simd_load(const double* p){return _mm512_loadu_pd(p);};
+inline void simd_store(double* p, simd_double a){_mm512_storeu_pd(p, a);};
+inline simd_double simd_set1(double a){return _mm512_set1_pd(a);};
+inline simd_double simd_add(simd_double a, simd_double b){return _mm512_add_pd(a, b);};
+inline simd_double simd_sub(simd_double a, simd_double b){return _mm512_sub_pd(a, b);};
+inline simd_double simd_mul(simd_double a, simd_double b){return _mm512_mul_pd(a, b);};
+inline simd_double simd_div(simd_double a, simd_double b){return _mm512_div_pd(a, b);};
+inline simd_double simd_sqrt(simd_double a){return _mm512_mask_sqrt_pd(_mm512_setzero_pd(), 0xFF, a);};
+inline simd_double simd_abs(simd_double a){return _mm512_abs_pd(a);};
+inline simd_double simd_max(simd_double a, simd_double b){return _mm512_mask_max_pd(_mm512_setzero_pd(), 0xFF, a, b);};
+inline simd_double simd_round(simd_double a)
+{
+    return _mm512_mask_roundscale_pd(_mm512_setzero_pd(), 0xFF, a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+};
+inline simd_mask simd_lt(simd_double a, simd_double b){return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);};
+inline simd_mask simd_le(simd_double a, simd_double b){return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ);};
+inline simd_double simd_select(simd_mask m, simd_double if_true, simd_double if_false)
+{
+    return _mm512_mask_blend_pd(m, if_false, if_true);
+};
+inline simd_double simd_pow2i(simd_double n)
+{
+    const __m512d magic = _mm512_set1_pd(6755399441055744.0);
+    __m512i k = _mm512_sub_epi64(
+        _mm512_castpd_si512(_mm512_add_pd(n, magic)), _mm512_castpd_si512(magic));
+    k = _mm512_mask_slli_epi64(_mm512_setzero_si512(), 0xFF, _mm512_add_epi64(k, _mm512_set1_epi64(1023)), 52);
+    return _mm512_castsi512_pd(k);
+};
+inline simd_double simd_exponent(simd_double a){return _mm512_mask_getexp_pd(_mm512_setzero_pd(), 0xFF, a);};
+inline simd_double simd_mantissa(simd_double a)
+{
+    return _mm512_mask_getmant_pd(_mm512_setzero_pd(), 0xFF, a, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+};
+
+#elif defined(ARBITRAGE_SIMD_AVX2)
+
+typedef __m256d simd_double;
+typedef __m256d simd_mask;
+constexpr std::size_t SIMD_WIDTH = 4;
+
+inline simd_double simd_load(const double* p){return _mm256_loadu_pd(p);};
+inline void simd_store(double* p, simd_double a){_mm256_storeu_pd(p, a);};
+inline simd_double simd_set1(double a){return _mm256_set1_pd(a);};
+inline simd_double simd_add(simd_double a, simd_double b){return _mm256_add_pd(a, b);};
+inline simd_double simd_sub(simd_double a, simd_double b){return _mm256_sub_pd(a, b);};
+inline simd_double simd_mul(simd_double a, simd_double b){return _mm256_mul_pd(a, b);};
+inline simd_double simd_div(simd_double a, simd_double b){return _mm256_div_pd(a, b);};
+inline simd_double simd_sqrt(simd_double a){return _mm256_sqrt_pd(a);};
+inline simd_double simd_abs(simd_double a){return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);};
+inline simd_double simd_max(simd_double a, simd_double b){return _mm256_max_pd(a, b);};
+inline simd_double simd_round(simd_double a)
+{
+    return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+};
+inline simd_mask simd_lt(simd_double a, simd_double b){return _mm256_cmp_pd(a, b, _CMP_LT_OQ);};
+inline simd_mask simd_le(simd_double a, simd_double b){return _mm256_cmp_pd(a, b, _CMP_LE_OQ);};
+inline simd_double simd_select(simd_mask m, simd_double if_true, simd_double if_false)
+{
+    return _mm256_blendv_pd(if_false, if_true, m);
+};
+inline simd_double simd_pow2i(simd_double n)
+{
+    const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+    __m256i k = _mm256_sub_epi64(
+        _mm256_castpd_si256(_mm256_add_pd(n, magic)), _mm256_castpd_si256(magic));
+    k = _mm256_slli_epi64(_mm256_add_epi64(k, _mm256_set1_epi64x(1023)), 52);
+    return _mm256_castsi256_pd(k);
+};
+inline simd_double simd_exponent(simd_double a)
+{
+    const __m256d magic = _mm256_set1_pd(4503599627370496.0);
+    const __m256i e = _mm256_srli_epi64(_mm256_castpd_si256(a), 52);
+    return _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(e, _mm256_castpd_si256(magic))), _mm256_set1_pd(4503599627370496.0 + 1023.0));
+};
+inline simd_double simd_mantissa(simd_double a)
+{
+    const __m256d mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+    return _mm256_or_pd(_mm256_and_pd(a, mask), _mm256_set1_pd(1.0));
+};
+
+#elif defined(ARBITRAGE_SIMD_NEON)
+
+typedef float64x2_t simd_double;
+typedef uint64x2_t simd_mask;
+constexpr std::size_t SIMD_WIDTH = 2;
+
+inline simd_double simd_load(const double* p){return vld1q_f64(p);};
+inline void simd_store(double* p, simd_double a){vst1q_f64(p, a);};
+inline simd_double simd_set1(double a){return vdupq_n_f64(a);};
+inline simd_double simd_add(simd_double a, simd_double b){return vaddq_f64(a, b);};
+inline simd_double simd_sub(simd_double a, simd_double b){return vsubq_f64(a, b);};
+inline simd_double simd_mul(simd_double a, simd_double b){return vmulq_f64(a, b);};
+inline simd_double simd_div(simd_double a, simd_double b){return vdivq_f64(a, b);};
+inline simd_double simd_sqrt(simd_double a){return vsqrtq_f64(a);};
+inline simd_double simd_abs(simd_double a){return vabsq_f64(a);};
+inline simd_double simd_max(simd_double a, simd_double b){return vmaxq_f64(a, b);};
+inline simd_double simd_round(simd_double a){return vrndnq_f64(a);};
+inline simd_mask simd_lt(simd_double a, simd_double b){return vcltq_f64(a, b);};
+inline simd_mask simd_le(simd_double a, simd_double b){return vcleq_f64(a, b);};
+inline simd_double simd_select(simd_mask m, simd_double if_true, simd_double if_false)
+{
+    return vbslq_f64(m, if_true, if_false);
+};
+inline simd_double simd_pow2i(simd_double n)
+{
+    int64x2_t k = vcvtq_s64_f64(n);
+    k = vshlq_n_s64(vaddq_s64(k, vdupq_n_s64(1023)), 52);
+    return vreinterpretq_f64_s64(k);
+};
+inline simd_double simd_exponent(simd_double a)
+{
+    return vsubq_f64(vcvtq_f64_u64(vshrq_n_u64(vreinterpretq_u64_f64(a), 52)), vdupq_n_f64(1023.0));
+};
+inline simd_double simd_mantissa(simd_double a)
+{
+    const uint64x2_t m = vandq_u64(vreinterpretq_u64_f64(a), vdupq_n_u64(0x000FFFFFFFFFFFFFULL));
+    return vreinterpretq_f64_u64(vorrq_u64(m, vdupq_n_u64(0x3FF0000000000000ULL)));
+};
+
+#else
+
+typedef double simd_double;
+typedef bool simd_mask;
+constexpr std::size_t SIMD_WIDTH = 1;
+
+inline simd_double simd_load(const double* p){return *p;};
+inline void simd_store(double* p, simd_double a){*p = a;};
+inline simd_double simd_set1(double a){return a;};
+inline simd_double simd_add(simd_double a, simd_double b){return a + b;};
+inline simd_double simd_sub(simd_double a, simd_double b){return a - b;};
+inline simd_double simd_mul(simd_double a, simd_double b){return a * b;};
+inline simd_double simd_div(simd_double a, simd_double b){return a / b;};
+inline simd_double simd_sqrt(simd_double a){return std::sqrt(a);};
+inline simd_double simd_abs(simd_double a){return std::fabs(a);};
+inline simd_double simd_max(simd_double a, simd_double b){return a > b ? a : b;};
+inline simd_double simd_round(simd_double a){return std::nearbyint(a);};
+inline simd_mask simd_lt(simd_double a, simd_double b){return a < b;};
+inline simd_mask simd_le(simd_double a, simd_double b){return a <= b;};
+inline simd_double simd_select(simd_mask m, simd_double if_true, simd_double if_false)
+{
+    return m ? if_true : if_false;
+};
+inline simd_double simd_pow2i(simd_double n)
+{
+    std::int64_t k = (static_cast<std::int64_t>(n) + 1023) << 52;
+    double out;
+    std::memcpy(&out, &k, sizeof(double));
+    return out;
+};
+inline simd_double simd_exponent(simd_double a)
+{
+    int e;
+    std::frexp(a, &e);
+    return static_cast<double>(e - 1);
+};
+inline simd_double simd_mantissa(simd_double a)
+{
+    int e;
+    return 2*std::frexp(a, &e);
+};
+
+#endif
+
+/**
+ * @brief Vectorized exponential for arguments in [-708, 708] (the argument is clamped to
+ * that range). The argument is reduced as x = n*ln(2) + r with |r| <= ln(2)/2 and e^r
+ * is evaluated with a degree 13 Taylor polynomial, the result is within 2 ULP of std::exp.
+ * @param x The exponent.
+ * @return The exponential of x.
+ */
+inline simd_double simd_exp(simd_double x)
+{
+    const simd_double lo = simd_set1(-708.0);
+    const simd_double hi = simd_set1(708.0);
+    x = simd_select(simd_lt(x, lo), lo, x);
+    x = simd_select(simd_lt(hi, x), hi, x);
+    const simd_double n = simd_round(simd_mul(x, simd_set1(1.4426950408889634)));
+    simd_double r = simd_sub(x, simd_mul(n, simd_set1(6.93147180369123816490e-01)));
+    r = simd_sub(r, simd_mul(n, simd_set1(1.90821492927058770002e-10)));
+    simd_double p = simd_set1(1.0/6227020800.0);
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/479001600.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/39916800.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/3628800.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/362880.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/40320.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/5040.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/720.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/120.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/24.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0/6.0));
+    p = simd_add(simd_mul(p, r), simd_set1(0.5));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0));
+    p = simd_add(simd_mul(p, r), simd_set1(1.0));
+    return simd_mul(p, simd_pow2i(n));
+};
+
+/**
+ * @brief Vectorized natural logarithm for positive normal arguments (zero, negative, subnormal,
+ * infinite and NaN arguments are not handled). The argument is split as x = 2^e*m with m in 
+ * [sqrt(2)/2, sqrt(2)) (simd_exponent and simd_mantissa), and log(m) = 2*atanh((m-1)/(m+1)) is 
+ * evaluated with its series up to degree 21, the result is within 3 ULP of std::log.
+ * @param x The argument.
+ * @return The natural logarithm of x.
+ */
+inline simd_double simd_log(simd_double x)
+{
+    const simd_double one = simd_set1(1.0);
+    simd_double e = simd_exponent(x);
+    simd_double m = simd_mantissa(x);
+    const simd_mask large = simd_lt(simd_set1(1.4142135623730951), m);
+    m = simd_select(large, simd_mul(m, simd_set1(0.5)), m);
+    e = simd_select(large, simd_add(e, one), e);
+    const simd_double s = simd_div(simd_sub(m, one), simd_add(m, one));
+    const simd_double s2 = simd_mul(s, s);
+    simd_double p = simd_set1(1.0/21.0);
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/19.0));
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/17.0));
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/15.0));
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/13.0));
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/11.0));
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/9.0));
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/7.0));
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/5.0));
+    p = simd_add(simd_mul(p, s2), simd_set1(1.0/3.0));
+    const simd_double log_m = simd_mul(simd_mul(simd_set1(2.0), s), simd_add(simd_mul(p, s2), one));
+    return simd_add(
+        simd_mul(e, simd_set1(6.93147180369123816490e-01)), 
+        simd_add(log_m, simd_mul(e, simd_set1(1.90821492927058770002e-10))));
+};
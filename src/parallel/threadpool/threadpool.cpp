@@ -0,0 +1,432 @@
+#include "threadpool.h"
+
+/**
+* @file threadpool.h
+* @brief This file defines the work-stealing thread pool shared by the pricing frameworks, and
+* the parallel for and reduce built on it.
+*
+* References :
+* - "Scheduling multithreaded computations by work stealing", Blumofe, Leiserson, 1999.
+* - "Guided self-scheduling: a practical scheduling scheme for parallel supercomputers",
+* Polychronopoulos, Kuck, 1987.
+*/
+
+/**
+ * @brief The number of times an idle worker yields, looking for work, before it sleeps: the
+ * workers stay warm between the bursts of a pricing cycle.
+ */
+static const int WORKER_SPINS = 2000;
+
+/**
+ * @brief The number of chunks per thread of the automatic chunking.
+ */
+static const std::size_t CHUNKS_PER_THREAD = 8;
+
+/**
+ * @brief The pool and the index of the worker running on the current thread, null on the
+ * threads which are not workers.
+ */
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local std::size_t current_index = 0;
+
+/**
+ * @class ThreadPoolStopped
+ * @brief Definition of the error when a task is submitted to a stopped thread pool.
+ */
+/**
+ * @brief Definition of what() virtual std::exception function.
+ * @return The explication of the error.
+ */
+const char * ThreadPoolStopped::what() const throw(){
+    return "A task can not be submitted to a stopped thread pool.";
+};
+
+/**
+ * @brief Parses a Linux cpu list, such as "0-3,8,10-11".
+ * @param text The cpu list.
+ * @return The cpus of the list.
+ */
+static std::vector<int> parse_cpu_list(const std::string& text)
+{
+    std::vector<int> cpus;
+    std::size_t position = 0;
+    while (position < text.size())
+    {
+        std::size_t end = text.find(',', position);
+        if (end == std::string::npos){end = text.size();}
+        const std::string range = text.substr(position, end - position);
+        const std::size_t dash = range.find('-');
+        try
+        {
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu){cpus.push_back(cpu);}
+        }
+        catch (std::exception&){}
+        position = end + 1;
+    }
+    return cpus;
+};
+
+/**
+ * @brief Reads the cpus of each NUMA node from the sysfs, a single node with every cpu if
+ * the topology is not available.
+ * @return The cpus of each node.
+ */
+static std::vector<std::vector<int>> get_numa_nodes()
+{
+    std::vector<std::vector<int>> nodes;
+    for (int node = 0; ; ++node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file){break;}
+        std::string text;
+        std::getline(file, text);
+        std::vector<int> cpus = parse_cpu_list(text);
+        if (!cpus.empty()){nodes.push_back(cpus);}
+    }
+    if (nodes.empty())
+    {
+        nodes.emplace_back();
+        const int n_cpus = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < n_cpus; ++cpu){nodes[0].push_back(cpu);}
+    }
+    return nodes;
+};
+
+/**
+ * @brief Pins a thread to a cpu, does nothing outside Linux.
+ * @param thread The thread.
+ * @param cpu The cpu.
+ */
+static void pin_thread(std::thread& thread, const int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+};
+
+/**
+ * @class ThreadPool
+ * @brief A fixed number of worker threads, each with its own deque of tasks.
+ *
+ * A worker runs the tasks of its deque from the back (the last pushed, still in cache) and,
+ * when it is empty, steals from the front of the other deques, the workers of its NUMA node
+ * first. The tasks submitted by a worker go to its own deque, the others are dealt to the
+ * deques in turn. An idle worker yields for a while before it sleeps, and the threads live as
+ * long as the pool: a pricing cycle pays neither a thread spawn nor, most of the time, a wake
+ * up. The workers are spread over the NUMA nodes (worker i on node i modulo the number of
+ * nodes) and can be pinned to their cpu.
+ *
+ * parallel_for splits a range in chunks claimed one at a time by the workers and by the calling
+ * thread, which waits by running the tasks of the pool: a parallel_for nested in a task does
+ * not deadlock. parallel_reduce reduces the chunks in their order, so that its result does not
+ * depend on the number of threads.
+ */
+
+/**
+ * @brief The main constructor, the threads are not pinned.
+ * @param n_threads The number of worker threads, at least one thread is started.
+ */
+ThreadPool::ThreadPool(std::size_t n_threads): ThreadPool(n_threads, false){};
+
+/**
+ * @brief The constructor.
+ * @param n_threads The number of worker threads, at least one thread is started.
+ * @param pin_threads Whether each worker is pinned to its cpu.
+ */
+ThreadPool::ThreadPool(std::size_t n_threads, bool pin_threads):
+    pending_(0), next_queue_(0), stopped_(false)
+{
+    if (n_threads==0){n_threads = 1;}
+    const std::vector<std::vector<int>> nodes = get_numa_nodes();
+    queues_.reserve(n_threads);
+    for (std::size_t i = 0; i < n_threads; ++i)
+    {
+        std::unique_ptr<WorkerQueue> queue(new WorkerQueue());
+        const std::vector<int>& cpus = nodes[i % nodes.size()];
+        queue->node = static_cast<int>(i % nodes.size());
+        queue->cpu = cpus[(i / nodes.size()) % cpus.size()];
+        queues_.push_back(std::move(queue));
+    }
+    for (std::size_t i = 0; i < n_threads; ++i)
+    {
+        for (std::size_t pass = 0; pass < 2; ++pass)
+        {
+            for (std::size_t k = 1; k < n_threads; ++k)
+            {
+                const std::size_t j = (i + k) % n_threads;
+                const bool same_node = queues_[j]->node == queues_[i]->node;
+                if (same_node == (pass == 0)){queues_[i]->victims.push_back(j);}
+            }
+        }
+    }
+    workers_.reserve(n_threads);
+    for (std::size_t i = 0; i < n_threads; ++i)
+    {
+        workers_.emplace_back(&ThreadPool::work, this, i);
+        if (pin_threads){pin_thread(workers_.back(), queues_[i]->cpu);}
+    }
+};
+
+/**
+ * @brief The destructor, the queued tasks are run before the workers are joined.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    condition_.notify_all();
+    for (std::thread& worker : workers_){worker.join();}
+};
+
+/**
+ * @return The number of worker threads.
+ */
+std::size_t ThreadPool::size()
+{
+    return workers_.size();
+};
+
+/**
+ * @brief Gets the chunk size of a parallel loop.
+ * @param n The number of indices.
+ * @param chunk The requested chunk size, 0 for the automatic one: about 8 chunks per thread.
+ * @return The chunk size, at least 1.
+ */
+std::size_t ThreadPool::get_chunk(std::size_t n, std::size_t chunk)
+{
+    if (chunk > 0){return chunk;}
+    return std::max<std::size_t>(1, n/(CHUNKS_PER_THREAD*(workers_.size() + 1)));
+};
+
+/**
+ * @param i The index of the worker.
+ * @return The cpu the worker is assigned to, it runs there only if the pool pins its threads.
+ */
+int ThreadPool::get_worker_cpu(std::size_t i)
+{
+    return queues_.at(i)->cpu;
+};
+
+/**
+ * @param i The index of the worker.
+ * @return The NUMA node of the worker.
+ */
+int ThreadPool::get_worker_node(std::size_t i)
+{
+    return queues_.at(i)->node;
+};
+
+/**
+ * @brief Queues a task, on the deque of the current worker if it belongs to the pool.
+ * @param task The task.
+ * @throw ThreadPoolStopped
+ */
+void ThreadPool::push(std::function<void()> task)
+{
+    if (stopped_){throw ThreadPoolStopped();}
+    const std::size_t index = current_pool == this ? current_index : next_queue_++ % queues_.size();
+    {
+        std::unique_lock<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+        pending_++;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+    }
+    condition_.notify_one();
+};
+
+/**
+ * @brief Takes the last task of the deque of a worker, or steals one.
+ * @param index The index of the worker.
+ * @param task The task taken.
+ * @return False if every deque is empty.
+ */
+bool ThreadPool::pop(std::size_t index, std::function<void()>& task)
+{
+    {
+        WorkerQueue& queue = *queues_[index];
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            pending_--;
+            return true;
+        }
+    }
+    return steal(index, task);
+};
+
+/**
+ * @brief Steals the first task of another deque, those of the same NUMA node first.
+ * @param index The index of the thief.
+ * @param task The task stolen.
+ * @return False if the other deques are empty.
+ */
+bool ThreadPool::steal(std::size_t index, std::function<void()>& task)
+{
+    for (const std::size_t victim : queues_[index]->victims)
+    {
+        WorkerQueue& queue = *queues_[victim];
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            pending_--;
+            return true;
+        }
+    }
+    return false;
+};
+
+/**
+ * @brief Runs one queued task on the current thread, while it waits for a parallel loop.
+ * @return False if there was no task to run.
+ */
+bool ThreadPool::run_one()
+{
+    std::function<void()> task;
+    if (current_pool == this)
+    {
+        if (!pop(current_index, task)){return false;}
+    }
+    else
+    {
+        bool found = false;
+        for (std::size_t i = 0; i < queues_.size() && !found; ++i)
+        {
+            WorkerQueue& queue = *queues_[i];
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                pending_--;
+                found = true;
+            }
+        }
+        if (!found){return false;}
+    }
+    task();
+    return true;
+};
+
+/**
+ * @brief The loop run by every worker thread.
+ * @param index The index of the worker.
+ */
+void ThreadPool::work(std::size_t index)
+{
+    current_pool = this;
+    current_index = index;
+    std::function<void()> task;
+    while (true)
+    {
+        if (pop(index, task))
+        {
+            task();
+            task = nullptr;
+            continue;
+        }
+        bool found = false;
+        for (int spin = 0; spin < WORKER_SPINS && !found; ++spin)
+        {
+            found = pending_.load(std::memory_order_acquire) > 0;
+            if (!found){std::this_thread::yield();}
+        }
+        if (found){continue;}
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this](){return stopped_ || pending_.load() > 0;});
+        if (stopped_ && pending_.load() == 0){return;}
+    }
+};
+
+/**
+ * @brief Runs task(i) for i in [0, n) on the workers and waits for all of them.
+ * The first exception thrown by a task is rethrown once every task is finished.
+ * @param n The number of tasks.
+ * @param task The task, called with its index.
+ * @throw ThreadPoolStopped
+ */
+void ThreadPool::parallel_for(std::size_t n, const std::function<void(std::size_t)>& task)
+{
+    parallel_for(n, 1, [&task](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i){task(i);}
+    });
+};
+
+/**
+ * @brief Runs task(begin, end) on the chunks [begin, end) of [0, n), on the workers and on the
+ * calling thread, and waits for all of them. The chunks are claimed one at a time, so that the
+ * fast threads take more of them. The first exception thrown by a task is rethrown once every
+ * chunk is finished.
+ * @param n The number of indices.
+ * @param chunk The number of indices of a chunk (the last one may be shorter), 0 for the
+ * automatic chunking.
+ * @param task The task, called with the bounds of its chunk.
+ * @throw ThreadPoolStopped
+ */
+void ThreadPool::parallel_for(
+    std::size_t n,
+    std::size_t chunk,
+    const std::function<void(std::size_t begin, std::size_t end)>& task)
+{
+    if (n == 0){return;}
+    chunk = get_chunk(n, chunk);
+    const std::size_t n_chunks = (n + chunk - 1)/chunk;
+    if (n_chunks == 1){task(0, n); return;}
+    std::atomic<std::size_t> next_chunk(0);
+    const std::size_t n_runners = std::min(n_chunks, workers_.size() + 1);
+    std::atomic<std::size_t> running(n_runners);
+    std::exception_ptr error = nullptr;
+    std::mutex error_mutex;
+    auto runner = [&]()
+    {
+        while (true)
+        {
+            const std::size_t c = next_chunk.fetch_add(1);
+            if (c >= n_chunks){break;}
+            const std::size_t begin = c*chunk;
+            try{task(begin, std::min(n, begin + chunk));}
+            catch (...)
+            {
+                std::unique_lock<std::mutex> lock(error_mutex);
+                if (!error){error = std::current_exception();}
+            }
+        }
+        running.fetch_sub(1, std::memory_order_release);
+    };
+    for (std::size_t i = 1; i < n_runners; ++i){push(runner);}
+    runner();
+    while (running.load(std::memory_order_acquire) > 0)
+    {
+        if (!run_one()){std::this_thread::yield();}
+    }
+    if (error){std::rethrow_exception(error);}
+};
+
+/**
+ * @fn template <typename T, typename M, typename R> T ThreadPool::parallel_reduce(std::size_t n, std::size_t chunk, const T identity, M map, R reduce)
+ * @brief Maps the chunks of [0, n) in parallel and reduces them in their order.
+ * @param n The number of indices.
+ * @param chunk The number of indices of a chunk, 0 for the automatic chunking, the result
+ * depends on the chunking but not on the number of threads.
+ * @param identity The identity of the reduction.
+ * @param map The map, map(begin, end) gives the partial result of the chunk [begin, end).
+ * @param reduce The reduction, reduce(a, b) combines two partial results.
+ * @return The reduction of the partial results of the chunks.
+ * @throw ThreadPoolStopped
+ */
@@ -0,0 +1,83 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+class ThreadPoolStopped:  public std::exception
+{public: const char * what() const throw();};
+
+class ThreadPool
+{
+    public:
+        ThreadPool(std::size_t n_threads);
+        ThreadPool(std::size_t n_threads, bool pin_threads);
+        virtual ~ThreadPool();
+        std::size_t size();
+        std::size_t get_chunk(std::size_t n, std::size_t chunk);
+        int get_worker_cpu(std::size_t i);
+        int get_worker_node(std::size_t i);
+        template <typename F>
+        std::future<void> submit(F task);
+        void parallel_for(std::size_t n, const std::function<void(std::size_t)>& task);
+        void parallel_for(
+            std::size_t n,
+            std::size_t chunk,
+            const std::function<void(std::size_t begin, std::size_t end)>& task);
+        template <typename T, typename M, typename R>
+        T parallel_reduce(std::size_t n, std::size_t chunk, const T identity, M map, R reduce);
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+            int cpu;
+            int node;
+            std::vector<std::size_t> victims;
+        };
+        void work(std::size_t index);
+        void push(std::function<void()> task);
+        bool pop(std::size_t index, std::function<void()>& task);
+        bool steal(std::size_t index, std::function<void()>& task);
+        bool run_one();
+        std::vector<std::unique_ptr<WorkerQueue>> queues_;
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::atomic<std::size_t> pending_;
+        std::atomic<std::size_t> next_queue_;
+        std::atomic<bool> stopped_;
+};
+
+template <typename F>
+std::future<void> ThreadPool::submit(F task)
+{
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> result = packaged->get_future();
+    push([packaged](){(*packaged)();});
+    return result;
+};
+
+template <typename T, typename M, typename R>
+T ThreadPool::parallel_reduce(std::size_t n, std::size_t chunk, const T identity, M map, R reduce)
+{
+    chunk = get_chunk(n, chunk);
+    std::vector<T> partials((n + chunk - 1)/chunk, identity);
+    parallel_for(n, chunk, [&](std::size_t begin, std::size_t end){partials[begin/chunk] = map(begin, end);});
+    T result = identity;
+    for (const T& partial : partials){result = reduce(result, partial);}
+    return result;
+};